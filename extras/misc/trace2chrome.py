@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+# -*- coding: utf8 -*-
+#
+# Copyright © 2024 VLC authors and VideoLAN
+#
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+#
+# Converts the binary traces of the ring tracer (vlc --tracer=ring) to the
+# Chrome trace event JSON format, which Perfetto (ui.perfetto.dev) and
+# chrome://tracing can load.
+#
+# Each trace becomes an instant event on the track of the thread that emitted
+# it, named after its "type" (and "event" if any), with all values as
+# arguments. Timestamp values (pts, dts, pcr...) are also emitted as counters
+# per type and id, in milliseconds, to plot the clocks against each other.
+#
+# Usage: trace2chrome.py [--no-counters] vlc-trace.bin > trace.json
+
+import json
+import struct
+import sys
+
+MAGIC = b"VLCTRACE"
+VERSION = 2
+
+TRACER_INT = 0
+TRACER_TICK = 1
+TRACER_STRING = 2
+
+RECORD_TRUNCATED = 0x1
+RECORD_DROPPED = 0x2
+
+
+def parse_entries(order, payload):
+    entries = []
+    i = 0
+    while i < len(payload):
+        kind = payload[i]
+        keylen = payload[i + 1]
+        key = payload[i + 2:i + 2 + keylen].decode("utf-8", "replace")
+        i += 2 + keylen
+        if kind == TRACER_STRING:
+            vallen = payload[i]
+            value = payload[i + 1:i + 1 + vallen].decode("utf-8", "replace")
+            i += 1 + vallen
+        else:
+            value = struct.unpack_from(order + "q", payload, i)[0]
+            i += 8
+        entries.append((kind, key, value))
+    return entries
+
+
+def read_records(f):
+    hdr = f.read(16)
+    if len(hdr) < 16 or hdr[:8] != MAGIC:
+        raise ValueError("not a VLC ring tracer file")
+    order = "<" if struct.unpack_from("<H", hdr, 8)[0] == 0x0102 else ">"
+    version, size = struct.unpack_from(order + "HI", hdr, 10)
+    if version != VERSION:
+        raise ValueError("unsupported version %d" % version)
+
+    while True:
+        rec = f.read(size)
+        if len(rec) < size:
+            break
+        ts, tid, length, flags = struct.unpack_from(order + "qIHH", rec, 0)
+        yield ts, tid, flags, parse_entries(order, rec[16:16 + length])
+
+
+def convert(f, counters):
+    events = []
+    for ts, tid, flags, entries in read_records(f):
+        ev = {"ph": "i", "s": "t", "pid": 1, "tid": tid, "ts": ts}
+        args = {}
+        for kind, key, value in entries:
+            args[key] = value
+
+        if flags & RECORD_DROPPED:
+            ev["name"] = "dropped traces"
+            ev["s"] = "g"
+        else:
+            name = args.pop("type", "trace")
+            if "event" in args:
+                name += ": " + str(args.pop("event"))
+            ev["name"] = name
+        if flags & RECORD_TRUNCATED:
+            args["truncated"] = True
+        ev["args"] = args
+        events.append(ev)
+
+        if counters and not flags & RECORD_DROPPED:
+            values = {key: value / 1e3 for kind, key, value in entries
+                      if kind == TRACER_TICK}
+            if values:
+                track = ev["name"]
+                if "id" in args:
+                    track += " " + str(args["id"])
+                events.append({"ph": "C", "pid": 1, "name": track,
+                               "ts": ev["ts"], "args": values})
+
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main(argv):
+    counters = "--no-counters" not in argv
+    paths = [a for a in argv[1:] if not a.startswith("--")]
+    if len(paths) != 1:
+        sys.stderr.write("Usage: %s [--no-counters] <trace file>\n" % argv[0])
+        return 1
+
+    with open(paths[0], "rb") as f:
+        json.dump(convert(f, counters), sys.stdout)
+    sys.stdout.write("\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
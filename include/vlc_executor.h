@@ -60,6 +60,21 @@ struct vlc_runnable {
 
     /* Private data used by the vlc_executor_t (do not touch) */
     struct vlc_list node;
+    void *queue;
+};
+
+/**
+ * Runnable priority classes.
+ *
+ * Executor threads always run queued runnables of a higher priority first.
+ */
+enum vlc_executor_priority {
+    /** Work nobody is waiting for (e.g. media library scanning) */
+    VLC_EXECUTOR_PRIORITY_BACKGROUND,
+    /** Default priority, used by vlc_executor_Submit() */
+    VLC_EXECUTOR_PRIORITY_NORMAL,
+    /** Work the user is waiting for (e.g. a thumbnail being displayed) */
+    VLC_EXECUTOR_PRIORITY_INTERACTIVE,
 };
 
 /**
@@ -145,6 +160,21 @@ vlc_executor_Delete(vlc_executor_t *executor);
 VLC_API void
 vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable);
 
+/**
+ * Submit a runnable for execution with a given priority.
+ *
+ * This is the same as vlc_executor_Submit(), except that the runnable is
+ * executed before any queued runnable of a lower priority.
+ *
+ * \param executor the executor
+ * \param runnable the task to run
+ * \param priority the priority class of the task
+ */
+VLC_API void
+vlc_executor_SubmitWithPriority(vlc_executor_t *executor,
+                                struct vlc_runnable *runnable,
+                                enum vlc_executor_priority priority);
+
 /**
  * Cancel a runnable previously submitted.
  *
@@ -516,6 +516,29 @@ VLC_API void libvlc_MetadataCancel( libvlc_int_t *, void * );
 /******************
  * Input stats
  ******************/
+/**
+ * Stages of the pipeline latency statistics
+ */
+enum input_stats_latency
+{
+    INPUT_STATS_LATENCY_DEMUX, /**< From the demuxer to the decoder input */
+    INPUT_STATS_LATENCY_DECODER, /**< From the decoder input to its output */
+    INPUT_STATS_LATENCY_VOUT, /**< From the decoder to the vout prerendering */
+    INPUT_STATS_LATENCY_DISPLAY, /**< From the previous stage to display */
+    INPUT_STATS_LATENCY_TOTAL, /**< From the demuxer to display */
+    INPUT_STATS_LATENCY_COUNT
+};
+
+/**
+ * Latency distribution of a pipeline stage
+ */
+struct input_stats_latency_t
+{
+    vlc_tick_t p50; /**< Median (or VLC_TICK_INVALID if no samples) */
+    vlc_tick_t p99; /**< 99th percentile */
+    vlc_tick_t max; /**< Maximum */
+};
+
 struct input_stats_t
 {
     /* Input */
@@ -542,6 +565,13 @@ struct input_stats_t
     /* Aout */
     int64_t i_played_abuffers;
     int64_t i_lost_abuffers;
+
+    /* Frames and audio buffers output later than the live latency target */
+    int64_t i_latency_misses;
+
+    /* Latency, indexed by enum input_stats_latency */
+    struct input_stats_latency_t video_latency[INPUT_STATS_LATENCY_COUNT];
+    struct input_stats_latency_t audio_latency[INPUT_STATS_LATENCY_COUNT];
 };
 
 /**
@@ -48,6 +48,9 @@ enum vlc_module_properties
     VLC_MODULE_DESCRIPTION,
     VLC_MODULE_HELP,
     VLC_MODULE_TEXTDOMAIN,
+    VLC_MODULE_PROBE_EXTENSIONS,
+    VLC_MODULE_PROBE_MIME,
+    VLC_MODULE_PROBE_MAGIC,
     /* Insert new VLC_MODULE_* here */
 
     /* DO NOT EVER REMOVE, INSERT OR REPLACE ANY ITEM! It would break the ABI!
@@ -359,6 +362,33 @@ VLC_METADATA_EXPORTS
     if (vlc_module_set (VLC_MODULE_NO_UNLOAD)) \
         goto error;
 
+/**
+ * Declares the content accepted by the module when it is not forced.
+ *
+ * If any of these hints is set, the core may skip the module without loading
+ * it when probing content that matches none of them.
+ *
+ * \param exts comma-separated file extensions, without the dot
+ */
+#define set_probe_extensions( exts ) \
+    if (vlc_module_set (VLC_MODULE_PROBE_EXTENSIONS, VLC_CHECKED_TYPE(const char *, exts))) \
+        goto error;
+
+/**
+ * \param types comma-separated MIME types
+ */
+#define set_probe_mime( types ) \
+    if (vlc_module_set (VLC_MODULE_PROBE_MIME, VLC_CHECKED_TYPE(const char *, types))) \
+        goto error;
+
+/**
+ * \param magic comma-separated hexadecimal patterns of the first bytes of
+ *              the content, "??" matching any byte (e.g. "52494646????????57415645")
+ */
+#define set_probe_magic( magic ) \
+    if (vlc_module_set (VLC_MODULE_PROBE_MAGIC, VLC_CHECKED_TYPE(const char *, magic))) \
+        goto error;
+
 #define set_text_domain( dom ) \
     if (vlc_plugin_set (VLC_MODULE_TEXTDOMAIN, VLC_CHECKED_TYPE(const char *, dom))) \
         goto error;
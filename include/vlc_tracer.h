@@ -111,6 +111,14 @@ static inline struct vlc_tracer_entry vlc_tracer_entry_FromTick(const char *key,
     return trace;
 }
 
+static inline struct vlc_tracer_entry vlc_tracer_entry_FromInt(const char *key, int64_t value)
+{
+    vlc_tracer_value_t tracer_value;
+    tracer_value.integer = value;
+    struct vlc_tracer_entry trace = { key, tracer_value, VLC_TRACER_INT };
+    return trace;
+}
+
 static inline struct vlc_tracer_entry vlc_tracer_entry_FromString(const char *key, const char *value)
 {
     vlc_tracer_value_t tracer_value;
@@ -148,6 +156,10 @@ static inline struct vlc_tracer_entry VLC_TRACE(const char *key, const char *val
 }
 #endif
 
+/* Plain integers can't be told apart from vlc_tick_t by VLC_TRACE() */
+#define VLC_TRACE_INT(key, value) \
+        vlc_tracer_entry_FromInt(key, value)
+
 /*
  * Helper trace functions
  */
@@ -204,6 +204,20 @@ struct vout_display_owner_t {
      * from multiple threads.
      */
     void (*viewpoint_moved)(void *sys, const vlc_viewpoint_t *vp);
+
+    /* Presentation feedback from the module
+     *
+     * It can be NULL and must be used through
+     * vout_display_SendEventPresented(). It can be called from any thread.
+     */
+    void (*presented)(void *sys, vlc_tick_t date, uint64_t sequence);
+
+    /* Refresh period hint from the module
+     *
+     * It can be NULL and must be used through
+     * vout_display_SendEventRefreshPeriod(). It can be called from any thread.
+     */
+    void (*refresh_period)(void *sys, vlc_tick_t period);
 };
 
 /**
@@ -444,6 +458,42 @@ static inline void vout_display_SendEventViewpointMoved(vout_display_t *vd,
         vd->owner.viewpoint_moved(vd->owner.sys, vp);
 }
 
+/**
+ * Reports that the last displayed picture has been scanned out.
+ *
+ * Displays able to timestamp their vertical blanking (e.g. with page flip
+ * events) should report every picture taking effect on screen, so that the
+ * video output can measure the display latency and align the display dates
+ * to the refresh grid.
+ *
+ * \param date system date of the vblank the picture was scanned out at
+ * \param sequence vblank counter of that vblank, 0 if unknown
+ */
+static inline void vout_display_SendEventPresented(vout_display_t *vd,
+                                                   vlc_tick_t date,
+                                                   uint64_t sequence)
+{
+    if (vd->owner.presented)
+        vd->owner.presented(vd->owner.sys, date, sequence);
+}
+
+/**
+ * Reports the refresh period of the display mode.
+ *
+ * Displays that know their mode should report its period on open and on mode
+ * changes, so that the video output can align the display dates from the
+ * first presentation report, before the period is measured from the
+ * vblank counter.
+ *
+ * \param period refresh period, 0 if unknown
+ */
+static inline void vout_display_SendEventRefreshPeriod(vout_display_t *vd,
+                                                       vlc_tick_t period)
+{
+    if (vd->owner.refresh_period)
+        vd->owner.refresh_period(vd->owner.sys, period);
+}
+
 /**
  * Helper function that applies the necessary transforms to the mouse position
  * and then calls vout_display_SendEventMouseMoved.
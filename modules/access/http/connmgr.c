@@ -23,7 +23,9 @@
 #endif
 
 #include <assert.h>
+#include <string.h>
 #include <vlc_common.h>
+#include <vlc_list.h>
 #include <vlc_network.h>
 #include <vlc_tls.h>
 #include <vlc_url.h>
@@ -96,50 +98,276 @@ static char *vlc_http_proxy_find(const char *hostname, unsigned port,
 }
 
 
+/** Maximum number of connections kept open to a single origin */
+#define VLC_HTTP_MGR_MAX_PER_ORIGIN 4
+/** Maximum number of connections kept open overall */
+#define VLC_HTTP_MGR_MAX 16
+/** Delay without any open stream after which a connection is closed */
+#define VLC_HTTP_MGR_IDLE_TIMEOUT VLC_TICK_FROM_SEC(30)
+
+/**
+ * Pooled connection.
+ *
+ * Connections are keyed by origin (scheme, host and port) and by the proxy
+ * they go through, if any.
+ */
+struct vlc_http_mgr_conn
+{
+    struct vlc_http_conn *conn;
+    struct vlc_list node; /**< Pool node, most recently used first */
+    vlc_tick_t last_used; /**< Time of the last request or stream close */
+    unsigned streams; /**< Open streams */
+    bool secure;
+    bool multiplex; /**< Whether concurrent streams are supported (HTTP/2) */
+    unsigned port;
+    char *proxy;
+    char host[];
+};
+
 struct vlc_http_mgr
 {
     struct vlc_logger *logger;
     vlc_object_t *obj;
     vlc_tls_client_t *creds;
     struct vlc_http_cookie_jar_t *jar;
-    struct vlc_http_conn *conn;
+    struct vlc_list conns;
+    unsigned count;
 };
 
-static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
-                                               const char *host, unsigned port)
+static bool vlc_http_mgr_match(const struct vlc_http_mgr_conn *c, bool secure,
+                               const char *host, unsigned port,
+                               const char *proxy)
 {
-    (void) host; (void) port;
-    return mgr->conn;
+    if (c->secure != secure || c->port != port || strcasecmp(c->host, host))
+        return false;
+    if (c->proxy == NULL || proxy == NULL)
+        return c->proxy == proxy;
+    return strcmp(c->proxy, proxy) == 0;
+}
+
+static void vlc_http_mgr_conn_free(struct vlc_http_mgr_conn *c)
+{
+    free(c->proxy);
+    free(c);
 }
 
 static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
-                                 struct vlc_http_conn *conn)
+                                 struct vlc_http_mgr_conn *c)
+{
+    assert(mgr->count > 0);
+    vlc_list_remove(&c->node);
+    mgr->count--;
+
+    vlc_http_conn_release(c->conn);
+    c->conn = NULL;
+    /* Open streams keep the entry until they are closed */
+    if (c->streams == 0)
+        vlc_http_mgr_conn_free(c);
+}
+
+/**
+ * Stream of a pooled connection.
+ *
+ * It forwards to the stream of the connection, so that the manager knows
+ * whether the connection is busy and when it was last used.
+ */
+struct vlc_http_mgr_stream
+{
+    struct vlc_http_stream stream;
+    struct vlc_http_stream *payload;
+    struct vlc_http_mgr_conn *conn;
+};
+
+static struct vlc_http_msg *
+vlc_http_mgr_stream_read_headers(struct vlc_http_stream *stream)
+{
+    struct vlc_http_mgr_stream *s =
+        container_of(stream, struct vlc_http_mgr_stream, stream);
+    struct vlc_http_msg *m = vlc_http_stream_read_headers(s->payload);
+
+    /* The payload can change with the message, e.g. to a chunked stream */
+    if (m != NULL)
+        s->payload = vlc_http_msg_interpose(m, stream);
+    return m;
+}
+
+static ssize_t vlc_http_mgr_stream_write(struct vlc_http_stream *stream,
+                                         const void *base, size_t length,
+                                         bool eos)
+{
+    struct vlc_http_mgr_stream *s =
+        container_of(stream, struct vlc_http_mgr_stream, stream);
+
+    return vlc_http_stream_write(s->payload, base, length, eos);
+}
+
+static block_t *vlc_http_mgr_stream_read(struct vlc_http_stream *stream)
+{
+    struct vlc_http_mgr_stream *s =
+        container_of(stream, struct vlc_http_mgr_stream, stream);
+
+    return vlc_http_stream_read(s->payload);
+}
+
+static void vlc_http_mgr_stream_close(struct vlc_http_stream *stream,
+                                      bool abort)
+{
+    struct vlc_http_mgr_stream *s =
+        container_of(stream, struct vlc_http_mgr_stream, stream);
+    struct vlc_http_mgr_conn *c = s->conn;
+
+    vlc_http_stream_close(s->payload, abort);
+    free(s);
+
+    /* The idle delay starts when the last stream is closed */
+    assert(c->streams > 0);
+    c->last_used = vlc_tick_now();
+    if (--c->streams == 0 && c->conn == NULL)
+        vlc_http_mgr_conn_free(c);
+}
+
+static const struct vlc_http_stream_cbs vlc_http_mgr_stream_callbacks =
+{
+    vlc_http_mgr_stream_read_headers,
+    vlc_http_mgr_stream_write,
+    vlc_http_mgr_stream_read,
+    vlc_http_mgr_stream_close,
+};
+
+/** Reads the initial response of a stream of a pooled connection */
+static struct vlc_http_msg *
+vlc_http_mgr_get_initial(struct vlc_http_mgr_conn *c,
+                         struct vlc_http_stream *payload)
+{
+    struct vlc_http_mgr_stream *s = malloc(sizeof (*s));
+    if (unlikely(s == NULL))
+    {
+        vlc_http_stream_close(payload, true);
+        return NULL;
+    }
+
+    s->stream.cbs = &vlc_http_mgr_stream_callbacks;
+    s->payload = payload;
+    s->conn = c;
+    c->streams++;
+    return vlc_http_msg_get_initial(&s->stream);
+}
+
+/** Closes the connections that have been idle for too long */
+static void vlc_http_mgr_expire(struct vlc_http_mgr *mgr, vlc_tick_t now)
+{
+    struct vlc_http_mgr_conn *c;
+
+    vlc_list_foreach(c, &mgr->conns, node)
+        if (c->streams == 0
+         && now - c->last_used >= VLC_HTTP_MGR_IDLE_TIMEOUT)
+        {
+            vlc_http_dbg(mgr->logger, "closing idle connection to %s:%u",
+                         c->host, c->port);
+            vlc_http_mgr_release(mgr, c);
+        }
+}
+
+/**
+ * Adds a new connection to the pool.
+ *
+ * If the pool is full, for the origin or overall, the least recently used
+ * connection is closed to make room.
+ *
+ * \return the pooled connection, or NULL on error
+ */
+static struct vlc_http_mgr_conn *vlc_http_mgr_add(struct vlc_http_mgr *mgr,
+                            struct vlc_http_conn *conn, bool secure,
+                            const char *host, unsigned port, const char *proxy,
+                            bool multiplex)
 {
-    assert(mgr->conn == conn);
-    mgr->conn = NULL;
+    size_t len = strlen(host) + 1;
+    struct vlc_http_mgr_conn *c = malloc(sizeof (*c) + len);
+    if (unlikely(c == NULL))
+        return NULL;
 
-    vlc_http_conn_release(conn);
+    c->proxy = NULL;
+    if (proxy != NULL)
+    {
+        c->proxy = strdup(proxy);
+        if (unlikely(c->proxy == NULL))
+        {
+            free(c);
+            return NULL;
+        }
+    }
+
+    struct vlc_http_mgr_conn *oldest = NULL, *it;
+    unsigned same = 0;
+
+    vlc_list_foreach(it, &mgr->conns, node)
+        if (vlc_http_mgr_match(it, secure, host, port, proxy))
+        {
+            oldest = it;
+            same++;
+        }
+
+    if (same >= VLC_HTTP_MGR_MAX_PER_ORIGIN)
+        vlc_http_mgr_release(mgr, oldest);
+    else if (mgr->count >= VLC_HTTP_MGR_MAX)
+        vlc_http_mgr_release(mgr, vlc_list_last_entry_or_null(&mgr->conns,
+                                               struct vlc_http_mgr_conn, node));
+
+    c->conn = conn;
+    c->last_used = vlc_tick_now();
+    c->streams = 0;
+    c->secure = secure;
+    c->multiplex = multiplex;
+    c->port = port;
+    memcpy(c->host, host, len);
+    vlc_list_prepend(&c->node, &mgr->conns);
+    mgr->count++;
+    return c;
 }
 
+/**
+ * Sends a request through an existing connection to the origin.
+ *
+ * HTTP/2 connections are shared by concurrent requests. HTTP/1.x connections
+ * carry one request at a time, so busy ones are skipped. Failed connections
+ * are closed and the next candidate is tried.
+ */
 static
-struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
+struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr, bool secure,
                                         const char *host, unsigned port,
+                                        const char *proxy,
                                         const struct vlc_http_msg *req,
                                         bool payload)
 {
-    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
-    if (conn == NULL)
-        return NULL;
+    struct vlc_http_mgr_conn *c;
+    vlc_tick_t now = vlc_tick_now();
 
-    struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
-    if (stream != NULL)
+    vlc_http_mgr_expire(mgr, now);
+
+    vlc_list_foreach(c, &mgr->conns, node)
     {
-        struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
-        if (m != NULL)
-            return m;
+        if (!vlc_http_mgr_match(c, secure, host, port, proxy))
+            continue;
+
+        struct vlc_http_stream *stream = vlc_http_stream_open(c->conn, req,
+                                                              payload);
+        if (stream == NULL && !c->multiplex && c->conn->tls != NULL)
+            continue; /* HTTP/1.x connection busy with another request */
+
+        if (stream != NULL)
+        {
+            struct vlc_http_msg *m = vlc_http_mgr_get_initial(c, stream);
+            if (m != NULL)
+            {   /* Move to the front of the pool */
+                c->last_used = now;
+                vlc_list_remove(&c->node);
+                vlc_list_prepend(&c->node, &mgr->conns);
+                return m;
+            }
+        }
+        /* Get rid of closing or reset connection */
+        vlc_http_mgr_release(mgr, c);
     }
-    /* Get rid of closing or reset connection */
-    vlc_http_mgr_release(mgr, conn);
     return NULL;
 }
 
@@ -151,40 +379,43 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     vlc_tls_t *tls;
     bool http2 = true;
 
-    if (mgr->creds == NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTP to HTTPS not implemented */
-
     if (mgr->creds == NULL)
-    {   /* First TLS connection: load x509 credentials */
+    {   /* First TLS connection: load x509 credentials.
+         * They are kept for the lifetime of the manager, so that the TLS
+         * sessions can be resumed by later connections. */
         mgr->creds = vlc_tls_ClientCreate(mgr->obj);
         if (mgr->creds == NULL)
             return NULL;
     }
 
+    char *proxy = vlc_http_proxy_find(host, port, true);
+
     if (idempotent)
     {   /* If the request is idempotent, try to reuse an existing connection.
          * Otherwise, it is possible but unadvisable as we would not know if
          * the nonidempotent request was processed if the connection fails
          * before the response is received.
          */
-        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req,
-                                                       payload);
+        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, true, host, port,
+                                                       proxy, req, payload);
         if (resp != NULL)
+        {
+            free(proxy);
             return resp; /* existing connection reused */
+        }
     }
 
-    char *proxy = vlc_http_proxy_find(host, port, true);
     if (proxy != NULL)
-    {
         tls = vlc_https_connect_proxy(mgr->creds, mgr->creds,
                                       host, port, &http2, proxy);
-        free(proxy);
-    }
     else
         tls = vlc_https_connect(mgr->creds, host, port, &http2);
 
     if (tls == NULL)
+    {
+        free(proxy);
         return NULL;
+    }
 
     struct vlc_http_conn *conn;
 
@@ -203,14 +434,21 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     if (unlikely(conn == NULL))
     {
         vlc_tls_Close(tls);
+        free(proxy);
         return NULL;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
+    if (vlc_http_mgr_add(mgr, conn, true, host, port, proxy, http2) == NULL)
+    {
+        vlc_http_conn_release(conn);
+        free(proxy);
+        return NULL;
+    }
 
-    mgr->conn = conn;
-    return vlc_http_mgr_reuse(mgr, host, port, req, payload);
+    struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, true, host, port,
+                                                   proxy, req, payload);
+    free(proxy);
+    return resp;
 }
 
 static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
@@ -218,27 +456,27 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
                                              const struct vlc_http_msg *req,
                                              bool idempotent, bool payload)
 {
-    if (mgr->creds != NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTPS to HTTP not implemented */
+    char *proxy = vlc_http_proxy_find(host, port, false);
 
     if (idempotent)
     {
-        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req,
-                                                       payload);
+        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, false, host, port,
+                                                       proxy, req, payload);
         if (resp != NULL)
+        {
+            free(proxy);
             return resp;
+        }
     }
 
     struct vlc_http_conn *conn;
     struct vlc_http_stream *stream;
 
-    char *proxy = vlc_http_proxy_find(host, port, false);
     if (proxy != NULL)
     {
         vlc_url_t url;
 
         vlc_UrlParse(&url, proxy);
-        free(proxy);
 
         if (url.psz_host != NULL)
             stream = vlc_h1_request(mgr->logger, url.psz_host,
@@ -254,19 +492,28 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
                                 req, idempotent, payload, &conn);
 
     if (stream == NULL)
-        return NULL;
-
-    struct vlc_http_msg *resp = vlc_http_msg_get_initial(stream);
-    if (resp == NULL)
     {
-        vlc_http_conn_release(conn);
+        free(proxy);
         return NULL;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
+    struct vlc_http_mgr_conn *c = vlc_http_mgr_add(mgr, conn, false, host,
+                                                   port, proxy, false);
+    struct vlc_http_msg *resp;
+
+    if (c != NULL)
+    {
+        resp = vlc_http_mgr_get_initial(c, stream);
+        if (resp == NULL)
+            vlc_http_mgr_release(mgr, c);
+    }
+    else
+    {
+        resp = vlc_http_msg_get_initial(stream);
+        vlc_http_conn_release(conn); /* not reusable, closed after use */
+    }
 
-    mgr->conn = conn;
+    free(proxy);
     return resp;
 }
 
@@ -298,14 +545,17 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     mgr->obj = obj;
     mgr->creds = NULL;
     mgr->jar = jar;
-    mgr->conn = NULL;
+    vlc_list_init(&mgr->conns);
+    mgr->count = 0;
     return mgr;
 }
 
 void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
 {
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
+    struct vlc_http_mgr_conn *c;
+
+    vlc_list_foreach(c, &mgr->conns, node)
+        vlc_http_mgr_release(mgr, c);
     if (mgr->creds != NULL)
         vlc_tls_ClientDelete(mgr->creds);
     free(mgr);
@@ -0,0 +1,416 @@
+/*****************************************************************************
+ * connmgr_test.c: HTTP connection manager tests
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_network.h>
+#include <vlc_tls.h>
+#include "conn.h"
+#include "connmgr.h"
+#include "message.h"
+#include "transport.h"
+
+const char vlc_module_name[] = "test_http_connmgr";
+
+/* Fake network environment */
+static vlc_tls_t fake_tls;
+static vlc_tick_t fake_now = VLC_TICK_FROM_SEC(1000);
+static const char *proxy_url = NULL;
+static bool server_h2 = true;
+static bool server_reset = false;
+
+static unsigned created = 0, live = 0, proxied = 0;
+
+struct test_conn
+{
+    struct vlc_http_conn conn;
+    bool multiplex;
+    bool released;
+    unsigned streams;
+    unsigned requests;
+};
+
+struct test_stream
+{
+    struct vlc_http_stream stream;
+    struct test_conn *conn;
+    bool reset;
+};
+
+static struct test_conn *last_conn;
+
+static void conn_destroy(struct test_conn *conn)
+{
+    assert(conn->released);
+    assert(conn->streams == 0);
+    free(conn);
+}
+
+static struct vlc_http_msg *stream_read_headers(struct vlc_http_stream *s)
+{
+    struct test_stream *ts = container_of(s, struct test_stream, stream);
+
+    if (ts->reset)
+        return NULL;
+
+    struct vlc_http_msg *m = vlc_http_resp_create(200);
+    assert(m != NULL);
+    vlc_http_msg_attach(m, s);
+    return m;
+}
+
+static void stream_close(struct vlc_http_stream *s, bool abort)
+{
+    struct test_stream *ts = container_of(s, struct test_stream, stream);
+    struct test_conn *conn = ts->conn;
+
+    (void) abort;
+    free(ts);
+
+    assert(conn->streams > 0);
+    if (--conn->streams == 0 && conn->released)
+        conn_destroy(conn);
+}
+
+static const struct vlc_http_stream_cbs stream_callbacks =
+{
+    stream_read_headers,
+    NULL,
+    NULL,
+    stream_close,
+};
+
+static struct vlc_http_stream *conn_stream_open(struct vlc_http_conn *c,
+                                                const struct vlc_http_msg *req,
+                                                bool has_data)
+{
+    struct test_conn *conn = container_of(c, struct test_conn, conn);
+
+    assert(req != NULL);
+    assert(!has_data);
+    assert(!conn->released);
+
+    if (!conn->multiplex && conn->streams > 0)
+        return NULL; /* HTTP/1.x: one request at a time */
+
+    struct test_stream *ts = malloc(sizeof (*ts));
+    assert(ts != NULL);
+    ts->stream.cbs = &stream_callbacks;
+    ts->conn = conn;
+    ts->reset = server_reset;
+    conn->streams++;
+    conn->requests++;
+    return &ts->stream;
+}
+
+static void conn_release(struct vlc_http_conn *c)
+{
+    struct test_conn *conn = container_of(c, struct test_conn, conn);
+
+    assert(!conn->released);
+    conn->released = true;
+    live--;
+
+    if (conn->streams == 0)
+        conn_destroy(conn);
+}
+
+static const struct vlc_http_conn_cbs conn_callbacks =
+{
+    conn_stream_open,
+    conn_release,
+};
+
+static struct vlc_http_conn *conn_create(bool multiplex)
+{
+    struct test_conn *conn = malloc(sizeof (*conn));
+    assert(conn != NULL);
+
+    conn->conn.cbs = &conn_callbacks;
+    conn->conn.tls = &fake_tls;
+    conn->multiplex = multiplex;
+    conn->released = false;
+    conn->streams = 0;
+    conn->requests = 0;
+    created++;
+    live++;
+    last_conn = conn;
+    return &conn->conn;
+}
+
+struct vlc_http_conn *vlc_h1_conn_create(void *ctx, vlc_tls_t *tls,
+                                         bool proxy)
+{
+    assert(tls == &fake_tls);
+    assert(!proxy);
+    (void) ctx;
+    return conn_create(false);
+}
+
+struct vlc_http_conn *vlc_h2_conn_create(void *ctx, vlc_tls_t *tls)
+{
+    assert(tls == &fake_tls);
+    (void) ctx;
+    return conn_create(true);
+}
+
+struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
+                                       unsigned port, bool proxy,
+                                       const struct vlc_http_msg *req,
+                                       bool idempotent, bool has_data,
+                                       struct vlc_http_conn **restrict connp)
+{
+    assert(hostname != NULL && port != 0);
+    assert(proxy == (proxy_url != NULL));
+    (void) ctx; (void) idempotent;
+
+    struct vlc_http_conn *conn = conn_create(false);
+    struct vlc_http_stream *s = vlc_http_stream_open(conn, req, has_data);
+    assert(s != NULL);
+    *connp = conn;
+    return s;
+}
+
+vlc_tls_t *vlc_tls_SocketOpenTLS(vlc_tls_client_t *crd, const char *hostname,
+                                 unsigned port, const char *service,
+                                 const char *const *alpn, char **alp)
+{
+    assert(crd != NULL);
+    assert(hostname != NULL && port != 0);
+    assert(!strcmp(service, "https"));
+
+    *alp = strdup((server_h2 && !strcmp(alpn[0], "h2")) ? "h2" : "http/1.1");
+    return &fake_tls;
+}
+
+vlc_tls_t *vlc_https_connect_proxy(void *ctx, vlc_tls_client_t *creds,
+                                   const char *hostname, unsigned port,
+                                   bool *restrict two, const char *proxy)
+{
+    assert(creds != NULL && ctx == creds);
+    assert(hostname != NULL);
+    assert(!strcmp(proxy, proxy_url));
+    (void) port;
+
+    *two = server_h2;
+    proxied++;
+    return &fake_tls;
+}
+
+static char fake_creds;
+
+vlc_tls_client_t *vlc_tls_ClientCreate(vlc_object_t *obj)
+{
+    (void) obj;
+    return (vlc_tls_client_t *)&fake_creds;
+}
+
+void vlc_tls_ClientDelete(vlc_tls_client_t *crd)
+{
+    assert(crd == (vlc_tls_client_t *)&fake_creds);
+}
+
+char *vlc_getProxyUrl(const char *url)
+{
+    (void) url;
+    return (proxy_url != NULL) ? strdup(proxy_url) : NULL;
+}
+
+vlc_tick_t vlc_tick_now(void)
+{
+    return fake_now;
+}
+
+static struct vlc_http_msg *request(struct vlc_http_mgr *mgr, bool https,
+                                    const char *host, unsigned port,
+                                    bool idempotent)
+{
+    struct vlc_http_msg *req = vlc_http_req_create(idempotent ? "GET" : "POST",
+                                                   https ? "https" : "http",
+                                                   host, "/");
+    assert(req != NULL);
+
+    struct vlc_http_msg *resp = vlc_http_mgr_request(mgr, https, host, port,
+                                                     req, idempotent, false);
+    vlc_http_msg_destroy(req);
+    return resp;
+}
+
+int main(void)
+{
+    vlc_object_t obj = { .logger = NULL };
+    struct vlc_http_mgr *mgr = vlc_http_mgr_create(&obj, NULL);
+    struct vlc_http_msg *m[8];
+    struct test_conn *conn;
+
+    assert(mgr != NULL);
+
+    /* HTTP/2: concurrent requests are multiplexed on one connection */
+    m[0] = request(mgr, true, "www.example.com", 0, true);
+    assert(m[0] != NULL);
+    assert(created == 1);
+    conn = last_conn;
+    m[1] = request(mgr, true, "www.example.com", 0, true);
+    m[2] = request(mgr, true, "www.example.com", 0, true);
+    assert(m[1] != NULL && m[2] != NULL);
+    assert(created == 1);
+    assert(conn->requests == 3 && conn->streams == 3);
+    for (unsigned i = 0; i < 3; i++)
+        vlc_http_msg_destroy(m[i]);
+    assert(conn->streams == 0);
+
+    /* Connections are keyed by origin */
+    m[0] = request(mgr, true, "www.example.com", 8443, true);
+    m[1] = request(mgr, true, "www.example.org", 0, true);
+    assert(m[0] != NULL && m[1] != NULL);
+    assert(created == 3 && live == 3);
+    vlc_http_msg_destroy(m[0]);
+    vlc_http_msg_destroy(m[1]);
+    m[0] = request(mgr, true, "WWW.EXAMPLE.COM", 0, true);
+    assert(m[0] != NULL);
+    assert(created == 3 && conn->requests == 4);
+    vlc_http_msg_destroy(m[0]);
+
+    /* Non-idempotent requests get a new connection */
+    m[0] = request(mgr, true, "www.example.com", 0, false);
+    assert(m[0] != NULL);
+    assert(created == 4);
+    vlc_http_msg_destroy(m[0]);
+
+    /* HTTP/1.1: one request at a time per connection, bounded per origin */
+    m[0] = request(mgr, false, "www.example.com", 0, true);
+    assert(m[0] != NULL);
+    assert(created == 5 && live == 5);
+    vlc_http_msg_destroy(m[0]);
+    m[0] = request(mgr, false, "www.example.com", 0, true);
+    assert(created == 5); /* reused */
+
+    for (unsigned i = 1; i < 8; i++)
+    {
+        m[i] = request(mgr, false, "www.example.com", 0, true);
+        assert(m[i] != NULL);
+    }
+    assert(created == 12);
+    assert(live == 4 + 4); /* 4 HTTPS connections, 4 HTTP connections */
+    for (unsigned i = 0; i < 8; i++)
+        vlc_http_msg_destroy(m[i]);
+
+    m[0] = request(mgr, false, "www.example.com", 0, true);
+    m[1] = request(mgr, false, "www.example.com", 0, true);
+    assert(m[0] != NULL && m[1] != NULL);
+    assert(created == 12);
+    vlc_http_msg_destroy(m[0]);
+    vlc_http_msg_destroy(m[1]);
+
+    /* HTTP/1.1 over TLS, when HTTP/2 is not negotiated */
+    server_h2 = false;
+    m[0] = request(mgr, true, "www.example.net", 0, true);
+    m[1] = request(mgr, true, "www.example.net", 0, true);
+    assert(m[0] != NULL && m[1] != NULL);
+    assert(created == 14);
+    vlc_http_msg_destroy(m[0]);
+    vlc_http_msg_destroy(m[1]);
+    m[0] = request(mgr, true, "www.example.net", 0, true);
+    assert(created == 14);
+    vlc_http_msg_destroy(m[0]);
+    server_h2 = true;
+
+    /* Reset connections are discarded */
+    unsigned before = live;
+    server_reset = true;
+    m[0] = request(mgr, true, "www.example.org", 0, true);
+    assert(m[0] == NULL);
+    assert(created == 15);
+    assert(live == before - 1);
+    server_reset = false;
+    m[0] = request(mgr, true, "www.example.org", 0, true);
+    assert(m[0] != NULL);
+    assert(created == 16);
+    vlc_http_msg_destroy(m[0]);
+
+    /* Connections through a proxy are kept apart */
+    proxy_url = "http://proxy.example.com:3128";
+    m[0] = request(mgr, true, "www.example.com", 0, true);
+    assert(m[0] != NULL);
+    assert(created == 17 && proxied == 1);
+    vlc_http_msg_destroy(m[0]);
+    m[0] = request(mgr, true, "www.example.com", 0, true);
+    assert(created == 17 && proxied == 1);
+    vlc_http_msg_destroy(m[0]);
+    m[0] = request(mgr, false, "www.example.com", 0, true);
+    assert(created == 18);
+    vlc_http_msg_destroy(m[0]);
+    proxy_url = NULL;
+
+    /* The pool is bounded overall */
+    assert(live <= 16);
+
+    /* Busy connections do not expire, and their idle delay starts when
+     * their last stream is closed */
+    m[0] = request(mgr, true, "www.example.com", 0, true);
+    assert(m[0] != NULL);
+    before = created;
+    fake_now += VLC_TICK_FROM_SEC(40);
+    m[1] = request(mgr, true, "www.example.com", 0, true);
+    assert(m[1] != NULL);
+    assert(created == before);
+    vlc_http_msg_destroy(m[1]);
+    fake_now += VLC_TICK_FROM_SEC(40);
+    vlc_http_msg_destroy(m[0]);
+    fake_now += VLC_TICK_FROM_SEC(20);
+    m[0] = request(mgr, true, "www.example.com", 0, true);
+    assert(m[0] != NULL);
+    assert(created == before);
+    vlc_http_msg_destroy(m[0]);
+
+    m[0] = request(mgr, false, "www.example.com", 0, true);
+    assert(m[0] != NULL);
+    before = created;
+    fake_now += VLC_TICK_FROM_SEC(40);
+    vlc_http_msg_destroy(m[0]);
+    m[0] = request(mgr, false, "www.example.com", 0, true);
+    assert(m[0] != NULL);
+    assert(created == before);
+    vlc_http_msg_destroy(m[0]);
+
+    /* Idle connections expire */
+    fake_now += VLC_TICK_FROM_SEC(3600);
+    m[0] = request(mgr, true, "www.example.com", 0, true);
+    assert(m[0] != NULL);
+    assert(live == 1);
+    assert(created == before + 1);
+    vlc_http_msg_destroy(m[0]);
+
+    /* Blocked port */
+    assert(request(mgr, false, "www.example.com", 25, true) == NULL);
+
+    vlc_http_mgr_destroy(mgr);
+    assert(live == 0);
+    return 0;
+}
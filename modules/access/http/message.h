@@ -346,6 +346,16 @@ struct vlc_http_stream;
 extern void *const vlc_http_error;
 
 void vlc_http_msg_attach(struct vlc_http_msg *m, struct vlc_http_stream *s);
+
+/**
+ * Interposes a stream between a message and its payload.
+ *
+ * \param s stream to attach to the message, which must forward to the
+ *          payload stream
+ * \return the previous payload stream of the message
+ */
+struct vlc_http_stream *vlc_http_msg_interpose(struct vlc_http_msg *m,
+                                               struct vlc_http_stream *s);
 struct vlc_http_msg *vlc_http_msg_get_initial(struct vlc_http_stream *s)
 VLC_USED;
 
@@ -24,6 +24,7 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #ifdef HAVE_POLL_H
 #include <poll.h>
 #endif
@@ -36,6 +37,9 @@
 #define MSG_TRUNC 0
 #endif
 
+/* Upper bound on datagrams per batched receive call */
+#define VLEN 64
+
 struct vlc_dgram_sock
 {
     int fd;
@@ -77,6 +81,39 @@ static ssize_t vlc_datagram_Recv(struct vlc_dtls *dgs, struct iovec *iov,
     return ret;
 }
 
+#ifdef HAVE_RECVMMSG
+static int vlc_datagram_RecvBatch(struct vlc_dtls *dgs,
+                                  struct vlc_dtls_msg *msgs, unsigned count)
+{
+    struct mmsghdr hdrs[VLEN];
+    struct iovec iovs[VLEN];
+    int fd = container_of(dgs, struct vlc_dgram_sock, s)->fd;
+
+    if (count > VLEN)
+        count = VLEN;
+
+    memset(hdrs, 0, count * sizeof (*hdrs));
+
+    for (unsigned i = 0; i < count; i++) {
+        iovs[i].iov_base = msgs[i].buf;
+        iovs[i].iov_len = msgs[i].len;
+        hdrs[i].msg_hdr.msg_iov = &iovs[i];
+        hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int ret = recvmmsg(fd, hdrs, count, MSG_WAITFORONE, NULL);
+
+    for (int i = 0; i < ret; i++) {
+        msgs[i].len = hdrs[i].msg_len;
+        msgs[i].truncated = (hdrs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    }
+
+    return ret;
+}
+#else
+# define vlc_datagram_RecvBatch NULL
+#endif
+
 static ssize_t vlc_datagram_Send(struct vlc_dtls *dgs,
                                  const struct iovec *iov, unsigned iovlen)
 {
@@ -94,6 +131,7 @@ static const struct vlc_dtls_operations vlc_datagram_ops = {
     vlc_datagram_GetPollFD,
     vlc_datagram_Recv,
     vlc_datagram_Send,
+    vlc_datagram_RecvBatch,
 };
 
 struct vlc_dtls *vlc_datagram_CreateFD(int fd)
@@ -145,6 +183,7 @@ static const struct vlc_dtls_operations vlc_dccp_ops = {
     vlc_datagram_GetPollFD,
     vlc_dccp_Recv,
     vlc_datagram_Send,
+    NULL, /* zero-length reads need special handling */
 };
 
 struct vlc_dtls *vlc_dccp_CreateFD(int fd)
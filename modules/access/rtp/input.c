@@ -47,6 +47,8 @@
 #endif
 
 #define DEFAULT_MRU (1500u - (20 + 8))
+/* Maximum number of datagrams received per wake-up */
+#define RTP_BATCH 32u
 
 /**
  * Processes a packet received from the RTP socket.
@@ -95,6 +97,15 @@ static int rtp_timeout (vlc_tick_t deadline)
     return t;
 }
 
+static void rtp_release_blocks (void *data)
+{
+    block_t **blocks = data;
+
+    for (unsigned i = 0; i < RTP_BATCH; i++)
+        if (blocks[i] != NULL)
+            block_Release (blocks[i]);
+}
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -104,9 +115,16 @@ void *rtp_dgram_thread (void *opaque)
     demux_sys_t *sys = demux->p_sys;
     vlc_tick_t deadline = VLC_TICK_INVALID;
     struct vlc_dtls *rtp_sock = sys->rtp_sock;
+    block_t *blocks[RTP_BATCH] = { NULL };
+    struct vlc_dtls_msg msgs[RTP_BATCH];
 
     vlc_thread_set_name("vlc-rtp");
 
+    sys->stats.calls = 0;
+    sys->stats.packets = 0;
+    sys->stats.max_batch = 0;
+
+    vlc_cleanup_push (rtp_release_blocks, blocks);
     for (;;)
     {
         struct pollfd ufd[1];
@@ -124,31 +142,68 @@ void *rtp_dgram_thread (void *opaque)
 
         if (ufd[0].revents)
         {
-            block_t *block = block_Alloc(DEFAULT_MRU);
-            if (unlikely(block == NULL))
+            /* Spare blocks are kept across wake-ups, refill the used ones */
+            unsigned count = 0;
+
+            while (count < RTP_BATCH)
+            {
+                if (blocks[count] == NULL)
+                {
+                    blocks[count] = block_Alloc(DEFAULT_MRU);
+                    if (unlikely(blocks[count] == NULL))
+                        break;
+                }
+                msgs[count].buf = blocks[count]->p_buffer;
+                msgs[count].len = blocks[count]->i_buffer;
+                count++;
+            }
+
+            if (unlikely(count == 0))
+            {
+                vlc_restorecancel (canc);
                 break; /* we are totallly screwed */
+            }
 
-            bool truncated;
-            ssize_t len = vlc_dtls_Recv(rtp_sock, block->p_buffer,
-                                       block->i_buffer, &truncated);
-            if (len >= 0) {
-                if (truncated) {
-                    msg_Err(demux, "packet truncated (MRU was %zu)",
-                            block->i_buffer);
-                    block->i_flags |= BLOCK_FLAG_CORRUPTED;
+            int ret = vlc_dtls_RecvBatch(rtp_sock, msgs, count);
+            if (ret >= 0)
+            {
+                sys->stats.calls++;
+                sys->stats.packets += ret;
+                if ((unsigned)ret > sys->stats.max_batch)
+                    sys->stats.max_batch = ret;
+
+                for (int i = 0; i < ret; i++)
+                {
+                    block_t *block = blocks[i];
+
+                    blocks[i] = NULL;
+                    if (msgs[i].truncated) {
+                        msg_Err(demux, "packet truncated (MRU was %zu)",
+                                block->i_buffer);
+                        block->i_flags |= BLOCK_FLAG_CORRUPTED;
+                    }
+                    else
+                        block->i_buffer = msgs[i].len;
+
+                    rtp_process (demux, block);
                 }
-                else
-                    block->i_buffer = len;
 
-                rtp_process (demux, block);
+                /* Keep the spare blocks packed at the front of the array */
+                for (unsigned i = ret, j = 0; i < count; i++, j++)
+                {
+                    blocks[j] = blocks[i];
+                    blocks[i] = NULL;
+                }
             }
             else
             {
                 if (errno == EPIPE)
+                {
+                    vlc_restorecancel (canc);
                     break; /* connection terminated */
+                }
                 msg_Warn (demux, "RTP network error: %s",
                           vlc_strerror_c(errno));
-                block_Release (block);
             }
 
             n--;
@@ -159,5 +214,7 @@ void *rtp_dgram_thread (void *opaque)
             deadline = VLC_TICK_INVALID;
         vlc_restorecancel (canc);
     }
+    vlc_cleanup_pop ();
+    rtp_release_blocks (blocks);
     return NULL;
 }
@@ -272,6 +272,12 @@ static void Close (vlc_object_t *obj)
 
     vlc_cancel(p_sys->thread);
     vlc_join(p_sys->thread, NULL);
+    if (p_sys->stats.calls > 0)
+        msg_Dbg(demux, "received %"PRIu64" packets in %"PRIu64" calls "
+                "(%.2f per call on average, %u at most)", p_sys->stats.packets,
+                p_sys->stats.calls,
+                (double)p_sys->stats.packets / p_sys->stats.calls,
+                p_sys->stats.max_batch);
 #ifdef HAVE_SRTP
     if (p_sys->srtp)
         srtp_destroy (p_sys->srtp);
@@ -389,5 +389,12 @@ typedef struct
     uint16_t      max_dropout; /**< Max packet forward misordering */
     uint16_t      max_misorder; /**< Max packet backward misordering */
     uint8_t       max_src; /**< Max simultaneous RTP sources */
+
+    /* Receive statistics, owned by the session thread */
+    struct {
+        uint64_t  calls; /**< Receive system calls */
+        uint64_t  packets; /**< Received datagrams */
+        unsigned  max_batch; /**< Largest number of datagrams per call */
+    } stats;
 } demux_sys_t;
 
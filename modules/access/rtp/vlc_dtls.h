@@ -30,6 +30,15 @@ struct vlc_dtls {
     const struct vlc_dtls_operations *ops;
 };
 
+/**
+ * Datagram descriptor for batched reception
+ */
+struct vlc_dtls_msg {
+    void *buf; /**< Receive buffer */
+    size_t len; /**< Buffer size on input, datagram length on output */
+    bool truncated; /**< Whether the datagram did not fit the buffer */
+};
+
 struct vlc_dtls_operations {
     void (*close)(struct vlc_dtls *);
 
@@ -37,6 +46,9 @@ struct vlc_dtls_operations {
     ssize_t (*readv)(struct vlc_dtls *, struct iovec *iov, unsigned len,
                      bool *restrict truncated);
     ssize_t (*writev)(struct vlc_dtls *, const struct iovec *iov, unsigned len);
+    /* Optional: receives several datagrams at once */
+    int (*readmmsg)(struct vlc_dtls *, struct vlc_dtls_msg *msgs,
+                    unsigned count);
 };
 
 static inline void vlc_dtls_Close(struct vlc_dtls *dgs)
@@ -57,6 +69,29 @@ static inline ssize_t vlc_dtls_Recv(struct vlc_dtls *dgs, void *buf, size_t len,
     return dgs->ops->readv(dgs, &iov, 1, truncated);
 }
 
+/**
+ * Receives a batch of datagrams.
+ *
+ * Waits for at least one datagram, then fetches as many already queued ones
+ * as fit in the supplied descriptors, without blocking any further.
+ *
+ * \return the number of datagrams received, or -1 on error
+ */
+static inline int vlc_dtls_RecvBatch(struct vlc_dtls *dgs,
+                                     struct vlc_dtls_msg *msgs, unsigned count)
+{
+    if (dgs->ops->readmmsg != NULL)
+        return dgs->ops->readmmsg(dgs, msgs, count);
+
+    ssize_t ret = vlc_dtls_Recv(dgs, msgs[0].buf, msgs[0].len,
+                                &msgs[0].truncated);
+    if (ret < 0)
+        return -1;
+
+    msgs[0].len = ret;
+    return 1;
+}
+
 static inline ssize_t vlc_dtls_Send(struct vlc_dtls *dgs, const void *buf,
                                    size_t len)
 {
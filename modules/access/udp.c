@@ -47,19 +47,47 @@
 #ifdef HAVE_SYS_UIO_H
 # include <sys/uio.h>
 #endif
+#ifdef HAVE_RECVMMSG
+# include <sys/socket.h>
+# include <netinet/udp.h>
+#endif
 
 /* Buffer can be max theoretical datagram content minus anticipated MTU.
  * IPv6 headers are larger than IPv4, ignore IPv6 jumbograms.
  */
 #define MRU 65507u
 
+/* Receive slot granularity for batched reception. Slots are sized from the
+ * largest datagram seen so far, rounded up to this value. */
+#define SLOT_ALIGN 2048u
+/* Maximum number of coalesced reads per call with receive offload */
+#define GRO_BATCH 8u
+
 typedef struct {
     int fd;
     int timeout;
 
     size_t length;
     char *offset;
-    char buf[MRU];
+
+#ifdef HAVE_RECVMMSG
+    unsigned batch; /**< maximum datagrams per receive call */
+    size_t slot; /**< per-datagram receive slot size (0 if unknown yet) */
+    bool gro; /**< kernel-side UDP receive coalescing is enabled */
+    struct mmsghdr *msgs;
+    struct iovec *iovs;
+
+    struct {
+        uint64_t calls;
+        uint64_t datagrams;
+        uint64_t bytes;
+        uint64_t truncated;
+        unsigned max_batch;
+    } stats;
+#endif
+
+    size_t size;
+    char *buf;
 } access_sys_t;
 
 static int Control(stream_t *access, int query, va_list args)
@@ -83,6 +111,74 @@ static int Control(stream_t *access, int query, va_list args)
     return VLC_SUCCESS;
 }
 
+#ifdef HAVE_RECVMMSG
+/**
+ * Receives as many pending datagrams as possible with a single system call.
+ *
+ * Payloads are packed back to back at the start of the receive buffer, since
+ * this access exposes a byte stream and datagram boundaries are irrelevant.
+ * \return number of packed bytes, or -1 on error
+ */
+static ssize_t ReadBatch(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    unsigned count = sys->size / sys->slot;
+
+    if (count > sys->batch)
+        count = sys->batch;
+
+    for (unsigned i = 0; i < count; i++) {
+        sys->iovs[i].iov_base = sys->buf + i * sys->slot;
+        sys->iovs[i].iov_len = sys->slot;
+        memset(&sys->msgs[i].msg_hdr, 0, sizeof (sys->msgs[i].msg_hdr));
+        sys->msgs[i].msg_hdr.msg_iov = &sys->iovs[i];
+        sys->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    /* With MSG_TRUNC, the length of truncated datagrams is their real size */
+    int n = recvmmsg(sys->fd, sys->msgs, count, MSG_DONTWAIT | MSG_TRUNC, NULL);
+    if (n <= 0)
+        return -1;
+
+    size_t total = 0;
+    size_t oversize = 0;
+
+    for (int i = 0; i < n; i++) {
+        size_t len = sys->msgs[i].msg_len;
+
+        if (sys->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            /* Incomplete payload: drop the datagram */
+            if (len > oversize)
+                oversize = len;
+            sys->stats.truncated++;
+            continue;
+        }
+        if (total != (size_t)i * sys->slot)
+            memmove(sys->buf + total, sys->buf + i * sys->slot, len);
+        total += len;
+    }
+
+    sys->stats.calls++;
+    sys->stats.datagrams += n;
+    sys->stats.bytes += total;
+    if ((unsigned)n > sys->stats.max_batch)
+        sys->stats.max_batch = n;
+
+    if (unlikely(oversize > 0)) {
+        /* Larger datagrams than seen so far: grow the slots to fit */
+        size_t slot = __MIN((oversize + SLOT_ALIGN - 1)
+                            & ~(size_t)(SLOT_ALIGN - 1), MRU);
+        msg_Warn(access, "dropped %zu bytes datagram (slot was %zu bytes, "
+                 "now %zu)", oversize, sys->slot, slot);
+        sys->slot = slot;
+    }
+
+    if (total == 0)
+        return -1; /* only empty datagrams; retry */
+    return total;
+}
+#endif
+
 static ssize_t Read(stream_t *access, void *buf, size_t len)
 {
     access_sys_t *sys = access->p_sys;
@@ -110,6 +206,22 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
             return -1;
     }
 
+#ifdef HAVE_RECVMMSG
+    if (sys->slot > 0) {
+        ssize_t val = ReadBatch(access);
+        if (val <= 0)
+            return -1;
+
+        if (len > (size_t)val)
+            len = val;
+
+        memcpy(buf, sys->buf, len);
+        sys->offset = sys->buf + len;
+        sys->length = val - len;
+        return len;
+    }
+#endif
+
     struct iovec iov[] = {
         { .iov_base = buf,      .iov_len = len, },
         { .iov_base = sys->buf, .iov_len = MRU, },
@@ -123,6 +235,18 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
     if (val <= 0) /* empty (0 bytes) payload does *not* mean EOF here */
         return -1;
 
+#ifdef HAVE_RECVMMSG
+    /* Learn the datagram size, then switch to batched reception */
+    if (sys->batch > 1 && !sys->gro)
+        sys->slot = __MIN(((size_t)val + SLOT_ALIGN - 1)
+                          & ~(size_t)(SLOT_ALIGN - 1), MRU);
+    sys->stats.calls++;
+    sys->stats.datagrams++;
+    sys->stats.bytes += val;
+    if (sys->stats.max_batch == 0)
+        sys->stats.max_batch = 1;
+#endif
+
     if (unlikely((size_t)val > len)) {
         sys->offset = sys->buf;
         sys->length = val - len;
@@ -148,6 +272,19 @@ static int Open( vlc_object_t *p_this )
         return VLC_ENOMEM;
 
     sys->length = 0;
+#ifdef HAVE_RECVMMSG
+    sys->batch = var_InheritInteger( p_access, "udp-batch" );
+    if( sys->batch < 1 )
+        sys->batch = 1;
+    sys->slot = 0;
+    sys->gro = false;
+    memset( &sys->stats, 0, sizeof( sys->stats ) );
+    sys->msgs = vlc_obj_calloc( p_this, sys->batch, sizeof( *sys->msgs ) );
+    sys->iovs = vlc_obj_calloc( p_this, sys->batch, sizeof( *sys->iovs ) );
+    if( unlikely( sys->msgs == NULL || sys->iovs == NULL ) )
+        return VLC_ENOMEM;
+#endif
+
     p_access->p_sys = sys;
     p_access->pf_read = Read;
     p_access->pf_block = NULL;
@@ -213,6 +350,34 @@ static int Open( vlc_object_t *p_this )
         return VLC_EGENERIC;
     }
 
+#if defined (HAVE_RECVMMSG) && defined (UDP_GRO)
+    /* Let the kernel coalesce back-to-back datagrams of the same flow, so
+     * that a single receive call returns up to MRU bytes of payload. */
+    if( sys->batch > 1
+     && setsockopt( sys->fd, SOL_UDP, UDP_GRO, &(int){ 1 }, sizeof (int) ) == 0 )
+    {
+        msg_Dbg( p_access, "UDP receive offload enabled" );
+        sys->gro = true;
+        sys->slot = MRU;
+    }
+#endif
+
+#ifdef HAVE_RECVMMSG
+    /* Coalesced reads may each return up to MRU bytes; bound the buffer. */
+    if( sys->gro )
+        sys->size = __MIN( sys->batch, GRO_BATCH ) * (size_t)MRU;
+    else
+        sys->size = __MAX( MRU, sys->batch * SLOT_ALIGN );
+#else
+    sys->size = MRU;
+#endif
+    sys->buf = vlc_obj_malloc( p_this, sys->size );
+    if( unlikely( sys->buf == NULL ) )
+    {
+        net_Close( sys->fd );
+        return VLC_ENOMEM;
+    }
+
     sys->timeout = var_InheritInteger( p_access, "udp-timeout");
     if( sys->timeout > 0)
         sys->timeout *= 1000;
@@ -228,10 +393,23 @@ static void Close( vlc_object_t *p_this )
     stream_t     *p_access = (stream_t*)p_this;
     access_sys_t *sys = p_access->p_sys;
 
+#ifdef HAVE_RECVMMSG
+    if( sys->stats.calls > 0 )
+        msg_Dbg( p_access, "received %"PRIu64" datagrams (%"PRIu64" bytes) "
+                 "in %"PRIu64" calls: %.2f datagrams per call on average, "
+                 "%u at most, %"PRIu64" truncated", sys->stats.datagrams,
+                 sys->stats.bytes, sys->stats.calls,
+                 (double)sys->stats.datagrams / sys->stats.calls,
+                 sys->stats.max_batch, sys->stats.truncated );
+#endif
     net_Close( sys->fd );
 }
 
 #define TIMEOUT_TEXT N_("UDP Source timeout (sec)")
+#define BATCH_TEXT N_("Datagrams per receive call")
+#define BATCH_LONGTEXT N_( \
+    "Maximum number of datagrams to receive with a single system call. " \
+    "Set to 1 to receive one datagram at a time.")
 
 vlc_module_begin()
     set_shortname(N_("UDP"))
@@ -240,6 +418,9 @@ vlc_module_begin()
 
     add_obsolete_integer("udp-buffer") /* since 3.0.0 */
     add_integer("udp-timeout", -1, TIMEOUT_TEXT, NULL)
+#ifdef HAVE_RECVMMSG
+    add_integer_with_range("udp-batch", 32, 1, 1024, BATCH_TEXT, BATCH_LONGTEXT)
+#endif
 
     set_capability("access", 0)
     add_shortcut("udp", "udpstream", "udp4", "udp6")
@@ -849,6 +849,28 @@ out:
     return ret;
 }
 
+static void StatisticsLatency(struct cli_client *cl,
+                              const struct input_stats_latency_t *lat)
+{
+    static const char *const names[INPUT_STATS_LATENCY_COUNT] = {
+        [INPUT_STATS_LATENCY_DEMUX] = N_("demux to decoder"),
+        [INPUT_STATS_LATENCY_DECODER] = N_("decoder"),
+        [INPUT_STATS_LATENCY_VOUT] = N_("output queue"),
+        [INPUT_STATS_LATENCY_DISPLAY] = N_("display"),
+        [INPUT_STATS_LATENCY_TOTAL] = N_("total"),
+    };
+
+    for (size_t i = 0; i < INPUT_STATS_LATENCY_COUNT; i++)
+    {
+        if (lat[i].max == VLC_TICK_INVALID)
+            continue;
+        cli_printf(cl, _("| %-16s : %6.1f / %6.1f / %6.1f ms (p50/p99/max)"),
+                   _(names[i]), secf_from_vlc_tick(lat[i].p50) * 1000.f,
+                   secf_from_vlc_tick(lat[i].p99) * 1000.f,
+                   secf_from_vlc_tick(lat[i].max) * 1000.f);
+    }
+}
+
 static int Statistics(struct cli_client *cl, const char *const *args,
                       size_t count, void *data)
 {
@@ -889,6 +911,7 @@ static int Statistics(struct cli_client *cl, const char *const *args,
                    item->p_stats->i_late_pictures);
         cli_printf(cl, _("| frames lost      :    %5"PRIi64),
                    item->p_stats->i_lost_pictures);
+        StatisticsLatency(cl, item->p_stats->video_latency);
         cli_printf(cl, "|");
 
         /* Audio*/
@@ -899,8 +922,17 @@ static int Statistics(struct cli_client *cl, const char *const *args,
                    item->p_stats->i_played_abuffers);
         cli_printf(cl, _("| buffers lost     :    %5"PRIi64),
                    item->p_stats->i_lost_abuffers);
+        StatisticsLatency(cl, item->p_stats->audio_latency);
         cli_printf(cl, "|");
 
+        if (item->p_stats->i_latency_misses > 0)
+        {
+            cli_printf(cl, "%s", _("+-[Live]"));
+            cli_printf(cl, _("| over latency target: %5"PRIi64),
+                       item->p_stats->i_latency_misses);
+            cli_printf(cl, "|");
+        }
+
         vlc_mutex_unlock(&item->lock);
         cli_printf(cl,  "+----[ end of statistical info ]" );
     }
@@ -142,6 +142,7 @@ SegmentTracker::SegmentTracker(SharedResources *res,
     adaptationSet = adaptSet;
     synchronizationReferences = refs;
     format = StreamFormat::Type::Unknown;
+    prefetchBudget = 0;
 }
 
 SegmentTracker::~SegmentTracker()
@@ -262,35 +263,11 @@ SegmentTracker::prepareChunk(bool switch_allowed, Position pos) const
         if(!pos.isValid())
             return ChunkEntry();
     }
-    else /* continuing, or seek */
+    else if(switch_allowed) /* continuing, or seek */
     {
-        if(!adaptationSet->isSegmentAligned() || !pos.init_sent || !pos.index_sent)
-            switch_allowed = false;
-
-        if(switch_allowed)
-        {
-            Position temp;
-            temp.rep = logic->getNextRepresentation(adaptationSet, pos.rep);
-            if(temp.rep && temp.rep != pos.rep)
-            {
-                /* Convert our segment number if we need to */
-                temp.number = temp.rep->translateSegmentNumber(pos.number, pos.rep);
-
-                /* Ensure ephemere content is updated/loaded */
-                if(temp.rep->needsUpdate(temp.number))
-                    temp.rep->scheduleNextUpdate(temp.number, temp.rep->runLocalUpdates(resources));
-
-                /* could have been std::numeric_limits<uint64_t>::max() if not found because not avail */
-                if(!temp.isValid()) /* try again */
-                    temp.number = temp.rep->translateSegmentNumber(pos.number, pos.rep);
-
-                /* cancel switch that would go past playlist */
-                if(temp.isValid() && temp.rep->getMinAheadTime(temp.number) == 0)
-                    temp = Position();
-            }
-            if(temp.isValid())
-                pos = temp;
-        }
+        Position temp = getSwitchPosition(pos);
+        if(temp.isValid())
+            pos = temp;
     }
 
     bool b_gap = true;
@@ -318,13 +295,6 @@ SegmentTracker::prepareChunk(bool switch_allowed, Position pos) const
     if(!segment)
         segment = datasegment;
 
-    SegmentChunk *segmentChunk = segment->toChunk(resources, pos.number, pos.rep);
-    if(!segmentChunk)
-        return ChunkEntry();
-
-    if(segment != datasegment) /* need to set for init */
-        segmentChunk->discontinuitySequenceNumber = datasegment->getDiscontinuitySequenceNumber();
-
     vlc_tick_t startTime = VLC_TICK_INVALID;
     vlc_tick_t duration = 0;
     vlc_tick_t displayTime = datasegment->getDisplayTime();
@@ -332,9 +302,73 @@ SegmentTracker::prepareChunk(bool switch_allowed, Position pos) const
     if(pos.rep->getPlaybackTimeDurationBySegmentNumber(pos.number, &startTime, &duration))
         startTime += VLC_TICK_0;
 
+    /* segment start time is its download deadline */
+    SegmentChunk *segmentChunk = segment->toChunk(resources, pos.number, pos.rep, startTime);
+    if(!segmentChunk)
+        return ChunkEntry();
+
+    if(segment != datasegment) /* need to set for init */
+        segmentChunk->discontinuitySequenceNumber = datasegment->getDiscontinuitySequenceNumber();
+
     return ChunkEntry(segmentChunk, pos, startTime, duration, displayTime);
 }
 
+SegmentTracker::Position
+SegmentTracker::getSwitchPosition(const Position &pos) const
+{
+    Position temp;
+    if(!adaptationSet->isSegmentAligned() || !pos.init_sent || !pos.index_sent)
+        return temp;
+
+    temp.rep = logic->getNextRepresentation(adaptationSet, pos.rep);
+    if(temp.rep && temp.rep != pos.rep)
+    {
+        /* Convert our segment number if we need to */
+        temp.number = temp.rep->translateSegmentNumber(pos.number, pos.rep);
+
+        /* Ensure ephemere content is updated/loaded */
+        if(temp.rep->needsUpdate(temp.number))
+            temp.rep->scheduleNextUpdate(temp.number, temp.rep->runLocalUpdates(resources));
+
+        /* could have been std::numeric_limits<uint64_t>::max() if not found because not avail */
+        if(!temp.isValid()) /* try again */
+            temp.number = temp.rep->translateSegmentNumber(pos.number, pos.rep);
+
+        /* cancel switch that would go past playlist */
+        if(temp.isValid() && temp.rep->getMinAheadTime(temp.number) == 0)
+            temp = Position();
+    }
+    return temp;
+}
+
+void SegmentTracker::prefetchChunks()
+{
+    const unsigned count = bufferingLogic->getPrefetch();
+    Position pos = next;
+    vlc_tick_t ahead = 0;
+    for(const ChunkEntry &entry : chunkssequence)
+    {
+        pos = entry.pos;
+        ++pos;
+        ahead += entry.duration;
+    }
+
+    while(chunkssequence.size() < count && ahead < prefetchBudget)
+    {
+        ChunkEntry entry = prepareChunk(false, pos);
+        /* don't prefetch past a gap or the known segments */
+        if(!entry.isValid() || entry.pos.number != pos.number)
+        {
+            delete entry.chunk;
+            break;
+        }
+        chunkssequence.push_back(entry);
+        pos = entry.pos;
+        ++pos;
+        ahead += entry.duration;
+    }
+}
+
 void SegmentTracker::resetChunksSequence()
 {
     while(!chunkssequence.empty())
@@ -354,6 +388,16 @@ ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed)
         ChunkEntry chunk = prepareChunk(switch_allowed, next);
         chunkssequence.push_back(chunk);
     }
+    else if(switch_allowed)
+    {
+        /* prefetched chunks are dropped on representation switch */
+        Position temp = getSwitchPosition(next);
+        if(temp.isValid() && temp.rep != chunkssequence.front().pos.rep)
+        {
+            resetChunksSequence();
+            chunkssequence.push_back(prepareChunk(false, temp));
+        }
+    }
 
     ChunkEntry chunk = chunkssequence.front();
     if(!chunk.isValid())
@@ -436,7 +480,12 @@ ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed)
                                chunk.starttime, chunk.duration, chunk.displaytime));
 
     if(!b_gap)
+    {
         ++next;
+        prefetchChunks();
+    }
+    else
+        resetChunksSequence();
 
     return returnedChunk;
 }
@@ -579,8 +628,9 @@ void SegmentTracker::notifyBufferingState(bool enabled) const
 }
 
 void SegmentTracker::notifyBufferingLevel(vlc_tick_t min, vlc_tick_t max,
-                                          vlc_tick_t current, vlc_tick_t target) const
+                                          vlc_tick_t current, vlc_tick_t target)
 {
+    prefetchBudget = (max > current) ? max - current : 0;
     notify(BufferingLevelChangedEvent(adaptationSet->getID(), min, max, current, target));
 }
 
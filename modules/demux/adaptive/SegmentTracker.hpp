@@ -233,7 +233,7 @@ namespace adaptive
             bool getSynchronizationReference(uint64_t, vlc_tick_t, SynchronizationReference &) const;
             void updateSynchronizationReference(uint64_t, const Times &);
             void notifyBufferingState(bool) const;
-            void notifyBufferingLevel(vlc_tick_t, vlc_tick_t, vlc_tick_t, vlc_tick_t) const;
+            void notifyBufferingLevel(vlc_tick_t, vlc_tick_t, vlc_tick_t, vlc_tick_t);
             void registerListener(SegmentTrackerListenerInterface *);
             void updateSelected();
             bool bufferingAvailable() const;
@@ -253,6 +253,8 @@ namespace adaptive
             };
             std::list<ChunkEntry> chunkssequence;
             ChunkEntry prepareChunk(bool switch_allowed, Position pos) const;
+            Position getSwitchPosition(const Position &) const;
+            void prefetchChunks();
             void resetChunksSequence();
             void setAdaptationLogic(AbstractAdaptationLogic *);
             void notify(const TrackerEvent &) const;
@@ -261,6 +263,7 @@ namespace adaptive
             Position current;
             Position next;
             StreamFormat format;
+            vlc_tick_t prefetchBudget;
             SharedResources *resources;
             SynchronizationReferences *synchronizationReferences;
             AbstractAdaptationLogic *logic;
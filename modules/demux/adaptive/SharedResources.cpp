@@ -25,21 +25,25 @@
 #include "http/AuthStorage.hpp"
 #include "http/HTTPConnectionManager.h"
 #include "http/HTTPConnection.hpp"
+#include "http/SegmentCache.hpp"
 #include "encryption/Keyring.hpp"
 
 using namespace adaptive;
 
 SharedResources::SharedResources(AuthStorage *auth, Keyring *ring,
-                                 AbstractConnectionManager *conn)
+                                 AbstractConnectionManager *conn,
+                                 SegmentCache *cache)
 {
     authStorage = auth;
     encryptionKeyring = ring;
     connManager = conn;
+    segmentCache = cache;
 }
 
 SharedResources::~SharedResources()
 {
     delete connManager;
+    delete segmentCache;
     delete encryptionKeyring;
     delete authStorage;
 }
@@ -59,17 +63,34 @@ AbstractConnectionManager * SharedResources::getConnManager()
     return connManager;
 }
 
+SegmentCache * SharedResources::getSegmentCache()
+{
+    return segmentCache;
+}
+
 SharedResources * SharedResources::createDefault(vlc_object_t *obj,
                                                  const std::string & playlisturl)
 {
     AuthStorage *auth = new AuthStorage(obj);
     Keyring *keyring = new Keyring(obj);
-    HTTPConnectionManager *m = new HTTPConnectionManager(obj);
+    HTTPConnectionManager *m = new HTTPConnectionManager(obj,
+                                        var_InheritInteger(obj, "adaptive-prefetch"));
     if(!var_InheritBool(obj, "adaptive-use-access")) /* only use http from access */
         m->addFactory(new LibVLCHTTPConnectionFactory(auth));
     m->addFactory(new StreamUrlConnectionFactory());
     ConnectionParams params(playlisturl);
     if(params.isLocal())
         m->setLocalConnectionsAllowed();
-    return new SharedResources(auth, keyring, m);
+    SegmentCache *cache = nullptr;
+    const size_t cachesize = var_InheritInteger(obj, "adaptive-cache-size") << 20;
+    const bool b_diskcache = var_InheritBool(obj, "adaptive-disk-cache");
+    if(cachesize || b_diskcache)
+    {
+        cache = new SegmentCache(obj, cachesize,
+                                 b_diskcache ? SegmentCache::getDefaultDiskPath()
+                                             : std::string(),
+                                 SegmentCache::DEFAULT_DISK_MAX);
+        m->setSegmentCache(cache);
+    }
+    return new SharedResources(auth, keyring, m, cache);
 }
@@ -29,6 +29,7 @@ namespace adaptive
     {
         class AuthStorage;
         class AbstractConnectionManager;
+        class SegmentCache;
     }
 
     namespace encryption
@@ -42,11 +43,13 @@ namespace adaptive
     class SharedResources
     {
         public:
-            SharedResources(AuthStorage *, Keyring *, AbstractConnectionManager *);
+            SharedResources(AuthStorage *, Keyring *, AbstractConnectionManager *,
+                            SegmentCache * = nullptr);
             ~SharedResources();
             AuthStorage *getAuthStorage();
             Keyring     *getKeyring();
             AbstractConnectionManager *getConnManager();
+            SegmentCache *getSegmentCache();
             /* Helper */
             static SharedResources * createDefault(vlc_object_t *, const std::string &);
 
@@ -54,6 +57,7 @@ namespace adaptive
             AuthStorage *authStorage;
             Keyring *encryptionKeyring;
             AbstractConnectionManager *connManager;
+            SegmentCache *segmentCache;
     };
 }
 
@@ -77,6 +77,11 @@ static void Close   (vlc_object_t *);
 
 #define ADAPT_MAXBUFFER_TEXT N_("Max buffering (ms)")
 
+#define ADAPT_PREFETCH_TEXT N_("Prefetched segments")
+#define ADAPT_PREFETCH_LONGTEXT N_("Number of next segments downloaded ahead " \
+                                   "and concurrently, within max buffering. " \
+                                   "0 disables prefetching")
+
 #define ADAPT_LOGIC_TEXT N_("Adaptive Logic")
 
 #define ADAPT_ACCESS_TEXT N_("Use regular HTTP modules")
@@ -85,6 +90,15 @@ static void Close   (vlc_object_t *);
 #define ADAPT_LOWLATENCY_TEXT N_("Low latency")
 #define ADAPT_LOWLATENCY_LONGTEXT N_("Overrides low latency parameters")
 
+#define ADAPT_CACHE_TEXT N_("Segment cache size (MiB)")
+#define ADAPT_CACHE_LONGTEXT N_("Memory used to keep downloaded segments for " \
+                                "seeking back or switching again to a quality. " \
+                                "0 disables the cache")
+
+#define ADAPT_DISKCACHE_TEXT N_("Keep init segments on disk")
+#define ADAPT_DISKCACHE_LONGTEXT N_("Store initialization segments in the user " \
+                                    "cache directory, for faster restarts")
+
 static const AbstractAdaptationLogic::LogicType pi_logics[] = {
                                 AbstractAdaptationLogic::LogicType::Default,
                                 AbstractAdaptationLogic::LogicType::Predictive,
@@ -142,8 +156,15 @@ vlc_module_begin ()
         add_integer( "adaptive-maxbuffer",
                      MS_FROM_VLC_TICK(AbstractBufferingLogic::DEFAULT_MAX_BUFFERING),
                      ADAPT_MAXBUFFER_TEXT, nullptr );
+        add_integer_with_range( "adaptive-prefetch",
+                     AbstractBufferingLogic::DEFAULT_PREFETCH, 0, 8,
+                     ADAPT_PREFETCH_TEXT, ADAPT_PREFETCH_LONGTEXT );
         add_integer( "adaptive-lowlatency", -1, ADAPT_LOWLATENCY_TEXT, ADAPT_LOWLATENCY_LONGTEXT );
             change_integer_list(rgi_latency, ppsz_latency)
+        add_integer_with_range( "adaptive-cache-size", 16, 0, 1024,
+                     ADAPT_CACHE_TEXT, ADAPT_CACHE_LONGTEXT );
+        add_bool   ( "adaptive-disk-cache", false,
+                     ADAPT_DISKCACHE_TEXT, ADAPT_DISKCACHE_LONGTEXT );
         set_callbacks( Open, Close )
 vlc_module_end ()
 
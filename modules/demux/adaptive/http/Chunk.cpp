@@ -68,6 +68,11 @@ RequestStatus AbstractChunkSource::getRequestStatus() const
     return requeststatus;
 }
 
+bool AbstractChunkSource::isDownloaded() const
+{
+    return true;
+}
+
 const StorageID & AbstractChunkSource::getStorageID() const
 {
     return storeid;
@@ -135,6 +140,11 @@ bool AbstractChunk::hasMoreData() const
     return source->hasMoreData();
 }
 
+bool AbstractChunk::isDownloaded() const
+{
+    return source->isDownloaded();
+}
+
 block_t * AbstractChunk::readBlock()
 {
     return doRead(0, true);
@@ -235,7 +245,7 @@ block_t * HTTPChunkSource::read(size_t readsize)
     {
         p_block->i_buffer = (size_t) ret;
         consumed += p_block->i_buffer;
-        if((size_t)ret < readsize)
+        if(ret == 0 || consumed == contentLength)
         {
             eof = true;
             downloadEndTime = vlc_tick_now();
@@ -245,8 +255,8 @@ block_t * HTTPChunkSource::read(size_t readsize)
         {
             connManager->updateDownloadRate(sourceid,
                                             connection->getBytesRead(),
-                                            downloadEndTime - requestStartTime,
-                                            downloadEndTime - responseTime);
+                                            downloadEndTime - responseTime,
+                                            responseTime - requestStartTime);
         }
     }
 
@@ -341,6 +351,7 @@ HTTPChunkBufferedSource::HTTPChunkBufferedSource(const std::string& url, Abstrac
     done = false;
     eof = false;
     held = false;
+    transferring = false;
     p_read = nullptr;
     inblockreadoffset = 0;
 }
@@ -355,6 +366,9 @@ HTTPChunkBufferedSource::~HTTPChunkBufferedSource()
     while(held) /* wait release if not in queue but currently downloaded */
         avail.wait(lock);
 
+    if(transferring) /* cancelled */
+        connManager->transferEnded(sourceid);
+
     if(p_head)
     {
         block_ChainRelease(p_head);
@@ -371,6 +385,11 @@ bool HTTPChunkBufferedSource::isDone() const
     return done;
 }
 
+bool HTTPChunkBufferedSource::isDownloaded() const
+{
+    return isDone();
+}
+
 void HTTPChunkBufferedSource::hold()
 {
     mutex_locker locker {lock};
@@ -388,6 +407,7 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
 {
     {
         mutex_locker locker {lock};
+        const bool b_prepared = prepared;
         if(!prepare())
         {
             done = true;
@@ -396,6 +416,13 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
             return;
         }
 
+        if(!b_prepared && type == ChunkType::Segment)
+        {
+            transferring = true;
+            connManager->transferStarted(sourceid, responseTime,
+                                         responseTime - requestStartTime);
+        }
+
         if(readsize < HTTPChunkSource::CHUNK_SIZE)
             readsize = HTTPChunkSource::CHUNK_SIZE;
 
@@ -410,29 +437,21 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         return;
     }
 
-    struct
-    {
-        size_t size;
-        vlc_tick_t time;
-        vlc_tick_t latency;
-    } rate = {0,0,0};
-
     ssize_t ret = connection->read(p_block->p_buffer, readsize);
+    if(ret > 0 && transferring)
+        connManager->transferProgress(sourceid, ret);
+
+    mutex_locker locker {lock};
     if(ret <= 0)
     {
         block_Release(p_block);
         p_block = nullptr;
-        mutex_locker locker {lock};
         done = true;
         downloadEndTime = vlc_tick_now();
-        rate.size = buffered;
-        rate.time = downloadEndTime - requestStartTime;
-        rate.latency = responseTime - requestStartTime;
     }
     else
     {
         p_block->i_buffer = (size_t) ret;
-        mutex_locker locker {lock};
         buffered += p_block->i_buffer;
         block_ChainLastAppend(&pp_tail, p_block);
         if(p_read == nullptr)
@@ -440,20 +459,17 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
             p_read = p_block;
             inblockreadoffset = 0;
         }
-        if((size_t) ret < readsize)
+        if(buffered == contentLength) /* else until EOF, reads can be partial */
         {
             done = true;
             downloadEndTime = vlc_tick_now();
-            rate.size = buffered;
-            rate.time = downloadEndTime - requestStartTime;
-            rate.latency = responseTime - requestStartTime;
         }
     }
 
-    if(rate.size && rate.time && type == ChunkType::Segment)
+    if(done && transferring)
     {
-        connManager->updateDownloadRate(sourceid, rate.size,
-                                        rate.time, rate.latency);
+        transferring = false;
+        connManager->transferEnded(sourceid);
     }
 
     avail.signal();
@@ -539,11 +555,67 @@ block_t * HTTPChunkBufferedSource::read(size_t readsize)
     return p_block;
 }
 
+CachedChunkSource::CachedChunkSource(AbstractConnectionManager *manager,
+                                     ChunkType type, const BytesRange &range,
+                                     block_t *p_block, const std::string &ctype)
+    : AbstractChunkSource(type, range)
+{
+    connManager = manager;
+    p_data = p_block;
+    consumed = 0;
+    contentType = ctype;
+    contentLength = p_data->i_buffer;
+}
+
+CachedChunkSource::~CachedChunkSource()
+{
+    block_Release(p_data);
+}
+
+block_t * CachedChunkSource::readBlock()
+{
+    return read(HTTPChunkSource::CHUNK_SIZE);
+}
+
+block_t * CachedChunkSource::read(size_t readsize)
+{
+    readsize = std::min(readsize, p_data->i_buffer - consumed);
+    if(!readsize)
+        return nullptr;
+
+    block_t *p_block = block_Alloc(readsize);
+    if(!p_block)
+        return nullptr;
+    memcpy(p_block->p_buffer, &p_data->p_buffer[consumed], readsize);
+    consumed += readsize;
+    return p_block;
+}
+
+bool CachedChunkSource::hasMoreData() const
+{
+    return consumed < p_data->i_buffer;
+}
+
+size_t CachedChunkSource::getBytesRead() const
+{
+    return consumed;
+}
+
+std::string CachedChunkSource::getContentType() const
+{
+    return contentType;
+}
+
+void CachedChunkSource::recycle()
+{
+    connManager->recycleSource(this);
+}
+
 HTTPChunk::HTTPChunk(const std::string &url, AbstractConnectionManager *manager,
                      const adaptive::ID &id, ChunkType type, const BytesRange &range):
     AbstractChunk(manager->makeSource(url, id, type, range))
 {
-    manager->start(source);
+    manager->start(source, VLC_TICK_INVALID);
 }
 
 HTTPChunk::~HTTPChunk()
@@ -77,6 +77,7 @@ namespace adaptive
                 const StorageID &   getStorageID    () const;
                 virtual std::string getContentType  () const override;
                 virtual RequestStatus getRequestStatus() const override;
+                virtual bool        isDownloaded() const;
                 virtual void        recycle() = 0;
 
             protected:
@@ -99,6 +100,7 @@ namespace adaptive
                 virtual size_t        getBytesRead          () const override;
                 virtual bool          hasMoreData           () const override;
                 uint64_t              getStartByteInFile    () const;
+                bool                  isDownloaded          () const;
 
                 virtual block_t *   readBlock       () override;
                 virtual block_t *   read            (size_t) override;
@@ -164,6 +166,7 @@ namespace adaptive
                 virtual block_t *  readBlock       ()  override;
                 virtual block_t *  read            (size_t)  override;
                 virtual bool       hasMoreData     () const  override;
+                virtual bool       isDownloaded    () const  override;
                 virtual void        recycle() override;
 
             protected:
@@ -185,6 +188,33 @@ namespace adaptive
                 bool                eof;
                 vlc::threads::condition_variable avail;
                 bool                held;
+                bool                transferring; /* accounted by the manager */
+        };
+
+        class CachedChunkSource : public AbstractChunkSource
+        {
+            friend class HTTPConnectionManager;
+
+            public:
+                virtual ~CachedChunkSource();
+
+                virtual block_t *   readBlock       ()  override;
+                virtual block_t *   read            (size_t)  override;
+                virtual bool        hasMoreData     () const  override;
+                virtual size_t      getBytesRead    () const  override;
+                virtual std::string getContentType  () const  override;
+                virtual void        recycle() override;
+
+            protected:
+                CachedChunkSource(AbstractConnectionManager *, ChunkType,
+                                  const BytesRange &, block_t *,
+                                  const std::string &);
+
+            private:
+                AbstractConnectionManager *connManager;
+                block_t            *p_data;
+                size_t              consumed;
+                std::string         contentType;
         };
 
         class HTTPChunk : public AbstractChunk
@@ -29,64 +29,87 @@
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Downloader(unsigned workers_)
 {
     killed = false;
-    thread_handle_valid = false;
-    current = nullptr;
-    cancel_current = false;
+    workers = workers_ ? workers_ : 1;
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread, static_cast<void *>(this)))
+    while(threads.size() < workers)
     {
-        return false;
+        vlc_thread_t thread;
+        if(vlc_clone(&thread, downloaderThread, static_cast<void *>(this)))
+            break;
+        threads.push_back(thread);
     }
-    thread_handle_valid = true;
-    return true;
+    return !threads.empty();
 }
 
 Downloader::~Downloader()
 {
     kill();
 
-    if(thread_handle_valid)
-        vlc_join(thread_handle, nullptr);
+    for(vlc_thread_t thread : threads)
+        vlc_join(thread, nullptr);
 }
 
 void Downloader::kill()
 {
     vlc::threads::mutex_locker locker {lock};
     killed = true;
-    wait_cond.signal();
+    wait_cond.broadcast();
 }
 
-void Downloader::schedule(HTTPChunkBufferedSource *source)
+void Downloader::schedule(HTTPChunkBufferedSource *source, vlc_tick_t deadline)
 {
     vlc::threads::mutex_locker locker {lock};
     source->hold();
-    chunks.push_back(source);
+    jobs.push_back({source, deadline, false, false});
     wait_cond.signal();
 }
 
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc::threads::mutex_locker locker {lock};
-    while (current == source)
+    std::list<Job>::iterator it;
+    while((it = findJob(source)) != jobs.end() && (*it).active)
     {
-        cancel_current = true;
+        (*it).cancelled = true;
         updated_cond.wait(lock);
     }
 
-    if(!source->isDone())
+    if(it != jobs.end())
     {
-        chunks.remove(source);
+        jobs.erase(it);
         source->release();
     }
 }
 
+std::list<Downloader::Job>::iterator Downloader::findJob(const HTTPChunkBufferedSource *source)
+{
+    for(auto it = jobs.begin(); it != jobs.end(); ++it)
+        if((*it).source == source)
+            return it;
+    return jobs.end();
+}
+
+std::list<Downloader::Job>::iterator Downloader::nextJob()
+{
+    /* Earliest playback deadline first, unknown deadlines first,
+     * queue order among equals */
+    auto next = jobs.end();
+    for(auto it = jobs.begin(); it != jobs.end(); ++it)
+    {
+        if((*it).active)
+            continue;
+        if(next == jobs.end() || (*it).deadline < (*next).deadline)
+            next = it;
+    }
+    return next;
+}
+
 void * Downloader::downloaderThread(void *opaque)
 {
     vlc_thread_set_name("vlc-adapt-dl");
@@ -101,7 +124,8 @@ void Downloader::Run()
     {
         lock.lock();
 
-        while(chunks.empty() && !killed)
+        std::list<Job>::iterator job;
+        while((job = nextJob()) == jobs.end() && !killed)
             wait_cond.wait(lock);
 
         if(killed)
@@ -110,18 +134,24 @@ void Downloader::Run()
             break;
         }
 
-        current = chunks.front();
+        /* Only one step is done at a time, so that a worker
+         * can move to a more urgent source in between */
+        HTTPChunkBufferedSource *current = (*job).source;
+        (*job).active = true;
         lock.unlock();
         current->bufferize(HTTPChunkSource::CHUNK_SIZE);
         lock.lock();
-        if(current->isDone() || cancel_current)
+        if(current->isDone() || (*job).cancelled)
         {
-            chunks.pop_front();
+            jobs.erase(job);
             current->release();
         }
-        cancel_current = false;
-        current = nullptr;
-        updated_cond.signal();
+        else
+        {
+            (*job).active = false;
+            wait_cond.signal();
+        }
+        updated_cond.broadcast();
         lock.unlock();
     }
 }
@@ -25,6 +25,7 @@
 #include <vlc_common.h>
 #include <vlc_cxx_helpers.hpp>
 #include <list>
+#include <vector>
 
 namespace adaptive
 {
@@ -35,25 +36,33 @@ namespace adaptive
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned = 1);
                 ~Downloader();
                 bool start();
-                void schedule(HTTPChunkBufferedSource *);
+                void schedule(HTTPChunkBufferedSource *, vlc_tick_t = VLC_TICK_INVALID);
                 void cancel(HTTPChunkBufferedSource *);
 
             private:
+                class Job
+                {
+                    public:
+                        HTTPChunkBufferedSource *source;
+                        vlc_tick_t deadline;
+                        bool active; /* being bufferized by a worker */
+                        bool cancelled;
+                };
                 static void * downloaderThread(void *);
                 void Run();
                 void kill();
-                vlc_thread_t thread_handle;
+                std::list<Job>::iterator nextJob();
+                std::list<Job>::iterator findJob(const HTTPChunkBufferedSource *);
+                std::vector<vlc_thread_t> threads;
+                unsigned     workers;
                 vlc::threads::mutex lock;
                 vlc::threads::condition_variable wait_cond;
                 vlc::threads::condition_variable updated_cond;
-                bool         thread_handle_valid;
                 bool         killed;
-                bool         cancel_current;
-                std::list<HTTPChunkBufferedSource *> chunks;
-                HTTPChunkBufferedSource *current;
+                std::list<Job> jobs;
         };
 
     }
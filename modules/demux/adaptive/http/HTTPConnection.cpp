@@ -415,7 +415,8 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
 
 ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
 {
-    ssize_t read = vlc_stream_Read(stream, p_buffer, len);
+    /* Return data as it arrives, for chunked low latency delivery */
+    ssize_t read = vlc_stream_ReadPartial(stream, p_buffer, len);
     bytesRead = source->totalRead;
     return read;
 }
@@ -29,19 +29,22 @@
 #include "HTTPConnection.hpp"
 #include "ConnectionParams.hpp"
 #include "Downloader.hpp"
+#include "SegmentCache.hpp"
 #include "tools/Debug.hpp"
 #include <vlc_url.h>
 #include <vlc_http.h>
-
-#include <cassert>
+#include <vlc_block.h>
 
 using namespace adaptive::http;
 
+#define TRANSFER_SAMPLING VLC_TICK_FROM_MS(500)
+
 AbstractConnectionManager::AbstractConnectionManager(vlc_object_t *p_object_)
     : IDownloadRateObserver()
 {
     p_object = p_object_;
     rateObserver = nullptr;
+    vlc_mutex_init(&ratelock);
 }
 
 AbstractConnectionManager::~AbstractConnectionManager()
@@ -67,36 +70,102 @@ void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *o
     rateObserver = obs;
 }
 
+void AbstractConnectionManager::transferStarted(const adaptive::ID &sourceid,
+                                                vlc_tick_t responsetime,
+                                                vlc_tick_t latency)
+{
+    vlc_mutex_lock(&ratelock);
+    TransferWindow &window = transfers[sourceid];
+    if(window.active++ == 0)
+    {
+        window.size = 0;
+        window.start = responsetime;
+        window.latency = latency;
+    }
+    else if(latency > window.latency)
+    {
+        window.latency = latency;
+    }
+    vlc_mutex_unlock(&ratelock);
+}
+
+void AbstractConnectionManager::transferProgress(const adaptive::ID &sourceid,
+                                                 size_t size)
+{
+    vlc_mutex_lock(&ratelock);
+    std::map<ID, TransferWindow>::iterator it = transfers.find(sourceid);
+    if(it == transfers.end())
+    {
+        vlc_mutex_unlock(&ratelock);
+        return;
+    }
+    TransferWindow &window = (*it).second;
+    window.size += size;
+    /* A single transfer is reported once complete, as before. Overlapping
+       ones are sampled, as the window might never close */
+    const vlc_tick_t now = vlc_tick_now();
+    const vlc_tick_t time = now - window.start;
+    if(window.active < 2 || time < TRANSFER_SAMPLING)
+    {
+        vlc_mutex_unlock(&ratelock);
+        return;
+    }
+    const size_t total = window.size;
+    const vlc_tick_t latency = window.latency;
+    window.size = 0;
+    window.start = now;
+    vlc_mutex_unlock(&ratelock);
+
+    updateDownloadRate(sourceid, total, time, latency);
+}
+
+void AbstractConnectionManager::transferEnded(const adaptive::ID &sourceid)
+{
+    vlc_mutex_lock(&ratelock);
+    std::map<ID, TransferWindow>::iterator it = transfers.find(sourceid);
+    if(it == transfers.end())
+    {
+        vlc_mutex_unlock(&ratelock);
+        return;
+    }
+    TransferWindow &window = (*it).second;
+    if(--window.active > 0)
+    {
+        vlc_mutex_unlock(&ratelock);
+        return;
+    }
+    const size_t total = window.size;
+    const vlc_tick_t time = vlc_tick_now() - window.start;
+    const vlc_tick_t latency = window.latency;
+    transfers.erase(it);
+    vlc_mutex_unlock(&ratelock);
+
+    if(total && time > 0)
+        updateDownloadRate(sourceid, total, time, latency);
+}
+
 void AbstractConnectionManager::deleteSource(AbstractChunkSource *source)
 {
     delete source;
 }
 
-HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_)
+HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_,
+                                                 unsigned prefetch)
     : AbstractConnectionManager( p_object_ ),
       localAllowed(false)
 {
     vlc_mutex_init(&lock);
-    downloader = new Downloader();
+    /* One worker per elementary stream (audio and video),
+       plus one per prefetched segment */
+    downloader = new Downloader(2 + prefetch);
     downloaderhp = new Downloader();
     downloader->start();
     downloaderhp->start();
-    cache_total = 0;
-    cache_max = 1 << 19;
+    segmentCache = nullptr;
 }
 
 HTTPConnectionManager::~HTTPConnectionManager   ()
 {
-    while(!cache.empty())
-    {
-        HTTPChunkBufferedSource *purged = cache.back();
-        cache.pop_back();
-        assert(cache_total >= purged->contentLength);
-        cache_total -= purged->contentLength;
-        CacheDebug(msg_Dbg(p_object, "Cache DEL '%s' usage %u bytes",
-                            purged->getStorageID().c_str(), cache_total));
-        deleteSource(purged);
-    }
     delete downloader;
     delete downloaderhp;
     this->closeAllConnections();
@@ -176,70 +245,53 @@ AbstractChunkSource *HTTPConnectionManager::makeSource(const std::string &url,
                                                        const ID &id, ChunkType type,
                                                        const BytesRange &range)
 {
-    StorageID storageid = HTTPChunkSource::makeStorageID(url, range);
-    switch(type)
+    if(segmentCache)
     {
-        case ChunkType::Init:
-        case ChunkType::Index:
-            for(HTTPChunkBufferedSource *s : cache)
-            {
-                if(s->getStorageID() == storageid)
-                {
-                    cache.remove(s);
-                    assert(cache_total >= s->contentLength);
-                    cache_total -= s->contentLength;
-                    CacheDebug(msg_Dbg(p_object, "Cache GET '%s' usage %u bytes",
-                                       storageid.c_str(), cache_total));
-                    return s;
-                }
-            }
-            // fallthrough
-        case ChunkType::Segment:
-        case ChunkType::Key:
-        case ChunkType::Playlist:
-        default:
-            return new HTTPChunkBufferedSource(url, this, id, type, range);
+        StorageID storageid = HTTPChunkSource::makeStorageID(url, range);
+        std::string contentType;
+        block_t *p_data = segmentCache->get(storageid, type, contentType);
+        if(p_data)
+        {
+            CachedChunkSource *source = new CachedChunkSource(this, type, range,
+                                                              p_data, contentType);
+            source->storeid = storageid;
+            return source;
+        }
     }
+    return new HTTPChunkBufferedSource(url, this, id, type, range);
 }
 
 void HTTPConnectionManager::recycleSource(AbstractChunkSource *source)
 {
-    bool b_cacheable;
-    switch(source->getChunkType())
-    {
-        case ChunkType::Index:
-        case ChunkType::Init:
-            b_cacheable = true;
-            break;
-        case ChunkType::Key:
-        case ChunkType::Playlist:
-        case ChunkType::Segment:
-        default:
-            b_cacheable = false;
-            break;
-    }
-
     HTTPChunkBufferedSource *buf = dynamic_cast<HTTPChunkBufferedSource *>(source);
-    if(buf && b_cacheable && !buf->getStorageID().empty() &&
-       buf->contentLength < cache_max)
+    if(segmentCache && buf && SegmentCache::isCacheable(buf->getChunkType()))
     {
-        while(cache_max < cache_total + buf->contentLength)
+        /* only complete transfers, with known length */
+        const std::string contentType = buf->getContentType();
+        block_t *p_data = nullptr;
         {
-            HTTPChunkBufferedSource *purged = cache.back();
-            cache.pop_back();
-            assert(cache_total >= purged->contentLength);
-            cache_total -= purged->contentLength;
-            CacheDebug(msg_Dbg(p_object, "Cache DEL '%s' usage %u bytes",
-                               purged->getStorageID().c_str(), cache_total));
-            deleteSource(purged);
+            vlc::threads::mutex_locker locker {buf->lock};
+            if(buf->done && buf->p_head &&
+               buf->requeststatus == RequestStatus::Success &&
+               buf->contentLength && buf->buffered == buf->contentLength)
+            {
+                p_data = block_ChainGather(buf->p_head);
+                buf->p_head = nullptr;
+                buf->pp_tail = &buf->p_head;
+                buf->p_read = nullptr;
+                buf->buffered = 0;
+            }
         }
-        cache.push_front(buf);
-        cache_total += buf->contentLength;
-        CacheDebug(msg_Dbg(p_object, "Cache PUT '%s' usage %u bytes",
-                           buf->getStorageID().c_str(), cache_total));
+        if(p_data)
+            segmentCache->put(buf->getStorageID(), buf->getChunkType(),
+                              p_data, contentType);
     }
-    else
-        deleteSource(source);
+    deleteSource(source);
+}
+
+void HTTPConnectionManager::setSegmentCache(SegmentCache *cache)
+{
+    segmentCache = cache;
 }
 
 Downloader * HTTPConnectionManager::getDownloadQueue(const AbstractChunkSource *source) const
@@ -257,11 +309,11 @@ Downloader * HTTPConnectionManager::getDownloadQueue(const AbstractChunkSource *
     }
 }
 
-void HTTPConnectionManager::start(AbstractChunkSource *source)
+void HTTPConnectionManager::start(AbstractChunkSource *source, vlc_tick_t deadline)
 {
     HTTPChunkBufferedSource *src = dynamic_cast<HTTPChunkBufferedSource *>(source);
     if(src && !src->isDone())
-        getDownloadQueue(src)->schedule(src);
+        getDownloadQueue(src)->schedule(src, deadline);
 }
 
 void HTTPConnectionManager::cancel(AbstractChunkSource *source)
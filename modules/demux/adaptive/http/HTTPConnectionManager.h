@@ -32,6 +32,7 @@
 
 #include <vector>
 #include <list>
+#include <map>
 #include <string>
 
 namespace adaptive
@@ -44,6 +45,7 @@ namespace adaptive
         class Downloader;
         class AbstractChunkSource;
         class HTTPChunkBufferedSource;
+        class SegmentCache;
         enum class ChunkType;
 
         class AbstractConnectionManager : public IDownloadRateObserver
@@ -58,25 +60,42 @@ namespace adaptive
                                                         const BytesRange &) = 0;
                 virtual void recycleSource(AbstractChunkSource *) = 0;
 
-                virtual void start(AbstractChunkSource *) = 0;
+                virtual void start(AbstractChunkSource *, vlc_tick_t) = 0;
                 virtual void cancel(AbstractChunkSource *) = 0;
 
                 virtual void updateDownloadRate(const ID &, size_t,
                                                 vlc_tick_t, vlc_tick_t) override;
                 void setDownloadRateObserver(IDownloadRateObserver *);
 
+                /* Concurrent transfers of a same stream are measured together,
+                   as they share the link. Measurement starts on response, the
+                   time to first byte is reported apart as latency */
+                void transferStarted(const ID &, vlc_tick_t, vlc_tick_t);
+                void transferProgress(const ID &, size_t);
+                void transferEnded(const ID &);
+
             protected:
                 void deleteSource(AbstractChunkSource *);
                 vlc_object_t                                       *p_object;
 
             private:
+                class TransferWindow
+                {
+                    public:
+                        unsigned active;
+                        size_t size;
+                        vlc_tick_t start;
+                        vlc_tick_t latency;
+                };
                 IDownloadRateObserver                              *rateObserver;
+                vlc_mutex_t                                         ratelock;
+                std::map<ID, TransferWindow>                        transfers;
         };
 
         class HTTPConnectionManager : public AbstractConnectionManager
         {
             public:
-                HTTPConnectionManager           (vlc_object_t *p_object);
+                HTTPConnectionManager           (vlc_object_t *p_object, unsigned = 0);
                 virtual ~HTTPConnectionManager  ();
 
                 virtual void    closeAllConnections ()  override;
@@ -86,10 +105,11 @@ namespace adaptive
                                                         const BytesRange &) override;
                 virtual void recycleSource(AbstractChunkSource *) override;
 
-                virtual void start(AbstractChunkSource *)  override;
+                virtual void start(AbstractChunkSource *, vlc_tick_t)  override;
                 virtual void cancel(AbstractChunkSource *)  override;
                 void         setLocalConnectionsAllowed();
                 void         addFactory(AbstractConnectionFactory *);
+                void         setSegmentCache(SegmentCache *);
 
             private:
                 void    releaseAllConnections ();
@@ -101,9 +121,7 @@ namespace adaptive
                 bool                                                localAllowed;
                 AbstractConnection * reuseConnection(ConnectionParams &);
                 Downloader * getDownloadQueue(const AbstractChunkSource *) const;
-                std::list<HTTPChunkBufferedSource *> cache;
-                size_t cache_total;
-                size_t cache_max;
+                SegmentCache                                       *segmentCache;
         };
     }
 }
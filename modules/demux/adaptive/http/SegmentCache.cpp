@@ -0,0 +1,410 @@
+/*
+ * SegmentCache.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SegmentCache.hpp"
+#include "../tools/Debug.hpp"
+
+#include <vlc_block.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_strings.h>
+
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <ctime>
+#include <sys/stat.h>
+
+using namespace adaptive::http;
+
+const size_t SegmentCache::DEFAULT_DISK_MAX = 64 * 1024 * 1024;
+/* no revalidation, so that a changed init segment is not used for long */
+const time_t SegmentCache::DISK_TTL = 24 * 3600;
+
+#define DISK_SUFFIX ".seg"
+
+SegmentCache::SegmentCache(vlc_object_t *obj, size_t max_,
+                           const std::string &path, size_t diskmax_)
+{
+    p_object = obj;
+    vlc_mutex_init(&lock);
+    total = 0;
+    max = max_;
+    disktotal = 0;
+    diskmax = diskmax_;
+    if(!path.empty() && diskmax)
+    {
+        diskpath = path;
+        diskScan();
+    }
+}
+
+SegmentCache::~SegmentCache()
+{
+    for(Entry &e : entries)
+        block_Release(e.data);
+}
+
+bool SegmentCache::isCacheable(ChunkType type)
+{
+    switch(type)
+    {
+        case ChunkType::Init:
+        case ChunkType::Index:
+        case ChunkType::Segment:
+            return true;
+        case ChunkType::Key:
+        case ChunkType::Playlist:
+        default:
+            return false;
+    }
+}
+
+bool SegmentCache::isPersistent(ChunkType type)
+{
+    /* Media segments would only fill the disk for little gain,
+       while init segments are what zapping to a stream waits for */
+    switch(type)
+    {
+        case ChunkType::Init:
+        case ChunkType::Index:
+            return true;
+        case ChunkType::Segment:
+        case ChunkType::Key:
+        case ChunkType::Playlist:
+        default:
+            return false;
+    }
+}
+
+size_t SegmentCache::getUsage() const
+{
+    vlc_mutex_lock(&lock);
+    size_t usage = total;
+    vlc_mutex_unlock(&lock);
+    return usage;
+}
+
+block_t * SegmentCache::get(const StorageID &id, ChunkType type,
+                            std::string &contentType)
+{
+    if(id.empty() || !isCacheable(type))
+        return nullptr;
+
+    block_t *p_block = nullptr;
+    vlc_mutex_lock(&lock);
+    auto it = index.find(id);
+    const bool b_found = (it != index.end());
+    if(b_found)
+    {
+        /* move to front */
+        entries.splice(entries.begin(), entries, it->second);
+        const Entry &e = entries.front();
+        p_block = block_Duplicate(e.data);
+        if(p_block)
+            contentType = e.contentType;
+        CacheDebug(msg_Dbg(p_object, "Cache GET '%s' usage %zu bytes",
+                           id.c_str(), total));
+    }
+    vlc_mutex_unlock(&lock);
+
+    /* the disk is only read and written unlocked */
+    if(!b_found && isPersistent(type) && !diskpath.empty())
+    {
+        p_block = diskGet(id, contentType);
+        block_t *p_copy = p_block ? block_Duplicate(p_block) : nullptr;
+        if(p_copy)
+        {
+            vlc_mutex_lock(&lock);
+            if(index.find(id) == index.end())
+                store(id, p_copy, contentType);
+            else
+                block_Release(p_copy);
+            vlc_mutex_unlock(&lock);
+        }
+    }
+    return p_block;
+}
+
+void SegmentCache::put(const StorageID &id, ChunkType type, block_t *p_block,
+                       const std::string &contentType)
+{
+    if(id.empty() || !isCacheable(type) || p_block->i_buffer == 0)
+    {
+        block_Release(p_block);
+        return;
+    }
+
+    if(isPersistent(type) && !diskpath.empty())
+        diskPut(id, p_block, contentType);
+    vlc_mutex_lock(&lock);
+    if(index.find(id) == index.end())
+        store(id, p_block, contentType);
+    else
+        block_Release(p_block);
+    vlc_mutex_unlock(&lock);
+}
+
+void SegmentCache::store(const StorageID &id, block_t *p_block,
+                         const std::string &contentType)
+{
+    if(p_block->i_buffer > max)
+    {
+        block_Release(p_block);
+        return;
+    }
+    evict(p_block->i_buffer);
+    entries.push_front({id, contentType, p_block});
+    index[id] = entries.begin();
+    total += p_block->i_buffer;
+    CacheDebug(msg_Dbg(p_object, "Cache PUT '%s' usage %zu bytes",
+                       id.c_str(), total));
+}
+
+void SegmentCache::evict(size_t size)
+{
+    while(!entries.empty() && total + size > max)
+    {
+        Entry &e = entries.back();
+        total -= e.data->i_buffer;
+        CacheDebug(msg_Dbg(p_object, "Cache DEL '%s' usage %zu bytes",
+                           e.id.c_str(), total));
+        block_Release(e.data);
+        index.erase(e.id);
+        entries.pop_back();
+    }
+}
+
+std::string SegmentCache::getDefaultDiskPath()
+{
+    char *psz_dir = config_GetUserDir(VLC_CACHE_DIR);
+    if(!psz_dir)
+        return std::string();
+    std::string path(psz_dir);
+    free(psz_dir);
+    vlc_mkdir(path.c_str(), 0700);
+    path += DIR_SEP "adaptive";
+    if(vlc_mkdir(path.c_str(), 0700) != 0 && errno != EEXIST)
+        return std::string();
+    return path;
+}
+
+std::string SegmentCache::getDigest(const StorageID &id)
+{
+    vlc_hash_md5_t md5;
+    uint8_t digest[VLC_HASH_MD5_DIGEST_SIZE];
+    char hex[VLC_HASH_MD5_DIGEST_SIZE * 2 + 1];
+    vlc_hash_md5_Init(&md5);
+    vlc_hash_md5_Update(&md5, id.c_str(), id.length());
+    vlc_hash_md5_Finish(&md5, digest, sizeof(digest));
+    vlc_hex_encode_binary(digest, sizeof(digest), hex);
+    return std::string(hex);
+}
+
+void SegmentCache::diskScan()
+{
+    DIR *dir = vlc_opendir(diskpath.c_str());
+    if(!dir)
+    {
+        diskpath.clear();
+        return;
+    }
+
+    const time_t now = time(nullptr);
+    std::vector<DiskEntry> found;
+    std::vector<std::string> expired;
+    const char *psz_name;
+    while((psz_name = vlc_readdir(dir)))
+    {
+        std::string name(psz_name);
+        if(name.length() <= sizeof(DISK_SUFFIX) - 1 ||
+           name.compare(name.length() - sizeof(DISK_SUFFIX) + 1,
+                        std::string::npos, DISK_SUFFIX))
+            continue;
+        struct stat st;
+        if(vlc_stat((diskpath + DIR_SEP + name).c_str(), &st) || !S_ISREG(st.st_mode))
+            continue;
+        if(now - st.st_mtime >= DISK_TTL)
+            expired.push_back(name);
+        else
+            found.push_back({name, (size_t) st.st_size, st.st_mtime});
+    }
+    closedir(dir);
+    diskRemove(expired);
+
+    std::sort(found.begin(), found.end(),
+              [](const DiskEntry &a, const DiskEntry &b) { return a.mtime < b.mtime; });
+    for(const DiskEntry &e : found)
+    {
+        diskentries.push_back(e);
+        disktotal += e.size;
+    }
+    diskRemove(diskEvict(0));
+}
+
+std::vector<std::string> SegmentCache::diskEvict(size_t size)
+{
+    std::vector<std::string> evicted;
+    while(!diskentries.empty() && disktotal + size > diskmax)
+    {
+        const DiskEntry &e = diskentries.front();
+        evicted.push_back(e.name);
+        disktotal -= e.size;
+        diskentries.pop_front();
+    }
+    return evicted;
+}
+
+void SegmentCache::diskForget(const std::string &name)
+{
+    vlc_mutex_lock(&lock);
+    auto it = std::find_if(diskentries.begin(), diskentries.end(),
+                           [&name](const DiskEntry &e) { return e.name == name; });
+    if(it != diskentries.end())
+    {
+        disktotal -= it->size;
+        diskentries.erase(it);
+    }
+    vlc_mutex_unlock(&lock);
+}
+
+void SegmentCache::diskRemove(const std::vector<std::string> &names) const
+{
+    for(const std::string &name : names)
+        vlc_unlink((diskpath + DIR_SEP + name).c_str());
+}
+
+block_t * SegmentCache::diskGet(const StorageID &id, std::string &contentType)
+{
+    const std::string digest = getDigest(id);
+    const std::string name = digest + DISK_SUFFIX;
+    const auto match = [&name](const DiskEntry &e) { return e.name == name; };
+
+    size_t size = 0;
+    bool b_stale = false;
+    vlc_mutex_lock(&lock);
+    auto it = std::find_if(diskentries.begin(), diskentries.end(), match);
+    if(it != diskentries.end())
+    {
+        b_stale = (time(nullptr) - it->mtime >= DISK_TTL);
+        size = it->size;
+    }
+    vlc_mutex_unlock(&lock);
+    if(b_stale)
+    {
+        diskForget(name);
+        diskRemove({name});
+        return nullptr;
+    }
+    if(size == 0)
+        return nullptr;
+
+    FILE *fp = vlc_fopen((diskpath + DIR_SEP + name).c_str(), "rb");
+    if(!fp)
+        return nullptr;
+
+    /* "<key digest>\n<content type>\n<data>" */
+    block_t *p_block = block_Alloc(size);
+    if(p_block)
+    {
+        p_block->i_buffer = fread(p_block->p_buffer, 1, size, fp);
+        const uint8_t *p_end = p_block->p_buffer + p_block->i_buffer;
+        const uint8_t *p_key = p_block->p_buffer;
+        const uint8_t *p_type = std::find(p_key, p_end, '\n');
+        const uint8_t *p_data = (p_type != p_end) ? std::find(++p_type, p_end, '\n')
+                                                  : p_end;
+        if(p_data != p_end &&
+           digest.compare(0, std::string::npos, (const char *) p_key, p_type - 1 - p_key) == 0)
+        {
+            contentType.assign((const char *) p_type, p_data - p_type);
+            ++p_data;
+            const size_t header = p_data - p_block->p_buffer;
+            p_block->p_buffer += header;
+            p_block->i_buffer -= header;
+            CacheDebug(msg_Dbg(p_object, "Disk cache GET '%s'", id.c_str()));
+        }
+        else /* truncated or from an older version */
+        {
+            block_Release(p_block);
+            p_block = nullptr;
+            b_stale = true;
+        }
+    }
+    fclose(fp);
+    if(b_stale)
+    {
+        diskForget(name);
+        diskRemove({name});
+    }
+    return p_block;
+}
+
+void SegmentCache::diskPut(const StorageID &id, const block_t *p_block,
+                           const std::string &contentType)
+{
+    const std::string digest = getDigest(id);
+    const std::string name = digest + DISK_SUFFIX;
+    const auto match = [&name](const DiskEntry &e) { return e.name == name; };
+
+    /* The url, which can carry credentials, is never written out */
+    const std::string header = digest + '\n' + contentType + '\n';
+    const size_t size = header.length() + p_block->i_buffer;
+    if(size > diskmax || contentType.find('\n') != std::string::npos)
+        return;
+
+    /* reserve it first, so that it's only written once */
+    vlc_mutex_lock(&lock);
+    if(std::any_of(diskentries.begin(), diskentries.end(), match))
+    {
+        vlc_mutex_unlock(&lock);
+        return;
+    }
+    const std::vector<std::string> evicted = diskEvict(size);
+    diskentries.push_back({name, size, time(nullptr)});
+    disktotal += size;
+    vlc_mutex_unlock(&lock);
+    diskRemove(evicted);
+
+    /* write apart and rename, so that no other instance reads it partial */
+    const std::string path = diskpath + DIR_SEP + name;
+    const std::string tmppath = path + ".tmp";
+    FILE *fp = vlc_fopen(tmppath.c_str(), "wb");
+    bool b_ok = false;
+    if(fp)
+    {
+        b_ok = fwrite(header.c_str(), 1, header.length(), fp) == header.length() &&
+               fwrite(p_block->p_buffer, 1, p_block->i_buffer, fp) == p_block->i_buffer;
+        b_ok &= (fclose(fp) == 0);
+    }
+    if(!b_ok || vlc_rename(tmppath.c_str(), path.c_str()))
+    {
+        vlc_unlink(tmppath.c_str());
+        diskForget(name);
+        return;
+    }
+
+    CacheDebug(msg_Dbg(p_object, "Disk cache PUT '%s'", id.c_str()));
+}
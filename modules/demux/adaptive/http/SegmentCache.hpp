@@ -0,0 +1,101 @@
+/*
+ * SegmentCache.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef SEGMENTCACHE_HPP
+#define SEGMENTCACHE_HPP
+
+#include "Chunk.h"
+
+#include <vlc_common.h>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace adaptive
+{
+    namespace http
+    {
+        /* Completed downloads, keyed by url and byte range.
+         * The memory tier is a size bounded LRU shared by all the streams.
+         * Init and index segments can also be stored on disk, so that
+         * they survive the input and can be reused on restart, until
+         * they expire. Only a digest of the key is written there. */
+        class SegmentCache
+        {
+            public:
+                SegmentCache(vlc_object_t *, size_t,
+                             const std::string & = std::string(), size_t = 0);
+                ~SegmentCache();
+                /* returns a copy of the data, or nullptr */
+                block_t * get(const StorageID &, ChunkType, std::string &);
+                /* takes ownership of the data */
+                void put(const StorageID &, ChunkType, block_t *,
+                         const std::string &);
+                size_t getUsage() const;
+                static bool isCacheable(ChunkType);
+
+                /* for the disk tier in the user cache dir */
+                static std::string getDefaultDiskPath();
+                static const size_t DEFAULT_DISK_MAX;
+                static const time_t DISK_TTL; /* seconds */
+
+            private:
+                class Entry
+                {
+                    public:
+                        StorageID id;
+                        std::string contentType;
+                        block_t *data;
+                };
+                class DiskEntry
+                {
+                    public:
+                        std::string name;
+                        size_t size;
+                        time_t mtime;
+                };
+                static bool isPersistent(ChunkType);
+                void store(const StorageID &, block_t *, const std::string &);
+                void evict(size_t);
+                static std::string getDigest(const StorageID &);
+                block_t * diskGet(const StorageID &, std::string &);
+                void diskPut(const StorageID &, const block_t *,
+                             const std::string &);
+                void diskScan();
+                /* returns the files to remove once unlocked */
+                std::vector<std::string> diskEvict(size_t);
+                void diskForget(const std::string &);
+                void diskRemove(const std::vector<std::string> &) const;
+
+                vlc_object_t *p_object;
+                mutable vlc_mutex_t lock;
+                std::list<Entry> entries; /* most recently used first */
+                std::map<StorageID, std::list<Entry>::iterator> index;
+                size_t total;
+                size_t max;
+                std::string diskpath;
+                std::list<DiskEntry> diskentries; /* oldest first */
+                size_t disktotal;
+                size_t diskmax;
+        };
+    }
+}
+
+#endif // SEGMENTCACHE_HPP
@@ -41,12 +41,14 @@ const vlc_tick_t AbstractBufferingLogic::BUFFERING_LOWEST_LIMIT = VLC_TICK_FROM_
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_MIN_BUFFERING = VLC_TICK_FROM_SEC(6);
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_MAX_BUFFERING = VLC_TICK_FROM_SEC(30);
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_LIVE_BUFFERING = VLC_TICK_FROM_SEC(15);
+const unsigned AbstractBufferingLogic::DEFAULT_PREFETCH = 2;
 
 AbstractBufferingLogic::AbstractBufferingLogic()
 {
     userMinBuffering = 0;
     userMaxBuffering = 0;
     userLiveDelay = 0;
+    userPrefetch = DEFAULT_PREFETCH;
 }
 
 void AbstractBufferingLogic::setLowDelay(bool b)
@@ -69,6 +71,16 @@ void AbstractBufferingLogic::setUserLiveDelay(vlc_tick_t v)
     userLiveDelay = v;
 }
 
+void AbstractBufferingLogic::setUserPrefetch(unsigned v)
+{
+    userPrefetch = v;
+}
+
+unsigned AbstractBufferingLogic::getPrefetch() const
+{
+    return userPrefetch;
+}
+
 /* Try to never buffer up to really end */
 /* Enforce no overlap for demuxers segments 3.0.0 */
 /* FIXME: check duration instead ? */
@@ -50,16 +50,20 @@ namespace adaptive
                 void setUserMinBuffering(vlc_tick_t);
                 void setUserMaxBuffering(vlc_tick_t);
                 void setUserLiveDelay(vlc_tick_t);
+                void setUserPrefetch(unsigned);
+                unsigned getPrefetch() const;
                 void setLowDelay(bool);
                 static const vlc_tick_t BUFFERING_LOWEST_LIMIT;
                 static const vlc_tick_t DEFAULT_MIN_BUFFERING;
                 static const vlc_tick_t DEFAULT_MAX_BUFFERING;
                 static const vlc_tick_t DEFAULT_LIVE_BUFFERING;
+                static const unsigned DEFAULT_PREFETCH;
 
             protected:
                 vlc_tick_t userMinBuffering;
                 vlc_tick_t userMaxBuffering;
                 vlc_tick_t userLiveDelay;
+                unsigned userPrefetch;
                 Undef<bool> userLowLatency;
         };
 
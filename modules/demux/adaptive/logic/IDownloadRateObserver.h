@@ -34,6 +34,7 @@ namespace adaptive
     class IDownloadRateObserver
     {
         public:
+            /* size, transfer time from first byte, latency to first byte */
             virtual void updateDownloadRate(const ID &, size_t,
                                             vlc_tick_t, vlc_tick_t) = 0;
             virtual ~IDownloadRateObserver(){}
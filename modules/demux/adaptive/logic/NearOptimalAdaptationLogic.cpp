@@ -95,8 +95,9 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
     if(lowest == highest)
         return lowest;
 
-    const float umin = getUtility(lowest);
-    const float umax = getUtility(highest);
+    /* utilities are normalized so that the lowest one is 1 */
+    const float umin = getUtility(lowest) - 1.0;
+    const float umax = getUtility(highest) - umin;
 
     vlc_mutex_lock(&lock);
 
@@ -112,8 +113,10 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
 
     vlc_mutex_unlock(&lock);
 
-    const float gammaP = 1.0 + (umax - umin) / ((float)ctxcopy.buffering_target / ctxcopy.buffering_min - 1.0);
-    const float Vd = (secf_from_vlc_tick(ctxcopy.buffering_min) - 1.0) / (umin + gammaP);
+    /* Picks the lowest quality at the minimum buffering, and the highest
+     * one from the target on */
+    const float gammaP = (umax - 1.0) / ((float)ctxcopy.buffering_target / ctxcopy.buffering_min - 1.0);
+    const float Vd = secf_from_vlc_tick(ctxcopy.buffering_min) / gammaP;
 
     BaseRepresentation *m;
     if(prevRep == nullptr) /* Starting */
@@ -130,7 +133,7 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
     else
     {
         /* noted m* */
-        m = getNextQualityIndex(adaptSet, selector, gammaP - umin /* umin == Sm, utility = std::log(S/Sm) */,
+        m = getNextQualityIndex(adaptSet, selector, gammaP - umin /* utility = 1 + std::log(S/Sm) */,
                                 Vd, secf_from_vlc_tick(ctxcopy.buffering_level));
         if(m->getBandwidth() < prevRep->getBandwidth()) /* m*[n] < m*[n-1] */
         {
@@ -149,6 +152,17 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
             }
             m = mp;
         }
+        else if(m->getBandwidth() > prevRep->getBandwidth()) /* m*[n] > m*[n-1] */
+        {
+            /* don't go above what the link sustains, only to come back
+             * once the buffer is drained */
+            BaseRepresentation *mp = selector.select(adaptSet, bps); /* m' */
+            if(mp->getBandwidth() >= m->getBandwidth())
+                mp = m;
+            else if(mp->getBandwidth() < prevRep->getBandwidth())
+                mp = prevRep;
+            m = mp;
+        }
     }
 
     BwDebug( msg_Info(p_obj, "buffering level %.2f% rep %ld kBps %zu kBps",
@@ -192,14 +206,15 @@ unsigned NearOptimalAdaptationLogic::getMaxCurrentBw() const
 }
 
 void NearOptimalAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize,
-                                                    vlc_tick_t time, vlc_tick_t)
+                                                    vlc_tick_t time, vlc_tick_t latency)
 {
     vlc_mutex_lock(&lock);
     std::map<ID, NearOptimalContext>::iterator it = streams.find(id);
     if(it != streams.end())
     {
         NearOptimalContext &ctx = (*it).second;
-        ctx.last_download_rate = ctx.average.push(CLOCK_FREQ * dlsize * 8 / time);
+        if(ctx.estimator.push(dlsize, time, latency))
+            ctx.last_download_rate = ctx.estimator.get();
     }
     currentBps = getMaxCurrentBw();
     vlc_mutex_unlock(&lock);
@@ -22,7 +22,7 @@
 
 #include "AbstractAdaptationLogic.h"
 #include "Representationselectors.hpp"
-#include "../tools/MovingAverage.hpp"
+#include "../tools/ThroughputEstimator.hpp"
 #include <map>
 
 namespace adaptive
@@ -41,7 +41,7 @@ namespace adaptive
                 vlc_tick_t buffering_level;
                 vlc_tick_t buffering_target;
                 unsigned last_download_rate;
-                MovingAverage<unsigned> average;
+                ThroughputEstimator estimator;
         };
 
         class NearOptimalAdaptationLogic : public AbstractAdaptationLogic
@@ -83,7 +83,7 @@ BaseRepresentation *PredictiveAdaptationLogic::getNextRepresentation(BaseAdaptat
 
         double f_buffering_level = (double)stats.buffering_level / stats.buffering_target;
         double f_min_buffering_level = f_buffering_level;
-        unsigned i_max_bitrate = 0;
+        unsigned i_max_bitrate = stats.last_download_rate;
         if(streams.size() > 1)
         {
             std::map<ID, PredictiveStats>::const_iterator it2 = streams.begin();
@@ -105,7 +105,12 @@ BaseRepresentation *PredictiveAdaptationLogic::getNextRepresentation(BaseAdaptat
         }
         else
         {
-            const unsigned i_available_bw = getAvailableBw(i_max_bitrate, prevRep);
+            unsigned i_available_bw = getAvailableBw(i_max_bitrate, prevRep);
+            /* each segment request first waits for the response */
+            const vlc_tick_t latency = stats.estimator.getLatency();
+            if(latency > 0 && latency < stats.last_duration)
+                i_available_bw = (uint64_t) i_available_bw *
+                                 (stats.last_duration - latency) / stats.last_duration;
             if(!prevRep)
             {
                 rep = selector.select(adaptSet, i_available_bw);
@@ -152,14 +157,15 @@ BaseRepresentation *PredictiveAdaptationLogic::getNextRepresentation(BaseAdaptat
 }
 
 void PredictiveAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize,
-                                                   vlc_tick_t time, vlc_tick_t)
+                                                   vlc_tick_t time, vlc_tick_t latency)
 {
     vlc_mutex_lock(&lock);
     std::map<ID, PredictiveStats>::iterator it = streams.find(id);
     if(it != streams.end())
     {
         PredictiveStats &stats = (*it).second;
-        stats.last_download_rate = stats.average.push(CLOCK_FREQ * dlsize * 8 / time);
+        if(stats.estimator.push(dlsize, time, latency))
+            stats.last_download_rate = stats.estimator.get();
     }
     vlc_mutex_unlock(&lock);
 }
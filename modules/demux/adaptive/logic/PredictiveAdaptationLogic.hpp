@@ -21,7 +21,7 @@
 #define PREDICTIVEADAPTATIONLOGIC_HPP
 
 #include "AbstractAdaptationLogic.h"
-#include "../tools/MovingAverage.hpp"
+#include "../tools/ThroughputEstimator.hpp"
 #include <map>
 
 namespace adaptive
@@ -42,7 +42,7 @@ namespace adaptive
                 vlc_tick_t buffering_target;
                 unsigned last_download_rate;
                 vlc_tick_t last_duration;
-                MovingAverage<unsigned> average;
+                ThroughputEstimator estimator;
         };
 
         class PredictiveAdaptationLogic : public AbstractAdaptationLogic
@@ -77,12 +77,12 @@ BaseRepresentation *RateBasedAdaptationLogic::getNextRepresentation(BaseAdaptati
 }
 
 void RateBasedAdaptationLogic::updateDownloadRate(const ID &, size_t size,
-                                                  vlc_tick_t time, vlc_tick_t)
+                                                  vlc_tick_t time, vlc_tick_t latency)
 {
     if(unlikely(time == 0))
         return;
     /* Accumulate up to observation window */
-    dllength += time;
+    dllength += time + latency;
     dlsize += size;
 
     if(dllength < VLC_TICK_FROM_MS(250))
@@ -77,7 +77,8 @@ bool ISegment::prepareChunk(SharedResources *res, SegmentChunk *chunk, BaseRepre
     return true;
 }
 
-SegmentChunk* ISegment::toChunk(SharedResources *res, size_t index, BaseRepresentation *rep)
+SegmentChunk* ISegment::toChunk(SharedResources *res, size_t index, BaseRepresentation *rep,
+                                vlc_tick_t deadline)
 {
     const std::string url = getUrlSegment().toString(index, rep);
     BytesRange range;
@@ -108,7 +109,7 @@ SegmentChunk* ISegment::toChunk(SharedResources *res, size_t index, BaseRepresen
                 delete chunk;
                 return nullptr;
             }
-            res->getConnManager()->start(source);
+            res->getConnManager()->start(source, deadline);
             return chunk;
         }
         else
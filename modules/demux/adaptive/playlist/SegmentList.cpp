@@ -112,9 +112,20 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
     }
     else
     {
-        const Segment * prevSegment = segments.back();
+        Segment * prevSegment = segments.back();
         const uint64_t oldest = updated->segments.front()->getSequenceNumber();
 
+        /* last known one might have been listed while being produced,
+         * with an estimated duration */
+        for(const Segment *seg : updated->segments)
+        {
+            if(seg->getSequenceNumber() != prevSegment->getSequenceNumber())
+                continue;
+            totalLength += seg->duration.Get() - prevSegment->duration.Get();
+            prevSegment->duration.Set(seg->duration.Get());
+            break;
+        }
+
         /* filter out known segments from the update */
         updated->pruneBySegmentNumber(prevSegment->getSequenceNumber() + 1);
 
@@ -104,6 +104,8 @@ uint64_t SegmentTemplate::getLiveTemplateNumber(vlc_tick_t playbacktime, bool ab
             vlc_tick_t streamstart =
                     parentSegmentInformation->getPlaylist()->availabilityStartTime.Get();
             streamstart += parentSegmentInformation->getPeriodStart();
+            /* chunked segments are available before being complete */
+            streamstart -= inheritAvailabilityTimeOffset();
             playbacktime -= streamstart;
         }
         stime_t elapsed = timescale.ToScaled(playbacktime) - dur;
@@ -131,12 +131,18 @@ class DummyConnectionManager : public AbstractConnectionManager
             return d;
         }
         virtual void recycleSource(AbstractChunkSource *) override {}
-        virtual void start(AbstractChunkSource *) override {}
+        virtual void start(AbstractChunkSource *, vlc_tick_t deadline) override
+        {
+            deadlines.push_back(deadline);
+        }
         virtual void cancel(AbstractChunkSource *) override {}
 
         std::map<std::string, std::vector<uint8_t>> data;
+        static std::vector<vlc_tick_t> deadlines;
 };
 
+std::vector<vlc_tick_t> DummyConnectionManager::deadlines;
+
 using mapentry = std::pair<std::string, std::vector<uint8_t>>;
 
 class SegmentTrackerListener : public SegmentTrackerListenerInterface
@@ -731,6 +737,128 @@ static int SegmentTracker_check_HLSseeks(BaseAdaptationSet *adaptSet,
     return 0;
 }
 
+/****** check prefetching ******/
+static int SegmentTracker_check_prefetch(BaseAdaptationSet *adaptSet,
+                                         DummyLogic *logic,
+                                         SegmentTracker *tracker,
+                                         SegmentTrackerListener &events)
+{
+    const stime_t START = 1337;
+    Timescale timescale(100);
+    std::vector<vlc_tick_t> &deadlines = DummyConnectionManager::deadlines;
+
+    ChunkInterface *currentChunk = nullptr;
+    try
+    {
+        for(int r=0; r<2; r++)
+        {
+            DummyRepresentation *rep = new DummyRepresentation(adaptSet);
+            adaptSet->addRepresentation(rep);
+            rep->setID(ID(std::to_string(r)));
+
+            SegmentList *segmentList = nullptr;
+            try
+            {
+                segmentList = new SegmentList(rep);
+                segmentList->addAttribute(new TimescaleAttr(timescale));
+                for(int i=0; i<10; i++)
+                {
+                    Segment *seg = new Segment(rep);
+                    seg->setSequenceNumber(123 + i);
+                    seg->startTime.Set(START + 100 * i);
+                    seg->duration.Set(100);
+                    seg->setSourceUrl(r == 0 ? "sample/aac" : "sample/ac3");
+                    segmentList->addSegment(seg);
+                }
+            } catch (...) {
+                delete segmentList;
+                std::rethrow_exception(std::current_exception());
+            }
+            rep->addAttribute(segmentList);
+        }
+
+        /* no prefetching until buffering level is known */
+        deadlines.clear();
+        Expect(tracker->setStartPosition() == true);
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(deadlines.size() == 1);
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        /* next segments are started ahead, with their playback deadline */
+        deadlines.clear();
+        tracker->notifyBufferingLevel(0, VLC_TICK_FROM_SEC(30), 0, 0);
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(deadlines.size() == 3);
+        for(size_t i=0; i<deadlines.size(); i++)
+            Expect(deadlines[i] == timescale.ToTime(START + 100 * (1 + i)) + VLC_TICK_0);
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        /* prefetched chunk is returned, queue is refilled */
+        deadlines.clear();
+        events.reset();
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(events.segmentchanged.starttime == timescale.ToTime(START + 100 * 2) + VLC_TICK_0);
+        Expect(deadlines.size() == 1);
+        Expect(deadlines[0] == timescale.ToTime(START + 100 * 4) + VLC_TICK_0);
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        /* nothing more is started past max buffering */
+        deadlines.clear();
+        tracker->notifyBufferingLevel(0, VLC_TICK_FROM_SEC(30), VLC_TICK_FROM_SEC(29), 0);
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(deadlines.empty());
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        /* prefetched chunks are dropped on switch */
+        logic->repindex = 1;
+        deadlines.clear();
+        events.reset();
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(events.occured(TrackerEvent::Type::RepresentationSwitch) == true);
+        Expect(events.segmentchanged.starttime == timescale.ToTime(START + 100 * 4) + VLC_TICK_0);
+        Expect(currentChunk->getContentType() == "sample/ac3");
+        Expect(deadlines.size() == 2); /* switched, and one more within budget */
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        /* and on seek */
+        tracker->notifyBufferingLevel(0, VLC_TICK_FROM_SEC(30), 0, 0);
+        deadlines.clear();
+        events.reset();
+        Expect(tracker->setPositionByTime(VLC_TICK_0 + timescale.ToTime(START + 800), false, false) == true);
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(events.segmentchanged.starttime == timescale.ToTime(START + 100 * 8) + VLC_TICK_0);
+        /* only one left to prefetch */
+        Expect(deadlines.size() == 2);
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        /* end of playlist */
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(events.segmentchanged.starttime == timescale.ToTime(START + 100 * 9) + VLC_TICK_0);
+        delete currentChunk;
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk == nullptr);
+
+    } catch( ... ) {
+        delete currentChunk;
+        return 1;
+    }
+
+    return 0;
+}
+
 typedef decltype(SegmentTracker_check_formats) testfunc;
 
 static int Prepare_test(testfunc func)
@@ -786,5 +914,6 @@ int SegmentTracker_test()
         Prepare_test(SegmentTracker_check_seeks) ||
         Prepare_test(SegmentTracker_check_switches) ||
         Prepare_test(SegmentTracker_check_HLSseeks) ||
+        Prepare_test(SegmentTracker_check_prefetch) ||
         0;
 }
@@ -0,0 +1,223 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../http/SegmentCache.hpp"
+
+#include "../test.hpp"
+
+#include <vlc_block.h>
+#include <vlc_fs.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <utime.h>
+
+using namespace adaptive::http;
+
+static block_t * makeData(size_t size, uint8_t value)
+{
+    block_t *p_block = block_Alloc(size);
+    if(p_block)
+        memset(p_block->p_buffer, value, size);
+    return p_block;
+}
+
+static bool checkData(block_t *p_block, size_t size, uint8_t value)
+{
+    if(!p_block)
+        return false;
+    bool b_ok = p_block->i_buffer == size &&
+                p_block->p_buffer[0] == value &&
+                p_block->p_buffer[size - 1] == value;
+    block_Release(p_block);
+    return b_ok;
+}
+
+static std::vector<std::string> listDir(const std::string &path)
+{
+    std::vector<std::string> files;
+    DIR *dir = vlc_opendir(path.c_str());
+    if(!dir)
+        return files;
+    const char *psz_name;
+    while((psz_name = vlc_readdir(dir)))
+    {
+        if(strcmp(psz_name, ".") && strcmp(psz_name, ".."))
+            files.push_back(path + DIR_SEP + psz_name);
+    }
+    closedir(dir);
+    return files;
+}
+
+static void cleanDir(const std::string &path)
+{
+    for(const std::string &file : listDir(path))
+        vlc_unlink(file.c_str());
+    rmdir(path.c_str());
+}
+
+static bool fileContains(const std::string &file, const char *psz)
+{
+    std::string content;
+    FILE *fp = vlc_fopen(file.c_str(), "rb");
+    if(!fp)
+        return false;
+    char buf[4096];
+    size_t read;
+    while((read = fread(buf, 1, sizeof(buf), fp)))
+        content.append(buf, read);
+    fclose(fp);
+    return content.find(psz) != std::string::npos;
+}
+
+static int MemoryCache_test()
+{
+    const BytesRange whole;
+    const StorageID init = HTTPChunkSource::makeStorageID("http://a/init.mp4", whole);
+    const StorageID seg1 = HTTPChunkSource::makeStorageID("http://a/seg.mp4", BytesRange(0, 999));
+    const StorageID seg2 = HTTPChunkSource::makeStorageID("http://a/seg.mp4", BytesRange(1000, 1999));
+    std::string type;
+
+    try
+    {
+        SegmentCache cache(nullptr, 3000);
+        Expect(cache.get(init, ChunkType::Init, type) == nullptr);
+
+        /* keyed by url and range */
+        cache.put(init, ChunkType::Init, makeData(1000, 1), "video/mp4");
+        cache.put(seg1, ChunkType::Segment, makeData(1000, 2), "video/mp4");
+        Expect(cache.getUsage() == 2000);
+        Expect(cache.get(seg2, ChunkType::Segment, type) == nullptr);
+        Expect(checkData(cache.get(init, ChunkType::Init, type), 1000, 1));
+        Expect(type == "video/mp4");
+        Expect(checkData(cache.get(seg1, ChunkType::Segment, type), 1000, 2));
+
+        /* not for playlists or keys */
+        const StorageID playlist = HTTPChunkSource::makeStorageID("http://a/index.m3u8", whole);
+        cache.put(playlist, ChunkType::Playlist, makeData(100, 3), "");
+        Expect(cache.get(playlist, ChunkType::Playlist, type) == nullptr);
+        Expect(cache.getUsage() == 2000);
+
+        /* least recently used goes first */
+        Expect(checkData(cache.get(init, ChunkType::Init, type), 1000, 1));
+        cache.put(seg2, ChunkType::Segment, makeData(1500, 4), "video/mp4");
+        Expect(cache.getUsage() == 2500);
+        Expect(cache.get(seg1, ChunkType::Segment, type) == nullptr);
+        Expect(checkData(cache.get(init, ChunkType::Init, type), 1000, 1));
+        Expect(checkData(cache.get(seg2, ChunkType::Segment, type), 1500, 4));
+
+        /* larger than the whole cache */
+        cache.put(seg1, ChunkType::Segment, makeData(4000, 5), "video/mp4");
+        Expect(cache.get(seg1, ChunkType::Segment, type) == nullptr);
+        Expect(cache.getUsage() == 2500);
+    }
+    catch(...)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+static int DiskCache_test()
+{
+    char tmpl[] = "/tmp/adaptive-cache-XXXXXX";
+    if(!mkdtemp(tmpl))
+        return 0; /* can't test */
+    const std::string path(tmpl);
+
+    const BytesRange whole;
+    const StorageID init1 = HTTPChunkSource::makeStorageID("http://a/init1.mp4", whole);
+    const StorageID init2 = HTTPChunkSource::makeStorageID("http://a/init2.mp4", whole);
+    const StorageID seg = HTTPChunkSource::makeStorageID("http://a/seg.mp4", whole);
+    const StorageID signed1 = HTTPChunkSource::makeStorageID("http://a/init.mp4?token=secret1", whole);
+    const StorageID signed2 = HTTPChunkSource::makeStorageID("http://a/init.mp4?token=secret2", whole);
+    std::string type;
+
+    try
+    {
+        {
+            SegmentCache cache(nullptr, 1 << 20, path, 4000);
+            cache.put(init1, ChunkType::Init, makeData(1000, 1), "video/mp4");
+            cache.put(seg, ChunkType::Segment, makeData(1000, 2), "video/mp4");
+        }
+
+        /* init segments survive restarts, media segments don't */
+        {
+            SegmentCache cache(nullptr, 1 << 20, path, 4000);
+            Expect(checkData(cache.get(init1, ChunkType::Init, type), 1000, 1));
+            Expect(type == "video/mp4");
+            Expect(cache.getUsage() == 1000);
+            Expect(cache.get(seg, ChunkType::Segment, type) == nullptr);
+            Expect(cache.get(init2, ChunkType::Init, type) == nullptr);
+
+            /* oldest files are removed above the disk limit */
+            cache.put(init2, ChunkType::Init, makeData(3000, 3), "audio/mp4");
+        }
+
+        {
+            SegmentCache cache(nullptr, 0, path, 4000);
+            Expect(cache.get(init1, ChunkType::Init, type) == nullptr);
+            Expect(checkData(cache.get(init2, ChunkType::Init, type), 3000, 3));
+            Expect(type == "audio/mp4");
+            Expect(cache.getUsage() == 0);
+
+            /* urls, and their credentials, are never written out */
+            cache.put(signed1, ChunkType::Init, makeData(100, 4), "video/mp4");
+            Expect(checkData(cache.get(signed1, ChunkType::Init, type), 100, 4));
+            Expect(cache.get(signed2, ChunkType::Init, type) == nullptr);
+            for(const std::string &file : listDir(path))
+                Expect(!fileContains(file, "http") && !fileContains(file, "secret"));
+        }
+
+        /* entries expire */
+        const time_t old = time(nullptr) - SegmentCache::DISK_TTL;
+        const struct utimbuf times = { old, old };
+        for(const std::string &file : listDir(path))
+            Expect(utime(file.c_str(), &times) == 0);
+        {
+            SegmentCache cache(nullptr, 0, path, 4000);
+            Expect(cache.get(init2, ChunkType::Init, type) == nullptr);
+            Expect(cache.get(signed1, ChunkType::Init, type) == nullptr);
+            Expect(listDir(path).empty());
+        }
+    }
+    catch(...)
+    {
+        cleanDir(path);
+        return 1;
+    }
+
+    cleanDir(path);
+    return 0;
+}
+
+int SegmentCache_test()
+{
+    return MemoryCache_test() || DiskCache_test();
+}
@@ -0,0 +1,324 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../playlist/BasePlaylist.hpp"
+#include "../../playlist/BasePeriod.h"
+#include "../../playlist/BaseAdaptationSet.h"
+#include "../../playlist/BaseRepresentation.h"
+#include "../../logic/AbstractAdaptationLogic.h"
+#include "../../logic/PredictiveAdaptationLogic.hpp"
+#include "../../logic/NearOptimalAdaptationLogic.hpp"
+#include "../../logic/RateBasedAdaptationLogic.h"
+#include "../../SegmentTracker.hpp"
+
+#include "../test.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::playlist;
+using namespace adaptive::logic;
+
+/*
+ * Offline replay of network traces against the adaptation logics.
+ *
+ * Segments are downloaded one after the other at the rate the trace
+ * gives, while playback drains the buffer. Set ADAPTIVE_TRACE to a file
+ * of "<duration ms> <kbit/s>" lines to replay a recorded trace and print
+ * the results of each logic.
+ */
+
+#define SEGMENT_DURATION VLC_TICK_FROM_SEC(4)
+#define RTT              VLC_TICK_FROM_MS(80)
+#define MIN_BUFFERING    VLC_TICK_FROM_SEC(6)
+#define MAX_BUFFERING    VLC_TICK_FROM_SEC(30)
+
+namespace
+{
+    class Trace
+    {
+        public:
+            Trace() : length(0) {}
+
+            /* constant rate periods, looped over */
+            void add(vlc_tick_t duration, unsigned bps)
+            {
+                periods.push_back({duration, bps});
+                length += duration;
+            }
+
+            bool load(const char *path)
+            {
+                FILE *fp = fopen(path, "r");
+                if(!fp)
+                    return false;
+                unsigned ms, kbps;
+                while(fscanf(fp, "%u %u", &ms, &kbps) == 2)
+                    add(VLC_TICK_FROM_MS(ms), kbps * 1000);
+                fclose(fp);
+                return length > 0;
+            }
+
+            /* time to transfer size bytes, starting at time */
+            vlc_tick_t transfer(vlc_tick_t start, size_t size) const
+            {
+                double bits = size * 8.0;
+                vlc_tick_t now = start;
+                size_t index = 0;
+                vlc_tick_t offset = start % length;
+                while(offset >= periods[index].duration)
+                    offset -= periods[index++].duration;
+                for(unsigned loops = 0; bits > 0; )
+                {
+                    const Period &p = periods[index];
+                    const vlc_tick_t remain = p.duration - offset;
+                    const double avail = (double) p.bps * remain / CLOCK_FREQ;
+                    if(avail >= bits)
+                        return now + (vlc_tick_t)(bits * CLOCK_FREQ / p.bps) - start;
+                    bits -= avail;
+                    now += remain;
+                    offset = 0;
+                    if(++index == periods.size())
+                    {
+                        index = 0;
+                        if(++loops > 1000) /* outage only */
+                            break;
+                    }
+                }
+                return now - start;
+            }
+
+        private:
+            class Period
+            {
+                public:
+                    vlc_tick_t duration;
+                    unsigned bps;
+            };
+            std::vector<Period> periods;
+            vlc_tick_t length;
+    };
+
+    class ReplayResult
+    {
+        public:
+            unsigned segments = 0;
+            uint64_t bitrates = 0;
+            unsigned switches = 0;
+            unsigned stalls = 0;
+            vlc_tick_t stalled = 0;
+            uint64_t lastbps = 0;
+
+            uint64_t averageBitrate() const
+            {
+                return segments ? bitrates / segments : 0;
+            }
+    };
+
+    class ReplayPlaylist
+    {
+        public:
+            ReplayPlaylist()
+            {
+                playlist = new BasePlaylist(nullptr);
+                BasePeriod *period = new BasePeriod(playlist);
+                set = new BaseAdaptationSet(period);
+                set->setID(ID("video"));
+                const unsigned bandwidths[] = { 250000, 500000, 1000000,
+                                                2000000, 4000000, 8000000 };
+                for(unsigned bw : bandwidths)
+                {
+                    BaseRepresentation *rep = new BaseRepresentation(set);
+                    rep->setID(ID(std::to_string(bw)));
+                    rep->setBandwidth(bw);
+                    set->addRepresentation(rep);
+                }
+                period->addAdaptationSet(set);
+                playlist->addPeriod(period);
+            }
+
+            ~ReplayPlaylist()
+            {
+                delete playlist;
+            }
+
+            BasePlaylist *playlist;
+            BaseAdaptationSet *set;
+    };
+}
+
+static ReplayResult Replay(AbstractAdaptationLogic *logic, const Trace &trace,
+                           unsigned count)
+{
+    ReplayPlaylist p;
+    const ID &id = p.set->getID();
+    ReplayResult result;
+
+    logic->trackerEvent(BufferingStateUpdatedEvent(id, true));
+
+    BaseRepresentation *rep = nullptr;
+    vlc_tick_t now = 0;
+    vlc_tick_t level = 0;
+    bool playing = false;
+    for(unsigned i=0; i<count; i++)
+    {
+        BaseRepresentation *next = logic->getNextRepresentation(p.set, rep);
+        if(next != rep)
+        {
+            logic->trackerEvent(RepresentationSwitchEvent(rep, next));
+            if(rep)
+                result.switches++;
+            rep = next;
+        }
+        logic->trackerEvent(SegmentChangedEvent(id, i, SEGMENT_DURATION * i,
+                                                SEGMENT_DURATION));
+
+        const size_t size = rep->getBandwidth() * SEGMENT_DURATION / CLOCK_FREQ / 8;
+        const vlc_tick_t time = trace.transfer(now + RTT, size);
+        const vlc_tick_t elapsed = RTT + time;
+        logic->updateDownloadRate(id, size, time, RTT);
+
+        if(playing)
+        {
+            if(elapsed > level)
+            {
+                result.stalls++;
+                result.stalled += elapsed - level;
+                level = 0;
+            }
+            else level -= elapsed;
+        }
+        now += elapsed;
+        level += SEGMENT_DURATION;
+        if(level >= MIN_BUFFERING)
+            playing = true;
+        if(level > MAX_BUFFERING) /* wait for room */
+        {
+            now += level - MAX_BUFFERING;
+            level = MAX_BUFFERING;
+        }
+        logic->trackerEvent(BufferingLevelChangedEvent(id, MIN_BUFFERING, MAX_BUFFERING,
+                                                       level, MAX_BUFFERING));
+
+        result.segments++;
+        result.bitrates += rep->getBandwidth();
+        result.lastbps = rep->getBandwidth();
+    }
+
+    logic->trackerEvent(RepresentationSwitchEvent(rep, nullptr));
+    logic->trackerEvent(BufferingStateUpdatedEvent(id, false));
+
+    return result;
+}
+
+static void Report(const char *name, const ReplayResult &r)
+{
+    std::cerr << name << ": avg " << r.averageBitrate() / 1000 << "kbps last "
+              << r.lastbps / 1000 << "kbps switches " << r.switches << " stalls "
+              << r.stalls << " (" << MS_FROM_VLC_TICK(r.stalled) << "ms)" << std::endl;
+}
+
+static int ReplayFile(const char *path)
+{
+    Trace trace;
+    if(!trace.load(path))
+    {
+        std::cerr << "can't load trace " << path << std::endl;
+        return 1;
+    }
+    std::unique_ptr<AbstractAdaptationLogic> logic;
+    logic = std::make_unique<PredictiveAdaptationLogic>(nullptr);
+    Report("predictive", Replay(logic.get(), trace, 150));
+    logic = std::make_unique<NearOptimalAdaptationLogic>(nullptr);
+    Report("nearoptimal", Replay(logic.get(), trace, 150));
+    logic = std::make_unique<RateBasedAdaptationLogic>(nullptr);
+    Report("rate", Replay(logic.get(), trace, 150));
+    return 0;
+}
+
+int TraceReplay_test()
+{
+    const char *path = getenv("ADAPTIVE_TRACE");
+    if(path)
+        return ReplayFile(path);
+
+    try
+    {
+        /* steady link, well above the highest quality */
+        Trace steady;
+        steady.add(VLC_TICK_FROM_SEC(1), 20000000);
+
+        /* link dropping to a third of the highest quality */
+        Trace drop;
+        drop.add(VLC_TICK_FROM_SEC(120), 20000000);
+        drop.add(VLC_TICK_FROM_SEC(3600), 2700000);
+
+        /* fast and slow phases, as on mobile */
+        Trace bursty;
+        bursty.add(VLC_TICK_FROM_SEC(20), 12000000);
+        bursty.add(VLC_TICK_FROM_SEC(20), 1500000);
+
+        std::unique_ptr<AbstractAdaptationLogic> logic;
+        ReplayResult r;
+
+        logic = std::make_unique<PredictiveAdaptationLogic>(nullptr);
+        r = Replay(logic.get(), steady, 60);
+        Expect(r.stalls == 0);
+        Expect(r.lastbps == 8000000);
+
+        logic = std::make_unique<PredictiveAdaptationLogic>(nullptr);
+        r = Replay(logic.get(), drop, 100);
+        Expect(r.lastbps <= 2000000);
+        Expect(r.stalled < VLC_TICK_FROM_SEC(8));
+
+        logic = std::make_unique<PredictiveAdaptationLogic>(nullptr);
+        r = Replay(logic.get(), bursty, 100);
+        Expect(r.stalled < VLC_TICK_FROM_SEC(8));
+        Expect(r.averageBitrate() > 2000000);
+
+        logic = std::make_unique<NearOptimalAdaptationLogic>(nullptr);
+        r = Replay(logic.get(), steady, 60);
+        Expect(r.stalls == 0);
+        Expect(r.lastbps == 8000000);
+
+        logic = std::make_unique<NearOptimalAdaptationLogic>(nullptr);
+        r = Replay(logic.get(), drop, 100);
+        Expect(r.lastbps <= 2000000);
+        Expect(r.stalled < VLC_TICK_FROM_SEC(8));
+        Expect(r.switches < 10);
+
+        logic = std::make_unique<NearOptimalAdaptationLogic>(nullptr);
+        r = Replay(logic.get(), bursty, 100);
+        Expect(r.stalled < VLC_TICK_FROM_SEC(8));
+        Expect(r.averageBitrate() > 2000000);
+    }
+    catch(...)
+    {
+        return 1;
+    }
+
+    return 0;
+}
@@ -417,6 +417,118 @@ int M3U8Playlist_test()
         return 1;
     }
 
+    /* Manifest 6: low latency, byterange parts */
+    const char manifest6[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=3.0,HOLD-BACK=12.0\n"
+    "#EXT-X-PART-INF:PART-TARGET=1.0\n"
+    "#EXT-X-MEDIA-SEQUENCE:10\n"
+    "#EXTINF:4\n"
+    "seg10.mp4\n"
+    "#EXT-X-PART:DURATION=1.0,URI=\"seg11.mp4\",BYTERANGE=\"1000@0\"\n"
+    "#EXT-X-PART:DURATION=1.0,URI=\"seg11.mp4\",BYTERANGE=\"1000@1000\"\n"
+    "#EXTINF:2\n"
+    "seg11.mp4\n"
+    "#EXT-X-PART:DURATION=1.0,URI=\"seg12.mp4\",BYTERANGE=\"1000@0\"\n"
+    "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"seg12.mp4\",BYTERANGE-START=1000\n";
+
+    m3u = ParseM3U8(obj, manifest6, sizeof(manifest6));
+    try
+    {
+        Expect(m3u);
+        Expect(m3u->isLive() == true);
+        Expect(m3u->isLowLatency() == true);
+        Expect(m3u->suggestedPresentationDelay.Get() == VLC_TICK_FROM_SEC(12));
+        HLSRepresentation *rep = dynamic_cast<HLSRepresentation *>(m3u->getFirstPeriod()->
+                                 getAdaptationSets().front()->getRepresentations().front());
+        Expect(rep);
+        const SegmentList *segmentList = rep->inheritSegmentList();
+        Expect(segmentList->getSegments().size() == 3);
+        /* segment being produced is requested as a whole */
+        const Segment *seg = segmentList->getSegments().back();
+        Expect(seg->getSequenceNumber() == 12);
+        Expect(seg->getUrlSegment().toString() == "stdin:///seg12.mp4");
+        Expect(seg->startTime.Get() == rep->inheritTimescale().ToScaled(VLC_TICK_FROM_SEC(6)));
+        Expect(seg->duration.Get() == rep->inheritTimescale().ToScaled(VLC_TICK_FROM_SEC(4)));
+        Expect(rep->getUpdatePlaylistUrl().toString() ==
+               "stdin://?_HLS_msn=12&_HLS_part=1");
+
+        delete m3u;
+    }
+    catch (...)
+    {
+        delete m3u;
+        return 1;
+    }
+
+    /* Manifests 7: the preload hint only becomes a segment when it follows
+     * the byterange parts in the same file */
+    const struct
+    {
+        const char *parts;
+        size_t segments;
+        const char *update;
+    } hints[] = {
+        /* parts as separate files */
+        { "#EXT-X-PART:DURATION=1.0,URI=\"seg11.0.mp4\"\n"
+          "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"seg11.1.mp4\"\n",
+          1, "stdin://?_HLS_msn=11&_HLS_part=1" },
+        { "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"seg11.0.mp4\"\n",
+          1, "stdin://?_HLS_msn=11&_HLS_part=0" },
+        /* first part at the start of the segment */
+        { "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"seg11.mp4\",BYTERANGE-START=0\n",
+          2, "stdin://?_HLS_msn=11&_HLS_part=0" },
+        /* not following the last part */
+        { "#EXT-X-PART:DURATION=1.0,URI=\"seg11.mp4\",BYTERANGE=\"1000@0\"\n"
+          "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"seg11.mp4\",BYTERANGE-START=2000\n",
+          1, "stdin://?_HLS_msn=11&_HLS_part=1" },
+        /* another file */
+        { "#EXT-X-PART:DURATION=1.0,URI=\"seg11.mp4\",BYTERANGE=\"1000\"\n"
+          "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"seg12.mp4\",BYTERANGE-START=1000\n",
+          1, "stdin://?_HLS_msn=11&_HLS_part=1" },
+        /* parts following each other without offsets */
+        { "#EXT-X-PART:DURATION=1.0,URI=\"seg11.mp4\",BYTERANGE=\"1000\"\n"
+          "#EXT-X-PART:DURATION=1.0,URI=\"seg11.mp4\",BYTERANGE=\"500\"\n"
+          "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"seg11.mp4\",BYTERANGE-START=1500\n",
+          2, "stdin://?_HLS_msn=11&_HLS_part=2" },
+    };
+
+    for(const auto &hint : hints)
+    {
+        const std::string manifest7 = std::string(
+        "#EXTM3U\n"
+        "#EXT-X-TARGETDURATION:4\n"
+        "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=3.0\n"
+        "#EXT-X-PART-INF:PART-TARGET=1.0\n"
+        "#EXT-X-MEDIA-SEQUENCE:10\n"
+        "#EXTINF:4\n"
+        "seg10.mp4\n") + hint.parts;
+
+        m3u = ParseM3U8(obj, manifest7.c_str(), manifest7.length());
+        try
+        {
+            Expect(m3u);
+            HLSRepresentation *rep = dynamic_cast<HLSRepresentation *>(m3u->getFirstPeriod()->
+                                     getAdaptationSets().front()->getRepresentations().front());
+            Expect(rep);
+            const SegmentList *segmentList = rep->inheritSegmentList();
+            Expect(segmentList->getSegments().size() == hint.segments);
+            Expect(segmentList->getSegments().back()->getSequenceNumber() == 9 + hint.segments);
+            if(hint.segments == 2)
+                Expect(segmentList->getSegments().back()->getUrlSegment().toString() ==
+                       "stdin:///seg11.mp4");
+            Expect(rep->getUpdatePlaylistUrl().toString() == hint.update);
+
+            delete m3u;
+        }
+        catch (...)
+        {
+            delete m3u;
+            return 1;
+        }
+    }
+
 
     return 0;
 }
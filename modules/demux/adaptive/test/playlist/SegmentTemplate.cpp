@@ -96,6 +96,22 @@ int SegmentTemplate_test()
         Expect(templ->getLiveTemplateNumber(now + timescale.ToTime(100) * 2 + 1, true) ==
                templ->getStartSegmentNumber() + 1);
 
+        /* availabilityTimeOffset: chunked segments are available that much
+         * before their end */
+        rep->addAttribute(new AvailabilityTimeOffsetAttr(timescale.ToTime(50)));
+        Expect(templ->getLiveTemplateNumber(now + timescale.ToTime(100 * 2 - 50) - 1, true) ==
+               templ->getStartSegmentNumber());
+        Expect(templ->getLiveTemplateNumber(now + timescale.ToTime(100 * 2 - 50), true) ==
+               templ->getStartSegmentNumber() + 1);
+        Expect(templ->getLiveTemplateNumber(now + timescale.ToTime(100 * 6 - 50), true) ==
+               templ->getStartSegmentNumber() + 5);
+        /* positions relative to the stream start are not moved */
+        Expect(templ->getLiveTemplateNumber(timescale.ToTime(100 * 2) - 1, false) ==
+               templ->getStartSegmentNumber());
+        rep->replaceAttribute(new AvailabilityTimeOffsetAttr(0));
+        Expect(templ->getLiveTemplateNumber(now + timescale.ToTime(100 * 2 - 50), true) ==
+               templ->getStartSegmentNumber());
+
         /* reset */
         pl->availabilityStartTime.Set(0);
         pl->availabilityEndTime.Set(0);
@@ -46,6 +46,9 @@ int main()
     TEST(Conversions) ||
     TEST(TemplatedUri) ||
     TEST(BufferingLogic) ||
+    TEST(ThroughputEstimator) ||
+    TEST(TraceReplay) ||
+    TEST(SegmentCache) ||
     TEST(CommandsQueue) ||
     TEST(M3U8MasterPlaylist) ||
     TEST(M3U8Playlist) ||
@@ -49,5 +49,8 @@ int CommandsQueue_test();
 int BufferingLogic_test();
 int FakeEsOut_test();
 int SegmentTracker_test();
+int ThroughputEstimator_test();
+int TraceReplay_test();
+int SegmentCache_test();
 
 #endif
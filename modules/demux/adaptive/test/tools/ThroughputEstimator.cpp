@@ -0,0 +1,85 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../tools/ThroughputEstimator.hpp"
+
+#include "../test.hpp"
+
+using namespace adaptive;
+
+int ThroughputEstimator_test()
+{
+    try
+    {
+        ThroughputEstimator estimator;
+        Expect(estimator.get() == 0);
+        Expect(estimator.getDownloadTime(1000) == VLC_TICK_INVALID);
+        Expect(!estimator.push(0, VLC_TICK_FROM_SEC(1), 0));
+        Expect(!estimator.push(1000, 0, 0));
+
+        /* 1MB segments at 8Mbps */
+        for(int i=0; i<5; i++)
+            Expect(estimator.push(1000000, VLC_TICK_FROM_SEC(1), VLC_TICK_FROM_MS(50)));
+        Expect(estimator.get() == 8000000);
+        Expect(estimator.getLatency() == VLC_TICK_FROM_MS(50));
+        Expect(estimator.getDownloadTime(1000000) == VLC_TICK_FROM_MS(1050));
+
+        /* small transfers, stuck in slow start, barely weight */
+        for(int i=0; i<5; i++)
+            Expect(estimator.push(10000, VLC_TICK_FROM_MS(100), VLC_TICK_FROM_MS(50)));
+        Expect(estimator.getAverage() > 7500000);
+        Expect(estimator.getPercentile(50) == 8000000);
+        Expect(estimator.getPercentile(0) == 800000);
+
+        /* served from a cache, ignored */
+        Expect(!estimator.push(1000000, VLC_TICK_FROM_MS(10), VLC_TICK_FROM_MS(1)));
+        Expect(estimator.getCachedCount() == 1);
+        Expect(estimator.getAverage() > 7500000 && estimator.getAverage() < 8000000);
+
+        /* until it persists */
+        Expect(!estimator.push(1000000, VLC_TICK_FROM_MS(10), VLC_TICK_FROM_MS(1)));
+        Expect(!estimator.push(1000000, VLC_TICK_FROM_MS(10), VLC_TICK_FROM_MS(1)));
+        Expect(estimator.push(1000000, VLC_TICK_FROM_MS(10), VLC_TICK_FROM_MS(1)));
+        Expect(estimator.getCachedCount() == 3);
+        /* and the estimate starts over from the new link */
+        Expect(estimator.get() == 800000000);
+        Expect(estimator.getLatency() == VLC_TICK_FROM_MS(1));
+        Expect(estimator.push(1000000, VLC_TICK_FROM_MS(10), VLC_TICK_FROM_MS(1)));
+        Expect(estimator.getCachedCount() == 3);
+        Expect(estimator.get() == 800000000);
+
+        /* conservative: lowest of average and median */
+        estimator.reset();
+        Expect(estimator.get() == 0);
+        Expect(estimator.push(1000000, VLC_TICK_FROM_SEC(1), VLC_TICK_FROM_MS(50)));
+        Expect(estimator.push(1000000, VLC_TICK_FROM_SEC(4), VLC_TICK_FROM_MS(50)));
+        Expect(estimator.get() == 2000000);
+        Expect(estimator.getAverage() > 2000000);
+    }
+    catch(...)
+    {
+        return 1;
+    }
+
+    return 0;
+}
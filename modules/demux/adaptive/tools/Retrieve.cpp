@@ -46,16 +46,23 @@ block_t * Retrieve::HTTP(SharedResources *resources, ChunkType type,
         return nullptr;
     }
 
+    block_t *p_data = ReadAll(datachunk);
+    delete datachunk;
+
+    return p_data;
+}
+
+block_t * Retrieve::ReadAll(ChunkInterface *chunk)
+{
     block_t *p_head = nullptr;
     block_t **pp_tail = &p_head;
     for(;;)
     {
-        block_t *p_block = datachunk->readBlock();
+        block_t *p_block = chunk->readBlock();
         if(!p_block)
             break;
         block_ChainLastAppend(&pp_tail, p_block);
     }
-    delete datachunk;
 
     return p_head ? block_ChainGather(p_head) : nullptr;
 }
@@ -29,12 +29,14 @@ namespace adaptive
     namespace http
     {
         enum class ChunkType;
+        class ChunkInterface;
     };
 
     class Retrieve
     {
         public:
             static block_t * HTTP(SharedResources *, http::ChunkType, const std::string &uri);
+            static block_t * ReadAll(http::ChunkInterface *);
     };
 }
 
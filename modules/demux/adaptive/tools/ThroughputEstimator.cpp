@@ -0,0 +1,166 @@
+/*
+ * ThroughputEstimator.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "ThroughputEstimator.hpp"
+
+#include <algorithm>
+#include <vector>
+#include <climits>
+#include <cmath>
+
+using namespace adaptive;
+
+const size_t ThroughputEstimator::DEFAULT_HALF_LIFE = 512 * 1024;
+const unsigned ThroughputEstimator::DEFAULT_WINDOW = 20;
+
+/* latency smoothing, per sample */
+#define LATENCY_ALPHA 0.25
+/* served from a cache: way faster to respond and transfer than usual */
+#define CACHED_LATENCY_RATIO 4
+#define CACHED_RATE_RATIO 4
+#define CACHED_MIN_SAMPLES 3
+/* unless it persists, then the link did change */
+#define CACHED_MAX_RUN 3
+
+ThroughputEstimator::ThroughputEstimator(size_t halflife_, unsigned window_)
+{
+    halflife = halflife_ ? halflife_ : DEFAULT_HALF_LIFE;
+    window = window_ ? window_ : DEFAULT_WINDOW;
+    reset();
+}
+
+void ThroughputEstimator::reset()
+{
+    samples.clear();
+    ewma = 0.0;
+    ewmasize = 0;
+    latency = 0;
+    cached = 0;
+    cachedrun = 0;
+}
+
+bool ThroughputEstimator::isCached(unsigned bps, vlc_tick_t ttfb) const
+{
+    if(samples.size() < CACHED_MIN_SAMPLES || !latency || ttfb <= 0 ||
+       cachedrun >= CACHED_MAX_RUN)
+        return false;
+    return ttfb * CACHED_LATENCY_RATIO < latency &&
+           bps > (uint64_t) get() * CACHED_RATE_RATIO;
+}
+
+bool ThroughputEstimator::push(size_t size, vlc_tick_t time, vlc_tick_t ttfb)
+{
+    if(size == 0 || time <= 0)
+        return false;
+
+    const uint64_t bps64 = CLOCK_FREQ * size * 8 / time;
+    const unsigned bps = std::min(bps64, (uint64_t) UINT_MAX);
+
+    if(isCached(bps, ttfb))
+    {
+        cached++;
+        cachedrun++;
+        return false;
+    }
+    if(cachedrun >= CACHED_MAX_RUN)
+    {
+        /* the link did change, the history would only slow down catching up */
+        samples.clear();
+        ewma = 0.0;
+        ewmasize = 0;
+        latency = 0;
+    }
+    cachedrun = 0;
+
+    if(ttfb > 0)
+        latency = latency ? (vlc_tick_t)(LATENCY_ALPHA * ttfb + (1.0 - LATENCY_ALPHA) * latency)
+                          : ttfb;
+
+    /* The weight of a sample depends on its size: a transfer of
+     * halflife bytes counts for half of the average */
+    const double alpha = 1.0 - std::pow(0.5, (double) size / halflife);
+    ewma = alpha * bps + (1.0 - alpha) * ewma;
+    ewmasize += size;
+
+    if(samples.size() >= window)
+        samples.pop_front();
+    samples.push_back({bps, size});
+
+    return true;
+}
+
+unsigned ThroughputEstimator::getAverage() const
+{
+    if(!ewmasize)
+        return 0;
+    /* zero initialized average is biased for the first samples */
+    const double correction = 1.0 - std::pow(0.5, (double) ewmasize / halflife);
+    return ewma / correction;
+}
+
+unsigned ThroughputEstimator::getPercentile(unsigned percent) const
+{
+    if(samples.empty())
+        return 0;
+
+    std::vector<Sample> sorted(samples.begin(), samples.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Sample &a, const Sample &b) { return a.bps < b.bps; });
+
+    size_t total = 0;
+    for(const Sample &s : sorted)
+        total += s.size;
+
+    const double wanted = (double) total * std::min(percent, 100U) / 100;
+    size_t cumulated = 0;
+    for(const Sample &s : sorted)
+    {
+        cumulated += s.size;
+        if(cumulated >= wanted)
+            return s.bps;
+    }
+    return sorted.back().bps;
+}
+
+unsigned ThroughputEstimator::get() const
+{
+    return std::min(getAverage(), getPercentile(50));
+}
+
+vlc_tick_t ThroughputEstimator::getLatency() const
+{
+    return latency;
+}
+
+vlc_tick_t ThroughputEstimator::getDownloadTime(size_t size) const
+{
+    const unsigned bps = get();
+    if(!bps)
+        return VLC_TICK_INVALID;
+    return latency + vlc_tick_from_samples(size * 8, bps);
+}
+
+unsigned ThroughputEstimator::getCachedCount() const
+{
+    return cached;
+}
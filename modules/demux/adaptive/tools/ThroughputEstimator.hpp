@@ -0,0 +1,73 @@
+/*
+ * ThroughputEstimator.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef THROUGHPUTESTIMATOR_HPP
+#define THROUGHPUTESTIMATOR_HPP
+
+#include <vlc_common.h>
+#include <list>
+
+namespace adaptive
+{
+    /* Estimates link throughput from transfer samples, excluding the
+     * time to first byte which is tracked separately.
+     * Samples are weighted by their size, so that small transfers, which
+     * never leave TCP slow start, can't drag down the estimate.
+     * The estimate is the lowest of a size weighted EWMA and of the size
+     * weighted median over a sliding window. */
+    class ThroughputEstimator
+    {
+        public:
+            ThroughputEstimator(size_t = DEFAULT_HALF_LIFE,
+                                unsigned = DEFAULT_WINDOW);
+            /* size, transfer time, latency (time to first byte)
+             * returns false if the sample was rejected */
+            bool push(size_t, vlc_tick_t, vlc_tick_t);
+            unsigned get() const;
+            vlc_tick_t getLatency() const;
+            vlc_tick_t getDownloadTime(size_t) const;
+            unsigned getPercentile(unsigned) const;
+            unsigned getAverage() const;
+            unsigned getCachedCount() const;
+            void reset();
+
+            static const size_t DEFAULT_HALF_LIFE;
+            static const unsigned DEFAULT_WINDOW;
+
+        private:
+            bool isCached(unsigned, vlc_tick_t) const;
+
+            class Sample
+            {
+                public:
+                    unsigned bps;
+                    size_t size;
+            };
+            std::list<Sample> samples;
+            size_t halflife;
+            unsigned window;
+            double ewma;
+            size_t ewmasize;
+            vlc_tick_t latency;
+            unsigned cached;
+            unsigned cachedrun;
+    };
+}
+
+#endif // THROUGHPUTESTIMATOR_HPP
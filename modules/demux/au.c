@@ -50,6 +50,7 @@ vlc_module_begin ()
     set_callback( Open )
     add_shortcut( "au" )
     add_file_extension("au")
+    set_probe_magic( "2E736E64" )
 vlc_module_end ()
 
 /*****************************************************************************
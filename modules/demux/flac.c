@@ -54,6 +54,8 @@ vlc_module_begin ()
     set_callbacks( Open, Close )
     add_shortcut( "flac" )
     add_file_extension("flac")
+    set_probe_mime( "audio/flac" )
+    set_probe_magic( "664C6143" )
 vlc_module_end ()
 
 /*****************************************************************************
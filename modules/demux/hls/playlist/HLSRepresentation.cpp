@@ -30,13 +30,18 @@
 #include "../../adaptive/playlist/BasePeriod.h"
 #include "../../adaptive/playlist/BaseAdaptationSet.h"
 #include "../../adaptive/playlist/SegmentList.h"
+#include "../../adaptive/http/Chunk.h"
+#include "../../adaptive/tools/Retrieve.hpp"
+#include "../../adaptive/SharedResources.hpp"
 
 #include <ctime>
 #include <limits>
 #include <cassert>
+#include <sstream>
 
 using namespace hls;
 using namespace hls::playlist;
+using namespace adaptive::http;
 
 HLSRepresentation::HLSRepresentation  ( BaseAdaptationSet *set ) :
                 BaseRepresentation( set )
@@ -46,11 +51,18 @@ HLSRepresentation::HLSRepresentation  ( BaseAdaptationSet *set ) :
     updateFailureCount = 0;
     lastUpdateTime = 0;
     targetDuration = 0;
+    canBlockReload = false;
+    partTarget = 0;
+    nextMediaSequence = 0;
+    nextPart = 0;
+    pendingReload = nullptr;
+    resources = nullptr;
     streamFormat = StreamFormat::Type::Unknown;
 }
 
 HLSRepresentation::~HLSRepresentation ()
 {
+    delete pendingReload;
 }
 
 StreamFormat HLSRepresentation::getStreamFormat() const
@@ -88,6 +100,21 @@ Url HLSRepresentation::getPlaylistUrl() const
     }
 }
 
+Url HLSRepresentation::getUpdatePlaylistUrl() const
+{
+    const Url url = getPlaylistUrl();
+    if(!b_loaded || !canBlockReload || !partTarget || updateFailureCount)
+        return url;
+
+    /* Blocking reload: server replies once the next part is published */
+    const std::string urlstr = url.toString();
+    std::stringstream ss;
+    ss.imbue(std::locale("C"));
+    ss << urlstr << ((urlstr.find('?') == std::string::npos) ? '?' : '&')
+       << "_HLS_msn=" << nextMediaSequence << "&_HLS_part=" << nextPart;
+    return Url(ss.str());
+}
+
 void HLSRepresentation::debug(vlc_object_t *obj, int indent) const
 {
     BaseRepresentation::debug(obj, indent);
@@ -122,6 +149,29 @@ void HLSRepresentation::scheduleNextUpdate(uint64_t, bool b_updated)
     lastUpdateTime = now;
 
     debug(playlist->getVLCObject(), 0);
+
+    if(canRequestBlockingReload())
+        requestBlockingReload();
+}
+
+bool HLSRepresentation::canRequestBlockingReload() const
+{
+    return b_loaded && isLive() && canBlockReload && partTarget &&
+           !updateFailureCount && !pendingReload && resources;
+}
+
+void HLSRepresentation::requestBlockingReload()
+{
+    /* The server holds the reply until the next part is published: wait
+     * for it on the download queue, not on the buffering thread */
+    try
+    {
+        pendingReload = new HTTPChunk(getUpdatePlaylistUrl().toString(),
+                                      resources->getConnManager(), ID(),
+                                      ChunkType::Playlist, BytesRange());
+    } catch (...) {
+        pendingReload = nullptr;
+    }
 }
 
 bool HLSRepresentation::needsUpdate(uint64_t number) const
@@ -132,6 +182,10 @@ bool HLSRepresentation::needsUpdate(uint64_t number) const
         return true;
     if(isLive())
     {
+        /* merge the blocking reload once the server replied */
+        if(pendingReload)
+            return pendingReload->isDownloaded();
+
         const vlc_tick_t now = vlc_tick_now();
         const vlc_tick_t elapsed = now - lastUpdateTime;
         vlc_tick_t duration = targetDuration
@@ -155,7 +209,23 @@ bool HLSRepresentation::runLocalUpdates(SharedResources *res)
 {
     BasePlaylist *playlist = getPlaylist();
     M3U8Parser parser(res);
-    if(!parser.appendSegmentsFromPlaylistURI(playlist->getVLCObject(), this))
+    bool b_updated;
+    resources = res;
+    if(pendingReload)
+    {
+        if(!pendingReload->isDownloaded())
+            return false;
+        block_t *p_block = nullptr;
+        if(pendingReload->getRequestStatus() == RequestStatus::Success)
+            p_block = Retrieve::ReadAll(pendingReload);
+        delete pendingReload;
+        pendingReload = nullptr;
+        b_updated = p_block &&
+                    parser.appendSegmentsFromPlaylist(playlist->getVLCObject(), this, p_block);
+    }
+    else b_updated = parser.appendSegmentsFromPlaylistURI(playlist->getVLCObject(), this);
+
+    if(!b_updated)
     {
         msg_Warn(playlist->getVLCObject(), "Failed to update %u/%u playlist ID %s",
                  updateFailureCount, MAX_UPDATE_FAILED_UPDATE_COUNT,
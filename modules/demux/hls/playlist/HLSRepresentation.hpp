@@ -25,6 +25,14 @@
 #include "../../adaptive/tools/Properties.hpp"
 #include "../../adaptive/StreamFormat.hpp"
 
+namespace adaptive
+{
+    namespace http
+    {
+        class AbstractChunk;
+    }
+}
+
 namespace hls
 {
     namespace playlist
@@ -37,6 +45,7 @@ namespace hls
         class HLSRepresentation : public BaseRepresentation
         {
             friend class M3U8Parser;
+            friend class M3U8;
 
             public:
                 HLSRepresentation( BaseAdaptationSet * );
@@ -45,6 +54,7 @@ namespace hls
 
                 void setPlaylistUrl(const std::string &);
                 Url getPlaylistUrl() const;
+                Url getUpdatePlaylistUrl() const;
                 bool isLive() const;
                 bool initialized() const;
                 virtual void scheduleNextUpdate(uint64_t, bool) override;
@@ -58,14 +68,24 @@ namespace hls
             protected:
                 time_t targetDuration;
                 Url playlistUrl;
+                /* Low latency, EXT-X-SERVER-CONTROL and EXT-X-PART-INF */
+                bool canBlockReload;
+                vlc_tick_t partTarget;
+                uint64_t nextMediaSequence;
+                unsigned nextPart;
 
             private:
                 static const unsigned MAX_UPDATE_FAILED_UPDATE_COUNT = 3;
+                bool canRequestBlockingReload() const;
+                void requestBlockingReload();
                 StreamFormat streamFormat;
                 bool b_live;
                 bool b_loaded;
                 unsigned updateFailureCount;
                 vlc_tick_t lastUpdateTime;
+                /* Blocking reload held by the server, on the download queue */
+                adaptive::http::AbstractChunk *pendingReload;
+                SharedResources *resources;
         };
     }
 }
@@ -163,23 +163,28 @@ void M3U8Parser::createAndFillRepresentation(vlc_object_t *p_obj, BaseAdaptation
 
 bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresentation *rep)
 {
-    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUrl().toString());
+    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist,
+                                      rep->getPlaylistUrl().toString());
     if(p_block)
+        return appendSegmentsFromPlaylist(p_obj, rep, p_block);
+    return false;
+}
+
+bool M3U8Parser::appendSegmentsFromPlaylist(vlc_object_t *p_obj, HLSRepresentation *rep,
+                                            block_t *p_block)
+{
+    stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
+    if(substream)
     {
-        stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
-        if(substream)
-        {
-            std::list<Tag *> tagslist = parseEntries(substream);
-            vlc_stream_Delete(substream);
+        std::list<Tag *> tagslist = parseEntries(substream);
+        vlc_stream_Delete(substream);
 
-            parseSegments(p_obj, rep, tagslist);
+        parseSegments(p_obj, rep, tagslist);
 
-            releaseTagsList(tagslist);
-        }
-        block_Release(p_block);
-        return true;
+        releaseTagsList(tagslist);
     }
-    return false;
+    block_Release(p_block);
+    return true;
 }
 
 static bool parseEncryption(const AttributesTag *keytag, const Url &playlistUrl,
@@ -239,6 +244,13 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
     const SingleValueTag *ctx_byterange = nullptr;
     CommonEncryption encryption;
     const ValuesListTag *ctx_extinf = nullptr;
+    std::list<const AttributesTag *> ctx_parts;
+    const AttributesTag *ctx_preloadhint = nullptr;
+    vlc_tick_t holdBack = 0;
+    vlc_tick_t partHoldBack = 0;
+
+    rep->canBlockReload = false;
+    rep->partTarget = 0;
 
     std::list<HLSSegment *> segmentstoappend;
 
@@ -270,6 +282,8 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                     ctx_byterange = nullptr;
                     break;
                 }
+                /* parts are now merged into a complete segment */
+                ctx_parts.clear();
 
                 HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
                 if(!segment)
@@ -384,15 +398,112 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                 discontinuitySequence++;
                 break;
 
+            case AttributesTag::EXTXSERVERCONTROL:
+            {
+                const AttributesTag *ctrltag = static_cast<const AttributesTag *>(tag);
+                const Attribute *attr = ctrltag->getAttributeByName("CAN-BLOCK-RELOAD");
+                rep->canBlockReload = (attr && attr->value == "YES");
+                if((attr = ctrltag->getAttributeByName("HOLD-BACK")))
+                    holdBack = vlc_tick_from_sec(attr->floatingPoint());
+                if((attr = ctrltag->getAttributeByName("PART-HOLD-BACK")))
+                    partHoldBack = vlc_tick_from_sec(attr->floatingPoint());
+            }
+            break;
+
+            case AttributesTag::EXTXPARTINF:
+            {
+                const Attribute *attr = static_cast<const AttributesTag *>(tag)
+                                        ->getAttributeByName("PART-TARGET");
+                if(attr)
+                    rep->partTarget = vlc_tick_from_sec(attr->floatingPoint());
+            }
+            break;
+
+            case AttributesTag::EXTXPART:
+                ctx_parts.push_back(static_cast<const AttributesTag *>(tag));
+                break;
+
+            case AttributesTag::EXTXPRELOADHINT:
+            {
+                const AttributesTag *hinttag = static_cast<const AttributesTag *>(tag);
+                if(hinttag->getAttributeByName("TYPE") &&
+                   hinttag->getAttributeByName("TYPE")->value == "PART" &&
+                   hinttag->getAttributeByName("URI"))
+                    ctx_preloadhint = hinttag;
+            }
+            break;
+
             case Tag::EXTXENDLIST:
                 break;
         }
     }
 
+    /* Next part the server will publish, used for blocking reloads */
+    rep->nextMediaSequence = sequenceNumber;
+    rep->nextPart = ctx_parts.size();
+
+    /* Byterange addressed parts and hint all point to the segment being
+     * produced: we can request it as a whole and get its data as it is
+     * written by the server (chunked transfer), like a complete one.
+     * Parts published as separate files stay parts. */
+    const Attribute *hintStartAttr = ctx_preloadhint ?
+                ctx_preloadhint->getAttributeByName("BYTERANGE-START") : nullptr;
+    if(rep->isLive() && hintStartAttr && rep->partTarget)
+    {
+        const std::string uri = ctx_preloadhint->getAttributeByName("URI")->quotedString();
+        /* the parts and the hint must follow each other in the same file */
+        std::size_t offset = 0;
+        bool b_samefile = true;
+        for(const AttributesTag *part : ctx_parts)
+        {
+            const Attribute *uriAttr = part->getAttributeByName("URI");
+            const Attribute *rangeAttr = part->getAttributeByName("BYTERANGE");
+            if(!uriAttr || uriAttr->quotedString() != uri || !rangeAttr)
+            {
+                b_samefile = false;
+                break;
+            }
+            const Attribute range = rangeAttr->unescapeQuotes();
+            std::pair<std::size_t,std::size_t> r = range.getByteRange();
+            if(range.value.find('@') == std::string::npos)
+                r.first = offset; /* follows the previous part */
+            if(r.first != offset)
+            {
+                b_samefile = false;
+                break;
+            }
+            offset = r.first + r.second;
+        }
+        b_samefile &= (hintStartAttr->decimal() == offset);
+
+        HLSSegment *segment;
+        if(b_samefile &&
+           (segment = new (std::nothrow) HLSSegment(rep, sequenceNumber)))
+        {
+            /* Real duration is only known once complete */
+            vlc_tick_t nzDuration = vlc_tick_from_sec(rep->targetDuration);
+            segment->setSourceUrl(uri);
+            segment->duration.Set(timescale.ToScaled(nzDuration));
+            segment->startTime.Set(timescale.ToScaled(nzStartTime));
+            if(absReferenceTime != VLC_TICK_INVALID)
+                segment->setDisplayTime(absReferenceTime);
+            segment->setDiscontinuitySequenceNumber(discontinuitySequence);
+            segment->discontinuity = discontinuity;
+            if(encryption.method != CommonEncryption::Method::None)
+                segment->setEncryption(encryption);
+            segmentstoappend.push_back(segment);
+        }
+    }
+
     for(HLSSegment *seg : segmentstoappend)
         segmentList->addSegment(seg);
     segmentstoappend.clear();
 
+    if(holdBack)
+        rep->getPlaylist()->suggestedPresentationDelay.Set(holdBack);
+    else if(partHoldBack)
+        rep->getPlaylist()->suggestedPresentationDelay.Set(partHoldBack);
+
     if(rep->isLive())
     {
         rep->getPlaylist()->duration.Set(0);
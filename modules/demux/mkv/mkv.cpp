@@ -85,6 +85,7 @@ vlc_module_begin ()
     add_file_extension("mka")
     add_file_extension("mks")
     add_file_extension("mkv")
+    set_probe_magic( "1A45DFA3" )
 
     add_submodule()
         set_callbacks( OpenTrusted, Close )
@@ -31,6 +31,7 @@
 #include <vlc_picture.h>
 #include <vlc_demux.h>
 #include <vlc_input.h>
+#include <vlc_interrupt.h>
 #include <vlc_vector.h>
 
 static ssize_t
@@ -163,6 +164,7 @@ var_Read_float(const char *psz)
     X(can_record, bool, add_bool, Bool, true) \
     X(error, bool, add_bool, Bool, false) \
     X(pts_delay, unsigned, add_integer, Unsigned, MS_FROM_VLC_TICK(DEFAULT_PTS_DELAY)) \
+    X(realtime, bool, add_bool, Bool, false) \
     X(config, char *, add_string, String, NULL )
 
 #define DECLARE_OPTION(var_name, type, module_header_type, getter, default_value)\
@@ -235,6 +237,8 @@ struct demux_sys
     vlc_tick_t chapter_gap;
 
     unsigned int updates;
+    /* System date of VLC_TICK_0 when emitting at the playback pace */
+    vlc_tick_t realtime_origin;
     OPTIONS_GLOBAL(DECLARE_OPTION)
     struct mock_video_options video;
     struct mock_audio_options audio;
@@ -321,6 +325,7 @@ Control(demux_t *demux, int query, va_list args)
                     return VLC_EGENERIC;
                 sys->current_title = new_title;
                 sys->pts = sys->audio_pts = sys->video_pts = VLC_TICK_0;
+                sys->realtime_origin = VLC_TICK_INVALID;
                 sys->updates |= INPUT_UPDATE_TITLE;
                 return VLC_SUCCESS;
             }
@@ -333,6 +338,7 @@ Control(demux_t *demux, int query, va_list args)
                 {
                     sys->pts = sys->audio_pts = sys->video_pts =
                         (seekpoint_idx * sys->chapter_gap) + VLC_TICK_0;
+                    sys->realtime_origin = VLC_TICK_INVALID;
                     return VLC_SUCCESS;
                 }
             }
@@ -366,6 +372,7 @@ Control(demux_t *demux, int query, va_list args)
                 return VLC_EGENERIC;
             sys->pts = sys->video_pts = sys->audio_pts =
                 VLC_TICK_0 + va_arg(args, double) * sys->length;
+            sys->realtime_origin = VLC_TICK_INVALID;
             return VLC_SUCCESS;
         case DEMUX_GET_LENGTH:
             *va_arg(args, vlc_tick_t *) = sys->length;
@@ -377,6 +384,7 @@ Control(demux_t *demux, int query, va_list args)
             if (!sys->can_seek)
                 return VLC_EGENERIC;
             sys->pts = sys->video_pts = sys->audio_pts = va_arg(args, vlc_tick_t);
+            sys->realtime_origin = VLC_TICK_INVALID;
             return VLC_SUCCESS;
         case DEMUX_GET_TITLE_INFO:
             if (sys->title_count > 0)
@@ -916,6 +924,17 @@ Demux(demux_t *demux)
 
     if (sys->pts > sys->length)
         sys->pts = sys->length;
+
+    if (sys->realtime)
+    {
+        /* Behave like a capture: samples are only available once their
+         * playback date is reached */
+        if (sys->realtime_origin == VLC_TICK_INVALID)
+            sys->realtime_origin = vlc_tick_now() - (sys->pts - VLC_TICK_0);
+        else if (vlc_mwait_i11e(sys->realtime_origin + sys->pts - VLC_TICK_0))
+            return VLC_DEMUXER_SUCCESS;
+    }
+
     es_out_SetPCR(demux->out, sys->pts);
 
     const vlc_tick_t video_step_length =
@@ -1124,6 +1143,7 @@ Open(vlc_object_t *obj)
     sys->chapter_gap = sys->chapter_count > 0 ?
                        (sys->length / sys->chapter_count) : VLC_TICK_INVALID;
     sys->updates = 0;
+    sys->realtime_origin = VLC_TICK_INVALID;
 
     demux->pf_control = Control;
     demux->pf_demux = Demux;
@@ -30,6 +30,7 @@
 #endif
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_plugin.h>
 #include <vlc_access.h>    /* DVB-specific things */
 #include <vlc_demux.h>
@@ -194,6 +195,12 @@ static bool GatherPESData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
+static uint8_t * ReadTSPacketBulk( demux_t *p_demux );
+static ts_bulk_buffer_t * BulkBufferNew( size_t i_size );
+static ts_bulk_buffer_t * BulkBufferHold( ts_bulk_buffer_t *p_buf );
+static void BulkBufferRelease( ts_bulk_buffer_t *p_buf );
+static void BulkReset( demux_sys_t *p_sys );
+static uint64_t TsTell( demux_sys_t *p_sys );
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, stime_t time );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
 static void PCRHandle( demux_t *p_demux, ts_pid_t *, stime_t );
@@ -399,6 +406,14 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_packet_size = i_packet_size;
     p_sys->i_packet_header_size = i_packet_header_size;
     p_sys->i_ts_read = 50;
+    p_sys->bulk.i_size = p_sys->i_ts_read * i_packet_size;
+    p_sys->bulk.p_buf = BulkBufferNew( p_sys->bulk.i_size );
+    if( !p_sys->bulk.p_buf )
+    {
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
+    BulkReset( p_sys );
     p_sys->csa = NULL;
     p_sys->b_start_record = false;
 
@@ -413,12 +428,14 @@ static int Open( vlc_object_t *p_this )
     patpid = GetPID(p_sys, 0);
     if ( !PIDSetup( p_demux, TYPE_PAT, patpid, NULL ) )
     {
+        BulkBufferRelease( p_sys->bulk.p_buf );
         free( p_sys );
         return VLC_ENOMEM;
     }
     if( !ts_psi_PAT_Attach( patpid, p_demux ) )
     {
         PIDRelease( p_demux, patpid );
+        BulkBufferRelease( p_sys->bulk.p_buf );
         free( p_sys );
         return VLC_EGENERIC;
     }
@@ -590,6 +607,7 @@ static void Close( vlc_object_t *p_this )
     /* Clear up attachments */
     vlc_dictionary_clear( &p_sys->attachments, FreeDictAttachment, NULL );
 
+    BulkBufferRelease( p_sys->bulk.p_buf );
     free( p_sys );
 }
 
@@ -618,6 +636,51 @@ static int ChangeKeyCallback( vlc_object_t *p_this, char const *psz_cmd,
 /*****************************************************************************
  * Demux:
  *****************************************************************************/
+/* Packets processed in place from the bulk read buffer (see ReadTSPacketBulk)
+ * are wrapped in stack blocks whose release is a no-op. */
+static void ReleaseTSPacketView( block_t *p_pkt )
+{
+    VLC_UNUSED(p_pkt); /* storage belongs to the read buffer */
+}
+
+static const struct vlc_block_callbacks ts_packet_view_cbs =
+{
+    ReleaseTSPacketView,
+};
+
+/* Packets kept for PES gathering reference the read buffer instead */
+typedef struct
+{
+    block_t           self;
+    ts_bulk_buffer_t *p_owner;
+} ts_packet_ref_t;
+
+static void ReleaseTSPacketRef( block_t *p_pkt )
+{
+    ts_packet_ref_t *p_ref = container_of( p_pkt, ts_packet_ref_t, self );
+    BulkBufferRelease( p_ref->p_owner );
+    free( p_ref );
+}
+
+static const struct vlc_block_callbacks ts_packet_ref_cbs =
+{
+    ReleaseTSPacketRef,
+};
+
+static block_t * DetachTSPacket( demux_sys_t *p_sys, block_t *p_view )
+{
+    ts_packet_ref_t *p_ref = malloc( sizeof(*p_ref) );
+    if( likely(p_ref) )
+    {
+        block_Init( &p_ref->self, &ts_packet_ref_cbs,
+                    p_view->p_buffer, p_view->i_buffer );
+        p_ref->self.i_flags = p_view->i_flags;
+        p_ref->p_owner = BulkBufferHold( p_sys->bulk.p_buf );
+    }
+    block_Release( p_view );
+    return likely(p_ref) ? &p_ref->self : NULL;
+}
+
 static int Demux( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -637,12 +700,19 @@ static int Demux( demux_t *p_demux )
     {
         bool         b_frame = false;
         int          i_header = 0;
+        block_t      pkt_view;
         block_t     *p_pkt;
-        if( !(p_pkt = ReadTSPacket( p_demux )) )
+        uint8_t     *p_data;
+        if( !(p_data = ReadTSPacketBulk( p_demux )) )
         {
             return VLC_DEMUXER_EOF;
         }
 
+        /* The packet is only borrowed from the read buffer. When its payload
+         * has to be kept (PES gathering), it gets a reference, not a copy. */
+        p_pkt = block_Init( &pkt_view, &ts_packet_view_cbs, p_data,
+                            p_sys->i_packet_size - p_sys->i_packet_header_size );
+
         if( p_sys->b_start_record )
         {
             /* Enable recording once synchronized */
@@ -731,7 +801,9 @@ static int Demux( demux_t *p_demux )
 
             if( p_pid->u.p_stream->transport == TS_TRANSPORT_PES )
             {
-                b_frame = GatherPESData( p_demux, p_pid, p_pkt, i_header );
+                p_pkt = DetachTSPacket( p_sys, p_pkt );
+                if( p_pkt )
+                    b_frame = GatherPESData( p_demux, p_pid, p_pkt, i_header );
             }
             else if( p_pid->u.p_stream->transport == TS_TRANSPORT_SECTIONS )
             {
@@ -952,7 +1024,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         if( (i64 = stream_Size( p_sys->stream) ) > 0 )
         {
-            uint64_t offset = vlc_stream_Tell( p_sys->stream );
+            uint64_t offset = TsTell( p_sys );
             *pf = (double)offset / (double)i64;
             return VLC_SUCCESS;
         }
@@ -1773,6 +1845,185 @@ static void PESDataChainHandle( vlc_object_t *p_obj, void *priv, block_t *p_data
     ParsePESDataChain( (demux_t *)p_obj, (ts_pid_t *) priv, p_data, i_appendpcr );
 }
 
+/*****************************************************************************
+ * Bulk packet reading
+ *
+ * Demux() reads the stream in large chunks and processes the packets in
+ * place. Packets of PES streams, which have to outlive the read buffer,
+ * reference it rather than copy it: the buffer is refcounted and replaced
+ * by a new one, instead of being reused, while such packets are queued.
+ * Packets are still dispatched one at a time.
+ * ReadTSPacket() is still used when probing or seeking, which always
+ * restores or resets the stream position.
+ *
+ * Note: when a CAM stream filter gets inserted, the already read-ahead
+ * packets are not descrambled.
+ *****************************************************************************/
+struct ts_bulk_buffer_t
+{
+    vlc_atomic_rc_t rc;
+    uint8_t p_data[];
+};
+
+static ts_bulk_buffer_t * BulkBufferNew( size_t i_size )
+{
+    ts_bulk_buffer_t *p_buf = malloc( sizeof(*p_buf) + i_size );
+    if( likely(p_buf) )
+        vlc_atomic_rc_init( &p_buf->rc );
+    return p_buf;
+}
+
+static ts_bulk_buffer_t * BulkBufferHold( ts_bulk_buffer_t *p_buf )
+{
+    vlc_atomic_rc_inc( &p_buf->rc );
+    return p_buf;
+}
+
+static void BulkBufferRelease( ts_bulk_buffer_t *p_buf )
+{
+    if( p_buf && vlc_atomic_rc_dec( &p_buf->rc ) )
+        free( p_buf );
+}
+
+static void BulkReset( demux_sys_t *p_sys )
+{
+    p_sys->bulk.i_start = 0;
+    p_sys->bulk.i_end = 0;
+    p_sys->bulk.i_synced = 0;
+}
+
+/* Stream position of the next unprocessed packet */
+static uint64_t TsTell( demux_sys_t *p_sys )
+{
+    return vlc_stream_Tell( p_sys->stream )
+           - ( p_sys->bulk.i_end - p_sys->bulk.i_start );
+}
+
+/* Ensures that at least i_min bytes are buffered, returns false on EOF */
+static bool BulkFill( demux_sys_t *p_sys, size_t i_min )
+{
+    assert( i_min <= p_sys->bulk.i_size );
+
+    while( p_sys->bulk.i_end - p_sys->bulk.i_start < i_min )
+    {
+        if( p_sys->bulk.i_size - p_sys->bulk.i_end < p_sys->i_packet_size )
+        {
+            const size_t i_left = p_sys->bulk.i_end - p_sys->bulk.i_start;
+            ts_bulk_buffer_t *p_buf = p_sys->bulk.p_buf;
+            /* Queued packets still point into it, use a new one */
+            if( vlc_atomic_rc_get( &p_buf->rc ) > 1 )
+            {
+                p_buf = BulkBufferNew( p_sys->bulk.i_size );
+                if( unlikely(!p_buf) )
+                    return false;
+                memcpy( p_buf->p_data, &p_sys->bulk.p_buf->p_data[p_sys->bulk.i_start],
+                        i_left );
+                BulkBufferRelease( p_sys->bulk.p_buf );
+                p_sys->bulk.p_buf = p_buf;
+            }
+            else
+                memmove( p_buf->p_data, &p_buf->p_data[p_sys->bulk.i_start], i_left );
+            p_sys->bulk.i_end = i_left;
+            p_sys->bulk.i_start = 0;
+        }
+
+        ssize_t i_read = vlc_stream_ReadPartial( p_sys->stream,
+                                &p_sys->bulk.p_buf->p_data[p_sys->bulk.i_end],
+                                p_sys->bulk.i_size - p_sys->bulk.i_end );
+        if( i_read == 0 )
+            return false;
+        if( i_read > 0 )
+            p_sys->bulk.i_end += i_read;
+    }
+    return true;
+}
+
+static bool BulkResync( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const size_t i_size = p_sys->i_packet_size;
+    const size_t i_header = p_sys->i_packet_header_size;
+
+    msg_Warn( p_demux, "lost synchro" );
+    for( ;; )
+    {
+        /* Two consecutive sync bytes are needed to confirm the alignment */
+        if( !BulkFill( p_sys, 2 * i_size ) )
+        {
+            msg_Dbg( p_demux, "eof ?" );
+            return false;
+        }
+
+        const uint8_t *p = &p_sys->bulk.p_buf->p_data[p_sys->bulk.i_start + i_header];
+        const size_t i_max = p_sys->bulk.i_end - p_sys->bulk.i_start
+                           - i_header - i_size;
+        size_t i_skip = 0;
+
+        while( i_skip < i_max )
+        {
+            /* memchr is vectorized by the C library */
+            const uint8_t *p_sync = memchr( &p[i_skip], 0x47, i_max - i_skip );
+            if( p_sync == NULL )
+            {
+                i_skip = i_max;
+                break;
+            }
+            i_skip = p_sync - p;
+            if( p[i_skip + i_size] == 0x47 )
+                break;
+            i_skip++;
+        }
+        msg_Dbg( p_demux, "skipping %zu bytes of garbage at %"PRIu64,
+                 i_skip, TsTell( p_sys ) );
+        p_sys->bulk.i_start += i_skip;
+
+        if( i_skip < i_max )
+            break;
+    }
+    msg_Dbg( p_demux, "resynced at %" PRIu64, TsTell( p_sys ) );
+    return true;
+}
+
+/* Returns the next packet (past any extra header) from the read buffer.
+ * The pointer is valid until the next call. */
+static uint8_t * ReadTSPacketBulk( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const size_t i_size = p_sys->i_packet_size;
+    const size_t i_header = p_sys->i_packet_header_size;
+
+    while( p_sys->bulk.i_synced < i_size )
+    {
+        if( !BulkFill( p_sys, i_size ) )
+        {
+            int64_t size = stream_Size( p_sys->stream );
+            if( size >= 0 && (uint64_t)size == vlc_stream_Tell( p_sys->stream ) )
+                msg_Dbg( p_demux, "EOF at %"PRIu64, vlc_stream_Tell( p_sys->stream ) );
+            else
+                msg_Dbg( p_demux, "Can't read TS packet at %"PRIu64, TsTell( p_sys ) );
+            return NULL;
+        }
+
+        /* Check the sync bytes of all buffered packets at once */
+        const uint8_t *p = &p_sys->bulk.p_buf->p_data[p_sys->bulk.i_start + i_header];
+        const size_t i_avail = p_sys->bulk.i_end - p_sys->bulk.i_start;
+        size_t i_synced = 0;
+
+        while( i_synced + i_size <= i_avail && p[i_synced] == 0x47 )
+            i_synced += i_size;
+
+        if( i_synced == 0 && !BulkResync( p_demux ) )
+            return NULL;
+
+        p_sys->bulk.i_synced = i_synced;
+    }
+
+    uint8_t *p_pkt = &p_sys->bulk.p_buf->p_data[p_sys->bulk.i_start + i_header];
+    p_sys->bulk.i_start += i_size;
+    p_sys->bulk.i_synced -= i_size;
+    return p_pkt;
+}
+
 static block_t* ReadTSPacket( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -1923,6 +2174,9 @@ static void ReadyQueuesPostSeek( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    /* Read-ahead data is from the previous position */
+    BulkReset( p_sys );
+
     ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
     for( int i=0; i< p_pat->programs.i_size; i++ )
     {
@@ -2283,14 +2537,14 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
         es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, FROM_SCALE(i_pcr) );
         /* growing files/named fifo handling */
         if( p_sys->b_access_control == false &&
-            vlc_stream_Tell( p_sys->stream ) > p_pmt->i_last_dts_byte )
+            TsTell( p_sys ) > p_pmt->i_last_dts_byte )
         {
             if( p_pmt->i_last_dts_byte == 0 ) /* first run */
                 p_pmt->i_last_dts_byte = stream_Size( p_sys->stream );
             else
             {
                 p_pmt->i_last_dts = i_pcr;
-                p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                p_pmt->i_last_dts_byte = TsTell( p_sys );
             }
         }
     }
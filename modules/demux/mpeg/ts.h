@@ -24,6 +24,7 @@
     typedef struct arib_instance_t arib_instance_t;
 #endif
 typedef struct csa_t csa_t;
+typedef struct ts_bulk_buffer_t ts_bulk_buffer_t;
 
 #define TS_USER_PMT_NUMBER (0)
 
@@ -71,6 +72,16 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* Packets read ahead from the stream, processed in place */
+    struct
+    {
+        ts_bulk_buffer_t *p_buf; /* shared with the PES packets still queued */
+        size_t   i_size;
+        size_t   i_start;  /* first unprocessed byte */
+        size_t   i_end;    /* end of valid data */
+        size_t   i_synced; /* bytes from i_start already checked for sync */
+    } bulk;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
 
@@ -70,6 +70,9 @@ vlc_module_begin ()
     add_file_extension("ogx")
     add_file_extension("opus")
     add_file_extension("spx")
+    /* Open() also takes streams without an OggS page served as ogg */
+    set_probe_mime( "application/ogg,video/ogg,audio/ogg" )
+    set_probe_magic( "4F676753" )
 vlc_module_end ()
 
 
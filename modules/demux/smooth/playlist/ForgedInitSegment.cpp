@@ -134,7 +134,8 @@ block_t * ForgedInitSegment::buildMoovBox(const CodecParameters &codecparameters
     return moov;
 }
 
-SegmentChunk* ForgedInitSegment::toChunk(SharedResources *, size_t, BaseRepresentation *rep)
+SegmentChunk* ForgedInitSegment::toChunk(SharedResources *, size_t, BaseRepresentation *rep,
+                                         vlc_tick_t)
 {
     QualityLevel *lvl = dynamic_cast<QualityLevel *>(rep);
     if(lvl == nullptr)
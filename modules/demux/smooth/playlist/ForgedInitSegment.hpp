@@ -43,7 +43,7 @@ namespace smooth
                                   uint64_t, vlc_tick_t);
                 virtual ~ForgedInitSegment();
                 virtual SegmentChunk* toChunk(SharedResources *, size_t,
-                                              BaseRepresentation *) override;
+                                              BaseRepresentation *, vlc_tick_t) override;
                 void setVideoSize(unsigned w, unsigned h);
                 void setTrackID(unsigned);
                 void setLanguage(const std::string &);
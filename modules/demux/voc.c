@@ -45,6 +45,7 @@ vlc_module_begin ()
     set_capability( "demux", 10 )
     set_callback( Open )
     add_file_extension("voc")
+    set_probe_magic( "437265617469766520566F6963652046696C651A" )
 vlc_module_end ()
 
 /*****************************************************************************
@@ -721,4 +721,5 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 142 )
     set_callbacks( Open, Close )
+    set_probe_magic( "52494646????????57415645,52463634????????57415645" )
 vlc_module_end ()
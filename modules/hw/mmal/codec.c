@@ -49,6 +49,12 @@
 static int OpenDecoder(vlc_object_t *);
 static void CloseDecoder(vlc_object_t *);
 
+#define MMAL_ZC_NAME "mmal-zero-copy"
+#define MMAL_ZC_TEXT N_("Output zero-copy pictures")
+#define MMAL_ZC_LONGTEXT N_("Decode into CMA buffers that can be exported as dmabufs " \
+    "and displayed directly (e.g. by the DRM output) rather than into opaque " \
+    "buffers that need an ISP copy. Pi4 only.")
+
 vlc_module_begin()
     set_subcategory( SUBCAT_INPUT_VCODEC )
     set_shortname(N_("MMAL decoder"))
@@ -57,6 +63,7 @@ vlc_module_begin()
 //    set_capability("video decoder", 900)
     add_shortcut("mmal_decoder")
     add_obsolete_bool("mmal-opaque") /* since 4.0.0 */
+    add_bool(MMAL_ZC_NAME, false, MMAL_ZC_TEXT, MMAL_ZC_LONGTEXT)
     set_callbacks(OpenDecoder, CloseDecoder)
 vlc_module_end()
 
@@ -68,6 +75,8 @@ typedef struct
     MMAL_PORT_T *output;
     hw_mmal_port_pool_ref_t *ppr;
     MMAL_ES_FORMAT_T *output_format;
+    // Output encoding if zero-copy (CMA backed), 0 if opaque
+    MMAL_FOURCC_T zc_encoding;
 
     MMAL_STATUS_T err_stream;
     bool b_progressive;
@@ -203,6 +212,93 @@ fail1:
     return NULL;
 }
 
+// Point the planes of a ZC pic at the decoded data in its CMA buffer
+static int zc_pic_set_planes(picture_t * const pic, const cma_buf_t * const cb)
+{
+    uint8_t * const base = cma_buf_addr(cb);
+    const unsigned int w = pic->format.i_width;
+    const unsigned int h = pic->format.i_height;
+
+    switch (pic->format.i_chroma) {
+        case VLC_CODEC_MMAL_ZC_SAND8:
+        {
+            // Luma then chroma in each 128 byte wide column - pitch is the
+            // column height in lines (as DRM_FORMAT_MOD_BROADCOM_SAND128_COL_HEIGHT)
+            const unsigned int col_height = h * 3 / 2;
+            if ((size_t)((w + 127) & ~127) * col_height > cma_buf_size(cb))
+                return VLC_EGENERIC;
+            pic->p[0].p_pixels = base;
+            pic->p[0].i_lines = h;
+            pic->p[0].i_pitch = col_height;
+            pic->p[1].p_pixels = base + 128 * h;
+            pic->p[1].i_lines = h / 2;
+            pic->p[1].i_pitch = col_height;
+            break;
+        }
+        case VLC_CODEC_MMAL_ZC_I420:
+        {
+            const unsigned int stride = mmal_encoding_width_to_stride(MMAL_ENCODING_I420, w);
+            if ((size_t)stride * h * 3 / 2 > cma_buf_size(cb))
+                return VLC_EGENERIC;
+            pic->p[0].p_pixels = base;
+            pic->p[0].i_lines = h;
+            pic->p[0].i_pitch = stride;
+            pic->p[1].p_pixels = base + stride * h;
+            pic->p[1].i_lines = h / 2;
+            pic->p[1].i_pitch = stride / 2;
+            pic->p[2].p_pixels = pic->p[1].p_pixels + stride / 2 * h / 2;
+            pic->p[2].i_lines = h / 2;
+            pic->p[2].i_pitch = stride / 2;
+            break;
+        }
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+// Buffer either attached to pic or recycled
+static picture_t * alloc_zc_pic(decoder_t * const dec, MMAL_BUFFER_HEADER_T * const buf)
+{
+    decoder_sys_t *const dec_sys = dec->p_sys;
+    picture_context_t * ctx;
+    picture_t * pic;
+    cma_buf_t * cb;
+
+    if (buf->length == 0) {
+        msg_Err(dec, "Empty buffer");
+        goto fail1;
+    }
+
+    if ((ctx = hw_mmal_gen_context(buf, dec_sys->ppr)) == NULL)
+        goto fail1;
+
+    // Planes are filled in from the CMA buffer once we have it
+    vlc_mutex_lock(&dec_sys->pic_lock);
+    pic = picture_NewFromResource(&dec->fmt_out.video, &(picture_resource_t){0});
+    vlc_mutex_unlock(&dec_sys->pic_lock);
+
+    if (pic == NULL) {
+        // Context owns buf now - destroying it recycles buf
+        ctx->destroy(ctx);
+        return NULL;
+    }
+    pic->context = ctx;
+
+    if ((cb = cma_buf_pic_get(pic)) == NULL || zc_pic_set_planes(pic, cb) != VLC_SUCCESS) {
+        msg_Err(dec, "Bad CMA buffer for %4.4s pic", (const char *)&pic->format.i_chroma);
+        picture_Release(pic);
+        return NULL;
+    }
+
+    buf_to_pic_copy_props(pic, buf);
+    return pic;
+
+fail1:
+    hw_mmal_port_pool_ref_recycle(dec_sys->ppr, buf);
+    return NULL;
+}
+
 static void control_port_cb(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer)
 {
     decoder_t *dec = (decoder_t *)port->userdata;
@@ -238,7 +334,9 @@ static void decoder_output_cb(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer)
 
     if (buffer->cmd == 0 && buffer->length != 0)
     {
-        picture_t *pic = alloc_opaque_pic(dec, buffer);
+        decoder_sys_t * const sys = dec->p_sys;
+        picture_t *pic = sys->zc_encoding != 0 ?
+            alloc_zc_pic(dec, buffer) : alloc_opaque_pic(dec, buffer);
         if (pic == NULL)
             msg_Err(dec, "Failed to allocate new picture");
         else
@@ -258,7 +356,7 @@ static void decoder_output_cb(MMAL_PORT_T *port, MMAL_BUFFER_HEADER_T *buffer)
         else
         {
             mmal_format_full_copy(format, fmt->format);
-            format->encoding = MMAL_ENCODING_OPAQUE;
+            format->encoding = sys->zc_encoding != 0 ? sys->zc_encoding : MMAL_ENCODING_OPAQUE;
 
             if (sys->output_format != NULL)
                 mmal_format_free(sys->output_format);
@@ -679,7 +777,20 @@ static int OpenDecoder(vlc_object_t *p_this)
         goto fail;
     }
 
-    if ((status = hw_mmal_opaque_output(VLC_OBJECT(dec), &sys->ppr,
+    if (devsys->is_cma && var_InheritBool(dec, MMAL_ZC_NAME)) {
+        // Prefer SAND as that is what the decoder produces natively
+        static const MMAL_FOURCC_T zc_encs[] = {MMAL_ENCODING_YUVUV128, MMAL_ENCODING_I420};
+        for (size_t i = 0; i != ARRAY_SIZE(zc_encs) && sys->ppr == NULL; ++i) {
+            if (hw_mmal_zc_output(VLC_OBJECT(dec), &sys->ppr, sys->output, zc_encs[i],
+                                  NUM_EXTRA_BUFFERS, decoder_output_cb, devsys->is_cma) == MMAL_SUCCESS)
+                sys->zc_encoding = zc_encs[i];
+        }
+        if (sys->ppr == NULL)
+            msg_Warn(dec, "Zero-copy output unavailable - using opaque");
+    }
+
+    if (sys->ppr == NULL &&
+        (status = hw_mmal_opaque_output(VLC_OBJECT(dec), &sys->ppr,
                                         sys->output, NUM_EXTRA_BUFFERS, decoder_output_cb)) != MMAL_SUCCESS)
         goto fail;
 
@@ -697,8 +808,11 @@ static int OpenDecoder(vlc_object_t *p_this)
     }
 
     sys->b_flushed = true;
-    dec->fmt_out.i_codec = VLC_CODEC_MMAL_OPAQUE;
-    dec->fmt_out.video.i_chroma = VLC_CODEC_MMAL_OPAQUE;
+    dec->fmt_out.i_codec =
+    dec->fmt_out.video.i_chroma =
+        sys->zc_encoding == MMAL_ENCODING_YUVUV128 ? VLC_CODEC_MMAL_ZC_SAND8 :
+        sys->zc_encoding == MMAL_ENCODING_I420 ? VLC_CODEC_MMAL_ZC_I420 :
+            VLC_CODEC_MMAL_OPAQUE;
 
     if ((status = decoder_send_extradata(dec, sys)) != MMAL_SUCCESS)
         goto fail;
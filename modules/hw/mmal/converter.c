@@ -168,6 +168,7 @@ typedef struct
     MMAL_STATUS_T err_stream;
 
     bool needs_copy_in;
+    bool dither;
     bool is_sliced;
     bool out_fmt_set;
     MMAL_PORT_BH_CB_T in_port_cb_fn;
@@ -662,7 +663,7 @@ static picture_t *conv_filter(filter_t *p_filter, picture_t *p_pic)
         mmal_decoder_device_t *devsys = GetMMALDeviceOpaque(sys->dec_dev);
         MMAL_BUFFER_HEADER_T *const pic_buf = sys->needs_copy_in ?
             hw_mmal_pic_buf_copied(p_pic, sys->in_pool, sys->input, sys->cma_in_pool,
-                                   devsys->is_cma) :
+                                   devsys->is_cma, sys->dither) :
             hw_mmal_pic_buf_replicated(p_pic, sys->in_pool);
 
         // Whether or not we extracted the pic_buf we are done with the picture
@@ -844,6 +845,7 @@ retry:
     pic_fifo_init(&sys->slice.pics);
 
     sys->needs_copy_in = !hw_mmal_chroma_is_mmal(p_filter->fmt_in.video.i_chroma);
+    sys->dither = var_InheritBool(p_filter, "mmal-dither"); // from mmal_vout
     sys->in_port_cb_fn = conv_input_port_cb;
 
     if (hw_mmal_chroma_is_mmal(p_filter->fmt_in.video.i_chroma))
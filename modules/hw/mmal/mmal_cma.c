@@ -413,6 +413,11 @@ void * cma_buf_addr(const cma_buf_t *const cb)
     return cb->mmap;
 }
 
+int cma_buf_fd(const cma_buf_t *const cb)
+{
+    return cb->fd;
+}
+
 
 
 void cma_buf_unref(cma_buf_t * const cb)
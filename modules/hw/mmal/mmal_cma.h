@@ -33,6 +33,9 @@ typedef struct cma_buf_s cma_buf_t;
 size_t cma_buf_size(const cma_buf_t * const cb);
 unsigned int cma_buf_vc_handle(const cma_buf_t *const cb);
 void * cma_buf_addr(const cma_buf_t *const cb);
+// dmabuf fd for the buffer (owned by cb - dup if you need to keep it)
+// -1 if not a CMA buffer
+int cma_buf_fd(const cma_buf_t *const cb);
 
 void cma_buf_unref(cma_buf_t * const cb);
 cma_buf_t * cma_buf_ref(cma_buf_t * const cb);
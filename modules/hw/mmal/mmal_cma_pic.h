@@ -0,0 +1,45 @@
+/*****************************************************************************
+ * mmal_cma_pic.h: Access to the CMA buffer behind a zero-copy MMAL picture
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_MMAL_MMAL_CMA_PIC_H_
+#define VLC_MMAL_MMAL_CMA_PIC_H_
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+
+#include "mmal_cma.h"
+
+// Does not need MMAL headers so can be used by non-MMAL outputs
+// (e.g. DRM) that want to scan out MMAL_ZC pictures directly
+
+static inline bool hw_mmal_chroma_is_zc(const vlc_fourcc_t chroma)
+{
+    return
+        chroma == VLC_CODEC_MMAL_ZC_I420 ||
+        chroma == VLC_CODEC_MMAL_ZC_SAND8 ||
+        chroma == VLC_CODEC_MMAL_ZC_SAND30 ||
+        chroma == VLC_CODEC_MMAL_ZC_RGB32;
+}
+
+// Returns the CMA buffer holding the pixels of a ZC pic or NULL if none
+// The buffer is NOT reffed - it remains valid for as long as the pic is held
+cma_buf_t * cma_buf_pic_get(picture_t * const pic);
+
+#endif // VLC_MMAL_MMAL_CMA_PIC_H_
@@ -0,0 +1,482 @@
+/*****************************************************************************
+ * mmal_piccpy.c: SAND128 & 10 bit to 8 bit picture copy helpers
+ *****************************************************************************
+ * Copyright © 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "mmal_piccpy.h"
+
+// Samples in a SAND30 column line
+#define SAND30_COL_SAMPLES (HW_MMAL_SAND_STRIDE1 / 4 * 3)
+
+typedef struct piccpy_fns_s {
+    void (*deinterleave)(uint8_t * u, uint8_t * v, const uint8_t * src, size_t n);
+    void (*p10_to_8)(uint8_t * dst, const uint16_t * src, size_t n, unsigned int dither);
+    void (*sand30_to_8)(uint8_t * dst, const uint32_t * src, size_t n_words);
+    void (*sand30_to_16)(uint16_t * dst, const uint32_t * src, size_t n_words);
+} piccpy_fns_t;
+
+//----------------------------------------------------------------------------
+// C line kernels
+
+void hw_mmal_piccpy_deinterleave_c(uint8_t * u, uint8_t * v, const uint8_t * src, size_t n)
+{
+    while (n-- != 0) {
+        *u++ = *src++;
+        *v++ = *src++;
+    }
+}
+
+void hw_mmal_piccpy_10_to_8_c(uint8_t * dst, const uint16_t * src, size_t n, unsigned int dither)
+{
+    const unsigned int d[2] = {dither & 0xf, (dither >> 4) & 0xf};
+
+    for (size_t i = 0; i != n; ++i) {
+        const unsigned int x = (src[i] + d[i & 1]) >> 2;
+        dst[i] = x > 255 ? 255 : x;
+    }
+}
+
+void hw_mmal_piccpy_sand30_to_8_c(uint8_t * dst, const uint32_t * src, size_t n_words)
+{
+    while (n_words-- != 0) {
+        const uint32_t w = *src++;
+        *dst++ = (uint8_t)(w >> 2);
+        *dst++ = (uint8_t)(w >> 12);
+        *dst++ = (uint8_t)(w >> 22);
+    }
+}
+
+void hw_mmal_piccpy_sand30_to_16_c(uint16_t * dst, const uint32_t * src, size_t n_words)
+{
+    while (n_words-- != 0) {
+        const uint32_t w = *src++;
+        *dst++ = w & 0x3ff;
+        *dst++ = (w >> 10) & 0x3ff;
+        *dst++ = (w >> 20) & 0x3ff;
+    }
+}
+
+static const piccpy_fns_t piccpy_c = {
+    .deinterleave = hw_mmal_piccpy_deinterleave_c,
+    .p10_to_8 = hw_mmal_piccpy_10_to_8_c,
+    .sand30_to_8 = hw_mmal_piccpy_sand30_to_8_c,
+    .sand30_to_16 = hw_mmal_piccpy_sand30_to_16_c,
+};
+
+#ifdef HAVE_PICCPY_NEON
+static const piccpy_fns_t piccpy_neon = {
+    .deinterleave = hw_mmal_piccpy_deinterleave_neon,
+    .p10_to_8 = hw_mmal_piccpy_10_to_8_neon,
+    .sand30_to_8 = hw_mmal_piccpy_sand30_to_8_neon,
+    .sand30_to_16 = hw_mmal_piccpy_sand30_to_16_neon,
+};
+#endif
+
+static const piccpy_fns_t * piccpy_fns(void)
+{
+#ifdef HAVE_PICCPY_NEON
+    if (vlc_CPU_ARM_NEON())
+        return &piccpy_neon;
+#endif
+    return &piccpy_c;
+}
+
+//----------------------------------------------------------------------------
+// Column walkers
+
+unsigned int hw_mmal_piccpy_dither(const unsigned int x, const unsigned int y)
+{
+    // 2x2 Bayer, scaled to the 2 bits we lose
+    static const uint8_t bayer[2][2] = {{0, 2}, {3, 1}};
+    const uint8_t * const row = bayer[y & 1];
+
+    return 0x100 | row[x & 1] | (row[~x & 1] << 4);
+}
+
+void hw_mmal_piccpy_10_to_8(uint8_t * dst, const uint16_t * src, size_t n,
+                            const unsigned int dither)
+{
+    piccpy_fns()->p10_to_8(dst, src, n, dither);
+}
+
+static inline const uint8_t * sand_line(const uint8_t * const src, const unsigned int stride2,
+                                        const unsigned int col, const unsigned int y)
+{
+    return src + (size_t)col * stride2 * HW_MMAL_SAND_STRIDE1 + (size_t)y * HW_MMAL_SAND_STRIDE1;
+}
+
+void hw_mmal_sand8_to_y8(uint8_t * dst, const size_t dst_stride,
+                         const uint8_t * src, const unsigned int stride2,
+                         const unsigned int x, const unsigned int y,
+                         const unsigned int w, const unsigned int h)
+{
+    for (unsigned int j = 0; j != h; ++j, dst += dst_stride) {
+        uint8_t * d = dst;
+        for (unsigned int xs = x, n = w; n != 0;) {
+            const unsigned int off = xs % HW_MMAL_SAND_STRIDE1;
+            const unsigned int len = __MIN(HW_MMAL_SAND_STRIDE1 - off, n);
+
+            memcpy(d, sand_line(src, stride2, xs / HW_MMAL_SAND_STRIDE1, y + j) + off, len);
+            d += len;
+            xs += len;
+            n -= len;
+        }
+    }
+}
+
+static void sand8_to_c8(const piccpy_fns_t * const fns,
+                        uint8_t * dst_u, const size_t dst_stride_u,
+                        uint8_t * dst_v, const size_t dst_stride_v,
+                        const uint8_t * src, const unsigned int stride2,
+                        const unsigned int x, const unsigned int y,
+                        const unsigned int w, const unsigned int h)
+{
+    const unsigned int col_pairs = HW_MMAL_SAND_STRIDE1 / 2;
+
+    for (unsigned int j = 0; j != h; ++j, dst_u += dst_stride_u, dst_v += dst_stride_v) {
+        uint8_t * u = dst_u;
+        uint8_t * v = dst_v;
+        for (unsigned int xs = x, n = w; n != 0;) {
+            const unsigned int off = xs % col_pairs;
+            const unsigned int len = __MIN(col_pairs - off, n);
+
+            fns->deinterleave(u, v, sand_line(src, stride2, xs / col_pairs, y + j) + off * 2, len);
+            u += len;
+            v += len;
+            xs += len;
+            n -= len;
+        }
+    }
+}
+
+void hw_mmal_sand8_to_c8(uint8_t * dst_u, const size_t dst_stride_u,
+                         uint8_t * dst_v, const size_t dst_stride_v,
+                         const uint8_t * src, const unsigned int stride2,
+                         const unsigned int x, const unsigned int y,
+                         const unsigned int w, const unsigned int h)
+{
+    sand8_to_c8(piccpy_fns(), dst_u, dst_stride_u, dst_v, dst_stride_v,
+                src, stride2, x, y, w, h);
+}
+
+// Convert len samples starting at sample xs of SAND30 line y to 8 bit
+static void sand30_seg_to_8(const piccpy_fns_t * const fns, uint8_t * d,
+                            const uint8_t * src, const unsigned int stride2,
+                            const unsigned int xs, const unsigned int y,
+                            const unsigned int len, const bool dither)
+{
+    const unsigned int off = xs % SAND30_COL_SAMPLES;
+    const unsigned int skip = off % 3;
+    const uint32_t * const s = (const uint32_t *)sand_line(src, stride2, xs / SAND30_COL_SAMPLES, y) + off / 3;
+    const unsigned int n_words = (skip + len + 2) / 3;
+
+    if (dither) {
+        uint16_t tmp[SAND30_COL_SAMPLES];
+        fns->sand30_to_16(tmp, s, n_words);
+        fns->p10_to_8(d, tmp + skip, len, hw_mmal_piccpy_dither(xs, y));
+    }
+    else if (skip == 0) {
+        // Whole words straight to the destination, only the tail via tmp
+        const unsigned int full = len / 3;
+        fns->sand30_to_8(d, s, full);
+        if (full * 3 != len) {
+            uint8_t tmp[3];
+            fns->sand30_to_8(tmp, s + full, 1);
+            memcpy(d + full * 3, tmp, len - full * 3);
+        }
+    }
+    else {
+        uint8_t tmp[SAND30_COL_SAMPLES];
+        fns->sand30_to_8(tmp, s, n_words);
+        memcpy(d, tmp + skip, len);
+    }
+}
+
+static void sand30_to_y8(const piccpy_fns_t * const fns,
+                         uint8_t * dst, const size_t dst_stride,
+                         const uint8_t * src, const unsigned int stride2,
+                         const unsigned int x, const unsigned int y,
+                         const unsigned int w, const unsigned int h,
+                         const bool dither)
+{
+    for (unsigned int j = 0; j != h; ++j, dst += dst_stride) {
+        uint8_t * d = dst;
+        for (unsigned int xs = x, n = w; n != 0;) {
+            const unsigned int len = __MIN(SAND30_COL_SAMPLES - xs % SAND30_COL_SAMPLES, n);
+
+            sand30_seg_to_8(fns, d, src, stride2, xs, y + j, len, dither);
+            d += len;
+            xs += len;
+            n -= len;
+        }
+    }
+}
+
+void hw_mmal_sand30_to_y8(uint8_t * dst, const size_t dst_stride,
+                          const uint8_t * src, const unsigned int stride2,
+                          const unsigned int x, const unsigned int y,
+                          const unsigned int w, const unsigned int h,
+                          const bool dither)
+{
+    sand30_to_y8(piccpy_fns(), dst, dst_stride, src, stride2, x, y, w, h, dither);
+}
+
+static void sand30_to_c8(const piccpy_fns_t * const fns,
+                         uint8_t * dst_u, const size_t dst_stride_u,
+                         uint8_t * dst_v, const size_t dst_stride_v,
+                         const uint8_t * src, const unsigned int stride2,
+                         const unsigned int x, const unsigned int y,
+                         const unsigned int w, const unsigned int h,
+                         const bool dither)
+{
+    const unsigned int col_pairs = SAND30_COL_SAMPLES / 2;
+
+    for (unsigned int j = 0; j != h; ++j, dst_u += dst_stride_u, dst_v += dst_stride_v) {
+        uint8_t * u = dst_u;
+        uint8_t * v = dst_v;
+        for (unsigned int xs = x, n = w; n != 0;) {
+            const unsigned int len = __MIN(col_pairs - xs % col_pairs, n);
+            uint8_t tmp[SAND30_COL_SAMPLES];
+
+            sand30_seg_to_8(fns, tmp, src, stride2, xs * 2, y + j, len * 2, dither);
+            fns->deinterleave(u, v, tmp, len);
+            u += len;
+            v += len;
+            xs += len;
+            n -= len;
+        }
+    }
+}
+
+void hw_mmal_sand30_to_c8(uint8_t * dst_u, const size_t dst_stride_u,
+                          uint8_t * dst_v, const size_t dst_stride_v,
+                          const uint8_t * src, const unsigned int stride2,
+                          const unsigned int x, const unsigned int y,
+                          const unsigned int w, const unsigned int h,
+                          const bool dither)
+{
+    sand30_to_c8(piccpy_fns(), dst_u, dst_stride_u, dst_v, dst_stride_v,
+                 src, stride2, x, y, w, h, dither);
+}
+
+#ifdef PICCPY_TEST
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct test_size
+{
+    unsigned int width;
+    unsigned int height;
+    unsigned int x;
+    unsigned int y;
+};
+static const struct test_size sizes[] = {
+    { 1, 1, 0, 0 },
+    { 3, 3, 1, 1 },
+    { 65, 39, 0, 0 },
+    { 65, 39, 63, 5 },
+    { 560, 369, 17, 3 },
+    { 1920, 1088, 0, 0 },
+};
+
+static unsigned int ref_sand8(const uint8_t * src, unsigned int stride2,
+                              unsigned int x, unsigned int y)
+{
+    return src[(x / 128) * stride2 * 128 + y * 128 + x % 128];
+}
+
+static unsigned int ref_sand30(const uint8_t * src, unsigned int stride2,
+                               unsigned int x, unsigned int y)
+{
+    const uint32_t * const s = (const uint32_t *)(src + (x / 96) * stride2 * 128 + y * 128);
+    return (s[(x % 96) / 3] >> ((x % 3) * 10)) & 0x3ff;
+}
+
+static unsigned int ref_10_to_8(unsigned int v, unsigned int x, unsigned int y, bool dither)
+{
+    static const uint8_t bayer[2][2] = {{0, 2}, {3, 1}};
+    v = (v + (dither ? bayer[y & 1][x & 1] : 0)) >> 2;
+    return v > 255 ? 255 : v;
+}
+
+// Plane of w x h samples in a SAND buffer: cols * stride2 * 128 bytes
+static uint8_t * sand_alloc(unsigned int w_bytes, unsigned int stride2, size_t * const psize)
+{
+    const size_t size = (size_t)((w_bytes + 127) / 128) * stride2 * 128;
+    uint8_t * const buf = malloc(size);
+    assert(buf);
+    for (size_t i = 0; i != size; ++i)
+        buf[i] = rand();
+    *psize = size;
+    return buf;
+}
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "error: %s: mismatch @ %u x %u\n", name, i, j); \
+        assert(!"error: pixel doesn't match"); \
+    } \
+} while (0)
+
+static void test_fns(const piccpy_fns_t * const fns, const char * const name)
+{
+    for (size_t k = 0; k < ARRAY_SIZE(sizes); ++k) {
+        const struct test_size * const sz = &sizes[k];
+        const unsigned int w = sz->width;
+        const unsigned int h = sz->height;
+        const unsigned int stride2 = h + sz->y + 8;
+        const unsigned int cw = (w + 1) / 2;
+        size_t size;
+
+        fprintf(stderr, "testing %s: %u x %u @ %u,%u\n", name, w, h, sz->x, sz->y);
+
+        uint8_t * const y8 = malloc(w * h);
+        uint8_t * const u8 = malloc(cw * h);
+        uint8_t * const v8 = malloc(cw * h);
+        assert(y8 && u8 && v8);
+
+        // SAND8 luma & chroma
+        uint8_t * src = sand_alloc(sz->x + w, stride2, &size);
+        hw_mmal_sand8_to_y8(y8, w, src, stride2, sz->x, sz->y, w, h);
+        for (unsigned int j = 0; j != h; ++j)
+            for (unsigned int i = 0; i != w; ++i)
+                CHECK(y8[j * w + i] == ref_sand8(src, stride2, sz->x + i, sz->y + j));
+        free(src);
+
+        src = sand_alloc((sz->x + cw) * 2, stride2, &size);
+        sand8_to_c8(fns, u8, cw, v8, cw, src, stride2, sz->x, sz->y, cw, h);
+        for (unsigned int j = 0; j != h; ++j)
+            for (unsigned int i = 0; i != cw; ++i) {
+                CHECK(u8[j * cw + i] == ref_sand8(src, stride2, (sz->x + i) * 2, sz->y + j));
+                CHECK(v8[j * cw + i] == ref_sand8(src, stride2, (sz->x + i) * 2 + 1, sz->y + j));
+            }
+        free(src);
+
+        // SAND30 luma & chroma, with & without dither
+        for (int dither = 0; dither != 2; ++dither) {
+            src = sand_alloc((sz->x + w + 95) / 96 * 128, stride2, &size);
+            sand30_to_y8(fns, y8, w, src, stride2, sz->x, sz->y, w, h, dither);
+            for (unsigned int j = 0; j != h; ++j)
+                for (unsigned int i = 0; i != w; ++i)
+                    CHECK(y8[j * w + i] ==
+                          ref_10_to_8(ref_sand30(src, stride2, sz->x + i, sz->y + j),
+                                      sz->x + i, sz->y + j, dither));
+            free(src);
+
+            src = sand_alloc(((sz->x + cw) * 2 + 95) / 96 * 128, stride2, &size);
+            sand30_to_c8(fns, u8, cw, v8, cw, src, stride2, sz->x, sz->y, cw, h, dither);
+            for (unsigned int j = 0; j != h; ++j)
+                for (unsigned int i = 0; i != cw; ++i) {
+                    const unsigned int xu = (sz->x + i) * 2;
+                    CHECK(u8[j * cw + i] ==
+                          ref_10_to_8(ref_sand30(src, stride2, xu, sz->y + j), xu, sz->y + j, dither));
+                    CHECK(v8[j * cw + i] ==
+                          ref_10_to_8(ref_sand30(src, stride2, xu + 1, sz->y + j), xu + 1, sz->y + j, dither));
+                }
+            free(src);
+        }
+
+        // Planar 10 bit, including out of range values which must saturate
+        uint16_t * const p10 = malloc(w * sizeof(uint16_t));
+        assert(p10);
+        for (unsigned int j = 0; j != 2; ++j) {
+            for (unsigned int i = 0; i != w; ++i)
+                p10[i] = (i & 7) == 0 ? 0x3ff : rand() & 0x3ff;
+            fns->p10_to_8(y8, p10, w, hw_mmal_piccpy_dither(sz->x, j));
+            for (unsigned int i = 0; i != w; ++i)
+                CHECK(y8[i] == ref_10_to_8(p10[i], sz->x + i, j, true));
+            fns->p10_to_8(y8, p10, w, 0);
+            for (unsigned int i = 0; i != w; ++i)
+                CHECK(y8[i] == p10[i] >> 2);
+        }
+        free(p10);
+
+        free(y8);
+        free(u8);
+        free(v8);
+    }
+}
+
+// 1080p SAND -> I420, reported rather than checked
+static void bench_fns(const piccpy_fns_t * const fns, const char * const name)
+{
+    const unsigned int w = 1920, h = 1080, stride2 = 1088 * 3 / 2;
+    const unsigned int reps = 20;
+    uint8_t * const dst = malloc(w * h * 3 / 2);
+    size_t size;
+    uint8_t * const s8 = sand_alloc(w, stride2, &size);
+    uint8_t * const s30 = sand_alloc((w + 95) / 96 * 128, stride2, &size);
+    assert(dst);
+
+    for (int fmt = 0; fmt != 3; ++fmt) {
+        static const char * const fmt_names[] = {"SAND8", "SAND30", "SAND30+dither"};
+        const vlc_tick_t t0 = vlc_tick_now();
+
+        for (unsigned int r = 0; r != reps; ++r) {
+            uint8_t * const du = dst + w * h;
+            uint8_t * const dv = du + w * h / 4;
+            if (fmt == 0) {
+                hw_mmal_sand8_to_y8(dst, w, s8, stride2, 0, 0, w, h);
+                sand8_to_c8(fns, du, w / 2, dv, w / 2, s8 + 128 * 1088, stride2, 0, 0, w / 2, h / 2);
+            }
+            else {
+                sand30_to_y8(fns, dst, w, s30, stride2, 0, 0, w, h, fmt == 2);
+                sand30_to_c8(fns, du, w / 2, dv, w / 2, s30 + 128 * 1088, stride2, 0, 0, w / 2, h / 2, fmt == 2);
+            }
+        }
+
+        const vlc_tick_t t = (vlc_tick_now() - t0) / reps;
+        fprintf(stderr, "%s: %s -> I420 1080p: %"PRId64" us/frame\n",
+                name, fmt_names[fmt], US_FROM_VLC_TICK(t));
+    }
+
+    free(s30);
+    free(s8);
+    free(dst);
+}
+
+int main(void)
+{
+    alarm(30);
+
+    test_fns(&piccpy_c, "C");
+    bench_fns(&piccpy_c, "C");
+#ifdef HAVE_PICCPY_NEON
+    if (vlc_CPU_ARM_NEON()) {
+        test_fns(&piccpy_neon, "NEON");
+        bench_fns(&piccpy_neon, "NEON");
+    }
+    else
+        fprintf(stderr, "WARNING: could not test NEON\n");
+#endif
+    return 0;
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*****************************************************************************
+ * mmal_piccpy.h: SAND128 & 10 bit to 8 bit picture copy helpers
+ *****************************************************************************
+ * Copyright © 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_MMAL_MMAL_PICCPY_H_
+#define VLC_MMAL_MMAL_PICCPY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// SAND128: a plane is split into 128 byte wide columns, each stride2 lines
+// high, with the columns one after another in memory. Within a column each
+// line is 128 contiguous bytes. Chroma is interleaved UV in the same layout.
+// SAND30 packs 3 10-bit samples into the low 30 bits of each 32-bit word so
+// a 128 byte column line holds 96 samples.
+#define HW_MMAL_SAND_STRIDE1 128
+
+// Dither value for 10->8 bit conversion starting at (x, y) or 0 for none
+// Ordered (2x2 Bayer) so it is stable from frame to frame
+unsigned int hw_mmal_piccpy_dither(const unsigned int x, const unsigned int y);
+
+// n 10 bit samples to 8 bit, rounding with dither (0 = truncate)
+void hw_mmal_piccpy_10_to_8(uint8_t * dst, const uint16_t * src, size_t n,
+                            const unsigned int dither);
+
+// x, y, w, h are in pixels for luma & in UV pairs for chroma
+// src points at the start of the plane
+void hw_mmal_sand8_to_y8(uint8_t * dst, const size_t dst_stride,
+                         const uint8_t * src, const unsigned int stride2,
+                         const unsigned int x, const unsigned int y,
+                         const unsigned int w, const unsigned int h);
+void hw_mmal_sand8_to_c8(uint8_t * dst_u, const size_t dst_stride_u,
+                         uint8_t * dst_v, const size_t dst_stride_v,
+                         const uint8_t * src, const unsigned int stride2,
+                         const unsigned int x, const unsigned int y,
+                         const unsigned int w, const unsigned int h);
+void hw_mmal_sand30_to_y8(uint8_t * dst, const size_t dst_stride,
+                          const uint8_t * src, const unsigned int stride2,
+                          const unsigned int x, const unsigned int y,
+                          const unsigned int w, const unsigned int h,
+                          const bool dither);
+void hw_mmal_sand30_to_c8(uint8_t * dst_u, const size_t dst_stride_u,
+                          uint8_t * dst_v, const size_t dst_stride_v,
+                          const uint8_t * src, const unsigned int stride2,
+                          const unsigned int x, const unsigned int y,
+                          const unsigned int w, const unsigned int h,
+                          const bool dither);
+// Semi-planar (NV12) chroma is hw_mmal_sand*_to_y8() with x & w doubled
+
+//----------------------------------------------------------------------------
+// Line kernels - C versions always exist, NEON versions if HAVE_PICCPY_NEON
+
+void hw_mmal_piccpy_deinterleave_c(uint8_t * u, uint8_t * v, const uint8_t * src, size_t n);
+void hw_mmal_piccpy_10_to_8_c(uint8_t * dst, const uint16_t * src, size_t n, unsigned int dither);
+void hw_mmal_piccpy_sand30_to_8_c(uint8_t * dst, const uint32_t * src, size_t n_words);
+void hw_mmal_piccpy_sand30_to_16_c(uint16_t * dst, const uint32_t * src, size_t n_words);
+
+void hw_mmal_piccpy_deinterleave_neon(uint8_t * u, uint8_t * v, const uint8_t * src, size_t n);
+void hw_mmal_piccpy_10_to_8_neon(uint8_t * dst, const uint16_t * src, size_t n, unsigned int dither);
+void hw_mmal_piccpy_sand30_to_8_neon(uint8_t * dst, const uint32_t * src, size_t n_words);
+void hw_mmal_piccpy_sand30_to_16_neon(uint16_t * dst, const uint32_t * src, size_t n_words);
+
+#endif // VLC_MMAL_MMAL_PICCPY_H_
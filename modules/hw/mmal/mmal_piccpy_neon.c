@@ -0,0 +1,92 @@
+/*****************************************************************************
+ * mmal_piccpy_neon.c: NEON line kernels for mmal_piccpy.c
+ *****************************************************************************
+ * Copyright © 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+// Intrinsics rather than .S so that the same source serves both AArch32 and
+// AArch64. Each kernel does the bulk in vectors & hands the tail to the C
+// version so results are bit identical.
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdint.h>
+#include <arm_neon.h>
+
+#include "mmal_piccpy.h"
+
+void hw_mmal_piccpy_deinterleave_neon(uint8_t * u, uint8_t * v, const uint8_t * src, size_t n)
+{
+    for (; n >= 16; n -= 16, src += 32, u += 16, v += 16) {
+        const uint8x16x2_t uv = vld2q_u8(src);
+        vst1q_u8(u, uv.val[0]);
+        vst1q_u8(v, uv.val[1]);
+    }
+    hw_mmal_piccpy_deinterleave_c(u, v, src, n);
+}
+
+void hw_mmal_piccpy_10_to_8_neon(uint8_t * dst, const uint16_t * src, size_t n, unsigned int dither)
+{
+    // Even lanes get the even dither, odd lanes the odd one
+    const uint16x8_t d = vreinterpretq_u16_u32(
+        vdupq_n_u32((dither & 0xf) | ((dither >> 4) & 0xf) << 16));
+
+    for (; n >= 16; n -= 16, src += 16, dst += 16) {
+        const uint16x8_t a = vaddq_u16(vld1q_u16(src), d);
+        const uint16x8_t b = vaddq_u16(vld1q_u16(src + 8), d);
+        vst1q_u8(dst, vcombine_u8(vqshrn_n_u16(a, 2), vqshrn_n_u16(b, 2)));
+    }
+    // 16 is even so the dither phase is unchanged for the tail
+    hw_mmal_piccpy_10_to_8_c(dst, src, n, dither);
+}
+
+void hw_mmal_piccpy_sand30_to_8_neon(uint8_t * dst, const uint32_t * src, size_t n_words)
+{
+    for (; n_words >= 8; n_words -= 8, src += 8, dst += 24) {
+        const uint32x4_t a = vld1q_u32(src);
+        const uint32x4_t b = vld1q_u32(src + 4);
+        uint8x8x3_t r;
+
+        // Keep the top 8 bits of each 10 bit field
+        r.val[0] = vmovn_u16(vcombine_u16(vmovn_u32(vshrq_n_u32(a, 2)),
+                                          vmovn_u32(vshrq_n_u32(b, 2))));
+        r.val[1] = vmovn_u16(vcombine_u16(vmovn_u32(vshrq_n_u32(a, 12)),
+                                          vmovn_u32(vshrq_n_u32(b, 12))));
+        r.val[2] = vmovn_u16(vcombine_u16(vmovn_u32(vshrq_n_u32(a, 22)),
+                                          vmovn_u32(vshrq_n_u32(b, 22))));
+        vst3_u8(dst, r);
+    }
+    hw_mmal_piccpy_sand30_to_8_c(dst, src, n_words);
+}
+
+void hw_mmal_piccpy_sand30_to_16_neon(uint16_t * dst, const uint32_t * src, size_t n_words)
+{
+    const uint32x4_t mask = vdupq_n_u32(0x3ff);
+
+    for (; n_words >= 4; n_words -= 4, src += 4, dst += 12) {
+        const uint32x4_t a = vld1q_u32(src);
+        uint16x4x3_t r;
+
+        r.val[0] = vmovn_u32(vandq_u32(a, mask));
+        r.val[1] = vmovn_u32(vandq_u32(vshrq_n_u32(a, 10), mask));
+        r.val[2] = vmovn_u32(vandq_u32(vshrq_n_u32(a, 20), mask));
+        vst3_u16(dst, r);
+    }
+    hw_mmal_piccpy_sand30_to_16_c(dst, src, n_words);
+}
@@ -33,6 +33,7 @@
 
 #include "mmal_cma.h"
 #include "mmal_picture.h"
+#include "mmal_piccpy.h"
 
 const vlc_fourcc_t hw_mmal_vzc_subpicture_chromas[] = { VLC_CODEC_RGBA, VLC_CODEC_BGRA, VLC_CODEC_ARGB, 0 };
 
@@ -113,6 +114,12 @@ MMAL_FOURCC_T vlc_to_mmal_video_fourcc(const video_frame_format_t * const vf_vlc
         // VLC_CODEC_ABGR does not exist in VLC
         case VLC_CODEC_MMAL_OPAQUE:
             return MMAL_ENCODING_OPAQUE;
+        case VLC_CODEC_MMAL_ZC_I420:
+            return MMAL_ENCODING_I420;
+        case VLC_CODEC_MMAL_ZC_SAND8:
+            return MMAL_ENCODING_YUVUV128;
+        case VLC_CODEC_MMAL_ZC_SAND30:
+            return MMAL_ENCODING_YUV10_COL;
         default:
             break;
     }
@@ -121,7 +128,8 @@ MMAL_FOURCC_T vlc_to_mmal_video_fourcc(const video_frame_format_t * const vf_vlc
 
 static void vlc_fmt_to_video_format(MMAL_VIDEO_FORMAT_T *const vf_mmal, const video_frame_format_t * const vf_vlc)
 {
-    const unsigned int wmask = (vf_vlc->i_chroma == VLC_CODEC_I420) ? 31 : 15;
+    const unsigned int wmask = (vf_vlc->i_chroma == VLC_CODEC_I420 ||
+                                vf_vlc->i_chroma == VLC_CODEC_MMAL_ZC_I420) ? 31 : 15;
 
     vf_mmal->width          = (vf_vlc->i_width + wmask) & ~wmask;
     vf_mmal->height         = (vf_vlc->i_height + 15) & ~15;
@@ -181,6 +189,10 @@ struct mmal_port_pool_ref_s
     atomic_uint refs;
     MMAL_POOL_T * pool;
     MMAL_PORT_T * port;
+
+    // Zero-copy only: cbs[n] is the CMA buffer behind pool->header[n]
+    cma_buf_pool_t * cbp;
+    cma_buf_t ** cbs;
 };
 
 static hw_mmal_port_pool_ref_t * hw_mmal_port_pool_ref_create(MMAL_PORT_T * const port,
@@ -215,7 +227,13 @@ static void * kill_ppr(void * v)
     hw_mmal_port_pool_ref_t * const ppr = v;
     if (ppr->port->is_enabled)
         mmal_port_disable(ppr->port);  // Avoid annoyed messages from MMAL when we kill the pool
+    if (ppr->cbs != NULL) {
+        for (unsigned int i = 0; i != ppr->pool->headers_num; ++i)
+            cma_buf_unref(ppr->cbs[i]);
+        free(ppr->cbs);
+    }
     mmal_port_pool_destroy(ppr->port, ppr->pool);
+    cma_buf_pool_delete(ppr->cbp);
     free(ppr);
     return NULL;
 }
@@ -232,6 +250,38 @@ void hw_mmal_port_pool_ref_release(hw_mmal_port_pool_ref_t * const ppr, const bo
         kill_ppr(ppr);
 }
 
+static cma_buf_t ** ppr_cb_slot(hw_mmal_port_pool_ref_t * const ppr, const MMAL_BUFFER_HEADER_T * const buf)
+{
+    for (unsigned int i = 0; i != ppr->pool->headers_num; ++i) {
+        if (ppr->pool->header[i] == buf)
+            return ppr->cbs + i;
+    }
+    return NULL;
+}
+
+// (Re)attach the CMA buffer for this header, growing it if the port buffer
+// size has increased since it was allocated (format change)
+// A header is only ever in one place at once so no lock is needed
+static MMAL_STATUS_T ppr_cma_attach(hw_mmal_port_pool_ref_t * const ppr, MMAL_BUFFER_HEADER_T * const buf)
+{
+    cma_buf_t ** const pcb = ppr->cbs == NULL ? NULL : ppr_cb_slot(ppr, buf);
+
+    if (pcb == NULL)
+        return ppr->cbs == NULL ? MMAL_SUCCESS : MMAL_EINVAL;
+
+    if (*pcb == NULL || cma_buf_size(*pcb) < ppr->port->buffer_size) {
+        cma_buf_t * const cb = cma_buf_pool_alloc_buf(ppr->cbp, ppr->port->buffer_size);
+        if (cb == NULL)
+            return MMAL_ENOMEM;
+        cma_buf_unref(*pcb);
+        *pcb = cb;
+    }
+
+    buf->data       = (uint8_t *)(uintptr_t)cma_buf_vc_handle(*pcb);
+    buf->alloc_size = cma_buf_size(*pcb);
+    return MMAL_SUCCESS;
+}
+
 // Put buffer in port if possible - if not then release to pool
 // Returns true if sent, false if recycled
 bool hw_mmal_port_pool_ref_recycle(hw_mmal_port_pool_ref_t * const ppr, MMAL_BUFFER_HEADER_T * const buf)
@@ -239,7 +289,8 @@ bool hw_mmal_port_pool_ref_recycle(hw_mmal_port_pool_ref_t * const ppr, MMAL_BUF
     mmal_buffer_header_reset(buf);
     buf->user_data = NULL;
 
-    if (mmal_port_send_buffer(ppr->port, buf) == MMAL_SUCCESS)
+    if (ppr_cma_attach(ppr, buf) == MMAL_SUCCESS &&
+        mmal_port_send_buffer(ppr->port, buf) == MMAL_SUCCESS)
         return true;
     mmal_buffer_header_release(buf);
     return false;
@@ -251,7 +302,8 @@ MMAL_STATUS_T hw_mmal_port_pool_ref_fill(hw_mmal_port_pool_ref_t * const ppr)
     MMAL_STATUS_T err = MMAL_SUCCESS;
 
     while ((buf = mmal_queue_get(ppr->pool->queue)) != NULL) {
-        if ((err = mmal_port_send_buffer(ppr->port, buf)) != MMAL_SUCCESS)
+        if ((err = ppr_cma_attach(ppr, buf)) != MMAL_SUCCESS ||
+            (err = mmal_port_send_buffer(ppr->port, buf)) != MMAL_SUCCESS)
         {
             mmal_queue_put_back(ppr->pool->queue, buf);
             break;
@@ -261,10 +313,12 @@ MMAL_STATUS_T hw_mmal_port_pool_ref_fill(hw_mmal_port_pool_ref_t * const ppr)
 }
 
 
-MMAL_STATUS_T hw_mmal_opaque_output(vlc_object_t * const obj,
-                                    hw_mmal_port_pool_ref_t ** pppr,
-                                    MMAL_PORT_T * const port,
-                                    const unsigned int extra_buffers, MMAL_PORT_BH_CB_T callback)
+static MMAL_STATUS_T port_output_setup(vlc_object_t * const obj,
+                                       hw_mmal_port_pool_ref_t ** pppr,
+                                       MMAL_PORT_T * const port,
+                                       const MMAL_FOURCC_T encoding,
+                                       const unsigned int extra_buffers, MMAL_PORT_BH_CB_T callback,
+                                       cma_buf_pool_t * const cbp)
 {
     MMAL_STATUS_T status;
 
@@ -274,6 +328,7 @@ MMAL_STATUS_T hw_mmal_opaque_output(vlc_object_t * const obj,
     if (status != MMAL_SUCCESS) {
         msg_Err(obj, "Failed to set MMAL_PARAMETER_EXTRA_BUFFERS on output port (status=%"PRIx32" %s)",
                 status, mmal_status_to_string(status));
+        cma_buf_pool_delete(cbp);
         return status;
     }
 
@@ -281,24 +336,39 @@ MMAL_STATUS_T hw_mmal_opaque_output(vlc_object_t * const obj,
     if (status != MMAL_SUCCESS) {
        msg_Err(obj, "Failed to set zero copy on port %s (status=%"PRIx32" %s)",
                 port->name, status, mmal_status_to_string(status));
+       cma_buf_pool_delete(cbp);
        return status;
     }
 
-    port->format->encoding = MMAL_ENCODING_OPAQUE;
+    port->format->encoding = encoding;
     port->format->encoding_variant = 0;
     if ((status = mmal_port_format_commit(port)) != MMAL_SUCCESS)
     {
         msg_Err(obj, "Failed to commit format on port %s (status=%"PRIx32" %s)",
                  port->name, status, mmal_status_to_string(status));
+        cma_buf_pool_delete(cbp);
         return status;
     }
 
     port->buffer_num = 30;
     port->buffer_size = port->buffer_size_recommended;
 
-    if ((*pppr = hw_mmal_port_pool_ref_create(port, port->buffer_num, port->buffer_size)) == NULL) {
+    // If CMA backed then the payload is attached per header, not allocated here
+    if ((*pppr = hw_mmal_port_pool_ref_create(port, port->buffer_num,
+                                              cbp != NULL ? 0 : port->buffer_size)) == NULL) {
         msg_Err(obj, "Failed to create output pool");
-        return status;
+        cma_buf_pool_delete(cbp);
+        return MMAL_ENOMEM;
+    }
+
+    if (cbp != NULL) {
+        // ppr owns cbp from here
+        (*pppr)->cbp = cbp;
+        if (((*pppr)->cbs = calloc(port->buffer_num, sizeof(cma_buf_t *))) == NULL) {
+            hw_mmal_port_pool_ref_release(*pppr, false);
+            *pppr = NULL;
+            return MMAL_ENOMEM;
+        }
     }
 
     status = mmal_port_enable(port, callback);
@@ -313,6 +383,32 @@ MMAL_STATUS_T hw_mmal_opaque_output(vlc_object_t * const obj,
     return MMAL_SUCCESS;
 }
 
+MMAL_STATUS_T hw_mmal_opaque_output(vlc_object_t * const obj,
+                                    hw_mmal_port_pool_ref_t ** pppr,
+                                    MMAL_PORT_T * const port,
+                                    const unsigned int extra_buffers, MMAL_PORT_BH_CB_T callback)
+{
+    return port_output_setup(obj, pppr, port, MMAL_ENCODING_OPAQUE, extra_buffers, callback, NULL);
+}
+
+MMAL_STATUS_T hw_mmal_zc_output(vlc_object_t * const obj,
+                                hw_mmal_port_pool_ref_t ** pppr,
+                                MMAL_PORT_T * const port,
+                                const MMAL_FOURCC_T encoding,
+                                const unsigned int extra_buffers, MMAL_PORT_BH_CB_T callback,
+                                bool is_cma)
+{
+    // One CMA buffer per header - allow them all to be in flight at once
+    // cbp is owned by port_output_setup whatever the outcome
+    cma_buf_pool_t * const cbp = cma_buf_pool_new(NUM_DECODER_BUFFER_HEADERS, NUM_DECODER_BUFFER_HEADERS,
+                                                  is_cma, "zc-out");
+    if (cbp == NULL) {
+        msg_Err(obj, "Failed to create CMA pool");
+        return MMAL_ENOMEM;
+    }
+    return port_output_setup(obj, pppr, port, encoding, extra_buffers, callback, cbp);
+}
+
 //----------------------------------------------------------------------------
 
 #define CTX_BUFS_MAX 4
@@ -413,18 +509,23 @@ hw_mmal_gen_context(MMAL_BUFFER_HEADER_T * buf, hw_mmal_port_pool_ref_t * const
     ctx->buf_count = 1;
     ctx->bufs[0] = buf;
 
+    // Zero-copy - hold the CMA buffer too so it can outlive the port
+    if (ppr != NULL && ppr->cbs != NULL) {
+        cma_buf_t ** const pcb = ppr_cb_slot(ppr, buf);
+        if (pcb != NULL)
+            ctx->cb = cma_buf_ref(*pcb);
+    }
+
     return &ctx->cmn;
 }
 
-// n is els
-typedef void piccpy_fn(void * dest, const void * src, size_t n);
-
-static void piccpy_10_to_8_c(void * dest, const void * src, size_t n)
+cma_buf_t * cma_buf_pic_get(picture_t * const pic)
 {
-    uint8_t * d = dest;
-    const uint16_t * s = src;
-    while (n-- != 0)
-        *d++ = *s++ >> 2;
+    pic_ctx_mmal_t * const ctx = (pic_ctx_mmal_t *)pic->context;
+
+    if (ctx == NULL || ctx->cmn.destroy != hw_mmal_pic_ctx_destroy)
+        return NULL;
+    return ctx->cb;
 }
 
 // Do a stride converting copy - if the strides are the same and line_len is
@@ -449,22 +550,25 @@ static void mem_copy_2d(uint8_t * d_ptr, const size_t d_stride,
 }
 
 // line_len in D units
+// Truncates unless dither - the ordered dither depends on the line so no
+// block copy
 static void mem_copy_2d_10_to_8(uint8_t * d_ptr, const size_t d_stride,
                         const uint8_t * s_ptr, const size_t s_stride,
-                        size_t lines, const size_t line_len)
+                        const size_t lines, const size_t line_len,
+                        const bool dither)
 {
-    piccpy_fn * const docpy = piccpy_10_to_8_c;
-    if (s_stride == d_stride * 2 && d_stride < line_len + 32)
+    if (!dither && s_stride == d_stride * 2 && d_stride < line_len + 32)
     {
-        docpy(d_ptr, s_ptr, d_stride * lines);
+        hw_mmal_piccpy_10_to_8(d_ptr, (const uint16_t *)s_ptr,
+                               d_stride * lines, 0);
+        return;
     }
-    else
-    {
-        while (lines-- != 0) {
-            docpy(d_ptr, s_ptr, line_len);
-            d_ptr += d_stride;
-            s_ptr += s_stride;
-        }
+
+    for (size_t y = 0; y != lines; ++y) {
+        hw_mmal_piccpy_10_to_8(d_ptr, (const uint16_t *)s_ptr, line_len,
+                               dither ? hw_mmal_piccpy_dither(0, y) : 0);
+        d_ptr += d_stride;
+        s_ptr += s_stride;
     }
 }
 
@@ -473,7 +577,7 @@ int hw_mmal_copy_pic_to_buf(void * const buf_data,
                             uint32_t * const pLength,
                             const MMAL_ES_FORMAT_T * const fmt,
                             const picture_t * const pic,
-                            bool is_cma)
+                            bool is_cma, bool dither)
 {
     const MMAL_VIDEO_FORMAT_T *const video = &fmt->es->video;
     uint8_t * const dest = buf_data;
@@ -515,23 +619,54 @@ int hw_mmal_copy_pic_to_buf(void * const buf_data,
             mem_copy_2d_10_to_8(dest, video->width,
                  pic->p[0].p_pixels, pic->p[0].i_pitch,
                  video->crop.height,
-                 video->crop.width);
+                 video->crop.width, dither);
 
             mem_copy_2d_10_to_8(dest + y_size, video->width / 2,
                  pic->p[1].p_pixels, pic->p[1].i_pitch,
                  video->crop.height / 2,
-                 video->crop.width / 2);
+                 video->crop.width / 2, dither);
 
             mem_copy_2d_10_to_8(dest + y_size + y_size / 4, video->width / 2,
                  pic->p[2].p_pixels, pic->p[2].i_pitch,
                  video->crop.height / 2,
-                 video->crop.width / 2);
+                 video->crop.width / 2, dither);
 
             // And make sure it is actually in memory
             length = y_size + y_size / 2;
             break;
         }
 
+        case VLC_CODEC_MMAL_ZC_SAND8:
+        case VLC_CODEC_MMAL_ZC_SAND30:
+        {
+            // Zero-copy decoder output: p[0] is the start of the luma
+            // columns, p[1] the chroma & i_pitch the column height
+            const size_t y_size = video->width * video->height;
+            const unsigned int stride2 = pic->p[0].i_pitch;
+
+            if (pic->format.i_chroma == VLC_CODEC_MMAL_ZC_SAND8) {
+                hw_mmal_sand8_to_y8(dest, video->width,
+                     pic->p[0].p_pixels, stride2,
+                     0, 0, video->crop.width, video->crop.height);
+                hw_mmal_sand8_to_c8(dest + y_size, video->width / 2,
+                     dest + y_size + y_size / 4, video->width / 2,
+                     pic->p[1].p_pixels, stride2,
+                     0, 0, video->crop.width / 2, video->crop.height / 2);
+            }
+            else {
+                hw_mmal_sand30_to_y8(dest, video->width,
+                     pic->p[0].p_pixels, stride2,
+                     0, 0, video->crop.width, video->crop.height, dither);
+                hw_mmal_sand30_to_c8(dest + y_size, video->width / 2,
+                     dest + y_size + y_size / 4, video->width / 2,
+                     pic->p[1].p_pixels, stride2,
+                     0, 0, video->crop.width / 2, video->crop.height / 2, dither);
+            }
+
+            length = y_size + y_size / 2;
+            break;
+        }
+
         default:
             if (pLength != NULL)
                 *pLength = 0;
@@ -604,7 +739,7 @@ MMAL_BUFFER_HEADER_T * hw_mmal_pic_buf_copied(const picture_t *const pic,
                                               MMAL_POOL_T * const rep_pool,
                                               MMAL_PORT_T * const port,
                                               cma_buf_pool_t * const cbp,
-                                              bool is_cma)
+                                              bool is_cma, bool dither)
 {
     MMAL_BUFFER_HEADER_T *const buf = mmal_queue_wait(rep_pool->queue);
     if (buf == NULL)
@@ -619,7 +754,8 @@ MMAL_BUFFER_HEADER_T * hw_mmal_pic_buf_copied(const picture_t *const pic,
 
     pic_to_buf_copy_props(buf, pic);
 
-    if (hw_mmal_copy_pic_to_buf(cma_buf_addr(cb), &buf->length, port->format, pic, is_cma) != VLC_SUCCESS)
+    if (hw_mmal_copy_pic_to_buf(cma_buf_addr(cb), &buf->length, port->format, pic,
+                                is_cma, dither) != VLC_SUCCESS)
         goto fail2;
     buf->flags = MMAL_BUFFER_HEADER_FLAG_FRAME_END;
 
@@ -29,6 +29,7 @@
 #include <interface/mmal/mmal.h>
 
 #include "mmal_cma.h"
+#include "mmal_cma_pic.h"
 
 /* Think twice before changing this. Incorrect values cause havoc. */
 #define NUM_ACTUAL_OPAQUE_BUFFERS 30
@@ -42,9 +43,10 @@ void hw_mmal_vlc_fmt_to_mmal_fmt(MMAL_ES_FORMAT_T *const es_fmt, const video_fra
 bool hw_mmal_vlc_pic_to_mmal_fmt_update(MMAL_ES_FORMAT_T *const es_fmt, const picture_t * const pic);
 
 // Copy pic contents into an existing buffer
+// 10 bit sources are truncated to 8 bits, or ordered dithered if dither is set
 int hw_mmal_copy_pic_to_buf(void * const buf_data, uint32_t * const pLength,
                             const MMAL_ES_FORMAT_T * const fmt, const picture_t * const pic,
-                            bool is_cma);
+                            bool is_cma, bool dither);
 
 //----------------------------------------------------------------------------
 
@@ -58,6 +60,14 @@ MMAL_STATUS_T hw_mmal_opaque_output(vlc_object_t * const obj,
                                     hw_mmal_port_pool_ref_t ** pppr,
                                     MMAL_PORT_T * const port,
                                     const unsigned int extra_buffers, MMAL_PORT_BH_CB_T callback);
+// As hw_mmal_opaque_output but each header is backed by a CMA buffer so
+// the decoded pixels can be exported (dmabuf) without a copy
+MMAL_STATUS_T hw_mmal_zc_output(vlc_object_t * const obj,
+                                hw_mmal_port_pool_ref_t ** pppr,
+                                MMAL_PORT_T * const port,
+                                const MMAL_FOURCC_T encoding,
+                                const unsigned int extra_buffers, MMAL_PORT_BH_CB_T callback,
+                                bool is_cma);
 
 MMAL_BUFFER_HEADER_T * hw_mmal_pic_sub_buf_get(picture_t * const pic, const unsigned int n);
 
@@ -107,7 +117,7 @@ MMAL_BUFFER_HEADER_T * hw_mmal_pic_buf_copied(const picture_t *const pic,
                                               MMAL_POOL_T * const rep_pool,
                                               MMAL_PORT_T * const port,
                                               cma_buf_pool_t * const cbp,
-                                              bool is_cma);
+                                              bool is_cma, bool dither);
 
 MMAL_BUFFER_HEADER_T * hw_mmal_pic_buf_replicated(const picture_t *const pic, MMAL_POOL_T * const rep_pool);
 
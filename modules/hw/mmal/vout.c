@@ -54,6 +54,12 @@
 #define MMAL_ADJUST_REFRESHRATE_NAME "mmal-adjust-refreshrate"
 #define MMAL_ADJUST_REFRESHRATE_TEXT N_("Adjust HDMI refresh rate to the video.")
 
+#define MMAL_DITHER_NAME "mmal-dither"
+#define MMAL_DITHER_TEXT N_("Dither 10 bit video copied to 8 bit.")
+#define MMAL_DITHER_LONGTEXT N_("Use an ordered dither instead of truncating " \
+        "10 bit video copied to 8 bit for the display, which hides banding " \
+        "at some CPU cost.")
+
 #define MMAL_NATIVE_INTERLACED "mmal-native-interlaced"
 #define MMAL_NATIVE_INTERLACE_TEXT N_("Force interlaced HDMI mode.")
 #define MMAL_NATIVE_INTERLACE_LONGTEXT N_("Force the HDMI output into an " \
@@ -81,6 +87,7 @@ vlc_module_begin()
                     MMAL_NATIVE_INTERLACE_LONGTEXT)
     add_string(MMAL_DISPLAY_NAME, "auto", MMAL_DISPLAY_TEXT,
                     MMAL_DISPLAY_LONGTEXT)
+    add_bool(MMAL_DITHER_NAME, false, MMAL_DITHER_TEXT, MMAL_DITHER_LONGTEXT)
     set_callback_display(OpenMmalVout, 16)  // 1 point better than ASCII art
 vlc_module_end()
 
@@ -117,6 +124,7 @@ typedef struct vout_display_sys_t {
     bool need_configure_display; /* indicates a required display reconfigure to main thread */
     bool adjust_refresh_rate;
     bool native_interlaced;
+    bool dither;
     bool b_top_field_first; /* cached interlaced settings to detect changes for native mode */
     bool b_progressive;
     bool force_config;
@@ -151,9 +159,17 @@ static bool want_copy(const video_format_t * const fmt)
     return (fmt->i_chroma == VLC_CODEC_I420 || fmt->i_chroma == VLC_CODEC_I420_10L);
 }
 
+// Pics whose buffers we can pass straight to the renderer
+static bool chroma_is_mmal_buf(const vlc_fourcc_t chroma)
+{
+    return hw_mmal_chroma_is_mmal(chroma) ||
+        chroma == VLC_CODEC_MMAL_ZC_I420 ||
+        chroma == VLC_CODEC_MMAL_ZC_SAND8;
+}
+
 static vlc_fourcc_t req_chroma(const video_format_t * const fmt)
 {
-    return hw_mmal_chroma_is_mmal(fmt->i_chroma) || want_copy(fmt) ?
+    return chroma_is_mmal_buf(fmt->i_chroma) || want_copy(fmt) ?
         fmt->i_chroma : VLC_CODEC_I420;
 }
 
@@ -162,7 +178,10 @@ static MMAL_FOURCC_T vout_vlc_to_mmal_pic_fourcc(const unsigned int fcc)
     switch (fcc){
     case VLC_CODEC_MMAL_OPAQUE:
         return MMAL_ENCODING_OPAQUE;
+    case VLC_CODEC_MMAL_ZC_SAND8:
+        return MMAL_ENCODING_YUVUV128;
     case VLC_CODEC_I420:
+    case VLC_CODEC_MMAL_ZC_I420:
         return MMAL_ENCODING_I420;
     default:
         break;
@@ -815,7 +834,7 @@ static void vd_prepare(vout_display_t *vd, picture_t *p_pic,
         // Copy 2d
         mmal_decoder_device_t *devsys = GetMMALDeviceOpaque(sys->dec_dev);
         hw_mmal_copy_pic_to_buf(buf->data, &buf->length, sys->input->format, p_pic,
-                                devsys->is_cma);
+                                devsys->is_cma, sys->dither);
         buf->flags = MMAL_BUFFER_HEADER_FLAG_FRAME_END;
 
         sys->copy_buf = buf;
@@ -1086,7 +1105,7 @@ static int OpenMmalVout(vout_display_t *vd,
     MMAL_STATUS_T status;
     int ret = VLC_EGENERIC;
     // At the moment all copy is via I420
-    const bool needs_copy = !hw_mmal_chroma_is_mmal(vd->source->i_chroma);
+    const bool needs_copy = !chroma_is_mmal_buf(vd->source->i_chroma);
     const MMAL_FOURCC_T enc_in = needs_copy ? MMAL_ENCODING_I420 :
         vout_vlc_to_mmal_pic_fourcc(vd->source->i_chroma);
 
@@ -1120,6 +1139,7 @@ static int OpenMmalVout(vout_display_t *vd,
     vc_tv_register_callback(tvservice_cb, vd);
 
     sys->layer = var_InheritInteger(vd, MMAL_LAYER_NAME);
+    sys->dither = var_InheritBool(vd, MMAL_DITHER_NAME);
 
     {
         const char *display_name = var_InheritString(vd, MMAL_DISPLAY_NAME);
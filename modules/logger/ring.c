@@ -0,0 +1,463 @@
+/*****************************************************************************
+ * ring.c: binary ring buffer tracer plugin
+ *****************************************************************************
+ * Copyright © 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Unlike the JSON tracer, this tracer does not format anything on the
+ * calling thread. Each thread copies its traces as fixed-size binary records
+ * into its own single-producer single-consumer ring, without locking. A
+ * background thread periodically drains all rings into the output file.
+ * If a ring is full, the trace is dropped and counted, rather than blocking
+ * the caller.
+ *
+ * Records keep vlc_tick_t values on the traced thread. They are converted
+ * to microseconds by the background thread, as they are written out.
+ *
+ * The file starts with a struct ring_file_header followed by records, in
+ * native byte order. extras/misc/trace2chrome.py converts it to the Chrome
+ * trace event JSON format, as read by Perfetto and chrome://tracing.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_fs.h>
+#include <vlc_tracer.h>
+
+#include <stdatomic.h>
+#include <errno.h>
+#include <assert.h>
+
+#define RING_FILENAME "vlc-trace.bin"
+#define RING_MAGIC "VLCTRACE"
+#define RING_VERSION 2
+
+#define RING_RECORD_SIZE 128
+#define RING_FLUSH_PERIOD VLC_TICK_FROM_MS(100)
+
+/* Record flags */
+#define RING_RECORD_TRUNCATED 0x1 /* Some entries did not fit */
+#define RING_RECORD_DROPPED   0x2 /* Count of records lost by the thread */
+
+struct ring_file_header
+{
+    char magic[8];
+    uint16_t byte_order; /* 0x0102 in native byte order */
+    uint16_t version;
+    uint32_t record_size;
+};
+
+/*
+ * The payload is a sequence of entries, each made of:
+ * - the entry type (enum vlc_tracer_value) as one byte,
+ * - the key length as one byte, then the key (without nul terminator),
+ * - an int64_t value (microseconds for ticks in the file), or for strings,
+ *   the length as
+ *   one byte then the string (without nul terminator).
+ */
+struct ring_record
+{
+    int64_t ts; /* vlc_tick_t in rings, microseconds in the file */
+    uint32_t tid;
+    uint16_t length; /* Bytes used in the payload */
+    uint16_t flags;
+    uint8_t payload[RING_RECORD_SIZE - 16];
+};
+
+static_assert(sizeof (struct ring_record) == RING_RECORD_SIZE,
+              "Unexpected record padding");
+
+struct ring
+{
+    struct ring *next; /* Protected by the tracer lock */
+    atomic_uint head; /* Written by the traced thread */
+    atomic_uint tail; /* Written by the flush thread */
+    atomic_uint dropped;
+    atomic_bool orphan; /* The traced thread has exited */
+    unsigned long tid;
+    struct ring_record records[];
+};
+
+typedef struct
+{
+    FILE *stream;
+    unsigned mask; /* Records per ring minus one */
+    vlc_threadvar_t key;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    struct ring *rings;
+    bool stop;
+    vlc_thread_t thread;
+} vlc_tracer_sys_t;
+
+static struct ring *RingGet(vlc_tracer_sys_t *sys)
+{
+    struct ring *ring = vlc_threadvar_get(sys->key);
+    if (likely(ring != NULL))
+        return ring;
+
+    ring = malloc(sizeof (*ring)
+                  + (sys->mask + 1) * sizeof (ring->records[0]));
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->dropped, 0);
+    atomic_init(&ring->orphan, false);
+    ring->tid = vlc_thread_id();
+
+    if (vlc_threadvar_set(sys->key, ring))
+    {
+        free(ring);
+        return NULL;
+    }
+
+    vlc_mutex_lock(&sys->lock);
+    ring->next = sys->rings;
+    sys->rings = ring;
+    vlc_mutex_unlock(&sys->lock);
+    return ring;
+}
+
+static void RingRelease(void *data)
+{
+    struct ring *ring = data;
+
+    /* Called on thread exit: the flush thread will free the ring. */
+    atomic_store(&ring->orphan, true);
+}
+
+static size_t RecordPutEntry(uint8_t *p, size_t avail,
+                             const struct vlc_tracer_entry *entry)
+{
+    size_t keylen = strnlen(entry->key, UINT8_MAX);
+    size_t len = 2 + keylen;
+    int64_t value = 0;
+    size_t vallen = 0;
+
+    switch (entry->type)
+    {
+        case VLC_TRACER_INT:
+            value = entry->value.integer;
+            len += sizeof (value);
+            break;
+        case VLC_TRACER_TICK:
+            value = entry->value.tick;
+            len += sizeof (value);
+            break;
+        case VLC_TRACER_STRING:
+            if (entry->value.string != NULL)
+                vallen = strnlen(entry->value.string, UINT8_MAX);
+            len += 1 + vallen;
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+
+    if (len > avail)
+        return 0;
+
+    *(p++) = entry->type;
+    *(p++) = keylen;
+    memcpy(p, entry->key, keylen);
+    p += keylen;
+
+    if (entry->type == VLC_TRACER_STRING)
+    {
+        *(p++) = vallen;
+        memcpy(p, entry->value.string, vallen);
+    }
+    else
+        memcpy(p, &value, sizeof (value));
+    return len;
+}
+
+static void TraceRing(void *opaque, vlc_tick_t ts, va_list entries)
+{
+    vlc_tracer_sys_t *sys = opaque;
+    struct ring *ring = RingGet(sys);
+    if (unlikely(ring == NULL))
+        return;
+
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail > sys->mask)
+    {   /* Full: never wait for the flush thread */
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    struct ring_record *rec = &ring->records[head & sys->mask];
+    size_t offset = 0;
+
+    rec->ts = ts;
+    rec->tid = ring->tid;
+    rec->flags = 0;
+
+    struct vlc_tracer_entry entry = va_arg(entries, struct vlc_tracer_entry);
+    while (entry.key != NULL)
+    {
+        size_t len = RecordPutEntry(rec->payload + offset,
+                                    sizeof (rec->payload) - offset, &entry);
+        if (len == 0)
+            rec->flags |= RING_RECORD_TRUNCATED;
+        offset += len;
+        entry = va_arg(entries, struct vlc_tracer_entry);
+    }
+    rec->length = offset;
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+static void RingWrite(vlc_tracer_sys_t *sys, const struct ring_record *recs,
+                      size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        struct ring_record rec = recs[i];
+
+        /* Convert the ticks to microseconds */
+        rec.ts = US_FROM_VLC_TICK(rec.ts);
+        for (size_t off = 0; off + 2 <= rec.length;)
+        {
+            uint8_t type = rec.payload[off];
+            uint8_t *p = rec.payload + off + 2 + rec.payload[off + 1];
+
+            if (type == VLC_TRACER_STRING)
+            {
+                off = p + 1 + p[0] - rec.payload;
+                continue;
+            }
+            if (type == VLC_TRACER_TICK)
+            {
+                int64_t value;
+
+                memcpy(&value, p, sizeof (value));
+                value = US_FROM_VLC_TICK(value);
+                memcpy(p, &value, sizeof (value));
+            }
+            off = p + sizeof (int64_t) - rec.payload;
+        }
+
+        if (fwrite(&rec, sizeof (rec), 1, sys->stream) != 1)
+            clearerr(sys->stream); /* Keep tracing: the disk may free up. */
+    }
+}
+
+static void RingDrain(vlc_tracer_sys_t *sys, struct ring *ring)
+{
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    unsigned dropped = atomic_exchange_explicit(&ring->dropped, 0,
+                                                memory_order_relaxed);
+
+    if (head != tail)
+    {
+        unsigned start = tail & sys->mask;
+        unsigned count = head - tail;
+
+        if (start + count > sys->mask + 1)
+        {   /* Wrapped around */
+            unsigned first = sys->mask + 1 - start;
+
+            RingWrite(sys, &ring->records[start], first);
+            RingWrite(sys, &ring->records[0], count - first);
+        }
+        else
+            RingWrite(sys, &ring->records[start], count);
+
+        atomic_store_explicit(&ring->tail, head, memory_order_release);
+    }
+
+    if (dropped > 0)
+    {
+        struct ring_record rec = {
+            .ts = vlc_tick_now(),
+            .tid = ring->tid,
+            .flags = RING_RECORD_DROPPED,
+        };
+        struct vlc_tracer_entry entry = {
+            .key = "dropped",
+            .value = { .integer = dropped },
+            .type = VLC_TRACER_INT,
+        };
+
+        rec.length = RecordPutEntry(rec.payload, sizeof (rec.payload),
+                                    &entry);
+        RingWrite(sys, &rec, 1);
+    }
+}
+
+/* Must be called with the lock held */
+static void RingFlush(vlc_tracer_sys_t *sys)
+{
+    for (struct ring **pp = &sys->rings; *pp != NULL;)
+    {
+        struct ring *ring = *pp;
+        /* Check before draining so that the last traces are not missed. */
+        bool orphan = atomic_load(&ring->orphan);
+
+        RingDrain(sys, ring);
+
+        if (orphan)
+        {
+            *pp = ring->next;
+            free(ring);
+        }
+        else
+            pp = &ring->next;
+    }
+    fflush(sys->stream);
+}
+
+static void *Thread(void *data)
+{
+    vlc_tracer_sys_t *sys = data;
+    vlc_tick_t deadline = vlc_tick_now();
+
+    vlc_thread_set_name("vlc-tracer");
+
+    vlc_mutex_lock(&sys->lock);
+    while (!sys->stop)
+    {
+        deadline += RING_FLUSH_PERIOD;
+        while (!sys->stop
+            && vlc_cond_timedwait(&sys->wait, &sys->lock, deadline) == 0);
+
+        RingFlush(sys);
+    }
+    vlc_mutex_unlock(&sys->lock);
+    return NULL;
+}
+
+static void Close(void *opaque)
+{
+    vlc_tracer_sys_t *sys = opaque;
+
+    vlc_mutex_lock(&sys->lock);
+    sys->stop = true;
+    vlc_cond_signal(&sys->wait);
+    vlc_mutex_unlock(&sys->lock);
+    vlc_join(sys->thread, NULL);
+
+    /* The thread flushed everything on exit; rings of live threads remain. */
+    vlc_threadvar_delete(&sys->key);
+    while (sys->rings != NULL)
+    {
+        struct ring *ring = sys->rings;
+
+        sys->rings = ring->next;
+        free(ring);
+    }
+
+    fclose(sys->stream);
+    free(sys);
+}
+
+static const struct vlc_tracer_operations ring_ops =
+{
+    TraceRing,
+    Close
+};
+
+static const struct vlc_tracer_operations *Open(vlc_object_t *obj,
+                                               void **restrict sysp)
+{
+    vlc_tracer_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+
+    /* Round the ring size up to a power of two */
+    unsigned records = var_InheritInteger(obj, "ring-tracer-records");
+    unsigned order = 4;
+    while ((1u << order) < records && order < 20)
+        order++;
+    sys->mask = (1u << order) - 1;
+
+    char *path = var_InheritString(obj, "ring-tracer-file");
+    const char *filename = (path != NULL) ? path : RING_FILENAME;
+
+    msg_Dbg(obj, "opening trace file `%s'", filename);
+    sys->stream = vlc_fopen(filename, "wb");
+    if (sys->stream == NULL)
+    {
+        msg_Err(obj, "error opening trace file `%s': %s", filename,
+                vlc_strerror_c(errno));
+        free(path);
+        free(sys);
+        return NULL;
+    }
+    free(path);
+
+    struct ring_file_header hdr = {
+        .magic = RING_MAGIC,
+        .byte_order = 0x0102,
+        .version = RING_VERSION,
+        .record_size = RING_RECORD_SIZE,
+    };
+    static_assert(sizeof (hdr.magic) == sizeof (RING_MAGIC) - 1, "Bad magic");
+
+    if (fwrite(&hdr, sizeof (hdr), 1, sys->stream) != 1
+     || vlc_threadvar_create(&sys->key, RingRelease))
+        goto error;
+
+    vlc_mutex_init(&sys->lock);
+    vlc_cond_init(&sys->wait);
+    sys->rings = NULL;
+    sys->stop = false;
+
+    if (vlc_clone(&sys->thread, Thread, sys))
+    {
+        vlc_threadvar_delete(&sys->key);
+        goto error;
+    }
+
+    *sysp = sys;
+    return &ring_ops;
+
+error:
+    fclose(sys->stream);
+    free(sys);
+    return NULL;
+}
+
+#define FILE_TEXT N_("Trace filename")
+#define FILE_LONGTEXT N_("Specify the binary trace filename.")
+#define RECORDS_TEXT N_("Records per thread")
+#define RECORDS_LONGTEXT N_("Number of traces that each thread can buffer " \
+    "between two flushes. Traces beyond that are dropped.")
+
+vlc_module_begin()
+    set_shortname(N_("Ring tracer"))
+    set_description(N_("Binary ring buffer tracer"))
+    set_subcategory(SUBCAT_ADVANCED_MISC)
+    set_capability("tracer", 0)
+    set_callback(Open)
+    add_shortcut("ring")
+
+    add_savefile("ring-tracer-file", NULL, FILE_TEXT, FILE_LONGTEXT)
+    add_integer("ring-tracer-records", 1024, RECORDS_TEXT, RECORDS_LONGTEXT)
+        change_integer_range(16, 1 << 20)
+vlc_module_end()
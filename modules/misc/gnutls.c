@@ -42,11 +42,32 @@
 #include <gnutls/gnutls.h>
 #include <gnutls/x509.h>
 
+/** Maximum number of client sessions kept for resumption */
+#define VLC_GNUTLS_RESUME_MAX 16
+
+/**
+ * Client-side TLS credentials private data
+ */
+typedef struct vlc_tls_client_sys
+{
+    gnutls_certificate_credentials_t x509;
+    vlc_mutex_t lock;
+    unsigned resume_count;
+    struct
+    {
+        char *host;
+        gnutls_datum_t data;
+    } resume[VLC_GNUTLS_RESUME_MAX]; /**< Most recent first */
+} vlc_tls_client_sys_t;
+
 typedef struct vlc_tls_gnutls
 {
     vlc_tls_t tls;
     gnutls_session_t session;
     vlc_object_t *obj;
+    vlc_tls_client_sys_t *client; /**< Client credentials (or NULL) */
+    char *host; /**< Server name (or NULL) */
+    bool resumable; /**< Whether the session can be saved for resumption */
 } vlc_tls_gnutls_t;
 
 static void gnutls_Banner(vlc_object_t *obj)
@@ -127,6 +148,68 @@ static ssize_t vlc_gnutls_writev(gnutls_transport_ptr_t ptr,
     return sock->ops->writev(sock, iov, iovcnt);
 }
 
+/**
+ * Saves the parameters of a client session, so that later connections to
+ * the same server can resume it with an abbreviated handshake.
+ */
+static void gnutls_SessionSave(vlc_tls_gnutls_t *priv)
+{
+    vlc_tls_client_sys_t *sys = priv->client;
+    gnutls_datum_t data;
+
+    assert(sys != NULL && priv->host != NULL);
+    priv->resumable = false;
+
+    if (gnutls_session_get_data2(priv->session, &data))
+        return;
+
+    char *host = strdup(priv->host);
+    if (unlikely(host == NULL))
+    {
+        gnutls_free(data.data);
+        return;
+    }
+
+    vlc_mutex_lock(&sys->lock);
+
+    unsigned i = 0;
+    while (i < sys->resume_count && strcmp(sys->resume[i].host, host))
+        i++;
+
+    if (i == VLC_GNUTLS_RESUME_MAX)
+        i--; /* full: evict the least recently saved */
+    if (i < sys->resume_count)
+    {
+        free(sys->resume[i].host);
+        gnutls_free(sys->resume[i].data.data);
+    }
+    else
+        sys->resume_count++;
+
+    memmove(sys->resume + 1, sys->resume, i * sizeof (sys->resume[0]));
+    sys->resume[0].host = host;
+    sys->resume[0].data = data;
+    vlc_mutex_unlock(&sys->lock);
+}
+
+/**
+ * Sets the parameters of the last session with the server, if any.
+ */
+static void gnutls_SessionRestore(vlc_tls_gnutls_t *priv)
+{
+    vlc_tls_client_sys_t *sys = priv->client;
+
+    vlc_mutex_lock(&sys->lock);
+    for (unsigned i = 0; i < sys->resume_count; i++)
+        if (!strcmp(sys->resume[i].host, priv->host))
+        {
+            gnutls_session_set_data(priv->session, sys->resume[i].data.data,
+                                    sys->resume[i].data.size);
+            break;
+        }
+    vlc_mutex_unlock(&sys->lock);
+}
+
 static int gnutls_GetFD(vlc_tls_t *tls, short *restrict events)
 {
     vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
@@ -156,6 +239,12 @@ static ssize_t gnutls_Recv(vlc_tls_t *tls, struct iovec *iov, unsigned count)
         count--;
     }
 
+#if GNUTLS_VERSION_NUMBER >= 0x030603
+    /* TLS 1.3 session tickets are received after the handshake. */
+    if (priv->resumable
+     && (gnutls_session_get_flags(session) & GNUTLS_SFLAGS_SESSION_TICKET))
+        gnutls_SessionSave(priv);
+#endif
     return rcvd;
 }
 
@@ -208,6 +297,7 @@ static void gnutls_Close (vlc_tls_t *tls)
     vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
 
     gnutls_deinit(priv->session);
+    free(priv->host);
     free(priv);
 }
 
@@ -295,6 +385,9 @@ static vlc_tls_gnutls_t *gnutls_SessionOpen(vlc_object_t *obj, int type,
 
     priv->session = session;
     priv->obj = obj;
+    priv->client = NULL;
+    priv->host = NULL;
+    priv->resumable = false;
 
     vlc_tls_t *tls = &priv->tls;
 
@@ -352,6 +445,8 @@ static int gnutls_Handshake(vlc_tls_t *tls, char **restrict alp)
         msg_Dbg(obj, " - encrypt then MAC (RFC7366) enabled");
     if (flags & GNUTLS_SFLAGS_FALSE_START)
         msg_Dbg(obj, " - false start (RFC7918) enabled");
+    if (gnutls_session_is_resumed(session))
+        msg_Dbg(obj, " - session resumed");
 
     if (alp != NULL)
     {
@@ -377,8 +472,9 @@ static vlc_tls_t *gnutls_ClientSessionOpen(vlc_tls_client_t *crd,
                                            vlc_tls_t *sk, const char *hostname,
                                            const char *const *alpn)
 {
+    vlc_tls_client_sys_t *sys = crd->sys;
     vlc_tls_gnutls_t *priv = gnutls_SessionOpen(VLC_OBJECT(crd), GNUTLS_CLIENT,
-                                                crd->sys, sk, alpn);
+                                                sys->x509, sk, alpn);
     if (priv == NULL)
         return NULL;
 
@@ -388,10 +484,17 @@ static vlc_tls_t *gnutls_ClientSessionOpen(vlc_tls_client_t *crd,
     gnutls_dh_set_prime_bits (session, 1024);
 
     if (likely(hostname != NULL))
+    {
         /* fill Server Name Indication */
         gnutls_server_name_set (session, GNUTLS_NAME_DNS,
                                 hostname, strlen (hostname));
 
+        priv->client = sys;
+        priv->host = strdup(hostname);
+        if (likely(priv->host != NULL))
+            gnutls_SessionRestore(priv);
+    }
+
     return &priv->tls;
 }
 
@@ -419,7 +522,17 @@ static int gnutls_ClientHandshake(vlc_tls_t *tls,
     }
 
     if (status == 0) /* Good certificate */
+    {
+        if (priv->host != NULL)
+        {
+            priv->resumable = true;
+#if GNUTLS_VERSION_NUMBER >= 0x030603
+            if (gnutls_protocol_get_version(session) < GNUTLS_TLS1_3)
+#endif
+                gnutls_SessionSave(priv);
+        }
         return 0;
+    }
 
     /* Bad certificate */
     gnutls_datum_t desc;
@@ -531,9 +644,15 @@ error:
 
 static void gnutls_ClientDestroy(vlc_tls_client_t *crd)
 {
-    gnutls_certificate_credentials_t x509 = crd->sys;
+    vlc_tls_client_sys_t *sys = crd->sys;
 
-    gnutls_certificate_free_credentials(x509);
+    for (unsigned i = 0; i < sys->resume_count; i++)
+    {
+        free(sys->resume[i].host);
+        gnutls_free(sys->resume[i].data.data);
+    }
+    gnutls_certificate_free_credentials(sys->x509);
+    free(sys);
 }
 
 static const struct vlc_tls_client_operations gnutls_ClientOps =
@@ -586,8 +705,19 @@ static int OpenClient(vlc_tls_client_t *crd)
     gnutls_certificate_set_verify_flags (x509,
                                          GNUTLS_VERIFY_ALLOW_X509_V1_CA_CRT);
 
+    vlc_tls_client_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+    {
+        gnutls_certificate_free_credentials(x509);
+        return VLC_ENOMEM;
+    }
+
+    sys->x509 = x509;
+    vlc_mutex_init(&sys->lock);
+    sys->resume_count = 0;
+
     crd->ops = &gnutls_ClientOps;
-    crd->sys = x509;
+    crd->sys = sys;
     return VLC_SUCCESS;
 }
 
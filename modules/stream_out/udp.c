@@ -29,6 +29,12 @@
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+#ifdef __linux__
+#include <netinet/udp.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_block.h>
@@ -39,6 +45,11 @@
 #include <vlc_memstream.h>
 #include "sdp_helper.h"
 
+/* Maximum number of datagrams handed to the kernel at once */
+#define UDP_BATCH 64
+/* Maximum number of blocks gathered into a single datagram */
+#define UDP_GATHER 16
+
 struct sout_stream_udp
 {
     sout_access_out_t *access;
@@ -46,6 +57,22 @@ struct sout_stream_udp
     session_descriptor_t *sap;
     int fd;
     uint_fast16_t mtu;
+    bool batch;
+    bool gso;
+
+    struct {
+        uint64_t datagrams;
+        uint64_t calls;
+        vlc_tick_t first;
+        vlc_tick_t last;
+    } stats;
+};
+
+struct udp_datagram
+{
+    struct iovec *iov;
+    unsigned iovlen;
+    size_t length;
 };
 
 static void *Add(sout_stream_t *stream, const es_format_t *fmt)
@@ -145,39 +172,206 @@ static int Control(sout_stream_t *stream, int query, va_list args)
     return VLC_SUCCESS;
 }
 
+static void SendStatsUpdate(struct sout_stream_udp *sys, unsigned datagrams)
+{
+    vlc_tick_t now = vlc_tick_now();
+
+    if (sys->stats.first == VLC_TICK_INVALID)
+        sys->stats.first = now;
+    sys->stats.last = now;
+    sys->stats.datagrams += datagrams;
+    sys->stats.calls++;
+}
+
+/**
+ * Sends one datagram per call.
+ */
+static ssize_t SendSingle(sout_access_out_t *access,
+                          const struct udp_datagram *dgrams, unsigned count)
+{
+    struct sout_stream_udp *sys = access->p_sys;
+    ssize_t total = 0;
+
+    for (unsigned i = 0; i < count; i++) {
+        struct msghdr hdr = {
+            .msg_iov = dgrams[i].iov,
+            .msg_iovlen = dgrams[i].iovlen,
+        };
+        ssize_t val = sendmsg(sys->fd, &hdr, 0);
+
+        SendStatsUpdate(sys, 1);
+        if (val < 0)
+            msg_Err(access, "send error: %s", vlc_strerror_c(errno));
+        else
+            total += val;
+    }
+    return total;
+}
+
+#ifdef UDP_SEGMENT
+/**
+ * Sends runs of equally-sized datagrams as single buffers, and lets the
+ * kernel (or the network interface) segment them.
+ */
+static ssize_t SendSegmented(sout_access_out_t *access,
+                             const struct udp_datagram *dgrams, unsigned count)
+{
+    struct sout_stream_udp *sys = access->p_sys;
+    ssize_t total = 0;
+
+    for (unsigned i = 0; i < count;) {
+        const size_t segsize = dgrams[i].length;
+        size_t length = segsize;
+        unsigned n = 1;
+
+        /* All segments but the last must have the same size, and the
+         * last one can't be larger: the run ends after a shorter one */
+        while (i + n < count && dgrams[i + n - 1].length == segsize
+            && dgrams[i + n].length <= segsize
+            && length + dgrams[i + n].length <= 65507) {
+            length += dgrams[i + n].length;
+            n++;
+        }
+
+        if (n == 1) {
+            total += SendSingle(access, dgrams + i, 1);
+            i++;
+            continue;
+        }
+
+        union {
+            char buf[CMSG_SPACE(sizeof (uint16_t))];
+            struct cmsghdr align;
+        } control;
+        struct msghdr hdr = {
+            .msg_iov = dgrams[i].iov,
+            /* iovecs of consecutive datagrams are contiguous */
+            .msg_iovlen = (dgrams[i + n - 1].iov + dgrams[i + n - 1].iovlen)
+                          - dgrams[i].iov,
+            .msg_control = control.buf,
+            .msg_controllen = sizeof (control.buf),
+        };
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr);
+
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof (uint16_t));
+        *(uint16_t *)CMSG_DATA(cmsg) = segsize;
+
+        ssize_t val = sendmsg(sys->fd, &hdr, 0);
+
+        SendStatsUpdate(sys, n);
+        if (val < 0) {
+            if (errno == EIO || errno == EINVAL) {
+                /* Segmentation offload not usable on this route */
+                msg_Warn(access, "UDP segmentation offload failed: %s",
+                         vlc_strerror_c(errno));
+                sys->gso = false;
+                return total + SendSingle(access, dgrams + i, count - i);
+            }
+            msg_Err(access, "send error: %s", vlc_strerror_c(errno));
+        } else
+            total += val;
+        i += n;
+    }
+    return total;
+}
+#endif
+
+#ifdef HAVE_SENDMMSG
+/**
+ * Sends many datagrams with a single call.
+ */
+static ssize_t SendBatch(sout_access_out_t *access,
+                         const struct udp_datagram *dgrams, unsigned count)
+{
+    struct sout_stream_udp *sys = access->p_sys;
+    struct mmsghdr msgs[UDP_BATCH];
+    ssize_t total = 0;
+
+    memset(msgs, 0, count * sizeof (*msgs));
+
+    for (unsigned i = 0; i < count; i++) {
+        msgs[i].msg_hdr.msg_iov = dgrams[i].iov;
+        msgs[i].msg_hdr.msg_iovlen = dgrams[i].iovlen;
+    }
+
+    for (unsigned i = 0; i < count;) {
+        int val = sendmmsg(sys->fd, msgs + i, count - i, 0);
+
+        SendStatsUpdate(sys, val > 0 ? val : 0);
+        if (val <= 0) {
+            /* Report the error, and skip the offending datagram */
+            msg_Err(access, "send error: %s", vlc_strerror_c(errno));
+            i++;
+            continue;
+        }
+
+        for (int j = 0; j < val; j++)
+            total += msgs[i + j].msg_len;
+        i += val;
+    }
+    return total;
+}
+#endif
+
+static ssize_t SendDatagrams(sout_access_out_t *access,
+                             const struct udp_datagram *dgrams, unsigned count)
+{
+    struct sout_stream_udp *sys = access->p_sys;
+
+    if (count == 0)
+        return 0;
+#ifdef UDP_SEGMENT
+    if (sys->gso)
+        return SendSegmented(access, dgrams, count);
+#endif
+#ifdef HAVE_SENDMMSG
+    if (sys->batch)
+        return SendBatch(access, dgrams, count);
+#endif
+    return SendSingle(access, dgrams, count);
+}
+
 static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
 {
     struct sout_stream_udp *sys = access->p_sys;
+    const unsigned maxcount = sys->batch ? UDP_BATCH : 1;
     ssize_t total = 0;
 
     while (block != NULL) {
-        struct iovec iov[16];
+        struct iovec iov[UDP_BATCH * UDP_GATHER];
+        struct udp_datagram dgrams[UDP_BATCH];
         block_t *unsent = block;
         unsigned iovlen = 0;
-        size_t tosend = 0;
-
-        /* Count how many blocks to gather */
-        do {
-            if (iovlen >= ARRAY_SIZE(iov))
-                break;
-            if (unsent->i_buffer + tosend > sys->mtu && likely(iovlen > 0))
-                break;
-
-            iov[iovlen].iov_base = unsent->p_buffer;
-            iov[iovlen].iov_len = unsent->i_buffer;
-            iovlen++;
-            tosend += unsent->i_buffer;
-            unsent = unsent->p_next;
-        } while (unsent != NULL);
+        unsigned count = 0;
+
+        /* Split the chain into datagrams, gathering blocks up to the MTU */
+        while (unsent != NULL && count < maxcount) {
+            struct udp_datagram *dgram = &dgrams[count++];
+
+            dgram->iov = iov + iovlen;
+            dgram->iovlen = 0;
+            dgram->length = 0;
+
+            do {
+                if (dgram->iovlen >= UDP_GATHER)
+                    break;
+                if (unsent->i_buffer + dgram->length > sys->mtu
+                 && likely(dgram->iovlen > 0))
+                    break;
+
+                iov[iovlen].iov_base = unsent->p_buffer;
+                iov[iovlen].iov_len = unsent->i_buffer;
+                iovlen++;
+                dgram->iovlen++;
+                dgram->length += unsent->i_buffer;
+                unsent = unsent->p_next;
+            } while (unsent != NULL);
+        }
 
         /* Send */
-        struct msghdr hdr = { .msg_iov = iov, .msg_iovlen = iovlen };
-        int val = sendmsg(sys->fd, &hdr, 0);
-
-        if (val < 0)
-            msg_Err(access, "send error: %s", vlc_strerror_c(errno));
-        else
-            total += val;
+        total += SendDatagrams(access, dgrams, count);
 
         /* Free */
         do {
@@ -200,6 +394,17 @@ static void Close(vlc_object_t *obj)
         sout_AnnounceUnRegister(stream, sys->sap);
 
     sout_MuxDelete(sys->mux);
+
+    if (sys->stats.calls > 0) {
+        vlc_tick_t duration = sys->stats.last - sys->stats.first;
+        double secs = duration > 0 ? secf_from_vlc_tick(duration) : 1.;
+
+        msg_Dbg(stream, "sent %"PRIu64" datagrams with %"PRIu64" system calls"
+                " (%.1f calls/s, %.2f datagrams per call)",
+                sys->stats.datagrams, sys->stats.calls,
+                sys->stats.calls / secs,
+                (double)sys->stats.datagrams / sys->stats.calls);
+    }
     sout_AccessOutDelete(sys->access);
     net_Close(sys->fd);
     free(sys);
@@ -210,7 +415,7 @@ static const struct sout_stream_operations ops = {
 };
 
 static const char *const chain_options[] = {
-    "avformat", "dst", "sap", "name", "description", NULL
+    "avformat", "dst", "sap", "name", "description", "batch", NULL
 };
 
 #define DEFAULT_PORT 1234
@@ -308,6 +513,18 @@ static int Open(vlc_object_t *obj)
     sys->access = access;
     sys->fd = fd;
     sys->mtu = var_InheritInteger(stream, "mtu");
+    sys->batch = var_GetBool(stream, SOUT_CFG_PREFIX "batch");
+    sys->gso = false;
+#ifdef UDP_SEGMENT
+    /* Probe for kernel support, the size is passed with each send call. */
+    if (sys->batch
+     && setsockopt(fd, SOL_UDP, UDP_SEGMENT, &(int){ 0 }, sizeof (int)) == 0)
+        sys->gso = true;
+#endif
+    sys->stats.datagrams = 0;
+    sys->stats.calls = 0;
+    sys->stats.first = VLC_TICK_INVALID;
+    sys->stats.last = VLC_TICK_INVALID;
 
     sout_mux_t *mux = sout_MuxNew(access, muxmod);
     if (mux == NULL) {
@@ -340,6 +557,10 @@ error:
     "Destination address and port (colon-separated) for the stream.")
 #define SAP_TEXT N_("SAP announcement")
 #define SAP_LONGTEXT N_("Announce this stream as a session with SAP.")
+#define BATCH_TEXT N_("Batch datagrams")
+#define BATCH_LONGTEXT N_( \
+    "Send multiple datagrams per system call, using segmentation offload " \
+    "if available.")
 #define NAME_TEXT N_("SAP name")
 #define NAME_LONGTEXT N_( \
     "Name of the stream that will be announced with SAP.")
@@ -359,6 +580,7 @@ vlc_module_begin()
     add_bool(SOUT_CFG_PREFIX "sap", false, SAP_TEXT, SAP_LONGTEXT)
     add_string(SOUT_CFG_PREFIX "name", "", NAME_TEXT, NAME_LONGTEXT)
     add_string(SOUT_CFG_PREFIX "description", "", DESC_TEXT, DESC_LONGTEXT)
+    add_bool(SOUT_CFG_PREFIX "batch", true, BATCH_TEXT, BATCH_LONGTEXT)
 
     set_callbacks(Open, Close)
 vlc_module_end()
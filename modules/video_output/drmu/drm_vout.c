@@ -27,6 +27,7 @@
 #endif
 
 #include <errno.h>
+#include <limits.h>
 #include <pthread.h>
 
 #include "drmu.h"
@@ -52,6 +53,17 @@
  Defaults to the 'preferred' mode if no good enough match found. \
  If unset then resolution & refresh will not be set.")
 
+#define DRM_VOUT_RATE_MODESET_NAME "drm-vout-rate-modeset"
+#define DRM_VOUT_RATE_MODESET_TEXT N_("Attempt to match display refresh rate to source")
+#define DRM_VOUT_RATE_MODESET_LONGTEXT N_("Keep the display resolution but switch to the lowest refresh rate\
+ that is a multiple of the source frame rate, fractional rates (23.976, 59.94) included.\
+ The original mode is restored on close. Ignored if a mode is set by other flags.")
+
+#define DRM_VOUT_MODESET_DELAY_NAME "drm-vout-modeset-delay"
+#define DRM_VOUT_MODESET_DELAY_TEXT N_("Mode switch delay (ms)")
+#define DRM_VOUT_MODESET_DELAY_LONGTEXT N_("Time to wait after a mode switch before displaying\
+ anything, for displays that take a while to lock onto a new mode.")
+
 #define DRM_VOUT_MODE_NAME "drm-vout-mode"
 #define DRM_VOUT_MODE_TEXT N_("Set this mode for display")
 #define DRM_VOUT_MODE_LONGTEXT N_("arg: <w>x<h>@<hz> Force mode to arg")
@@ -70,6 +82,8 @@
 #define TRACE_ALL 0
 
 #define SUBPICS_MAX 4
+// Max regions we take from a subpicture list - any more are dropped
+#define SUBPIC_REGIONS_MAX 32
 
 #define DRM_MODULE "vc4"
 
@@ -81,6 +95,13 @@ typedef struct subpic_ent_s {
     int alpha;
 } subpic_ent_t;
 
+// Region composed into the shared ARGB plane
+typedef struct subpic_composed_s {
+    picture_t * pic;
+    int x, y;
+    int alpha;
+} subpic_composed_t;
+
 typedef struct vout_display_sys_t {
     vlc_decoder_device *dec_dev;
 
@@ -90,8 +111,13 @@ typedef struct vout_display_sys_t {
     drmu_pool_t * pic_pool;
     drmu_pool_t * sub_fb_pool;
     drmu_plane_t * subplanes[SUBPICS_MAX];
+    unsigned int subplane_n;
     subpic_ent_t subpics[SUBPICS_MAX];
     vlc_fourcc_t * subpic_chromas;
+    // Regions composed into the top subplane when there are too few planes
+    subpic_composed_t composed[SUBPIC_REGIONS_MAX];
+    unsigned int composed_n;
+    bool compose_warned;
 
     drmu_atomic_t * display_set;
 
@@ -126,6 +152,227 @@ copy_pic_to_fb(vout_display_t *vd, drmu_pool_t * const pool, picture_t * const s
     return fb;
 }
 
+static void
+subpic_ent_clear(subpic_ent_t * const spe)
+{
+    if (spe->pic != NULL) {
+        picture_Release(spe->pic);
+        spe->pic = NULL;
+    }
+    drmu_fb_unref(&spe->fb);
+}
+
+static void
+subpic_composed_clear(vout_display_sys_t * const sys)
+{
+    for (unsigned int i = 0; i != sys->composed_n; ++i)
+        picture_Release(sys->composed[i].pic);
+    sys->composed_n = 0;
+}
+
+// Give a region a plane of its own
+static void
+subpic_set_region(vout_display_t * const vd, subpic_ent_t * const dst,
+                  const subpicture_t * const spic, const subpicture_region_t * const sreg)
+{
+    vout_display_sys_t * const sys = vd->sys;
+    picture_t * const src = sreg->p_picture;
+
+    // If the same picture then assume the same contents
+    // We keep a ref to the previous pic to ensure that teh same picture
+    // structure doesn't get reused and confuse us.
+    if (src != dst->pic) {
+        subpic_ent_clear(dst);
+
+        dst->fb = copy_pic_to_fb(vd, sys->sub_fb_pool, src);
+        if (dst->fb == NULL)
+            return;
+        drmu_fb_pixel_blend_mode_set(dst->fb, DRMU_FB_PIXEL_BLEND_COVERAGE);
+
+        dst->pic = picture_Hold(src);
+    }
+
+    // *** More transform required
+    dst->pos = (drmu_rect_t){
+        .x = sreg->i_x,
+        .y = sreg->i_y,
+        .w = src->format.i_visible_width,
+        .h = src->format.i_visible_height,
+    };
+    dst->alpha = spic->i_alpha;
+
+//    msg_Info(vd, "Orig: %dx%d", spic->i_original_picture_width, spic->i_original_picture_height);
+    dst->space = drmu_rect_wh(spic->i_original_picture_width, spic->i_original_picture_height);
+}
+
+// Subpic chromas that can be composed: packed 8-bit RGB with alpha
+// Gets the byte offsets of R, G, B & A in a pixel
+// (drmu has no planar YUVA and VUYA is not offered to the blender)
+static bool
+compose_chroma_offsets(const vlc_fourcc_t fcc, unsigned int off[4])
+{
+    switch (fcc) {
+        case VLC_CODEC_RGBA:
+            off[0] = 0, off[1] = 1, off[2] = 2, off[3] = 3;
+            return true;
+        case VLC_CODEC_BGRA:
+            off[0] = 2, off[1] = 1, off[2] = 0, off[3] = 3;
+            return true;
+        case VLC_CODEC_ARGB:
+            off[0] = 1, off[1] = 2, off[2] = 3, off[3] = 0;
+            return true;
+        case VLC_CODEC_ABGR:
+            off[0] = 3, off[1] = 2, off[2] = 1, off[3] = 0;
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
+
+// Blend src over dst (non-premultiplied), converting the channel order
+static void
+compose_over(const plane_t * const dst, const unsigned int * const doff,
+             const picture_t * const src, const unsigned int * const soff,
+             const int x, const int y, const unsigned int alpha)
+{
+    const video_format_t * const fmt = &src->format;
+
+    for (unsigned int j = 0; j != fmt->i_visible_height; ++j) {
+        uint8_t * d = dst->p_pixels + (y + j) * dst->i_pitch + x * 4;
+        const uint8_t * s = src->p[0].p_pixels + (fmt->i_y_offset + j) * src->p[0].i_pitch +
+            fmt->i_x_offset * 4;
+
+        for (unsigned int i = 0; i != fmt->i_visible_width; ++i, d += 4, s += 4) {
+            const unsigned int sa = s[soff[3]] * alpha / 255;
+            const unsigned int da = d[doff[3]] * (255 - sa) / 255;
+            const unsigned int oa = sa + da;
+
+            if (sa == 0)
+                continue;
+            for (unsigned int c = 0; c != 3; ++c)
+                d[doff[c]] = (s[soff[c]] * sa + d[doff[c]] * da + oa / 2) / oa;
+            d[doff[3]] = oa;
+        }
+    }
+}
+
+// Compose regions into a single plane in the chroma of the 1st one
+// Regions in another RGB order are converted, regions that cannot be
+// composed or are in another space are dropped
+static void
+subpic_set_composed(vout_display_t * const vd, subpic_ent_t * const dst,
+                    subpicture_t * const * const spics, subpicture_region_t * const * const sregs,
+                    const unsigned int n)
+{
+    vout_display_sys_t * const sys = vd->sys;
+    const video_format_t * const fmt0 = &sregs[0]->p_picture->format;
+    const drmu_rect_t space = drmu_rect_wh(spics[0]->i_original_picture_width, spics[0]->i_original_picture_height);
+    subpic_composed_t comp[SUBPIC_REGIONS_MAX];
+    unsigned int comp_n = 0;
+    unsigned int off0[4];
+    bool dropped = false;
+    int x0 = INT_MAX, y0 = INT_MAX, x1 = INT_MIN, y1 = INT_MIN;
+
+    if (!compose_chroma_offsets(fmt0->i_chroma, off0)) {
+        if (!sys->compose_warned)
+            msg_Warn(vd, "Cannot compose subpicture chroma %4.4s - extra regions dropped",
+                     (const char *)&fmt0->i_chroma);
+        sys->compose_warned = true;
+        subpic_set_region(vd, dst, spics[0], sregs[0]);
+        return;
+    }
+
+    for (unsigned int i = 0; i != n; ++i) {
+        const subpicture_region_t * const sreg = sregs[i];
+        const video_format_t * const fmt = &sreg->p_picture->format;
+        unsigned int off[4];
+
+        if (!compose_chroma_offsets(fmt->i_chroma, off) ||
+            spics[i]->i_original_picture_width != space.w ||
+            spics[i]->i_original_picture_height != space.h) {
+            if (!sys->compose_warned)
+                msg_Warn(vd, "Cannot compose subpicture region %4.4s %dx%d with %4.4s %dx%d - dropped",
+                         (const char *)&fmt->i_chroma,
+                         spics[i]->i_original_picture_width, spics[i]->i_original_picture_height,
+                         (const char *)&fmt0->i_chroma, space.w, space.h);
+            dropped = true;
+            continue;
+        }
+
+        comp[comp_n++] = (subpic_composed_t){
+            .pic = sreg->p_picture,
+            .x = sreg->i_x,
+            .y = sreg->i_y,
+            .alpha = spics[i]->i_alpha
+        };
+        x0 = __MIN(x0, sreg->i_x);
+        y0 = __MIN(y0, sreg->i_y);
+        x1 = __MAX(x1, sreg->i_x + (int)fmt->i_visible_width);
+        y1 = __MAX(y1, sreg->i_y + (int)fmt->i_visible_height);
+    }
+    sys->compose_warned |= dropped;
+
+    // Nothing changed?
+    if (dst->fb != NULL && dst->pic == NULL && comp_n == sys->composed_n) {
+        unsigned int i;
+        for (i = 0; i != comp_n; ++i) {
+            const subpic_composed_t * const c = sys->composed + i;
+            if (c->pic != comp[i].pic || c->x != comp[i].x || c->y != comp[i].y ||
+                c->alpha != comp[i].alpha)
+                break;
+        }
+        if (i == comp_n)
+            return;
+    }
+
+    subpic_ent_clear(dst);
+    subpic_composed_clear(sys);
+
+    if (x1 <= x0 || y1 <= y0)
+        return;
+
+    {
+        video_format_t fmt = *fmt0;
+        plane_t plane;
+
+        fmt.i_width = fmt.i_visible_width = x1 - x0;
+        fmt.i_height = fmt.i_visible_height = y1 - y0;
+        fmt.i_x_offset = fmt.i_y_offset = 0;
+
+        if ((dst->fb = drmu_pool_fb_new_dumb(sys->sub_fb_pool, fmt.i_width, fmt.i_height,
+                                             drmu_format_vlc_to_drm(&fmt))) == NULL) {
+            msg_Warn(vd, "Failed alloc for composed subpic: %dx%d", fmt.i_width, fmt.i_height);
+            return;
+        }
+        drmu_fb_pixel_blend_mode_set(dst->fb, DRMU_FB_PIXEL_BLEND_COVERAGE);
+
+        plane = drmu_fb_vlc_plane(dst->fb, 0);
+        for (int j = 0; j != plane.i_lines; ++j)
+            memset(plane.p_pixels + j * plane.i_pitch, 0, plane.i_visible_pitch);
+
+        for (unsigned int i = 0; i != comp_n; ++i) {
+            unsigned int off[4];
+            compose_chroma_offsets(comp[i].pic->format.i_chroma, off);
+            compose_over(&plane, off0, comp[i].pic, off, comp[i].x - x0, comp[i].y - y0,
+                         comp[i].alpha);
+        }
+    }
+
+    for (unsigned int i = 0; i != comp_n; ++i)
+        sys->composed[i] = (subpic_composed_t){
+            .pic = picture_Hold(comp[i].pic),
+            .x = comp[i].x,
+            .y = comp[i].y,
+            .alpha = comp[i].alpha
+        };
+    sys->composed_n = comp_n;
+
+    dst->pos = (drmu_rect_t){.x = x0, .y = y0, .w = x1 - x0, .h = y1 - y0};
+    dst->space = space;
+    dst->alpha = 0xff;
+}
+
 static void vd_drm_prepare(vout_display_t *vd, picture_t *pic,
                            subpicture_t *subpicture, vlc_tick_t date)
 {
@@ -153,62 +400,37 @@ static void vd_drm_prepare(vout_display_t *vd, picture_t *pic,
 
     // * Mode (currently) doesn't change whilst running so no need to set here
 
-    // Attempt to import the subpics
-    for (subpicture_t * spic = subpicture; spic != NULL; spic = spic->p_next)
+    // Allocate the subplanes to the regions, in order so that later regions
+    // are on top. If there are more regions than planes the last plane gets
+    // all the remaining regions composed into it.
     {
-        for (subpicture_region_t *sreg = spic->p_region; sreg != NULL; sreg = sreg->p_next) {
-            picture_t * const src = sreg->p_picture;
-            subpic_ent_t * const dst = sys->subpics + n;
-
-            // If we've run out of subplanes we could allocate - give up now
-            if (!sys->subplanes[n])
-                goto subpics_done;
-
-            // If the same picture then assume the same contents
-            // We keep a ref to the previous pic to ensure that teh same picture
-            // structure doesn't get reused and confuse us.
-            if (src != dst->pic) {
-                drmu_fb_unref(&dst->fb);
-                if (dst->pic != NULL) {
-                    picture_Release(dst->pic);
-                    dst->pic = NULL;
-                }
-
-                dst->fb = copy_pic_to_fb(vd, sys->sub_fb_pool, src);
-                if (dst->fb == NULL)
-                    continue;
-                drmu_fb_pixel_blend_mode_set(dst->fb, DRMU_FB_PIXEL_BLEND_COVERAGE);
-
-                dst->pic = picture_Hold(src);
+        subpicture_t * spics[SUBPIC_REGIONS_MAX];
+        subpicture_region_t * sregs[SUBPIC_REGIONS_MAX];
+        unsigned int nreg = 0;
+
+        for (subpicture_t * spic = subpicture; spic != NULL; spic = spic->p_next) {
+            for (subpicture_region_t *sreg = spic->p_region; sreg != NULL && nreg != SUBPIC_REGIONS_MAX; sreg = sreg->p_next) {
+                spics[nreg] = spic;
+                sregs[nreg++] = sreg;
             }
+        }
 
-            // *** More transform required
-            dst->pos = (drmu_rect_t){
-                .x = sreg->i_x,
-                .y = sreg->i_y,
-                .w = src->format.i_visible_width,
-                .h = src->format.i_visible_height,
-            };
-            dst->alpha = spic->i_alpha;
-
-//            msg_Info(vd, "Orig: %dx%d", spic->i_original_picture_width, spic->i_original_picture_height);
-            dst->space = drmu_rect_wh(spic->i_original_picture_width, spic->i_original_picture_height);
-
-            if (++n == SUBPICS_MAX)
-                goto subpics_done;
+        if (nreg <= sys->subplane_n) {
+            for (; n != nreg; ++n)
+                subpic_set_region(vd, sys->subpics + n, spics[n], sregs[n]);
+            subpic_composed_clear(sys);
+        }
+        else if (sys->subplane_n != 0) {
+            for (; n != sys->subplane_n - 1; ++n)
+                subpic_set_region(vd, sys->subpics + n, spics[n], sregs[n]);
+            subpic_set_composed(vd, sys->subpics + n, spics + n, sregs + n, nreg - n);
+            ++n;
         }
     }
-subpics_done:
 
     // Clear any other entries
-    for (; n != SUBPICS_MAX; ++n) {
-        subpic_ent_t * const dst = sys->subpics + n;
-        if (dst->pic != NULL) {
-            picture_Release(dst->pic);
-            dst->pic = NULL;
-        }
-        drmu_fb_unref(&dst->fb);
-    }
+    for (; n != SUBPICS_MAX; ++n)
+        subpic_ent_clear(sys->subpics + n);
 
     {
         vout_display_place_t place;
@@ -272,7 +494,15 @@ subpics_done:
         goto fail;
     }
 
-    for (i = 0; i != SUBPICS_MAX; ++i) {
+    {
+        drmu_plane_t * planes[SUBPICS_MAX + 1] = {sys->dp};
+
+        for (i = 0; i != sys->subplane_n; ++i)
+            planes[i + 1] = sys->subplanes[i];
+        drmu_atomic_add_planes_zpos(da, planes, sys->subplane_n + 1);
+    }
+
+    for (i = 0; i != sys->subplane_n; ++i) {
         subpic_ent_t * const spe = sys->subpics + i;
 
 //        msg_Info(vd, "pic=%dx%d @ %d,%d, r=%dx%d @ %d,%d, space=%dx%d @ %d,%d",
@@ -303,6 +533,15 @@ fail:
     drmu_atomic_unref(&da);
 }
 
+// Page flip completion - called on the drmu event thread
+static void vd_drm_flip_cb(void * v, unsigned int sequence, uint64_t time_us)
+{
+    vout_display_t * const vd = v;
+
+    // DRM event timestamps are CLOCK_MONOTONIC, as is vlc_tick_now()
+    vout_display_SendEventPresented(vd, VLC_TICK_FROM_US(time_us), sequence);
+}
+
 static void vd_drm_display(vout_display_t *vd, picture_t *p_pic)
 {
     vout_display_sys_t *const sys = vd->sys;
@@ -365,11 +604,12 @@ static void CloseDrmVout(vout_display_t *vd)
 
     for (i = 0; i != SUBPICS_MAX; ++i)
         drmu_plane_unref(sys->subplanes + i);
-    for (i = 0; i != SUBPICS_MAX; ++i) {
-        if (sys->subpics[i].pic != NULL)
-            picture_Release(sys->subpics[i].pic);
-        drmu_fb_unref(&sys->subpics[i].fb);
-    }
+    for (i = 0; i != SUBPICS_MAX; ++i)
+        subpic_ent_clear(sys->subpics + i);
+    subpic_composed_clear(sys);
+
+    if (sys->du != NULL)
+        drmu_env_flip_cb_set(sys->du, NULL, NULL);
 
     drmu_plane_unref(&sys->dp);
     drmu_output_unref(&sys->dout);
@@ -454,6 +694,41 @@ subpic_make_chromas_from_drm(const uint32_t * const drm_chromas, const unsigned
     return c;
 }
 
+// Switch mode now rather than on the 1st picture so that the display has
+// (hopefully) locked onto the new mode before the clock starts
+static void modeset_now(vout_display_t *vd)
+{
+    vout_display_sys_t * const sys = vd->sys;
+    const drmu_mode_simple_params_t cur = drmu_crtc_mode_simple_params(drmu_output_crtc(sys->dout));
+    const drmu_mode_simple_params_t * const mode = drmu_output_mode_simple_params(sys->dout);
+    drmu_atomic_t * da;
+    vlc_tick_t start;
+    int rv;
+
+    if (cur.width == mode->width && cur.height == mode->height &&
+        cur.hz_x_1000 == mode->hz_x_1000)
+        return;
+
+    if ((da = drmu_atomic_new(sys->du)) == NULL)
+        return;
+
+    start = vlc_tick_now();
+    if ((rv = drmu_atomic_add_output_props(da, sys->dout)) == 0)
+        rv = drmu_atomic_commit(da, DRM_MODE_ATOMIC_ALLOW_MODESET);
+    drmu_atomic_unref(&da);
+
+    if (rv != 0) {
+        // The old fb may not fit the new mode; the 1st picture will set it
+        msg_Dbg(vd, "Early mode switch failed: %s", strerror(-rv));
+        return;
+    }
+    msg_Info(vd, "Mode switch took %"PRId64" ms", MS_FROM_VLC_TICK(vlc_tick_now() - start));
+
+    const int delay = var_InheritInteger(vd, DRM_VOUT_MODESET_DELAY_NAME);
+    if (delay > 0)
+        vlc_tick_sleep(VLC_TICK_FROM_MS(delay));
+}
+
 static int OpenDrmVout(vout_display_t *vd,
                         video_format_t *fmtp, vlc_video_context *vctx)
 {
@@ -508,6 +783,7 @@ static int OpenDrmVout(vout_display_t *vd,
     }
 
     drmu_env_restore_enable(sys->du);
+    drmu_env_flip_cb_set(sys->du, vd_drm_flip_cb, vd);
 
     if ((sys->dout = drmu_output_new(sys->du)) == NULL) {
         msg_Err(vd, "Failed to allocate new drmu output");
@@ -531,16 +807,14 @@ static int OpenDrmVout(vout_display_t *vd,
     if ((sys->dp = drmu_output_plane_ref_primary(sys->dout)) == NULL)
         goto fail;
 
-    for (unsigned int i = 0; i != SUBPICS_MAX; ++i) {
-        if ((sys->subplanes[i] = drmu_output_plane_ref_other(sys->dout)) == NULL) {
-            msg_Warn(vd, "Cannot allocate subplane %d", i);
-            break;
-        }
-        if (sys->subpic_chromas == NULL) {
-            unsigned int n;
-            const uint32_t * const drm_chromas = drmu_plane_formats(sys->subplanes[i], &n);
-            sys->subpic_chromas = subpic_make_chromas_from_drm(drm_chromas, n);
-        }
+    sys->subplane_n = drmu_output_planes_ref_other(sys->dout, sys->subplanes, SUBPICS_MAX);
+    if (sys->subplane_n < SUBPICS_MAX)
+        msg_Warn(vd, "Only %u subplanes - more regions will be composed into one",
+                 sys->subplane_n);
+    if (sys->subplane_n != 0) {
+        unsigned int n;
+        const uint32_t * const drm_chromas = drmu_plane_formats(sys->subplanes[0], &n);
+        sys->subpic_chromas = subpic_make_chromas_from_drm(drm_chromas, n);
     }
     vd->info = (vout_display_info_t) {
 // We can scale but as it stands it looks like VLC is confused about coord
@@ -598,6 +872,41 @@ static int OpenDrmVout(vout_display_t *vd,
         }
     }
 
+    else if (var_InheritBool(vd, DRM_VOUT_RATE_MODESET_NAME) &&
+             fmtp->i_frame_rate != 0 && fmtp->i_frame_rate_base != 0) {
+        const drmu_mode_simple_params_t * const cur = drmu_output_mode_simple_params(sys->dout);
+        drmu_mode_pick_rate_params_t pick = {
+            .width = cur->width,
+            .height = cur->height,
+            .hz_x_1000 = cur->hz_x_1000,
+            .frame_hz_x_1000 = (unsigned int)(((uint64_t)fmtp->i_frame_rate * 1000) / fmtp->i_frame_rate_base),
+        };
+
+        sys->mode_id = drmu_output_mode_pick_simple(sys->dout, drmu_mode_pick_rate_cb, &pick);
+
+        if (sys->mode_id >= 0) {
+            const drmu_mode_simple_params_t * mode;
+
+            drmu_output_mode_id_set(sys->dout, sys->mode_id);
+            mode = drmu_output_mode_simple_params(sys->dout);
+            msg_Info(vd, "Mode %d: %dx%d@%d.%03d - source %d.%03d fps", sys->mode_id,
+                     mode->width, mode->height, mode->hz_x_1000 / 1000, mode->hz_x_1000 % 1000,
+                     pick.frame_hz_x_1000 / 1000, pick.frame_hz_x_1000 % 1000);
+        }
+    }
+
+    if (sys->mode_id >= 0 && !var_InheritBool(vd, DRM_VOUT_NO_MODESET_NAME))
+        modeset_now(vd);
+
+    {
+        // Seed the vout vblank grid; the flip events measure it from there
+        const drmu_mode_simple_params_t * const mode = drmu_output_mode_simple_params(sys->dout);
+        const vlc_tick_t period = mode->hz_x_1000 == 0 ? 0 :
+            vlc_tick_from_samples(1000, mode->hz_x_1000);
+        msg_Dbg(vd, "Vsync period: %"PRId64" us", US_FROM_VLC_TICK(period));
+        vout_display_SendEventRefreshPeriod(vd, period);
+    }
+
 #if 0
 #if HAS_DRMPRIME
     if (vd->fmt->i_chroma == VLC_CODEC_DRM_PRIME_OPAQUE) {
@@ -637,6 +946,9 @@ vlc_module_begin()
     set_subcategory(SUBCAT_VIDEO_VOUT)
 
     add_bool(DRM_VOUT_SOURCE_MODESET_NAME, false, DRM_VOUT_SOURCE_MODESET_TEXT, DRM_VOUT_SOURCE_MODESET_LONGTEXT)
+    add_bool(DRM_VOUT_RATE_MODESET_NAME,   false, DRM_VOUT_RATE_MODESET_TEXT, DRM_VOUT_RATE_MODESET_LONGTEXT)
+    add_integer(DRM_VOUT_MODESET_DELAY_NAME, 0, DRM_VOUT_MODESET_DELAY_TEXT, DRM_VOUT_MODESET_DELAY_LONGTEXT)
+        change_integer_range(0, 10000)
     add_bool(DRM_VOUT_NO_MODESET_NAME,     false, DRM_VOUT_NO_MODESET_TEXT, DRM_VOUT_NO_MODESET_LONGTEXT)
     add_bool(DRM_VOUT_NO_MAX_BPC,          false, DRM_VOUT_NO_MAX_BPC_TEXT, DRM_VOUT_NO_MAX_BPC_LONGTEXT)
     add_string(DRM_VOUT_MODE_NAME,         "none", DRM_VOUT_MODE_TEXT, DRM_VOUT_MODE_LONGTEXT)
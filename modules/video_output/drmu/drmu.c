@@ -935,7 +935,7 @@ drmu_bo_new_fd(drmu_env_t *const du, const int fd)
     pthread_mutex_lock(&boe->lock);
 
     if ((rv = drmu_ioctl(du, DRM_IOCTL_PRIME_FD_TO_HANDLE, &ph)) != 0) {
-        drmu_err(du, "Failed to convert fd %d to BO: %s", __func__, fd, strerror(-rv));
+        drmu_err(du, "Failed to convert fd %d to BO: %s", fd, strerror(-rv));
         goto unlock;
     }
 
@@ -2598,6 +2598,8 @@ typedef struct drmu_atomic_q_s {
     drmu_atomic_t * last_flip;
     unsigned int retry_count;
     struct polltask * retry_task;
+    drmu_env_flip_fn * flip_fn;
+    void * flip_v;
 } drmu_atomic_q_t;
 
 static void atomic_q_retry(drmu_atomic_q_t * const aq, drmu_env_t * const du);
@@ -2662,6 +2664,12 @@ atomic_q_retry(drmu_atomic_q_t * const aq, drmu_env_t * const du)
 
 // Called after an atomic commit has completed
 // not called on every vsync, so if we haven't committed anything this won't be called
+//
+// This is where the atomic that has stopped being scanned out is released,
+// and with it its fbs and the pictures they hold. An OUT_FENCE_PTR fence on
+// the commit would signal on the same vblank as this event, so waiting on
+// it would not free anything earlier, but would cost a sync_file fd and a
+// polltask per frame.
 static void
 drmu_atomic_page_flip_cb(int fd, unsigned int sequence, unsigned int tv_sec, unsigned int tv_usec, unsigned int crtc_id, void *user_data)
 {
@@ -2670,9 +2678,6 @@ drmu_atomic_page_flip_cb(int fd, unsigned int sequence, unsigned int tv_sec, uns
     drmu_atomic_q_t * const aq = env_atomic_q(du);
 
     (void)fd;
-    (void)sequence;
-    (void)tv_sec;
-    (void)tv_usec;
     (void)crtc_id;
 
     // At this point:
@@ -2693,6 +2698,10 @@ drmu_atomic_page_flip_cb(int fd, unsigned int sequence, unsigned int tv_sec, uns
     if (aq->next_flip != NULL)
         atomic_q_attempt_commit_next(aq);
 
+    // Called with the lock held so clearing the callback is synchronous
+    if (aq->flip_fn != NULL)
+        aq->flip_fn(aq->flip_v, sequence, (uint64_t)tv_sec * 1000000 + tv_usec);
+
     pthread_cond_broadcast(&aq->cond);
     pthread_mutex_unlock(&aq->lock);
 }
@@ -2758,6 +2767,17 @@ drmu_atomic_queue(drmu_atomic_t ** ppda)
     return atomic_q_queue(env_atomic_q(drmu_atomic_env(da)), da);
 }
 
+void
+drmu_env_flip_cb_set(drmu_env_t * const du, drmu_env_flip_fn * const fn, void * const v)
+{
+    drmu_atomic_q_t *const aq = env_atomic_q(du);
+
+    pthread_mutex_lock(&aq->lock);
+    aq->flip_fn = fn;
+    aq->flip_v = v;
+    pthread_mutex_unlock(&aq->lock);
+}
+
 int
 drmu_env_queue_wait(drmu_env_t * const du)
 {
@@ -2797,6 +2817,8 @@ atomic_q_init(drmu_atomic_q_t * const aq)
     pthread_condattr_t condattr;
 
     aq->next_flip = NULL;
+    aq->flip_fn = NULL;
+    aq->flip_v = NULL;
     pthread_mutex_init(&aq->lock, NULL);
 
     pthread_condattr_init(&condattr);
@@ -3061,6 +3083,7 @@ typedef struct drmu_plane_s {
         drmu_prop_bitmask_t * rotation;
         drmu_prop_range_t * chroma_siting_h;
         drmu_prop_range_t * chroma_siting_v;
+        drmu_prop_range_t * zpos;
     } pid;
     uint64_t rot_vals[8];
 
@@ -3097,6 +3120,30 @@ drmu_atomic_add_plane_alpha(struct drmu_atomic_s * const da, const drmu_plane_t
     return drmu_atomic_add_prop_range(da, dp->plane.plane_id, dp->pid.alpha, alpha);
 }
 
+bool
+drmu_plane_zpos_range(const drmu_plane_t * const dp, int * const pmin, int * const pmax)
+{
+    const drmu_prop_range_t * const pra = dp->pid.zpos;
+
+    if (pra == NULL || (pra->flags & DRM_MODE_PROP_IMMUTABLE) != 0)
+        return false;
+    *pmin = (int)drmu_prop_range_min(pra);
+    *pmax = (int)drmu_prop_range_max(pra);
+    return true;
+}
+
+int
+drmu_atomic_add_plane_zpos(struct drmu_atomic_s * const da, const drmu_plane_t * const dp, const int zpos)
+{
+    int zmin, zmax;
+
+    if (!drmu_plane_zpos_range(dp, &zmin, &zmax))
+        return -ENOENT;
+    if (zpos < zmin || zpos > zmax)
+        return -EINVAL;
+    return drmu_atomic_add_prop_range(da, dp->plane.plane_id, dp->pid.zpos, zpos);
+}
+
 int
 drmu_atomic_add_plane_rotation(struct drmu_atomic_s * const da, const drmu_plane_t * const dp, const int rot)
 {
@@ -3270,6 +3317,7 @@ plane_uninit(drmu_plane_t * const dp)
     drmu_prop_range_delete(&dp->pid.alpha);
     drmu_prop_range_delete(&dp->pid.chroma_siting_h);
     drmu_prop_range_delete(&dp->pid.chroma_siting_v);
+    drmu_prop_range_delete(&dp->pid.zpos);
     drmu_prop_enum_delete(&dp->pid.color_encoding);
     drmu_prop_enum_delete(&dp->pid.color_range);
     drmu_prop_enum_delete(&dp->pid.pixel_blend_mode);
@@ -3327,6 +3375,7 @@ plane_init(drmu_env_t * const du, drmu_plane_t * const dp, const uint32_t plane_
     dp->pid.rotation         = drmu_prop_enum_new(du, props_name_to_id(props, "rotation"));
     dp->pid.chroma_siting_h  = drmu_prop_range_new(du, props_name_to_id(props, "CHROMA_SITING_H"));
     dp->pid.chroma_siting_v  = drmu_prop_range_new(du, props_name_to_id(props, "CHROMA_SITING_V"));
+    dp->pid.zpos             = drmu_prop_range_new(du, props_name_to_id(props, "zpos"));
 
     dp->rot_vals[DRMU_PLANE_ROTATION_0] = drmu_prop_bitmask_value(dp->pid.rotation, "rotate-0");
     if (dp->rot_vals[DRMU_PLANE_ROTATION_0]) {
@@ -383,6 +383,12 @@ bool drmu_plane_format_check(const drmu_plane_t * const dp, const uint32_t forma
 #define DRMU_PLANE_ALPHA_OPAQUE                 0xffff
 int drmu_atomic_add_plane_alpha(struct drmu_atomic_s * const da, const drmu_plane_t * const dp, const int alpha);
 
+// Zpos: planes with a higher zpos are composed on top of lower ones
+// Returns false if the plane has no settable zpos
+bool drmu_plane_zpos_range(const drmu_plane_t * const dp, int * const pmin, int * const pmax);
+// -ENOENT if no settable zpos, -EINVAL if out of range
+int drmu_atomic_add_plane_zpos(struct drmu_atomic_s * const da, const drmu_plane_t * const dp, const int zpos);
+
 // X, Y & TRANSPOSE can be ORed to get all others
 #define DRMU_PLANE_ROTATION_0                   0
 #define DRMU_PLANE_ROTATION_X_FLIP              1
@@ -456,6 +462,14 @@ int drmu_atomic_queue(struct drmu_atomic_s ** ppda);
 // progress)
 int drmu_env_queue_wait(drmu_env_t * const du);
 
+// Called (on the event thread) when a queued commit has taken effect
+// sequence   vblank count of the flip
+// time_us    CLOCK_MONOTONIC time of the vblank in us
+typedef void drmu_env_flip_fn(void * v, unsigned int sequence, uint64_t time_us);
+// Set the flip callback, fn = NULL to clear it
+// Once cleared the callback is guaranteed not to be running or called again
+void drmu_env_flip_cb_set(drmu_env_t * const du, drmu_env_flip_fn * const fn, void * const v);
+
 // Do ioctl - returns -errno on error, 0 on success
 // deals with recalling the ioctl when required
 int drmu_ioctl(const drmu_env_t * const du, unsigned long req, void * arg);
@@ -2,6 +2,7 @@
 #include "drmu_log.h"
 
 #include <errno.h>
+#include <limits.h>
 #include <string.h>
 
 #include <libdrm/drm.h>
@@ -56,6 +57,43 @@ drmu_output_plane_ref_other(drmu_output_t * const dout)
     return dp;
 }
 
+unsigned int
+drmu_output_planes_ref_other(drmu_output_t * const dout, drmu_plane_t ** const planes, const unsigned int n)
+{
+    unsigned int i;
+    unsigned int j;
+
+    for (i = 0; i != n; ++i) {
+        if ((planes[i] = drmu_output_plane_ref_other(dout)) == NULL)
+            break;
+    }
+    for (j = i; j < n; ++j)
+        planes[j] = NULL;
+    return i;
+}
+
+int
+drmu_atomic_add_planes_zpos(drmu_atomic_t * const da, drmu_plane_t * const * const planes, const unsigned int n)
+{
+    int rv = 0;
+    int zpos = INT_MIN;
+    unsigned int i;
+
+    for (i = 0; i != n; ++i) {
+        int zmin, zmax;
+
+        if (planes[i] == NULL || !drmu_plane_zpos_range(planes[i], &zmin, &zmax))
+            continue;
+        zpos = (zpos == INT_MIN || zpos + 1 < zmin) ? zmin : zpos + 1;
+        if (zpos > zmax) {
+            rv = -EINVAL;
+            break;
+        }
+        rv = rvup(rv, drmu_atomic_add_plane_zpos(da, planes[i], zpos));
+    }
+    return rv;
+}
+
 int
 drmu_atomic_add_output_props(drmu_atomic_t * const da, drmu_output_t * const dout)
 {
@@ -174,6 +212,42 @@ drmu_mode_pick_simple_cb(void * v, const drmu_mode_simple_params_t * mode)
     return score;
 }
 
+int
+drmu_mode_pick_rate_cb(void * v, const drmu_mode_simple_params_t * mode)
+{
+    const drmu_mode_pick_rate_params_t * const p = v;
+
+    const int pref = (mode->type & DRM_MODE_TYPE_PREFERRED) != 0;
+    const unsigned int r_m = mode->hz_x_1000;
+    int score = -1;
+    unsigned int k;
+
+    if ((mode->flags & DRM_MODE_FLAG_INTERLACE) != 0 ||
+        p->width != mode->width || p->height != mode->height)
+        return -1;
+
+    // Within 0.02% tells 23.976 from 24, 0.2% still beats a 3:2 pulldown
+    // Lowest multiple first as that is the least work for the display
+    for (k = 1; p->frame_hz_x_1000 != 0 && k <= 8; ++k) {
+        const unsigned int r_f = p->frame_hz_x_1000 * k;
+        const unsigned int err = r_m > r_f ? r_m - r_f : r_f - r_m;
+        int s = -1;
+
+        if (err * 5000 <= r_f)
+            s = 100000000 - k * 1000000 - err;
+        else if (err * 500 <= r_f)
+            s = 50000000 - k * 1000000 - err;
+
+        if (s > score)
+            score = s;
+    }
+
+    if (score <= 0 && r_m + 10 >= p->hz_x_1000 && r_m <= p->hz_x_1000 + 10)
+        score = 10000000;
+
+    return score <= 0 ? score : score + pref;
+}
+
 int
 drmu_output_mode_pick_simple(drmu_output_t * const dout, drmu_mode_score_fn * const score_fn, void * const score_v)
 {
@@ -12,6 +12,13 @@ typedef struct drmu_output_s drmu_output_t;
 
 drmu_plane_t * drmu_output_plane_ref_primary(drmu_output_t * const dout);
 drmu_plane_t * drmu_output_plane_ref_other(drmu_output_t * const dout);
+// Ref up to n overlay (or cursor) planes for the output
+// Returns the number of planes reffed - the rest of planes[] is set to NULL
+unsigned int drmu_output_planes_ref_other(drmu_output_t * const dout, drmu_plane_t ** const planes, const unsigned int n);
+
+// Stack planes in the given order (planes[0] lowest) by setting zpos where
+// it can be set. Planes without a settable zpos keep their fixed order.
+int drmu_atomic_add_planes_zpos(drmu_atomic_t * const da, drmu_plane_t * const * const planes, const unsigned int n);
 
 // Add all props accumulated on the output to the atomic
 int drmu_atomic_add_output_props(drmu_atomic_t * const da, drmu_output_t * const dout);
@@ -33,6 +40,19 @@ int drmu_output_mode_pick_simple(drmu_output_t * const dout, drmu_mode_score_fn
 // If nothing "plausible" defaults to EDID preferred mode
 drmu_mode_score_fn drmu_mode_pick_simple_cb;
 
+typedef struct drmu_mode_pick_rate_params_s {
+    unsigned int width;
+    unsigned int height;
+    unsigned int hz_x_1000;        // Refresh rate to keep if nothing matches
+    unsigned int frame_hz_x_1000;  // Content frame rate * 1000
+} drmu_mode_pick_rate_params_t;
+
+// Refresh rate picker cb (v is a drmu_mode_pick_rate_params_t) - keeps
+// width / height and looks for the lowest refresh that is a multiple of
+// the frame rate, telling fractional (x1000/1001) rates from integer ones
+// If nothing plausible keeps the given refresh
+drmu_mode_score_fn drmu_mode_pick_rate_cb;
+
 // Allow fb max_bpc info to set the output mode (default false)
 int drmu_output_max_bpc_allow(drmu_output_t * const dout, const bool allow);
 
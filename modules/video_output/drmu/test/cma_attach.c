@@ -0,0 +1,243 @@
+/*****************************************************************************
+ * cma_attach.c: drmu MMAL zero-copy picture scanout test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Runs MMAL zero-copy pictures through drmu_fb_vlc_new_pic_cma_attach and
+ * commits the resulting fb to the primary plane. The CMA buffer accessors
+ * are mocked: the buffer is a dumb buffer exported as a dmabuf and the
+ * picture planes are laid out in it as the MMAL decoder lays them out in
+ * CMA. Checks the picture is held by the fb and released with it, and that
+ * HDR metadata is only attached to HDR pictures. Chromas the primary plane
+ * cannot scan out are skipped, as is the whole test if the vkms module is
+ * not loaded.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "../drmu_vlc.h"
+#include "../drmu_output.h"
+#include "../../../hw/mmal/mmal_cma_pic.h"
+
+#include <libdrm/drm.h>
+#include <libdrm/drm_mode.h>
+#include <libdrm/drm_fourcc.h>
+
+// CMA buffer mock - the parts of cma_buf_t drmu uses
+struct cma_buf_s {
+    int fd;
+    uint8_t * addr;
+};
+
+void * cma_buf_addr(const cma_buf_t * const cb)
+{
+    return cb->addr;
+}
+
+int cma_buf_fd(const cma_buf_t * const cb)
+{
+    return cb->fd;
+}
+
+cma_buf_t * cma_buf_pic_get(picture_t * const pic)
+{
+    return pic->p_sys;
+}
+
+static unsigned int pics_released;
+
+static void pic_destroy(picture_t * pic)
+{
+    VLC_UNUSED(pic);
+    ++pics_released;
+}
+
+static void log_cb(void * v, enum drmu_log_level_e level, const char * fmt, va_list vl)
+{
+    (void)v;
+    (void)level;
+    vfprintf(stderr, fmt, vl);
+}
+
+// Plane layout as zc_pic_set_planes in the MMAL decoder, with the dumb
+// buffer pitch standing in for the MMAL stride
+static unsigned int pic_layout(picture_resource_t * const res, const vlc_fourcc_t chroma,
+                               uint8_t * const base, const unsigned int pitch, const unsigned int h)
+{
+    switch (chroma) {
+        case VLC_CODEC_MMAL_ZC_I420:
+            res->p[0].p_pixels = base;
+            res->p[0].i_lines = h;
+            res->p[0].i_pitch = pitch;
+            res->p[1].p_pixels = base + pitch * h;
+            res->p[1].i_lines = h / 2;
+            res->p[1].i_pitch = pitch / 2;
+            res->p[2].p_pixels = res->p[1].p_pixels + pitch / 2 * h / 2;
+            res->p[2].i_lines = h / 2;
+            res->p[2].i_pitch = pitch / 2;
+            return 3;
+        case VLC_CODEC_MMAL_ZC_RGB32:
+            res->p[0].p_pixels = base;
+            res->p[0].i_lines = h;
+            res->p[0].i_pitch = pitch;
+            return 1;
+    }
+    return 0;
+}
+
+// 0 on success, 77 if the plane cannot scan out the chroma
+static int test_cma_attach(drmu_env_t * const du, drmu_output_t * const dout, drmu_plane_t * const dp,
+                           const vlc_fourcc_t chroma, const video_transfer_func_t transfer)
+{
+    const drmu_mode_simple_params_t * const mode = drmu_output_mode_simple_params(dout);
+    const bool is_yuv = chroma == VLC_CODEC_MMAL_ZC_I420;
+    struct drm_mode_create_dumb cd = {
+        .width = mode->width,
+        .height = is_yuv ? mode->height * 3 / 2 : mode->height,
+        .bpp = is_yuv ? 8 : 32
+    };
+    struct drm_prime_handle ph = {.fd = -1};
+    struct cma_buf_s cb = {.fd = -1, .addr = MAP_FAILED};
+    picture_resource_t res = {.p_sys = &cb, .pf_destroy = pic_destroy};
+    video_format_t fmt;
+    picture_t * pic;
+    drmu_fb_t * dfb;
+    drmu_atomic_t * da;
+    unsigned int planes;
+    int rv;
+
+    if (!drmu_plane_format_check(dp, drmu_format_vlc_to_drm_cma(chroma), 0)) {
+        fprintf(stderr, "%4.4s not supported by plane - skipping\n", (const char *)&chroma);
+        return 77;
+    }
+
+    rv = drmu_ioctl(du, DRM_IOCTL_MODE_CREATE_DUMB, &cd);
+    assert(rv == 0);
+    ph.handle = cd.handle;
+    ph.flags = DRM_CLOEXEC | DRM_RDWR;
+    rv = drmu_ioctl(du, DRM_IOCTL_PRIME_HANDLE_TO_FD, &ph);
+    assert(rv == 0);
+    cb.fd = ph.fd;
+    cb.addr = mmap(NULL, cd.size, PROT_READ | PROT_WRITE, MAP_SHARED, ph.fd, 0);
+    assert(cb.addr != MAP_FAILED);
+    memset(cb.addr, 0x80, cd.size);
+
+    video_format_Setup(&fmt, chroma, mode->width, mode->height,
+                       mode->width, mode->height, 1, 1);
+    fmt.transfer = transfer;
+    fmt.mastering.max_luminance = 10000000;
+    planes = pic_layout(&res, chroma, cb.addr, cd.pitch, mode->height);
+    pic = picture_NewFromResource(&fmt, &res);
+    assert(pic != NULL);
+    assert(pic->i_planes == (int)planes);
+
+    // The fb holds the pic, the CMA buffer is imported not copied
+    pics_released = 0;
+    dfb = drmu_fb_vlc_new_pic_cma_attach(du, pic);
+    assert(dfb != NULL);
+    picture_Release(pic);
+    assert(pics_released == 0);
+
+    for (unsigned int i = 0; i != planes; ++i)
+        assert(drmu_fb_pitch(dfb, i) == (uint32_t)res.p[i].i_pitch);
+    if (transfer == TRANSFER_FUNC_SMPTE_ST2084) {
+        assert(drmu_fb_hdr_metadata_isset(dfb) == DRMU_ISSET_SET);
+        assert(drmu_fb_hdr_metadata_get(dfb)->hdmi_metadata_type1.eotf == HDMI_EOTF_SMPTE_ST2084);
+    }
+    else {
+        assert(drmu_fb_hdr_metadata_isset(dfb) == DRMU_ISSET_NULL);
+    }
+
+    da = drmu_atomic_new(du);
+    assert(da != NULL);
+    drmu_atomic_conn_add_crtc(da, drmu_output_conn(dout, 0), drmu_output_crtc(dout));
+    drmu_atomic_crtc_add_active(da, drmu_output_crtc(dout), 1);
+    drmu_atomic_add_output_props(da, dout);
+    rv = drmu_atomic_plane_fb_set(da, dp, dfb, drmu_rect_wh(mode->width, mode->height));
+    assert(rv == 0);
+    if ((rv = drmu_atomic_commit(da, DRM_MODE_ATOMIC_ALLOW_MODESET)) != 0)
+        fprintf(stderr, "Commit %4.4s failed: %s\n", (const char *)&chroma, strerror(-rv));
+    assert(rv == 0);
+
+    // Released once the last fb ref goes
+    drmu_atomic_unref(&da);
+    drmu_fb_unref(&dfb);
+    assert(pics_released == 1);
+
+    munmap(cb.addr, cd.size);
+    close(ph.fd);
+    return 0;
+}
+
+int main(void)
+{
+    const drmu_log_env_t log = {
+        .fn = log_cb,
+        .v = NULL,
+        .max_level = DRMU_LOG_LEVEL_ERROR
+    };
+    static const struct {
+        vlc_fourcc_t chroma;
+        video_transfer_func_t transfer;
+    } cases[] = {
+        {VLC_CODEC_MMAL_ZC_I420, TRANSFER_FUNC_BT709},
+        {VLC_CODEC_MMAL_ZC_I420, TRANSFER_FUNC_SMPTE_ST2084},
+        {VLC_CODEC_MMAL_ZC_RGB32, TRANSFER_FUNC_SRGB},
+    };
+    drmu_env_t * du;
+    drmu_output_t * dout;
+    drmu_plane_t * dp;
+    int ret = 77;
+
+    if ((du = drmu_env_new_open("vkms", &log)) == NULL) {
+        fprintf(stderr, "vkms not available - skipping\n");
+        return 77;
+    }
+
+    dout = drmu_output_new(du);
+    assert(dout != NULL);
+    assert(drmu_output_add_output(dout, NULL) == 0);
+    drmu_output_modeset_allow(dout, true);
+    drmu_output_mode_id_set(dout,
+        drmu_output_mode_pick_simple(dout, drmu_mode_pick_simple_cb,
+                                     &(drmu_mode_simple_params_t){0}));
+    assert(drmu_output_mode_simple_params(dout)->width != 0);
+    dp = drmu_output_plane_ref_primary(dout);
+    assert(dp != NULL);
+
+    for (size_t i = 0; i != ARRAY_SIZE(cases); ++i) {
+        if (test_cma_attach(du, dout, dp, cases[i].chroma, cases[i].transfer) == 0)
+            ret = 0;
+    }
+
+    drmu_plane_unref(&dp);
+    drmu_output_unref(&dout);
+    drmu_env_delete(&du);
+    return ret;
+}
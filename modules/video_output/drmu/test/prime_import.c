@@ -0,0 +1,157 @@
+/*****************************************************************************
+ * prime_import.c: drmu dmabuf import & scanout test
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Checks that drmu can import a dmabuf as a BO, wrap it in an fb and commit
+ * it to the primary plane, as drmu_fb_vlc_new_pic_cma_attach does for MMAL
+ * zero-copy pictures (that function is tested with a mocked CMA picture in
+ * cma_attach.c). A dumb buffer exported as a dmabuf stands in for the CMA
+ * buffer and vkms stands in for the HVS. Skipped if the vkms module is not
+ * loaded.
+ */
+
+#include "../drmu.h"
+#include "../drmu_output.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <libdrm/drm.h>
+#include <libdrm/drm_mode.h>
+#include <libdrm/drm_fourcc.h>
+
+static void log_cb(void * v, enum drmu_log_level_e level, const char * fmt, va_list vl)
+{
+    (void)v;
+    (void)level;
+    vfprintf(stderr, fmt, vl);
+}
+
+int main(void)
+{
+    const drmu_log_env_t log = {
+        .fn = log_cb,
+        .v = NULL,
+        .max_level = DRMU_LOG_LEVEL_ERROR
+    };
+    drmu_env_t * du;
+    drmu_output_t * dout = NULL;
+    drmu_plane_t * dp = NULL;
+    drmu_fb_t * dfb = NULL;
+    drmu_atomic_t * da = NULL;
+    struct drm_mode_create_dumb cd = {0};
+    struct drm_prime_handle ph = {.fd = -1};
+    int ret = 1;
+    int rv;
+
+    if ((du = drmu_env_new_open("vkms", &log)) == NULL) {
+        fprintf(stderr, "vkms not available - skipping\n");
+        return 77;
+    }
+
+    if ((dout = drmu_output_new(du)) == NULL ||
+        drmu_output_add_output(dout, NULL) != 0)
+        goto fail;
+    drmu_output_modeset_allow(dout, true);
+    drmu_output_mode_id_set(dout,
+        drmu_output_mode_pick_simple(dout, drmu_mode_pick_simple_cb,
+                                     &(drmu_mode_simple_params_t){0}));
+
+    const drmu_mode_simple_params_t * const mode = drmu_output_mode_simple_params(dout);
+    if (mode->width == 0 || (dp = drmu_output_plane_ref_primary(dout)) == NULL)
+        goto fail;
+
+    // CMA stand-in: a dumb buffer exported as a dmabuf
+    cd.width = mode->width;
+    cd.height = mode->height;
+    cd.bpp = 32;
+    if ((rv = drmu_ioctl(du, DRM_IOCTL_MODE_CREATE_DUMB, &cd)) != 0) {
+        fprintf(stderr, "Create dumb failed: %s\n", strerror(-rv));
+        goto fail;
+    }
+    ph.handle = cd.handle;
+    ph.flags = DRM_CLOEXEC | DRM_RDWR;
+    if ((rv = drmu_ioctl(du, DRM_IOCTL_PRIME_HANDLE_TO_FD, &ph)) != 0) {
+        fprintf(stderr, "Export dmabuf failed: %s\n", strerror(-rv));
+        goto fail;
+    }
+
+    {
+        // Fill through the dmabuf mapping as a decoder writing to CMA would
+        uint32_t * const p = mmap(NULL, cd.size, PROT_READ | PROT_WRITE, MAP_SHARED, ph.fd, 0);
+        if (p != MAP_FAILED) {
+            for (size_t i = 0; i != cd.size / 4; ++i)
+                p[i] = 0xff2060a0;
+            munmap(p, cd.size);
+        }
+    }
+
+    // Same sequence as drmu_fb_vlc_new_pic_cma_attach
+    if ((dfb = drmu_fb_int_alloc(du)) == NULL)
+        goto fail;
+    drmu_fb_int_fmt_size_set(dfb, DRM_FORMAT_XRGB8888, cd.width, cd.height,
+                             drmu_rect_wh(cd.width, cd.height));
+    {
+        drmu_bo_t * const bo = drmu_bo_new_fd(du, ph.fd);
+        if (bo == NULL) {
+            drmu_fb_int_free(dfb);
+            dfb = NULL;
+            goto fail;
+        }
+        drmu_fb_int_bo_set(dfb, 0, bo);
+    }
+    drmu_fb_int_layer_set(dfb, 0, 0, cd.pitch, 0);
+    if (drmu_fb_int_make(dfb) != 0) {
+        drmu_fb_int_free(dfb);
+        dfb = NULL;
+        fprintf(stderr, "Failed to make fb from dmabuf\n");
+        goto fail;
+    }
+
+    if ((da = drmu_atomic_new(du)) == NULL)
+        goto fail;
+    drmu_atomic_conn_add_crtc(da, drmu_output_conn(dout, 0), drmu_output_crtc(dout));
+    drmu_atomic_crtc_add_active(da, drmu_output_crtc(dout), 1);
+    drmu_atomic_add_output_props(da, dout);
+    if ((rv = drmu_atomic_plane_fb_set(da, dp, dfb, drmu_rect_wh(mode->width, mode->height))) != 0) {
+        fprintf(stderr, "Plane set failed: %s\n", strerror(-rv));
+        goto fail;
+    }
+
+    if ((rv = drmu_atomic_commit(da, DRM_MODE_ATOMIC_ALLOW_MODESET)) != 0) {
+        fprintf(stderr, "Commit failed: %s\n", strerror(-rv));
+        goto fail;
+    }
+
+    ret = 0;
+
+fail:
+    drmu_atomic_unref(&da);
+    drmu_fb_unref(&dfb);
+    if (ph.fd != -1)
+        close(ph.fd);
+    drmu_plane_unref(&dp);
+    drmu_output_unref(&dout);
+    drmu_env_delete(&du);
+    return ret;
+}
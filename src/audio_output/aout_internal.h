@@ -34,12 +34,6 @@
 /* Max input rate factor (1/4 -> 4) */
 # define AOUT_MAX_INPUT_RATE (4)
 
-enum {
-    AOUT_RESAMPLING_NONE=0,
-    AOUT_RESAMPLING_UP,
-    AOUT_RESAMPLING_DOWN
-};
-
 typedef struct aout_volume aout_volume_t;
 typedef struct vlc_aout_stream vlc_aout_stream;
 
@@ -139,6 +133,8 @@ struct vlc_aout_stream_cfg
     struct vlc_clock_t *clock;
     const char *str_id;
     const audio_replay_gain_t *replay_gain;
+    /* Output buffering over which the stream is flushed, 0 if unbound */
+    vlc_tick_t queue_max;
 };
 
 vlc_aout_stream *vlc_aout_stream_New(audio_output_t *p_aout,
@@ -189,6 +185,8 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *, const vlc_clock_t *,
 void aout_FiltersResetClock(aout_filters_t *filters);
 void aout_FiltersSetClockDelay(aout_filters_t *filters, vlc_tick_t delay);
 bool aout_FiltersCanResample (aout_filters_t *filters);
+/* Resamples by a fraction of the input rate, e.g. 1e-6 to play 1 ppm faster */
+void aout_FiltersSetResampling (aout_filters_t *filters, double ratio);
 filter_t *aout_filter_Create(vlc_object_t *obj, const filter_owner_t *restrict owner,
                              const char *type, const char *name,
                              const audio_sample_format_t *infmt,
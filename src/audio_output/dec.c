@@ -37,6 +37,7 @@
 
 #include "aout_internal.h"
 #include "clock/clock.h"
+#include "clock/clock_internal.h"
 #include "libvlc.h"
 
 struct vlc_aout_stream
@@ -53,11 +54,11 @@ struct vlc_aout_stream
     {
         struct vlc_clock_t *clock;
         float rate; /**< Play-out speed rate */
-        vlc_tick_t resamp_start_drift; /**< Resampler drift absolute value */
-        int resamp_type; /**< Resampler mode (FIXME: redundant / resampling) */
+        clock_resampler_t resamp; /**< Drift controller driving the resampler */
         bool discontinuity;
         vlc_tick_t request_delay;
         vlc_tick_t delay;
+        vlc_tick_t queue_max; /**< Output buffering to flush over, 0 if none */
     } sync;
     vlc_tick_t original_pts;
 
@@ -99,6 +100,11 @@ static inline struct vlc_tracer *aout_stream_tracer(vlc_aout_stream *stream)
         vlc_object_get_tracer(VLC_OBJECT(aout_stream_aout(stream)));
 }
 
+static void stream_ResetResampling(vlc_aout_stream *stream)
+{
+    ResamplerReset(&stream->sync.resamp);
+}
+
 static void stream_Reset(vlc_aout_stream *stream)
 {
     aout_owner_t *owner = aout_stream_owner(stream);
@@ -191,6 +197,7 @@ vlc_aout_stream * vlc_aout_stream_New(audio_output_t *p_aout,
     stream->filter_format = stream->mixer_format = stream->input_format = *p_format;
 
     stream->sync.clock = cfg->clock;
+    stream->sync.queue_max = cfg->queue_max;
     stream->str_id = cfg->str_id;
 
     stream->filters = NULL;
@@ -225,7 +232,7 @@ error:
     }
 
     stream->sync.rate = 1.f;
-    stream->sync.resamp_type = AOUT_RESAMPLING_NONE;
+    stream_ResetResampling(stream);
     stream->sync.discontinuity = true;
     stream->sync.delay = stream->sync.request_delay = 0;
     stream->original_pts = VLC_TICK_INVALID;
@@ -307,7 +314,7 @@ static int stream_CheckReady (vlc_aout_stream *stream)
             vlc_tracer_TraceEvent(tracer, "RENDER", stream->str_id, "filters_restart");
 
         msg_Dbg (aout, "restarting filters...");
-        stream->sync.resamp_type = AOUT_RESAMPLING_NONE;
+        stream_ResetResampling(stream);
 
         if (stream->mixer_format.i_format && !owner->bitexact)
         {
@@ -353,10 +360,32 @@ static void stream_StopResampling(vlc_aout_stream *stream)
 {
     assert(stream->filters);
 
-    stream->sync.resamp_type = AOUT_RESAMPLING_NONE;
+    stream_ResetResampling(stream);
     aout_FiltersAdjustResampling (stream->filters, 0);
 }
 
+static void stream_UpdateResampling(vlc_aout_stream *stream,
+                                    vlc_tick_t system_ts, vlc_tick_t drift)
+{
+    audio_output_t *aout = aout_stream_aout(stream);
+    const double previous = stream->sync.resamp.ratio;
+    const double ratio = ResamplerUpdate(&stream->sync.resamp, system_ts,
+                                         drift);
+
+    if (previous == 0. && ratio != 0.)
+        msg_Dbg (aout, "playback drift (%"PRId64" us): resampling", drift);
+    aout_FiltersSetResampling(stream->filters, ratio);
+
+    struct vlc_tracer *tracer = aout_stream_tracer(stream);
+    if (tracer != NULL)
+        vlc_tracer_Trace(tracer, VLC_TRACE("type", "RENDER"),
+                         VLC_TRACE("id", stream->str_id),
+                         VLC_TRACE("drift",
+                                   vlc_tick_from_sec(stream->sync.resamp.drift)),
+                         VLC_TRACE_INT("resampling_ppm", llround(ratio * 1e6)),
+                         VLC_TRACE_END);
+}
+
 static void stream_Silence (vlc_aout_stream *stream, vlc_tick_t length, vlc_tick_t pts)
 {
     audio_output_t *aout = aout_stream_aout(stream);
@@ -450,61 +479,7 @@ static void stream_RequestRetiming(vlc_aout_stream *stream, vlc_tick_t system_ts
     if (!aout_FiltersCanResample(stream->filters))
         return;
 
-    /* Resampling */
-    if (drift > +AOUT_MAX_PTS_DELAY
-     && stream->sync.resamp_type != AOUT_RESAMPLING_UP)
-    {
-        if (tracer != NULL)
-            vlc_tracer_TraceEvent(tracer, "RENDER", stream->str_id, "late_upsampling");
-        msg_Warn (aout, "playback too late (%"PRId64"): up-sampling",
-                  drift);
-        stream->sync.resamp_type = AOUT_RESAMPLING_UP;
-        stream->sync.resamp_start_drift = +drift;
-    }
-    if (drift < -AOUT_MAX_PTS_ADVANCE
-     && stream->sync.resamp_type != AOUT_RESAMPLING_DOWN)
-    {
-        if (tracer != NULL)
-            vlc_tracer_TraceEvent(tracer, "RENDER", stream->str_id, "early_downsampling");
-        msg_Warn (aout, "playback too early (%"PRId64"): down-sampling",
-                  drift);
-        stream->sync.resamp_type = AOUT_RESAMPLING_DOWN;
-        stream->sync.resamp_start_drift = -drift;
-    }
-
-    if (stream->sync.resamp_type == AOUT_RESAMPLING_NONE)
-        return; /* Everything is fine. Nothing to do. */
-
-    if (llabs (drift) > 2 * stream->sync.resamp_start_drift)
-    {   /* If the drift is ever increasing, then something is seriously wrong.
-         * Cease resampling and hope for the best. */
-        if (tracer != NULL)
-            vlc_tracer_TraceEvent(tracer, "RENDER", stream->str_id, "timing_screwed");
-
-        msg_Warn (aout, "timing screwed (drift: %"PRId64" us): "
-                  "stopping resampling", drift);
-        stream_StopResampling(stream);
-        return;
-    }
-
-    /* Resampling has been triggered earlier. This checks if it needs to be
-     * increased or decreased. Resampling rate changes must be kept slow for
-     * the comfort of listeners. */
-    int adj = (stream->sync.resamp_type == AOUT_RESAMPLING_UP) ? +2 : -2;
-
-    if (2 * llabs (drift) <= stream->sync.resamp_start_drift)
-        /* If the drift has been reduced from more than half its initial
-         * value, then it is time to switch back the resampling direction. */
-        adj *= -1;
-
-    if (!aout_FiltersAdjustResampling (stream->filters, adj))
-    {   /* Everything is back to normal: stop resampling. */
-        stream->sync.resamp_type = AOUT_RESAMPLING_NONE;
-
-        if (tracer != NULL)
-            vlc_tracer_TraceEvent(tracer, "RENDER", stream->str_id, "stop_resampling");
-        msg_Dbg (aout, "resampling stopped (drift: %"PRId64" us)", drift);
-    }
+    stream_UpdateResampling(stream, system_ts, drift);
 }
 
 static void stream_Synchronize(vlc_aout_stream *stream, vlc_tick_t system_now,
@@ -532,6 +507,22 @@ static void stream_Synchronize(vlc_aout_stream *stream, vlc_tick_t system_now,
     if (aout_TimeGet(aout, &delay) != 0)
         return; /* nothing can be done if timing is unknown */
 
+    /* Live: the output buffers more than its latency budget, the clock won't
+     * catch up by resampling, start over. */
+    if (stream->sync.queue_max > 0 && !stream->sync.discontinuity
+     && delay > stream->sync.queue_max)
+    {
+        struct vlc_tracer *tracer = aout_stream_tracer(stream);
+        if (tracer != NULL)
+            vlc_tracer_TraceEvent(tracer, "RENDER", stream->str_id, "queue_flush");
+
+        msg_Warn(aout, "output buffering over its latency budget (%"PRId64
+                 " ms): flushing buffers", MS_FROM_VLC_TICK(delay));
+        vlc_aout_stream_Flush(stream);
+        stream_StopResampling(stream);
+        return;
+    }
+
     if (stream->sync.discontinuity)
     {
         /* Chicken-egg situation for most aout modules that can't be started
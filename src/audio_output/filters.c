@@ -38,6 +38,7 @@
 #include <vlc_filter.h>
 #include <libvlc.h>
 #include "aout_internal.h"
+#include "../clock/clock_internal.h"
 #include "../video_output/vout_internal.h" /* for vout_Request */
 
 struct aout_filter
@@ -775,6 +776,17 @@ bool aout_FiltersAdjustResampling (aout_filters_t *filters, int adjust)
     return filters->resampling != 0;
 }
 
+void aout_FiltersSetResampling (aout_filters_t *filters, double ratio)
+{
+    if (filters->resampler.f == NULL)
+        return;
+
+    /* The resamplers only take integer rates, and each change of rate
+     * reconfigures them: only step when the requested rate is well off. */
+    filters->resampling = ResamplerGetStep(filters->resampling, ratio,
+                                   filters->resampler.f->fmt_in.audio.i_rate);
+}
+
 block_t *aout_FiltersPlay(aout_filters_t *filters, block_t *block, float rate)
 {
     int nominal_rate = 0;
@@ -25,10 +25,16 @@
 #include <vlc_aout.h>
 #include <assert.h>
 #include <limits.h>
+#include <math.h>
 #include <vlc_tracer.h>
 #include "clock.h"
 #include "clock_internal.h"
 
+/* Time constant of the drift estimation */
+#define CLOCK_DRIFT_TAU VLC_TICK_FROM_SEC(10)
+/* Points further than this from the fit are a discontinuity, not jitter */
+#define CLOCK_DRIFT_MAX_RESIDUAL VLC_TICK_FROM_MS(20)
+
 struct vlc_clock_main_t
 {
     struct vlc_logger *logger;
@@ -46,7 +52,7 @@ struct vlc_clock_main_t
      * system = ts * coeff / rate + offset
      */
     clock_point_t last;
-    average_t coeff_avg; /* Moving average to smooth out the instant coeff */
+    clock_drift_t drift; /* Linear fit of the points, to smooth out jitter */
     double rate;
     double coeff;
     vlc_tick_t offset;
@@ -93,7 +99,7 @@ static void vlc_clock_main_reset(vlc_clock_main_t *main_clock)
 {
     main_clock->coeff = 1.0f;
     main_clock->rate = 1.0f;
-    AvgResetAndFill(&main_clock->coeff_avg, main_clock->coeff);
+    DriftReset(&main_clock->drift);
     main_clock->offset = VLC_TICK_INVALID;
 
     main_clock->wait_sync_ref_priority = UINT_MAX;
@@ -131,6 +137,8 @@ static vlc_tick_t vlc_clock_master_update(vlc_clock_t *clock,
         return VLC_TICK_INVALID;
 
     const vlc_tick_t ts = original_ts + clock->delay;
+    double coeff = 1.;
+    vlc_tick_t error = VLC_TICK_INVALID;
 
     vlc_mutex_lock(&main_clock->lock);
 
@@ -141,15 +149,9 @@ static vlc_tick_t vlc_clock_master_update(vlc_clock_t *clock,
         if (main_clock->offset != VLC_TICK_INVALID
          && ts != main_clock->last.stream)
         {
-            if (rate == main_clock->rate)
-            {
-                /* We have a reference so we can update coeff */
-                double instant_coeff = (system_now - main_clock->last.system)
-                                     / (double)(ts - main_clock->last.stream)
-                                     * rate;
-                AvgUpdate(&main_clock->coeff_avg, instant_coeff);
-                main_clock->coeff = AvgGet(&main_clock->coeff_avg);
-            }
+            /* The points are fitted in the stream time scaled by the rate */
+            if (rate != main_clock->rate)
+                DriftReset(&main_clock->drift);
         }
         else
         {
@@ -158,8 +160,25 @@ static vlc_tick_t vlc_clock_master_update(vlc_clock_t *clock,
                 clock_point_Create(VLC_TICK_INVALID, VLC_TICK_INVALID);
         }
 
-        main_clock->offset =
-            system_now - ((vlc_tick_t) (ts * main_clock->coeff / rate));
+        const clock_point_t point =
+            clock_point_Create(system_now, (vlc_tick_t) (ts / rate));
+        const vlc_tick_t fit = DriftGetSystem(&main_clock->drift, point.stream);
+
+        if (fit != VLC_TICK_INVALID
+         && llabs(system_now - fit) > CLOCK_DRIFT_MAX_RESIDUAL)
+        {
+            vlc_debug(main_clock->logger, "clock discontinuity of %"PRId64
+                      " us, restarting the drift estimation",
+                      system_now - fit);
+            DriftReset(&main_clock->drift);
+        }
+        DriftUpdate(&main_clock->drift, point);
+        main_clock->coeff = coeff = DriftGetCoeff(&main_clock->drift);
+        error = DriftGetError(&main_clock->drift);
+
+        /* Follow the fit rather than the last point to filter its jitter */
+        main_clock->offset = DriftGetSystem(&main_clock->drift, point.stream)
+                           - ((vlc_tick_t) (ts * main_clock->coeff / rate));
 
         main_clock->last = clock_point_Create(system_now, ts);
 
@@ -171,6 +190,13 @@ static vlc_tick_t vlc_clock_master_update(vlc_clock_t *clock,
 
     vlc_clock_on_update(clock, system_now, original_ts, rate, frame_rate,
                         frame_rate_base);
+
+    if (main_clock->tracer != NULL && clock->track_str_id
+     && error != VLC_TICK_INVALID)
+        vlc_tracer_Trace(main_clock->tracer, VLC_TRACE("type", "RENDER"),
+                         VLC_TRACE("id", clock->track_str_id),
+                         VLC_TRACE_INT("drift_ppb", llround((coeff - 1.) * 1e9)),
+                         VLC_TRACE("jitter", error), VLC_TRACE_END);
     return VLC_TICK_INVALID;
 }
 
@@ -211,6 +237,9 @@ static vlc_tick_t vlc_clock_master_set_delay(vlc_clock_t *clock, vlc_tick_t dela
 
     vlc_tick_t delta = delay - clock->delay;
 
+    /* The stream points of the master are moving */
+    DriftReset(&main_clock->drift);
+
     if (delta > 0)
     {
         /* The master clock is delayed */
@@ -428,8 +457,7 @@ vlc_clock_main_t *vlc_clock_main_New(struct vlc_logger *parent_logger, struct vl
     main_clock->input_dejitter = DEFAULT_PTS_DELAY;
     main_clock->output_dejitter = AOUT_MAX_PTS_ADVANCE * 2;
 
-    AvgInit(&main_clock->coeff_avg, 10);
-    AvgResetAndFill(&main_clock->coeff_avg, main_clock->coeff);
+    DriftInit(&main_clock->drift, CLOCK_DRIFT_TAU);
 
     return main_clock;
 }
@@ -492,6 +520,7 @@ void vlc_clock_main_ChangePause(vlc_clock_main_t *main_clock, vlc_tick_t now,
         {
             main_clock->last.system += delay;
             main_clock->offset += delay;
+            DriftShift(&main_clock->drift, delay);
         }
         if (main_clock->first_pcr.system != VLC_TICK_INVALID)
             main_clock->first_pcr.system += delay;
@@ -523,6 +552,14 @@ vlc_tick_t vlc_clock_UpdateVideo(vlc_clock_t *clock, vlc_tick_t system_now,
     return clock->update(clock, system_now, ts, rate, frame_rate, frame_rate_base);
 }
 
+void vlc_clock_ReportStage(vlc_clock_t *clock, enum vlc_clock_stage stage,
+                           vlc_tick_t ts)
+{
+    if (clock->cbs != NULL && clock->cbs->on_stage != NULL
+     && ts != VLC_TICK_INVALID)
+        clock->cbs->on_stage(stage, vlc_tick_now(), ts, clock->cbs_data);
+}
+
 void vlc_clock_Reset(vlc_clock_t *clock)
 {
     clock->reset(clock);
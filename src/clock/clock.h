@@ -31,6 +31,16 @@ enum vlc_clock_master_source
 typedef struct vlc_clock_main_t vlc_clock_main_t;
 typedef struct vlc_clock_t vlc_clock_t;
 
+/**
+ * Points of the pipeline reported with vlc_clock_ReportStage()
+ */
+enum vlc_clock_stage
+{
+    VLC_CLOCK_STAGE_DECODE, /**< Input of the decoder module */
+    VLC_CLOCK_STAGE_DECODED, /**< Output of the decoder module */
+    VLC_CLOCK_STAGE_PRERENDER, /**< Prerendering by the video output */
+};
+
 /**
  * Callbacks for the owner of the main clock
  */
@@ -53,6 +63,18 @@ struct vlc_clock_cbs
     void (*on_update)(vlc_tick_t system_ts, vlc_tick_t ts, double rate,
                       unsigned frame_rate, unsigned frame_rate_base,
                       void *data);
+
+    /**
+     * Called when a stream timestamp reaches a stage of the pipeline (can be
+     * NULL)
+     *
+     * @param stage the stage reached
+     * @param system_now system date when the stage was reached
+     * @param ts stream timestamp
+     * @param data opaque pointer set from vlc_clock_main_New()
+     */
+    void (*on_stage)(enum vlc_clock_stage stage, vlc_tick_t system_now,
+                     vlc_tick_t ts, void *data);
 };
 
 /**
@@ -157,6 +179,13 @@ vlc_tick_t vlc_clock_UpdateVideo(vlc_clock_t *clock, vlc_tick_t system_now,
                                  vlc_tick_t ts, double rate,
                                  unsigned frame_rate, unsigned frame_rate_base);
 
+/**
+ * This function reports that a stream timestamp reached a stage of the
+ * pipeline, for latency statistics
+ */
+void vlc_clock_ReportStage(vlc_clock_t *clock, enum vlc_clock_stage stage,
+                           vlc_tick_t ts);
+
 /**
  * This function resets the clock drift
  */
@@ -25,8 +25,27 @@
 # include "config.h"
 #endif
 
+#include <math.h>
+
 #include "clock_internal.h"
 
+/* Stream duration the points must span before the slope is trusted */
+#define DRIFT_MIN_SPAN VLC_TICK_FROM_SEC(1)
+/* Bound the estimated drift to sane values, like 5% */
+#define DRIFT_MAX_DEVIATION 0.05
+
+/* Resampler controller gains (1/s and 1/s²), critically damped: the drift is
+ * caught up within a few tens of seconds, slowly enough not to be heard. */
+#define RESAMPLER_KP 0.1
+#define RESAMPLER_KI (RESAMPLER_KP * RESAMPLER_KP / 4.)
+/* Time constant of the drift low-pass filter (s) */
+#define RESAMPLER_FILTER 0.2
+/* Maximum resampling ratio, about 9 cents of pitch */
+#define RESAMPLER_MAX_RATIO 0.005
+/* Resampling step hysteresis (ratio), beyond rounding: above the ratio moves
+ * caused by the measurement jitter */
+#define RESAMPLER_HYSTERESIS 60e-6
+
 /*****************************************************************************
  * Long term average helpers
  *****************************************************************************/
@@ -85,3 +104,150 @@ void AvgRescale(average_t *avg, int range)
     avg->range = range;
     avg->value = tmp / avg->range;
 }
+
+/*****************************************************************************
+ * Drift estimation helpers
+ *****************************************************************************/
+void DriftInit(clock_drift_t *drift, vlc_tick_t tau)
+{
+    drift->tau = tau;
+    DriftReset(drift);
+}
+
+void DriftReset(clock_drift_t *drift)
+{
+    drift->origin = clock_point_Create(VLC_TICK_INVALID, VLC_TICK_INVALID);
+    drift->last = VLC_TICK_INVALID;
+    drift->weight = 0.;
+    drift->stream = drift->system = 0.;
+    drift->var = drift->cov = 0.;
+    drift->error = 0.;
+}
+
+void DriftUpdate(clock_drift_t *drift, clock_point_t point)
+{
+    if (drift->origin.system == VLC_TICK_INVALID)
+        drift->origin = point;
+
+    const double x = point.stream - drift->origin.stream;
+    const double y = point.system - drift->origin.system;
+
+    /* Forget the past points according to the elapsed stream time, so that
+     * the estimation does not depend on the rate of the updates. */
+    double decay = 1.;
+    if (drift->last != VLC_TICK_INVALID && point.stream > drift->last)
+        decay = exp(-(double)(point.stream - drift->last) / drift->tau);
+    drift->last = point.stream;
+
+    if (drift->weight > 0.)
+    {
+        const double residual = y - (double)(DriftGetSystem(drift, point.stream)
+                                             - drift->origin.system);
+        drift->error = decay * drift->error
+                     + (1. - decay) * residual * residual;
+    }
+
+    /* Weighted incremental (co)variance, West's algorithm */
+    drift->weight = decay * drift->weight + 1.;
+    const double dx = x - drift->stream;
+    const double dy = y - drift->system;
+    drift->stream += dx / drift->weight;
+    drift->system += dy / drift->weight;
+    drift->var = decay * drift->var + dx * (x - drift->stream);
+    drift->cov = decay * drift->cov + dx * (y - drift->system);
+}
+
+void DriftShift(clock_drift_t *drift, vlc_tick_t delay)
+{
+    if (drift->origin.system != VLC_TICK_INVALID)
+        drift->origin.system += delay;
+}
+
+double DriftGetCoeff(const clock_drift_t *drift)
+{
+    /* The variance is a weighted sum of squares: compare it to the one of
+     * points spread over DRIFT_MIN_SPAN */
+    const double span = DRIFT_MIN_SPAN;
+    if (drift->weight < 2. || drift->var < drift->weight * span * span / 12.)
+        return 1.;
+
+    const double coeff = drift->cov / drift->var;
+    if (coeff < 1. - DRIFT_MAX_DEVIATION)
+        return 1. - DRIFT_MAX_DEVIATION;
+    if (coeff > 1. + DRIFT_MAX_DEVIATION)
+        return 1. + DRIFT_MAX_DEVIATION;
+    return coeff;
+}
+
+vlc_tick_t DriftGetSystem(const clock_drift_t *drift, vlc_tick_t stream)
+{
+    if (drift->weight <= 0.)
+        return VLC_TICK_INVALID;
+
+    const double x = stream - drift->origin.stream;
+    const double y = drift->system + DriftGetCoeff(drift) * (x - drift->stream);
+    return drift->origin.system + llround(y);
+}
+
+vlc_tick_t DriftGetError(const clock_drift_t *drift)
+{
+    return llround(sqrt(drift->error));
+}
+
+/*****************************************************************************
+ * Resampler controller
+ *****************************************************************************/
+void ResamplerReset(clock_resampler_t *resamp)
+{
+    resamp->date = VLC_TICK_INVALID;
+    resamp->drift = 0.;
+    resamp->integral = 0.;
+    resamp->ratio = 0.;
+}
+
+double ResamplerUpdate(clock_resampler_t *resamp, vlc_tick_t system,
+                       vlc_tick_t drift)
+{
+    const double measure = secf_from_vlc_tick(drift);
+    double dt = 0.;
+
+    /* Low-pass the drift: it carries the jitter of the output timings */
+    if (resamp->date == VLC_TICK_INVALID)
+        resamp->drift = measure;
+    else if (system > resamp->date)
+    {
+        dt = secf_from_vlc_tick(__MIN(system - resamp->date,
+                                      VLC_TICK_FROM_SEC(1)));
+        resamp->drift += (measure - resamp->drift) * dt
+                       / (dt + RESAMPLER_FILTER);
+    }
+    resamp->date = system;
+
+    const double error = resamp->drift;
+    const double prop = RESAMPLER_KP * error;
+    const double integral = resamp->integral + RESAMPLER_KI * error * dt;
+    double ratio = prop + integral;
+
+    /* Anti-windup: stop integrating while the ratio is saturated */
+    if (fabs(ratio) <= RESAMPLER_MAX_RATIO
+     || fabs(integral) < fabs(resamp->integral))
+        resamp->integral = integral;
+
+    ratio = prop + resamp->integral;
+    if (ratio > RESAMPLER_MAX_RATIO)
+        ratio = RESAMPLER_MAX_RATIO;
+    else if (ratio < -RESAMPLER_MAX_RATIO)
+        ratio = -RESAMPLER_MAX_RATIO;
+
+    resamp->ratio = ratio;
+    return ratio;
+}
+
+int ResamplerGetStep(int step, double ratio, unsigned rate)
+{
+    double target = ratio * rate;
+
+    if (fabs(target - step) <= 0.5 + RESAMPLER_HYSTERESIS * rate)
+        return step;
+    return lround(target);
+}
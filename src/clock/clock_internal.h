@@ -67,4 +67,63 @@ static inline clock_point_t clock_point_Create(vlc_tick_t system, vlc_tick_t str
     return (clock_point_t) { .system = system, .stream = stream };
 }
 
+/**
+ * This structure holds an exponentially weighted linear regression of the
+ * system time against the stream time, to estimate the drift between both
+ * clocks while filtering out the jitter of the points.
+ */
+typedef struct
+{
+    clock_point_t origin; /* The values are relative to the first point */
+    vlc_tick_t last; /* Stream time of the last point */
+    vlc_tick_t tau; /* Time constant of the forgetting (stream time) */
+    double weight; /* Sum of the weights */
+    double stream, system; /* Weighted means */
+    double var, cov; /* Weighted sums of the (co)variances */
+    double error; /* Weighted mean square of the residuals */
+} clock_drift_t;
+
+/* Points older than tau have their weight divided by e */
+void DriftInit(clock_drift_t *, vlc_tick_t tau);
+void DriftReset(clock_drift_t *);
+void DriftUpdate(clock_drift_t *, clock_point_t);
+
+/* Moves all the points by the given system delay (e.g. after a pause) */
+void DriftShift(clock_drift_t *, vlc_tick_t delay);
+
+/* Slope of the fit (system per stream), 1.0 until it can be trusted */
+double DriftGetCoeff(const clock_drift_t *);
+
+/* System time of the fit for a stream time, VLC_TICK_INVALID if empty */
+vlc_tick_t DriftGetSystem(const clock_drift_t *, vlc_tick_t stream);
+
+/* Root mean square of the residuals */
+vlc_tick_t DriftGetError(const clock_drift_t *);
+
+/**
+ * This structure holds the proportional-integral controller of the audio
+ * playback speed. The integral term converges on the rate mismatch between
+ * the stream and output clocks, the proportional one catches up the
+ * remaining drift.
+ */
+typedef struct
+{
+    vlc_tick_t date; /* System time of the last drift */
+    double drift; /* Low-pass filtered drift (s) */
+    double integral; /* Integral term of the ratio */
+    double ratio; /* Last resampling ratio */
+} clock_resampler_t;
+
+void ResamplerReset(clock_resampler_t *);
+
+/* Returns the resampling ratio for a drift measured at a system time,
+ * positive to play faster when late (positive drift) */
+double ResamplerUpdate(clock_resampler_t *, vlc_tick_t system,
+                       vlc_tick_t drift);
+
+/* Returns the integer rate step (Hz) to resample a given rate by, from the
+ * current step and the requested ratio. Every change reconfigures the
+ * resampler, so the step only follows the ratio once it is well off. */
+int ResamplerGetStep(int step, double ratio, unsigned rate);
+
 #endif
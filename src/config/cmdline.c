@@ -154,6 +154,19 @@ int config_LoadCmdLine( vlc_object_t *p_this, int i_argc,
     const module_config_t *pp_shortopts[256] = { NULL };
     char *psz_shortopts;
 
+    /* Without any option, there is no need to index all configuration items
+     * (which would load those of every plug-in from the plugins cache). */
+    bool has_opts = false;
+    for (int i = 1; i < i_argc && !has_opts; i++)
+        has_opts = ppsz_argv[i][0] == '-' && ppsz_argv[i][1] != '\0';
+
+    if (!has_opts && i_argc > 0)
+    {
+        if (pindex != NULL)
+            *pindex = 1;
+        return 0;
+    }
+
     /*
      * Generate the longopts and shortopts structures used by getopt_long
      */
@@ -183,11 +196,13 @@ int config_LoadCmdLine( vlc_object_t *p_this, int i_argc,
 
     /* Fill the p_longopts and psz_shortopts structures */
     i_index = 0;
-    for (const vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
+    for (vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
     {
+        const struct vlc_param *params = vlc_plugin_Config(p);
+
         for (size_t i = 0; i < p->conf.size; i++)
         {
-            const struct vlc_param *param = p->conf.params + i;
+            const struct vlc_param *param = params + i;
             const module_config_t *p_item = &param->item;
 
             /* Ignore hints */
@@ -372,23 +372,32 @@ error:
     return -1;
 }
 
+/* Configuration item reference, so that items from the plugins cache can be
+ * indexed without loading them */
+struct vlc_param_ref
+{
+    const char *name;
+    vlc_plugin_t *plugin;
+    size_t index;
+};
+
 static int confcmp (const void *a, const void *b)
 {
-    const struct vlc_param *const *ca = a, *const *cb = b;
+    const struct vlc_param_ref *ca = a, *cb = b;
 
-    return strcmp ((*ca)->item.psz_name, (*cb)->item.psz_name);
+    return strcmp (ca->name, cb->name);
 }
 
 static int confnamecmp (const void *key, const void *elem)
 {
-    const struct vlc_param *const *conf = elem;
+    const struct vlc_param_ref *conf = elem;
 
-    return strcmp (key, (*conf)->item.psz_name);
+    return strcmp (key, conf->name);
 }
 
 static struct
 {
-    struct vlc_param **list;
+    struct vlc_param_ref *list;
     size_t count;
 } config = { NULL, 0 };
 
@@ -403,7 +412,7 @@ int config_SortConfig (void)
     for (p = vlc_plugins; p != NULL; p = p->next)
         nconf += p->conf.count;
 
-    struct vlc_param **clist = vlc_alloc(nconf, sizeof (*clist));
+    struct vlc_param_ref *clist = vlc_alloc(nconf, sizeof (*clist));
     if (unlikely(clist == NULL))
         return VLC_ENOMEM;
 
@@ -412,26 +421,28 @@ int config_SortConfig (void)
     {
         for (size_t i = 0; i < p->conf.size; i++)
         {
-            struct vlc_param *param = p->conf.params + i;
-            module_config_t *item = &param->item;
+            const char *name = vlc_plugin_ConfigName(p, i);
 
-            if (!CONFIG_ITEM(item->i_type))
+            if (name == NULL)
                 continue; /* ignore hints */
             assert(index < nconf);
-            clist[index++] = param;
+            clist[index].name = name;
+            clist[index].plugin = p;
+            clist[index].index = i;
+            index++;
         }
     }
 
-    qsort (clist, nconf, sizeof (*clist), confcmp);
+    qsort (clist, index, sizeof (*clist), confcmp);
 
     config.list = clist;
-    config.count = nconf;
+    config.count = index;
     return VLC_SUCCESS;
 }
 
 void config_UnsortConfig (void)
 {
-    struct vlc_param **clist;
+    struct vlc_param_ref *clist;
 
     clist = config.list;
     config.list = NULL;
@@ -442,11 +453,18 @@ void config_UnsortConfig (void)
 
 struct vlc_param *vlc_param_Find(const char *name)
 {
-    struct vlc_param *const *p;
+    const struct vlc_param_ref *ref;
 
     assert(name != NULL);
-    p = bsearch (name, config.list, config.count, sizeof (*p), confnamecmp);
-    return (p != NULL) ? *p : NULL;
+    ref = bsearch (name, config.list, config.count, sizeof (*ref),
+                   confnamecmp);
+    if (ref == NULL)
+        return NULL;
+
+    struct vlc_param *params = vlc_plugin_Config(ref->plugin);
+    if (unlikely(ref->index >= ref->plugin->conf.size))
+        return NULL; /* corrupted plugins cache */
+    return params + ref->index;
 }
 
 module_config_t *config_FindConfig(const char *name)
@@ -490,9 +508,11 @@ void config_ResetAll(void)
     vlc_mutex_lock(&config_lock);
     for (vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
     {
+        struct vlc_param *params = vlc_plugin_Config(p);
+
         for (size_t i = 0; i < p->conf.size; i++ )
         {
-            struct vlc_param *param = p->conf.params + i;
+            struct vlc_param *param = params + i;
             module_config_t *p_config = &param->item;
 
             if (IsConfigIntegerType (p_config->i_type))
@@ -437,7 +437,7 @@ int config_SaveConfigFile (vlc_object_t *p_this)
         else
             fprintf( file, "\n\n" );
 
-        for (struct vlc_param *param = p->conf.params,
+        for (struct vlc_param *param = vlc_plugin_Config(p),
                               *end = param + p->conf.size;
              param < end;
              param++)
@@ -592,7 +592,7 @@ static void Usage (vlc_object_t *p_this, char const *psz_search)
     const bool desc = var_InheritBool(p_this, "help-verbose");
 
     /* Enumerate the config for each module */
-    for (const vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
+    for (vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
     {
         const module_t *m = p->module;
         const module_config_t *section = NULL;
@@ -604,6 +604,8 @@ static void Usage (vlc_object_t *p_this, char const *psz_search)
             continue;
         found = true;
 
+        const struct vlc_param *params = vlc_plugin_Config(p);
+
         if (psz_search == NULL && !plugin_show(p))
             continue;
 
@@ -620,7 +622,7 @@ static void Usage (vlc_object_t *p_this, char const *psz_search)
         /* Print module options */
         for (size_t j = 0; j < p->conf.size; j++)
         {
-            const struct vlc_param *param = p->conf.params + j;
+            const struct vlc_param *param = params + j;
 
             if (param->obsolete)
                 continue; /* Skip removed options */
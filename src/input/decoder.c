@@ -87,6 +87,22 @@ struct vlc_input_decoder_t
     decoder_t *p_packetizer;
     bool b_packetizer;
 
+    /* Optional thread running the decoder module, fed with the packetized
+     * frames by the DecoderThread. The fifo lock protects its state. */
+    struct
+    {
+        block_fifo_t *fifo; /* NULL if decoding on the DecoderThread */
+        vlc_thread_t thread;
+        vlc_cond_t wait; /* a frame was dequeued or decoded */
+        es_format_t fmt; /* packetizer format the module was loaded with */
+        bool busy;
+        bool draining;
+        bool flushing;
+        bool aborting;
+    } pipeline;
+
+    char *affinity; /* CPUs of the decoder threads, or NULL */
+
     /* Current format in use by the output */
     es_format_t    fmt;
     vlc_video_context *vctx;
@@ -96,8 +112,14 @@ struct vlc_input_decoder_t
     vlc_meta_t     *p_description;
     atomic_int     reload;
 
-    /* fifo */
+    /* fifo: its lock protects the decoder thread state, while input
+     * frames go through the lock-free queue */
     block_fifo_t *p_fifo;
+    vlc_frame_spsc_t *frames;
+    atomic_bool fifo_sleeping; /* decoder thread waits for input frames */
+    vlc_tick_t fifo_max; /* duration of queued frames to keep, 0 if unbound */
+    vlc_tick_t out_queue_max; /* output buffering to keep, 0 if unbound */
+    _Atomic vlc_tick_t fifo_head; /* timestamp of the last dequeued frame */
 
     /* Lock for communication with decoder thread */
     vlc_mutex_t lock;
@@ -190,6 +212,14 @@ struct vlc_input_decoder_t
 #define DECODER_SPU_VOUT_WAIT_DURATION   VLC_TICK_FROM_MS(200)
 #define BLOCK_FLAG_CORE_PRIVATE_RELOADED (1 << BLOCK_FLAG_CORE_PRIVATE_SHIFT)
 
+/* Input frames queued without locking before spilling to the overflow lane,
+ * enough for high packet rate audio between two decoder wake-ups */
+#define DECODER_QUEUE_SIZE 256
+
+/* Packetized frames queued to the pipeline thread, enough to absorb the
+ * bursts of the packetizers without adding much latency */
+#define DECODER_PIPELINE_SIZE 8
+
 #define decoder_Notify(decoder_priv, event, ...) \
     if (decoder_priv->cbs && decoder_priv->cbs->event) \
         decoder_priv->cbs->event(decoder_priv, __VA_ARGS__, \
@@ -200,6 +230,17 @@ static inline vlc_input_decoder_t *dec_get_owner( decoder_t *p_dec )
     return container_of( p_dec, vlc_input_decoder_t, dec );
 }
 
+static void DecoderSetAffinity( vlc_input_decoder_t *p_owner )
+{
+    if( p_owner->affinity == NULL )
+        return;
+
+    int val = vlc_thread_SetAffinity( p_owner->affinity );
+    if( val != 0 )
+        msg_Warn( &p_owner->dec, "cannot run on CPUs %s: %s",
+                  p_owner->affinity, vlc_strerror_c( val ) );
+}
+
 /**
  * When the input decoder is being used only for packetizing (happen in stream output
  * configuration.), there's no need to spawn a decoder thread. The input_decoder is then considered
@@ -267,9 +308,12 @@ static int DecoderThread_Reload( vlc_input_decoder_t *p_owner,
         assert( p_owner->fmt.i_cat == AUDIO_ES );
         audio_output_t *p_aout = p_owner->p_aout;
         vlc_aout_stream *p_astream = p_owner->p_astream;
-        // no need to lock, the decoder and ModuleThread are dead
+        // the decoder and ModuleThread are dead, but the DecoderThread can
+        // still use the aout if the module runs on the pipeline thread
+        vlc_mutex_lock( &p_owner->lock );
         p_owner->p_aout = NULL;
         p_owner->p_astream = NULL;
+        vlc_mutex_unlock( &p_owner->lock );
         if( p_aout )
         {
             assert( p_astream );
@@ -401,7 +445,8 @@ static int ModuleThread_UpdateAudioFormat( decoder_t *p_dec )
                 .profile = p_dec->fmt_out.i_profile,
                 .clock = p_owner->p_clock,
                 .str_id = p_owner->psz_id,
-                .replay_gain = &p_dec->fmt_out.audio_replay_gain
+                .replay_gain = &p_dec->fmt_out.audio_replay_gain,
+                .queue_max = p_owner->out_queue_max,
             };
             p_astream = vlc_aout_stream_New( p_aout, &cfg );
             if( p_astream == NULL )
@@ -506,6 +551,7 @@ static int ModuleThread_UpdateVideoFormat( decoder_t *p_dec, vlc_video_context *
         .str_id = p_owner->psz_id,
         .fmt = &p_dec->fmt_out.video,
         .mouse_event = MouseEvent, .mouse_opaque = p_dec,
+        .queue_max = p_owner->out_queue_max,
     };
     enum input_resource_vout_state vout_state;
     vout_thread_t *p_vout =
@@ -991,6 +1037,30 @@ static void DecoderThread_ProcessSout( vlc_input_decoder_t *p_owner, vlc_frame_t
 }
 #endif
 
+/**
+ * Queues input frames to the decoder thread.
+ *
+ * This is lock-free unless the decoder thread is waiting for input. Only one
+ * thread may queue frames to a given decoder.
+ */
+static void DecoderQueueFrame( vlc_input_decoder_t *p_owner,
+                               vlc_frame_t *frame )
+{
+    if( unlikely(frame == NULL) )
+        return;
+
+    vlc_frame_spsc_Push( p_owner->frames, frame );
+
+    /* Pairs with the check in DecoderThread() before going to sleep: either
+     * the decoder thread sees the new frame, or we see it sleeping. */
+    if( atomic_load( &p_owner->fifo_sleeping ) )
+    {
+        vlc_fifo_Lock( p_owner->p_fifo );
+        vlc_fifo_Signal( p_owner->p_fifo );
+        vlc_fifo_Unlock( p_owner->p_fifo );
+    }
+}
+
 static void DecoderPlayCc( vlc_input_decoder_t *p_owner, vlc_frame_t *p_cc,
                            const decoder_cc_desc_t *p_desc )
 {
@@ -1011,11 +1081,11 @@ static void DecoderPlayCc( vlc_input_decoder_t *p_owner, vlc_frame_t *p_cc,
 
         if( i_bitmap > 1 )
         {
-            block_FifoPut( p_ccowner->p_fifo, block_Duplicate(p_cc) );
+            DecoderQueueFrame( p_ccowner, block_Duplicate(p_cc) );
         }
         else
         {
-            block_FifoPut( p_ccowner->p_fifo, p_cc );
+            DecoderQueueFrame( p_ccowner, p_cc );
             p_cc = NULL; /* was last dec */
         }
     }
@@ -1153,6 +1223,9 @@ static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
         vlc_tracer_TraceStreamPTS( tracer, "DEC", p_owner->psz_id,
                             "OUT", p_pic->date );
     }
+    if( p_owner->p_clock != NULL )
+        vlc_clock_ReportStage( p_owner->p_clock, VLC_CLOCK_STAGE_DECODED,
+                               p_pic->date );
     int success = ModuleThread_PlayVideo( p_owner, p_pic );
 
     ModuleThread_UpdateStatVideo( p_owner, success != VLC_SUCCESS );
@@ -1288,6 +1361,9 @@ static void ModuleThread_QueueAudio( decoder_t *p_dec, vlc_frame_t *p_aout_buf )
         vlc_tracer_TraceStreamDTS( tracer, "DEC", p_owner->psz_id, "OUT",
                             p_aout_buf->i_pts, p_aout_buf->i_dts );
     }
+    if( p_owner->p_clock != NULL && p_aout_buf != NULL )
+        vlc_clock_ReportStage( p_owner->p_clock, VLC_CLOCK_STAGE_DECODED,
+                               p_aout_buf->i_pts );
     int success = ModuleThread_PlayAudio( p_owner, p_aout_buf );
 
     ModuleThread_UpdateStatAudio( p_owner, success != VLC_SUCCESS );
@@ -1353,6 +1429,7 @@ static void ModuleThread_QueueSpu( decoder_t *p_dec, subpicture_t *p_spu )
 }
 
 static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_t *frame );
+static void PipelineThread_Decode( vlc_input_decoder_t *p_owner, vlc_frame_t *frame );
 static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t *frame )
 {
     decoder_t *p_dec = &p_owner->dec;
@@ -1363,6 +1440,11 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t
         vlc_tracer_TraceStreamDTS( tracer, "DEC", p_owner->psz_id, "IN",
                             frame->i_pts, frame->i_dts );
     }
+    /* Closed captions decoders share the clock of the video */
+    if( p_owner->p_clock != NULL && frame != NULL
+     && p_dec->fmt_in.i_cat != SPU_ES )
+        vlc_clock_ReportStage( p_owner->p_clock, VLC_CLOCK_STAGE_DECODE,
+                               frame->i_pts );
 
     int ret = p_dec->pf_decode( p_dec, frame );
     switch( ret )
@@ -1379,7 +1461,10 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t
             if( !( frame->i_flags & BLOCK_FLAG_CORE_PRIVATE_RELOADED ) )
             {
                 frame->i_flags |= BLOCK_FLAG_CORE_PRIVATE_RELOADED;
-                DecoderThread_ProcessInput( p_owner, frame );
+                if( p_owner->pipeline.fifo != NULL )
+                    PipelineThread_Decode( p_owner, frame );
+                else
+                    DecoderThread_ProcessInput( p_owner, frame );
             }
             else /* We prefer loosing this frame than an infinite recursion */
                 block_Release( frame );
@@ -1390,17 +1475,16 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t
 }
 
 /**
- * Decode a frame
+ * Reloads the decoder module if requested
  *
- * \param p_dec the decoder object
- * \param frame the block to decode
+ * \return false if the decoder module is unusable
  */
-static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_t *frame )
+static bool DecoderThread_CheckModule( vlc_input_decoder_t *p_owner )
 {
     decoder_t *p_dec = &p_owner->dec;
 
     if( p_owner->error )
-        goto error;
+        return false;
 
     /* Here, the atomic doesn't prevent to miss a reload request.
      * DecoderThread_ProcessInput() can still be called after the decoder module or the
@@ -1413,8 +1497,206 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_
                   reload == RELOAD_DECODER_AOUT ? " and the audio output" : "" );
 
         if( DecoderThread_Reload( p_owner, &p_dec->fmt_in, reload ) != VLC_SUCCESS )
-            goto error;
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Decodes a packetized frame on the pipeline thread
+ */
+static void PipelineThread_Decode( vlc_input_decoder_t *p_owner, vlc_frame_t *frame )
+{
+    if( !DecoderThread_CheckModule( p_owner ) )
+    {
+        if( frame != NULL )
+            block_Release( frame );
+        return;
+    }
+    DecoderThread_DecodeBlock( p_owner, frame );
+}
+
+static void *PipelineThread( void *data )
+{
+    vlc_input_decoder_t *p_owner = data;
+    block_fifo_t *fifo = p_owner->pipeline.fifo;
+
+    vlc_thread_set_name( "vlc-dec-module" );
+    DecoderSetAffinity( p_owner );
+
+    vlc_fifo_Lock( fifo );
+    while( !p_owner->pipeline.aborting )
+    {
+        vlc_frame_t *frame = vlc_fifo_DequeueUnlocked( fifo );
+        if( frame == NULL && !p_owner->pipeline.draining )
+        {
+            vlc_fifo_Wait( fifo );
+            continue;
+        }
+
+        p_owner->pipeline.busy = true;
+        vlc_cond_signal( &p_owner->pipeline.wait );
+        vlc_fifo_Unlock( fifo );
+
+        PipelineThread_Decode( p_owner, frame );
+
+        vlc_fifo_Lock( fifo );
+        p_owner->pipeline.busy = false;
+        if( frame == NULL )
+            p_owner->pipeline.draining = false;
+        vlc_cond_signal( &p_owner->pipeline.wait );
+
+        if( vlc_fifo_IsEmpty( fifo ) )
+        {   /* vlc_input_decoder_Wait() waits for the pipeline to be idle */
+            vlc_fifo_Unlock( fifo );
+            vlc_mutex_lock( &p_owner->lock );
+            vlc_cond_signal( &p_owner->wait_acknowledge );
+            vlc_mutex_unlock( &p_owner->lock );
+            vlc_fifo_Lock( fifo );
+        }
+    }
+    vlc_fifo_Unlock( fifo );
+    return NULL;
+}
+
+/* Discards the queued frames and waits for the pipeline thread to be done
+ * with the decoder module */
+static void DecoderThread_FlushPipelineLocked( vlc_input_decoder_t *p_owner )
+{
+    block_fifo_t *fifo = p_owner->pipeline.fifo;
+
+    block_ChainRelease( vlc_fifo_DequeueAllUnlocked( fifo ) );
+    p_owner->pipeline.draining = false;
+    while( p_owner->pipeline.busy )
+        vlc_fifo_WaitCond( fifo, &p_owner->pipeline.wait );
+}
+
+/**
+ * Decodes a packetized frame, or queues it to the pipeline thread
+ *
+ * A NULL frame drains the decoder module, waiting for the pipeline thread to
+ * be done with it.
+ */
+static void DecoderThread_Decode( vlc_input_decoder_t *p_owner, vlc_frame_t *frame )
+{
+    block_fifo_t *fifo = p_owner->pipeline.fifo;
+
+    if( fifo == NULL )
+    {
+        DecoderThread_DecodeBlock( p_owner, frame );
+        return;
+    }
+
+    vlc_fifo_Lock( fifo );
+    if( frame != NULL )
+    {
+        while( vlc_fifo_GetCount( fifo ) >= DECODER_PIPELINE_SIZE
+            && !p_owner->pipeline.flushing )
+            vlc_fifo_WaitCond( fifo, &p_owner->pipeline.wait );
+
+        if( !p_owner->pipeline.flushing )
+            vlc_fifo_QueueUnlocked( fifo, frame );
+        else
+            block_Release( frame );
+    }
+    else
+    {
+        p_owner->pipeline.draining = true;
+        vlc_fifo_Signal( fifo );
+        while( p_owner->pipeline.draining && !p_owner->pipeline.flushing )
+            vlc_fifo_WaitCond( fifo, &p_owner->pipeline.wait );
+        if( p_owner->pipeline.draining )
+            /* No need to drain what is about to be flushed */
+            DecoderThread_FlushPipelineLocked( p_owner );
+    }
+    vlc_fifo_Unlock( fifo );
+}
+
+static void DecoderThread_FlushPipeline( vlc_input_decoder_t *p_owner )
+{
+    block_fifo_t *fifo = p_owner->pipeline.fifo;
+
+    if( fifo == NULL )
+        return;
+
+    vlc_fifo_Lock( fifo );
+    DecoderThread_FlushPipelineLocked( p_owner );
+    vlc_fifo_Unlock( fifo );
+}
+
+static void DecoderPipelineSetFlushing( vlc_input_decoder_t *p_owner,
+                                        bool flushing )
+{
+    block_fifo_t *fifo = p_owner->pipeline.fifo;
+
+    if( fifo == NULL )
+        return;
+
+    vlc_fifo_Lock( fifo );
+    p_owner->pipeline.flushing = flushing;
+    vlc_cond_signal( &p_owner->pipeline.wait );
+    vlc_fifo_Unlock( fifo );
+}
+
+static int DecoderStartPipeline( vlc_input_decoder_t *p_owner )
+{
+    p_owner->pipeline.fifo = block_FifoNew();
+    if( unlikely(p_owner->pipeline.fifo == NULL) )
+        return VLC_ENOMEM;
+
+    if( es_format_Copy( &p_owner->pipeline.fmt,
+                        &p_owner->p_packetizer->fmt_out ) != VLC_SUCCESS
+     || vlc_clone( &p_owner->pipeline.thread, PipelineThread, p_owner ) )
+    {
+        es_format_Clean( &p_owner->pipeline.fmt );
+        block_FifoRelease( p_owner->pipeline.fifo );
+        p_owner->pipeline.fifo = NULL;
+        return VLC_EGENERIC;
     }
+    return VLC_SUCCESS;
+}
+
+static void DecoderStopPipeline( vlc_input_decoder_t *p_owner )
+{
+    block_fifo_t *fifo = p_owner->pipeline.fifo;
+
+    if( fifo == NULL )
+        return;
+
+    vlc_fifo_Lock( fifo );
+    p_owner->pipeline.aborting = true;
+    vlc_fifo_Signal( fifo );
+    vlc_fifo_Unlock( fifo );
+    vlc_join( p_owner->pipeline.thread, NULL );
+}
+
+static bool DecoderPipelineIsIdle( vlc_input_decoder_t *p_owner )
+{
+    block_fifo_t *fifo = p_owner->pipeline.fifo;
+
+    if( fifo == NULL )
+        return true;
+
+    vlc_fifo_Lock( fifo );
+    bool idle = vlc_fifo_IsEmpty( fifo ) && !p_owner->pipeline.busy
+             && !p_owner->pipeline.draining;
+    vlc_fifo_Unlock( fifo );
+    return idle;
+}
+
+/**
+ * Decode a frame
+ *
+ * \param p_dec the decoder object
+ * \param frame the block to decode
+ */
+static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_t *frame )
+{
+    decoder_t *p_dec = &p_owner->dec;
+
+    /* The pipeline thread checks the decoder module it runs */
+    if( p_owner->pipeline.fifo == NULL && !DecoderThread_CheckModule( p_owner ) )
+        goto error;
 
     bool packetize = p_owner->p_packetizer != NULL;
     if( frame )
@@ -1444,16 +1726,25 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_
         vlc_frame_t *packetized_frame;
         vlc_frame_t **ppframe = frame ? &frame : NULL;
         decoder_t *p_packetizer = p_owner->p_packetizer;
+        /* The decoder module input format belongs to the pipeline thread */
+        es_format_t *fmt = p_owner->pipeline.fifo != NULL ?
+                           &p_owner->pipeline.fmt : &p_dec->fmt_in;
 
         while( (packetized_frame =
                 p_packetizer->pf_packetize( p_packetizer, ppframe ) ) )
         {
-            if( !es_format_IsSimilar( &p_dec->fmt_in, &p_packetizer->fmt_out ) )
+            if( !es_format_IsSimilar( fmt, &p_packetizer->fmt_out ) )
             {
                 msg_Dbg( p_dec, "restarting module due to input format change");
 
                 /* Drain the decoder module */
-                DecoderThread_DecodeBlock( p_owner, NULL );
+                DecoderThread_Decode( p_owner, NULL );
+
+                if( p_owner->pipeline.fifo != NULL )
+                {
+                    es_format_Clean( fmt );
+                    es_format_Copy( fmt, &p_packetizer->fmt_out );
+                }
 
                 if( DecoderThread_Reload( p_owner, &p_packetizer->fmt_out,
                                           RELOAD_DECODER ) != VLC_SUCCESS )
@@ -1471,8 +1762,8 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_
                 vlc_frame_t *p_next = packetized_frame->p_next;
                 packetized_frame->p_next = NULL;
 
-                DecoderThread_DecodeBlock( p_owner, packetized_frame );
-                if( p_owner->error )
+                DecoderThread_Decode( p_owner, packetized_frame );
+                if( p_owner->pipeline.fifo == NULL && p_owner->error )
                 {
                     block_ChainRelease( p_next );
                     return;
@@ -1483,7 +1774,7 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_
         }
         /* Drain the decoder after the packetizer is drained */
         if( !ppframe )
-            DecoderThread_DecodeBlock( p_owner, NULL );
+            DecoderThread_Decode( p_owner, NULL );
     }
     else
         DecoderThread_DecodeBlock( p_owner, frame );
@@ -1499,6 +1790,9 @@ static void DecoderThread_Flush( vlc_input_decoder_t *p_owner )
     decoder_t *p_dec = &p_owner->dec;
     decoder_t *p_packetizer = p_owner->p_packetizer;
 
+    /* The decoder module is flushed from here once the pipeline is idle */
+    DecoderThread_FlushPipeline( p_owner );
+
     if( p_owner->error )
         return;
 
@@ -1646,6 +1940,25 @@ static void DecoderThread_ChangeDelay( vlc_input_decoder_t *p_owner, vlc_tick_t
     }
 }
 
+static vlc_tick_t FrameTimestamp( const vlc_frame_t *frame )
+{
+    return frame->i_dts != VLC_TICK_INVALID ? frame->i_dts : frame->i_pts;
+}
+
+/* Duration of the frames queued before the given one, 0 if unknown */
+static vlc_tick_t DecoderFifoDuration( vlc_input_decoder_t *p_owner,
+                                       const vlc_frame_t *frame )
+{
+    vlc_tick_t head = atomic_load_explicit( &p_owner->fifo_head,
+                                            memory_order_relaxed );
+    vlc_tick_t ts = FrameTimestamp( frame );
+
+    if( head == VLC_TICK_INVALID || ts == VLC_TICK_INVALID
+     || ts <= head || vlc_frame_spsc_GetCount( p_owner->frames ) == 0 )
+        return 0;
+    return ts - head;
+}
+
 /**
  * The decoding main loop
  *
@@ -1659,6 +1972,7 @@ static void *DecoderThread( void *p_data )
     bool paused = false;
 
     vlc_thread_set_name("vlc-decoder");
+    DecoderSetAffinity( p_owner );
 
     /* The decoder's main loop */
     vlc_fifo_Lock( p_owner->p_fifo );
@@ -1679,6 +1993,7 @@ static void *DecoderThread( void *p_data )
              * is called again. This will avoid a second useless flush (but
              * harmless). */
             p_owner->flushing = false;
+            DecoderPipelineSetFlushing( p_owner, false );
 
             continue;
         }
@@ -1740,15 +2055,22 @@ static void *DecoderThread( void *p_data )
 
         vlc_cond_signal( &p_owner->wait_fifo );
 
-        vlc_frame_t *frame = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
+        vlc_frame_t *frame = vlc_frame_spsc_Pop( p_owner->frames );
         if( frame == NULL )
         {
             if( likely(!p_owner->b_draining) )
             {   /* Wait for a block to decode (or a request to drain) */
+                atomic_store( &p_owner->fifo_sleeping, true );
+                if( vlc_frame_spsc_GetCount( p_owner->frames ) > 0 )
+                {   /* Lost the race against DecoderQueueFrame() */
+                    atomic_store( &p_owner->fifo_sleeping, false );
+                    continue;
+                }
                 p_owner->b_idle = true;
                 vlc_cond_signal( &p_owner->wait_acknowledge );
                 vlc_fifo_Wait( p_owner->p_fifo );
                 p_owner->b_idle = false;
+                atomic_store( &p_owner->fifo_sleeping, false );
                 continue;
             }
             /* We have emptied the FIFO and there is a pending request to
@@ -1757,6 +2079,10 @@ static void *DecoderThread( void *p_data )
 
         vlc_fifo_Unlock( p_owner->p_fifo );
 
+        if( frame != NULL && p_owner->fifo_max > 0 )
+            atomic_store_explicit( &p_owner->fifo_head, FrameTimestamp( frame ),
+                                   memory_order_relaxed );
+
         DecoderThread_ProcessInput( p_owner, frame );
 
         if( frame == NULL && p_owner->dec.fmt_in.i_cat == AUDIO_ES )
@@ -1858,6 +2184,13 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
     p_owner->p_sout = cfg->sout;
     p_owner->p_sout_input = NULL;
     p_owner->p_packetizer = NULL;
+    p_owner->pipeline.fifo = NULL;
+    vlc_cond_init( &p_owner->pipeline.wait );
+    p_owner->pipeline.busy = false;
+    p_owner->pipeline.draining = false;
+    p_owner->pipeline.flushing = false;
+    p_owner->pipeline.aborting = false;
+    p_owner->affinity = NULL;
 
     p_owner->b_fmt_description = false;
     p_owner->p_description = NULL;
@@ -1892,6 +2225,17 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
         vlc_object_delete(p_dec);
         return NULL;
     }
+    p_owner->frames = vlc_frame_spsc_New( DECODER_QUEUE_SIZE );
+    if( unlikely(p_owner->frames == NULL) )
+    {
+        block_FifoRelease( p_owner->p_fifo );
+        vlc_object_delete(p_dec);
+        return NULL;
+    }
+    atomic_init( &p_owner->fifo_sleeping, false );
+    p_owner->fifo_max = cfg->fifo_max;
+    p_owner->out_queue_max = cfg->out_queue_max;
+    atomic_init( &p_owner->fifo_head, VLC_TICK_INVALID );
 
     vlc_mutex_init( &p_owner->lock );
     vlc_mutex_init( &p_owner->mouse_lock );
@@ -1899,6 +2243,11 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
     vlc_cond_init( &p_owner->wait_acknowledge );
     vlc_cond_init( &p_owner->wait_fifo );
 
+    if( fmt->i_cat == VIDEO_ES )
+        p_owner->affinity = var_InheritString( p_dec, "video-dec-affinity" );
+    else if( fmt->i_cat == AUDIO_ES )
+        p_owner->affinity = var_InheritString( p_dec, "audio-dec-affinity" );
+
     /* Load a packetizer module if the input is not already packetized */
     if( cfg->sout == NULL && !fmt->b_packetized )
     {
@@ -1997,7 +2346,14 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner, enum es_format_category
         vlc_video_context_Release( p_owner->vctx );
 
     /* Free all packets still in the decoder fifo. */
+    vlc_frame_spsc_Delete( p_owner->frames );
     block_FifoRelease( p_owner->p_fifo );
+    if( p_owner->pipeline.fifo != NULL )
+    {
+        block_FifoRelease( p_owner->pipeline.fifo );
+        es_format_Clean( &p_owner->pipeline.fmt );
+    }
+    free( p_owner->affinity );
 
     /* Cleanup */
 #ifdef ENABLE_SOUT
@@ -2130,10 +2486,20 @@ decoder_New( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
 
     if( !vlc_input_decoder_IsSynchronous( p_owner ) )
     {
+        /* Run the decoder module on its own thread, if there is something
+         * else to do on the DecoderThread: packetizing */
+        if( p_owner->p_packetizer != NULL
+         && ( p_dec->fmt_in.i_cat == VIDEO_ES
+           || p_dec->fmt_in.i_cat == AUDIO_ES )
+         && var_InheritBool( p_dec, "dec-pipeline" )
+         && DecoderStartPipeline( p_owner ) != VLC_SUCCESS )
+            msg_Warn( p_dec, "cannot spawn the decoder pipeline thread" );
+
         /* Spawn the decoder thread in asynchronous scenario. */
         if( vlc_clone( &p_owner->thread, DecoderThread, p_owner ) )
         {
             msg_Err( p_dec, "cannot spawn decoder thread" );
+            DecoderStopPipeline( p_owner );
             DeleteDecoder( p_owner, p_dec->fmt_in.i_cat );
             return NULL;
         }
@@ -2190,6 +2556,7 @@ void vlc_input_decoder_Delete( vlc_input_decoder_t *p_owner )
     vlc_fifo_Lock( p_owner->p_fifo );
     p_owner->aborting = true;
     p_owner->flushing = true;
+    DecoderPipelineSetFlushing( p_owner, true );
     vlc_fifo_Signal( p_owner->p_fifo );
     vlc_fifo_Unlock( p_owner->p_fifo );
 
@@ -2230,7 +2597,10 @@ void vlc_input_decoder_Delete( vlc_input_decoder_t *p_owner )
     vlc_mutex_unlock( &p_owner->lock );
 
     if( !vlc_input_decoder_IsSynchronous( p_owner ) )
+    {
         vlc_join( p_owner->thread, NULL );
+        DecoderStopPipeline( p_owner );
+    }
 
     /* */
     if( p_owner->cc.b_supported )
@@ -2256,36 +2626,58 @@ void vlc_input_decoder_Decode( vlc_input_decoder_t *p_owner, vlc_frame_t *frame,
     if( vlc_input_decoder_IsSynchronous( p_owner ) )
     {
         /* DecoderThread's fifo should be empty as no decoder thread is running. */
-        assert( vlc_fifo_IsEmpty( p_owner->p_fifo ) );
+        assert( vlc_frame_spsc_GetCount( p_owner->frames ) == 0 );
         DecoderThread_ProcessInput( p_owner, frame );
         return;
     }
 
-    vlc_fifo_Lock( p_owner->p_fifo );
     if( !b_do_pace )
     {
         /* FIXME: ideally we would check the time amount of data
          * in the FIFO instead of its size. */
         /* 400 MiB, i.e. ~ 50mb/s for 60s */
-        if( vlc_fifo_GetBytes( p_owner->p_fifo ) > 400*1024*1024 )
+        if( vlc_frame_spsc_GetBytes( p_owner->frames ) > 400*1024*1024 )
         {
             msg_Warn( &p_owner->dec, "decoder/packetizer fifo full (data not "
                       "consumed quickly enough), resetting fifo!" );
-            block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+            /* The decoder thread only dequeues with the fifo lock held */
+            vlc_fifo_Lock( p_owner->p_fifo );
+            block_ChainRelease( vlc_frame_spsc_PopAll( p_owner->frames ) );
+            vlc_fifo_Unlock( p_owner->p_fifo );
             frame->i_flags |= BLOCK_FLAG_DISCONTINUITY;
         }
+        else
+        if( p_owner->fifo_max > 0 && !p_owner->b_waiting )
+        {   /* The fifo is not consumed when waiting, the buffering is bound
+             * by the input clock in that case. */
+            vlc_tick_t queued = DecoderFifoDuration( p_owner, frame );
+            if( queued > p_owner->fifo_max )
+            {
+                msg_Warn( &p_owner->dec, "decoder fifo over its latency budget "
+                          "(%"PRId64" ms queued), resetting fifo!",
+                          MS_FROM_VLC_TICK(queued) );
+                vlc_fifo_Lock( p_owner->p_fifo );
+                block_ChainRelease( vlc_frame_spsc_PopAll( p_owner->frames ) );
+                vlc_fifo_Unlock( p_owner->p_fifo );
+                atomic_store_explicit( &p_owner->fifo_head, VLC_TICK_INVALID,
+                                       memory_order_relaxed );
+                frame->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+            }
+        }
     }
     else
-    if( !p_owner->b_waiting )
+    if( !p_owner->b_waiting
+     && vlc_frame_spsc_GetCount( p_owner->frames ) >= 10 )
     {   /* The FIFO is not consumed when waiting, so pacing would deadlock VLC.
          * Locking is not necessary as b_waiting is only read, not written by
          * the decoder thread. */
-        while( vlc_fifo_GetCount( p_owner->p_fifo ) >= 10 )
+        vlc_fifo_Lock( p_owner->p_fifo );
+        while( vlc_frame_spsc_GetCount( p_owner->frames ) >= 10 )
             vlc_fifo_WaitCond( p_owner->p_fifo, &p_owner->wait_fifo );
+        vlc_fifo_Unlock( p_owner->p_fifo );
     }
 
-    vlc_fifo_QueueUnlocked( p_owner->p_fifo, frame );
-    vlc_fifo_Unlock( p_owner->p_fifo );
+    DecoderQueueFrame( p_owner, frame );
 }
 
 bool vlc_input_decoder_IsEmpty( vlc_input_decoder_t * p_owner )
@@ -2293,13 +2685,16 @@ bool vlc_input_decoder_IsEmpty( vlc_input_decoder_t * p_owner )
     assert( !p_owner->b_waiting );
 
     vlc_fifo_Lock( p_owner->p_fifo );
-    if( !vlc_fifo_IsEmpty( p_owner->p_fifo ) || p_owner->b_draining )
+    if( vlc_frame_spsc_GetCount( p_owner->frames ) > 0 || p_owner->b_draining )
     {
         vlc_fifo_Unlock( p_owner->p_fifo );
         return false;
     }
     vlc_fifo_Unlock( p_owner->p_fifo );
 
+    if( !DecoderPipelineIsIdle( p_owner ) )
+        return false;
+
     bool b_empty;
 
     vlc_mutex_lock( &p_owner->lock );
@@ -2359,13 +2754,16 @@ void vlc_input_decoder_Flush( vlc_input_decoder_t *p_owner )
     vlc_fifo_Lock( p_owner->p_fifo );
 
     /* Empty the fifo */
-    block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+    block_ChainRelease( vlc_frame_spsc_PopAll( p_owner->frames ) );
+    atomic_store_explicit( &p_owner->fifo_head, VLC_TICK_INVALID,
+                           memory_order_relaxed );
 
     /* Don't need to wait for the DecoderThread to flush. Indeed, if called a
      * second time, this function will clear the FIFO again before anything was
      * dequeued by DecoderThread and there is no need to flush a second time in
      * a row. */
     p_owner->flushing = true;
+    DecoderPipelineSetFlushing( p_owner, true );
 
     /* Flush video/spu decoder when paused: increment frames_countdown in order
      * to display one frame/subtitle */
@@ -2578,7 +2976,9 @@ void vlc_input_decoder_Wait( vlc_input_decoder_t *p_owner )
         if( p_owner->paused )
             break;
         vlc_fifo_Lock( p_owner->p_fifo );
-        if( p_owner->b_idle && vlc_fifo_IsEmpty( p_owner->p_fifo ) )
+        if( p_owner->b_idle
+         && vlc_frame_spsc_GetCount( p_owner->frames ) == 0
+         && DecoderPipelineIsIdle( p_owner ) )
         {
             msg_Err( &p_owner->dec, "buffer deadlock prevented" );
             vlc_fifo_Unlock( p_owner->p_fifo );
@@ -2643,7 +3043,7 @@ void vlc_input_decoder_GetStatus( vlc_input_decoder_t *p_owner,
 
 size_t vlc_input_decoder_GetFifoSize( vlc_input_decoder_t *p_owner )
 {
-    return block_FifoSize( p_owner->p_fifo );
+    return vlc_frame_spsc_GetBytes( p_owner->frames );
 }
 
 static bool DecoderHasVbi( decoder_t *dec )
@@ -60,6 +60,12 @@ struct vlc_input_decoder_cfg
     enum input_type input_type;
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_data;
+    /* Maximum duration of input frames queued to the decoder when the input
+     * can't be paced, 0 to only bound the fifo by its size */
+    vlc_tick_t fifo_max;
+    /* Maximum duration of decoded data buffered by the audio or video output,
+     * 0 if unbound */
+    vlc_tick_t out_queue_max;
 };
 
 vlc_input_decoder_t *
@@ -35,6 +35,7 @@
 #include <vlc_modules.h>
 #include <vlc_strings.h>
 #include "input_internal.h"
+#include "modules/modules.h"
 
 typedef const struct
 {
@@ -93,6 +94,9 @@ static void demux_DestroyDemux(demux_t *demux)
     vlc_stream_Delete(demux->s);
 }
 
+/* Number of bytes to peek for the demux probe hints */
+#define DEMUX_HINT_PEEK 32
+
 static int demux_Probe(void *func, bool forced, va_list ap)
 {
     int (*probe)(vlc_object_t *) = func;
@@ -162,15 +166,17 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
     p_demux->p_sys      = NULL;
 
     char *modbuf = NULL;
+    char *type = NULL;
     bool strict = true;
+    struct vlc_module_hint hint = { NULL, NULL, NULL, 0 };
 
     if (!strcasecmp(module, "any" ) || module[0] == '\0') {
         /* Look up demux by content type for hard to detect formats */
-        char *type = stream_MimeType(s);
+        type = stream_MimeType(s);
 
         if (type != NULL) {
             module = demux_NameFromMimeType(type);
-            free(type);
+            hint.mime = type;
         }
         strict = false;
     }
@@ -180,20 +186,37 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
         const char *ext = strrchr(p_demux->psz_filepath, '.');
 
         if (ext != NULL) {
+            hint.extension = ext + 1;
             if (b_preparsing && !vlc_ascii_strcasecmp(ext, ".mp3"))
                 module = "mpga";
             else
             if (likely(asprintf(&modbuf, "ext-%s", ext + 1) >= 0))
                 module = modbuf;
             else
+            {
+                free(type);
                 goto error;
+            }
         }
         strict = false;
     }
 
-    priv->module = vlc_module_load(p_demux, "demux", module, strict,
-                                   demux_Probe, p_demux);
+    if (!strict) {
+        /* Peek the start of the content so that modules whose probe hints
+         * cannot match are not even loaded. */
+        ssize_t peeked = vlc_stream_Peek(s, &hint.magic, DEMUX_HINT_PEEK);
+
+        if (peeked >= 0)
+            hint.magic_size = peeked;
+        else
+            hint.magic = NULL;
+    }
+
+    priv->module = vlc_module_load_hinted(vlc_object_logger(p_demux), "demux",
+                                          module, strict, &hint,
+                                          demux_Probe, p_demux);
     free(modbuf);
+    free(type);
 
     if (priv->module == NULL)
         goto error;
@@ -132,6 +132,8 @@ struct es_out_id_t
     vlc_input_decoder_t   *p_dec;
     vlc_input_decoder_t   *p_dec_record;
     vlc_clock_t *p_clock;
+    struct input_latency *latency; /* NULL if statistics are disabled */
+    vlc_tick_t latency_warning; /* last live target miss warning date */
 
     /* Used by vlc_clock_cbs, need to be const during the lifetime of the clock */
     bool master;
@@ -635,6 +637,8 @@ static void EsRelease(es_out_id_t *es)
         free(es->psz_language);
         free(es->psz_language_code);
         es_format_Clean(&es->fmt);
+        if (es->latency != NULL)
+            input_latency_Delete(es->latency);
         input_source_Release(es->id.source);
         free(es->id.str_id);
         free(es);
@@ -1539,9 +1543,11 @@ static es_out_pgrm_t *EsOutProgramAdd( es_out_t *out, input_source_t *source, in
 
     /* In case of low delay: don't use any output dejitter. This may result on
      * some audio/video glitches when starting, but low-delay is more important
-     * than the visual quality if the user chose this option. */
+     * than the visual quality if the user chose this option. The live mode
+     * keeps the share of its latency budget given to the outputs. */
     if (input_priv(p_input)->b_low_delay)
-        vlc_clock_main_SetDejitter(p_pgrm->p_main_clock, 0);
+        vlc_clock_main_SetDejitter(p_pgrm->p_main_clock,
+                                   input_priv(p_input)->live.output);
 
     /* Append it */
     vlc_list_append(&p_pgrm->node, &p_sys->programs);
@@ -2224,6 +2230,12 @@ static es_out_id_t *EsOutAddLocked( es_out_t *out, input_source_t *source,
     es->p_dec = NULL;
     es->p_dec_record = NULL;
     es->p_clock = NULL;
+    es->latency = NULL;
+    if( input_priv(p_input)->stats != NULL )
+        es->latency = input_latency_New( input_priv(p_input)->stats,
+                                         es->fmt.i_cat,
+                                         input_priv(p_input)->live.target );
+    es->latency_warning = VLC_TICK_INVALID;
     es->master = false;
     es->cc.type = 0;
     es->cc.i_bitmap = 0;
@@ -2290,6 +2302,40 @@ static void ClockUpdate(vlc_tick_t system_ts, vlc_tick_t ts, double rate,
 
     input_SendEventOutputClock(p_sys->p_input, &es->id, es->master, system_ts,
                                ts, rate, frame_rate, frame_rate_base);
+
+    if (es->latency == NULL || system_ts == VLC_TICK_INVALID)
+        return;
+
+    vlc_tick_t now = vlc_tick_now();
+    vlc_tick_t latency =
+        input_latency_Mark(es->latency, INPUT_LATENCY_DISPLAY, ts,
+                           system_ts != VLC_TICK_MAX ? system_ts : now);
+
+    /* Only called from the output thread of the ES */
+    const vlc_tick_t target = input_priv(p_sys->p_input)->live.target;
+    if (target > 0 && latency != VLC_TICK_INVALID && latency > target
+     && (es->latency_warning == VLC_TICK_INVALID
+      || now - es->latency_warning >= VLC_TICK_FROM_SEC(1)))
+    {
+        msg_Warn(p_sys->p_input, "%s output %"PRId64" ms late for the live "
+                 "latency target (%"PRId64" ms)", es->id.str_id,
+                 MS_FROM_VLC_TICK(latency - target), MS_FROM_VLC_TICK(target));
+        es->latency_warning = now;
+    }
+}
+
+static void ClockStage(enum vlc_clock_stage stage, vlc_tick_t system_now,
+                       vlc_tick_t ts, void *data)
+{
+    static const enum input_latency_point points[] = {
+        [VLC_CLOCK_STAGE_DECODE] = INPUT_LATENCY_DECODE,
+        [VLC_CLOCK_STAGE_DECODED] = INPUT_LATENCY_DECODED,
+        [VLC_CLOCK_STAGE_PRERENDER] = INPUT_LATENCY_PRERENDER,
+    };
+    es_out_id_t *es = data;
+
+    if (es->latency != NULL)
+        input_latency_Mark(es->latency, points[stage], ts, system_now);
 }
 
 static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
@@ -2299,7 +2345,8 @@ static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
     vlc_input_decoder_t *dec;
 
     static const struct vlc_clock_cbs clock_cbs = {
-        .on_update = ClockUpdate
+        .on_update = ClockUpdate,
+        .on_stage = ClockStage,
     };
 
     assert( p_es->p_pgrm );
@@ -2354,6 +2401,10 @@ static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
         .input_type = p_sys->input_type,
         .cbs = &decoder_cbs,
         .cbs_data = p_es,
+        .fifo_max = priv->live.target > 0 && p_es->fmt.i_cat != SPU_ES ?
+            priv->live.caching + priv->live.jitter + priv->live.decoder : 0,
+        .out_queue_max = priv->live.target > 0 && p_es->fmt.i_cat != SPU_ES ?
+            priv->live.caching + priv->live.jitter + priv->live.output : 0,
     };
     dec = vlc_input_decoder_New( VLC_OBJECT(p_input), &cfg );
     if( dec != NULL )
@@ -3008,6 +3059,9 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
             vlc_input_decoder_Decode( es->p_dec_record, p_dup,
                                       input_priv(p_input)->b_out_pace_control );
     }
+    if( es->latency != NULL )
+        input_latency_Mark( es->latency, INPUT_LATENCY_SEND, p_block->i_pts,
+                            vlc_tick_now() );
     vlc_input_decoder_Decode( es->p_dec, p_block,
                               input_priv(p_input)->b_out_pace_control );
 
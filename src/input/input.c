@@ -202,6 +202,44 @@ input_item_t *input_GetItem( input_thread_t *p_input )
     return input_priv(p_input)->p_item;
 }
 
+/**
+ * Splits the live latency target between the stages buffering data.
+ *
+ * Most of it goes to the caching that absorbs the network jitter, the rest
+ * bounds the clock jitter compensation, the data waiting for the decoders
+ * and the data queued in the audio and video outputs, dejitter included.
+ * The decoders and outputs drop what they hold beyond their share.
+ */
+static void InitLiveBudget( input_thread_t *p_input )
+{
+    input_thread_private_t *priv = input_priv(p_input);
+    struct input_live_budget *live = &priv->live;
+
+    live->target = priv->type == INPUT_TYPE_NONE ?
+        VLC_TICK_FROM_MS(var_InheritInteger( p_input, "live-latency" )) : 0;
+    live->caching = live->target / 2;
+    live->jitter = live->target / 10;
+    live->decoder = live->target / 5;
+    live->output = live->target / 5;
+
+    if( live->target == 0 )
+        return;
+
+    /* Demuxers and decoders inherit the low delay mode: no frame reordering
+     * or threading delay, frames are output as soon as they are decoded. */
+    var_Create( p_input, "low-delay", VLC_VAR_BOOL );
+    var_SetBool( p_input, "low-delay", true );
+    priv->b_low_delay = true;
+    if( priv->i_jitter_max > live->jitter )
+        priv->i_jitter_max = live->jitter;
+
+    msg_Dbg( p_input, "live mode: %"PRId64" ms target, caching %"PRId64
+             " ms, jitter %"PRId64" ms, decoder %"PRId64" ms, output %"PRId64
+             " ms", MS_FROM_VLC_TICK(live->target),
+             MS_FROM_VLC_TICK(live->caching), MS_FROM_VLC_TICK(live->jitter),
+             MS_FROM_VLC_TICK(live->decoder), MS_FROM_VLC_TICK(live->output) );
+}
+
 #undef input_Create
 /**
  * Create a new input_thread_t.
@@ -352,6 +390,7 @@ input_thread_t *input_Create( vlc_object_t *p_parent,
 
     priv->b_low_delay = var_InheritBool( p_input, "low-delay" );
     priv->i_jitter_max = VLC_TICK_FROM_MS(var_InheritInteger( p_input, "clock-jitter" ));
+    InitLiveBudget( p_input );
 
     /* Remove 'Now playing' info as it is probably outdated */
     input_item_SetNowPlaying( p_item, NULL );
@@ -1179,6 +1218,15 @@ static void UpdatePtsDelay( input_thread_t *p_input )
     if( i_pts_delay < 0 )
         i_pts_delay = 0;
 
+    /* The live mode caps the caching to its share of the latency target */
+    if( p_sys->live.target > 0 && i_pts_delay > p_sys->live.caching )
+    {
+        msg_Dbg( p_input, "live mode: caching reduced from %"PRId64" to %"
+                 PRId64" ms", MS_FROM_VLC_TICK(i_pts_delay),
+                 MS_FROM_VLC_TICK(p_sys->live.caching) );
+        i_pts_delay = p_sys->live.caching;
+    }
+
     /* Update cr_average depending on the caching */
     const int i_cr_average = var_GetInteger( p_input, "cr-average" ) * i_pts_delay / DEFAULT_PTS_DELAY;
 
@@ -445,6 +445,20 @@ typedef struct
     input_control_param_t param;
 } input_control_t;
 
+/**
+ * Split of the glass-to-glass latency target of the live mode (see the
+ * "live-latency" option) between the stages that buffer data
+ */
+struct input_live_budget
+{
+    vlc_tick_t target;  /**< 0 if the live mode is disabled */
+    vlc_tick_t caching; /**< maximum pts_delay */
+    vlc_tick_t jitter;  /**< maximum input jitter compensation */
+    vlc_tick_t decoder; /**< decoder fifo, on top of caching and jitter */
+    vlc_tick_t output;  /**< audio/video outputs dejitter, and buffering on
+                             top of caching and jitter */
+};
+
 /** Private input fields */
 typedef struct input_thread_private_t
 {
@@ -470,6 +484,7 @@ typedef struct input_thread_private_t
     /* Delays */
     bool        b_low_delay;
     vlc_tick_t  i_jitter_max;
+    struct input_live_budget live;
 
     /* Output */
     bool            b_out_pace_control; /* XXX Move it ot es_sout ? */
@@ -709,6 +724,30 @@ typedef struct input_rate_t
     } samples[2];
 } input_rate_t;
 
+/* Number of buckets of a latency histogram: 16 linear ones (1 tick each)
+ * then 8 per power of two up to 2^31 ticks, i.e. a 12.5% precision. */
+#define INPUT_LATENCY_BUCKETS (16 + 8 * 27)
+
+typedef struct input_latency_histogram_t
+{
+    atomic_uint buckets[INPUT_LATENCY_BUCKETS];
+    atomic_uint count;
+    _Atomic vlc_tick_t max;
+} input_latency_histogram_t;
+
+/**
+ * Points of the pipeline where the latency is measured
+ */
+enum input_latency_point
+{
+    INPUT_LATENCY_SEND, /**< es_out_Send() */
+    INPUT_LATENCY_DECODE, /**< Decoder input */
+    INPUT_LATENCY_DECODED, /**< Decoder output */
+    INPUT_LATENCY_PRERENDER, /**< Video output prerendering */
+    INPUT_LATENCY_DISPLAY, /**< Display (or audio playback) date */
+    INPUT_LATENCY_POINTS
+};
+
 struct input_stats {
     input_rate_t input_bitrate;
     input_rate_t demux_bitrate;
@@ -721,6 +760,9 @@ struct input_stats {
     atomic_uint displayed_pictures;
     atomic_uint late_pictures;
     atomic_uint lost_pictures;
+    atomic_uint latency_misses;
+    input_latency_histogram_t video_latency[INPUT_STATS_LATENCY_COUNT];
+    input_latency_histogram_t audio_latency[INPUT_STATS_LATENCY_COUNT];
 };
 
 struct input_stats *input_stats_Create(void);
@@ -728,4 +770,37 @@ void input_stats_Destroy(struct input_stats *);
 void input_rate_Add(input_rate_t *, uintmax_t);
 void input_stats_Compute(struct input_stats *, input_stats_t*);
 
+/**
+ * Latency tracker of an elementary stream
+ *
+ * It remembers when recent timestamps went through each point of the
+ * pipeline, and accounts the time spent between two points into the
+ * histograms of the input statistics.
+ */
+struct input_latency;
+
+/**
+ * Creates a latency tracker
+ *
+ * \param target latency over which displayed frames are counted as misses,
+ * 0 for none
+ */
+struct input_latency *input_latency_New(struct input_stats *,
+                                        enum es_format_category_e,
+                                        vlc_tick_t target);
+void input_latency_Delete(struct input_latency *);
+
+/**
+ * Reports that a timestamp went through a point of the pipeline.
+ *
+ * \param ts stream timestamp (of the block or picture)
+ * \param date system date when the point was reached
+ * \note This function is thread-safe.
+ * \return the total latency for INPUT_LATENCY_DISPLAY if known,
+ * VLC_TICK_INVALID otherwise
+ */
+vlc_tick_t input_latency_Mark(struct input_latency *,
+                              enum input_latency_point,
+                              vlc_tick_t ts, vlc_tick_t date);
+
 #endif
@@ -28,6 +28,7 @@
 #include <string.h>
 
 #include <vlc_common.h>
+#include <vlc_es.h>
 #include "input/input_internal.h"
 
 /**
@@ -51,6 +52,92 @@ static float stats_GetRate(const input_rate_t *rate)
         / (float)(rate->samples[0].date - rate->samples[1].date);
 }
 
+static void input_latency_histogram_Init(input_latency_histogram_t *h)
+{
+    for (size_t i = 0; i < INPUT_LATENCY_BUCKETS; i++)
+        atomic_init(&h->buckets[i], 0);
+    atomic_init(&h->count, 0);
+    atomic_init(&h->max, 0);
+}
+
+static size_t input_latency_Bucket(vlc_tick_t value)
+{
+    if (value < 16)
+        return value;
+    if (value > INT32_MAX)
+        value = INT32_MAX;
+
+    unsigned msb = (sizeof (unsigned) * 8 - 1) - clz((unsigned)value);
+    return 16 + 8 * (msb - 4) + ((value >> (msb - 3)) & 7);
+}
+
+/* Largest value accounted into a bucket */
+static vlc_tick_t input_latency_BucketMax(size_t bucket)
+{
+    if (bucket < 16)
+        return bucket;
+
+    unsigned msb = (bucket - 16) / 8 + 4;
+    vlc_tick_t mantissa = 8 + (bucket - 16) % 8;
+    return ((mantissa + 1) << (msb - 3)) - 1;
+}
+
+static void input_latency_histogram_Add(input_latency_histogram_t *h,
+                                        vlc_tick_t value)
+{
+    if (value < 0)
+        value = 0;
+
+    atomic_fetch_add_explicit(&h->buckets[input_latency_Bucket(value)], 1,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+
+    vlc_tick_t max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while (value > max
+        && !atomic_compare_exchange_weak_explicit(&h->max, &max, value,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed));
+}
+
+static void input_latency_histogram_Compute(input_latency_histogram_t *h,
+                                            struct input_stats_latency_t *st)
+{
+    unsigned count = atomic_load_explicit(&h->count, memory_order_relaxed);
+
+    st->p50 = st->p99 = st->max = VLC_TICK_INVALID;
+    if (count == 0)
+        return;
+
+    st->max = atomic_load_explicit(&h->max, memory_order_relaxed);
+
+    /* The buckets may be updated concurrently: the ranks are approximate. */
+    unsigned rank50 = (count + 1) / 2;
+    unsigned rank99 = count - count / 100;
+    unsigned seen = 0;
+
+    for (size_t i = 0; i < INPUT_LATENCY_BUCKETS; i++)
+    {
+        seen += atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+
+        vlc_tick_t value = input_latency_BucketMax(i);
+        if (value > st->max)
+            value = st->max;
+
+        if (st->p50 == VLC_TICK_INVALID && seen >= rank50)
+            st->p50 = value;
+        if (seen >= rank99)
+        {
+            st->p99 = value;
+            break;
+        }
+    }
+
+    if (st->p99 == VLC_TICK_INVALID)
+        st->p99 = st->max;
+    if (st->p50 == VLC_TICK_INVALID)
+        st->p50 = st->p99;
+}
+
 struct input_stats *input_stats_Create(void)
 {
     struct input_stats *stats = malloc(sizeof (*stats));
@@ -68,6 +155,13 @@ struct input_stats *input_stats_Create(void)
     atomic_init(&stats->displayed_pictures, 0);
     atomic_init(&stats->late_pictures, 0);
     atomic_init(&stats->lost_pictures, 0);
+    atomic_init(&stats->latency_misses, 0);
+
+    for (size_t i = 0; i < INPUT_STATS_LATENCY_COUNT; i++)
+    {
+        input_latency_histogram_Init(&stats->video_latency[i]);
+        input_latency_histogram_Init(&stats->audio_latency[i]);
+    }
     return stats;
 }
 
@@ -111,6 +205,17 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
                                                     memory_order_relaxed);
     st->i_lost_pictures = atomic_load_explicit(&stats->lost_pictures,
                                                memory_order_relaxed);
+
+    /* Latency */
+    st->i_latency_misses = atomic_load_explicit(&stats->latency_misses,
+                                                memory_order_relaxed);
+    for (size_t i = 0; i < INPUT_STATS_LATENCY_COUNT; i++)
+    {
+        input_latency_histogram_Compute(&stats->video_latency[i],
+                                        &st->video_latency[i]);
+        input_latency_histogram_Compute(&stats->audio_latency[i],
+                                        &st->audio_latency[i]);
+    }
 }
 
 /** Update a counter element with new values
@@ -140,3 +245,152 @@ void input_rate_Add(input_rate_t *counter, uintmax_t val)
     counter->samples[0].date = now;
     vlc_mutex_unlock(&counter->lock);
 }
+
+/* Number of recent timestamps remembered by a latency tracker. This must
+ * cover the decoder input FIFO, or the demux stage will not be measured. */
+#define INPUT_LATENCY_MARKS 512
+/* Largest difference with the closest earlier timestamp, if not exact */
+#define INPUT_LATENCY_MATCH_WINDOW VLC_TICK_FROM_MS(500)
+
+struct input_latency
+{
+    vlc_mutex_t lock;
+    input_latency_histogram_t *histograms;
+    atomic_uint *misses;
+    vlc_tick_t target;
+    /* Audio decoders split or merge blocks: match the closest earlier one */
+    bool match_earlier;
+    size_t next;
+    struct
+    {
+        vlc_tick_t ts;
+        vlc_tick_t dates[INPUT_LATENCY_POINTS];
+    } marks[INPUT_LATENCY_MARKS];
+};
+
+static void input_latency_Reset(struct input_latency *lat)
+{
+    vlc_mutex_lock(&lat->lock);
+    lat->next = 0;
+    for (size_t i = 0; i < INPUT_LATENCY_MARKS; i++)
+        lat->marks[i].ts = VLC_TICK_INVALID;
+    vlc_mutex_unlock(&lat->lock);
+}
+
+struct input_latency *input_latency_New(struct input_stats *stats,
+                                        enum es_format_category_e cat,
+                                        vlc_tick_t target)
+{
+    input_latency_histogram_t *histograms;
+
+    switch (cat)
+    {
+        case VIDEO_ES:
+            histograms = stats->video_latency;
+            break;
+        case AUDIO_ES:
+            histograms = stats->audio_latency;
+            break;
+        default:
+            return NULL;
+    }
+
+    struct input_latency *lat = malloc(sizeof (*lat));
+    if (unlikely(lat == NULL))
+        return NULL;
+
+    vlc_mutex_init(&lat->lock);
+    lat->histograms = histograms;
+    lat->misses = &stats->latency_misses;
+    lat->target = target;
+    lat->match_earlier = cat == AUDIO_ES;
+    input_latency_Reset(lat);
+    return lat;
+}
+
+void input_latency_Delete(struct input_latency *lat)
+{
+    free(lat);
+}
+
+vlc_tick_t input_latency_Mark(struct input_latency *lat,
+                              enum input_latency_point point,
+                              vlc_tick_t ts, vlc_tick_t date)
+{
+    static const enum input_stats_latency stages[] = {
+        [INPUT_LATENCY_DECODE] = INPUT_STATS_LATENCY_DEMUX,
+        [INPUT_LATENCY_DECODED] = INPUT_STATS_LATENCY_DECODER,
+        [INPUT_LATENCY_PRERENDER] = INPUT_STATS_LATENCY_VOUT,
+        [INPUT_LATENCY_DISPLAY] = INPUT_STATS_LATENCY_DISPLAY,
+    };
+
+    if (ts == VLC_TICK_INVALID || date == VLC_TICK_INVALID)
+        return VLC_TICK_INVALID;
+
+    vlc_mutex_lock(&lat->lock);
+
+    if (point == INPUT_LATENCY_SEND)
+    {
+        size_t i = lat->next;
+
+        lat->next = (i + 1) % INPUT_LATENCY_MARKS;
+        lat->marks[i].ts = ts;
+        lat->marks[i].dates[INPUT_LATENCY_SEND] = date;
+        for (size_t p = 1; p < INPUT_LATENCY_POINTS; p++)
+            lat->marks[i].dates[p] = VLC_TICK_INVALID;
+        vlc_mutex_unlock(&lat->lock);
+        return VLC_TICK_INVALID;
+    }
+
+    /* Look for the timestamp, starting from the most recent one */
+    size_t found = INPUT_LATENCY_MARKS;
+    for (size_t n = 1; n <= INPUT_LATENCY_MARKS; n++)
+    {
+        size_t i = (lat->next + INPUT_LATENCY_MARKS - n) % INPUT_LATENCY_MARKS;
+        vlc_tick_t mark = lat->marks[i].ts;
+
+        if (mark == ts)
+        {
+            found = i;
+            break;
+        }
+        if (lat->match_earlier && mark != VLC_TICK_INVALID && mark < ts
+         && ts - mark < INPUT_LATENCY_MATCH_WINDOW
+         && (found == INPUT_LATENCY_MARKS || mark > lat->marks[found].ts))
+            found = i;
+    }
+
+    if (found == INPUT_LATENCY_MARKS)
+    {
+        vlc_mutex_unlock(&lat->lock);
+        return VLC_TICK_INVALID;
+    }
+
+    vlc_tick_t *dates = lat->marks[found].dates;
+    bool first = dates[point] == VLC_TICK_INVALID;
+
+    /* Account the time since the closest earlier point */
+    for (int p = point - 1; p >= 0; p--)
+        if (dates[p] != VLC_TICK_INVALID)
+        {
+            input_latency_histogram_Add(&lat->histograms[stages[point]],
+                                        date - dates[p]);
+            break;
+        }
+
+    vlc_tick_t total = VLC_TICK_INVALID;
+    if (point == INPUT_LATENCY_DISPLAY)
+    {
+        total = date - dates[INPUT_LATENCY_SEND];
+        input_latency_histogram_Add(
+            &lat->histograms[INPUT_STATS_LATENCY_TOTAL], total);
+        if (lat->target > 0 && total > lat->target)
+            atomic_fetch_add_explicit(lat->misses, 1, memory_order_relaxed);
+    }
+
+    /* Several outputs may match one input (e.g. audio): keep the first. */
+    if (first)
+        dates[point] = date;
+    vlc_mutex_unlock(&lat->lock);
+    return total;
+}
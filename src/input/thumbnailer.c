@@ -255,7 +255,8 @@ RequestCommon(vlc_thumbnailer_t *thumbnailer, struct seek_target seek_target,
 
     ThumbnailerAddTask(thumbnailer, task);
 
-    vlc_executor_Submit(thumbnailer->executor, &task->runnable);
+    vlc_executor_SubmitWithPriority(thumbnailer->executor, &task->runnable,
+                                    VLC_EXECUTOR_PRIORITY_INTERACTIVE);
 
     /* XXX In theory, "task" might already be invalid here (if it is already
      * executed and deleted). This is consistent with the API documentation and
@@ -500,6 +500,12 @@ static const char *const fit_descriptions[] = {
     "This drops frames that are late (arrive to the video output after " \
     "their intended display date)." )
 
+#define VOUT_PIPELINE_TEXT N_("Pipeline video rendering")
+#define VOUT_PIPELINE_LONGTEXT N_( \
+    "This prerenders the next picture (filters, subtitles blending) while " \
+    "a separate thread waits for the display date of the current one, " \
+    "at the cost of holding up to two more pictures." )
+
 #define QUIET_SYNCHRO_TEXT N_("Quiet synchro")
 #define QUIET_SYNCHRO_LONGTEXT N_( \
     "This avoids flooding the message log with debug output from the " \
@@ -681,6 +687,14 @@ static const char *const ppsz_prefres[] = {
     "Try to minimize delay along decoding chain."\
     "Might break with non compliant streams.")
 
+#define INPUT_LIVE_LATENCY_TEXT N_("Live latency target (ms)")
+#define INPUT_LIVE_LATENCY_LONGTEXT N_(\
+    "Glass-to-glass latency to aim for with live streams, in milliseconds. " \
+    "The caching, clock jitter compensation, decoder queue and output " \
+    "buffering are sized together from it, and the low delay mode is " \
+    "enabled. Frames displayed later than this target are reported. " \
+    "0 disables it.")
+
 #define INPUT_REPEAT_TEXT N_("Input repetitions")
 #define INPUT_REPEAT_LONGTEXT N_( \
     "Number of time the same input will be repeated")
@@ -1004,6 +1018,23 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define DEC_DEV_TEXT N_("Preferred decoder hardware device")
 #define DEC_DEV_LONGTEXT N_("This allows hardware decoding when available.")
 
+#define DEC_PIPELINE_TEXT N_("Pipeline packetizing and decoding")
+#define DEC_PIPELINE_LONGTEXT N_( \
+    "Run the audio and video decoder modules on their own threads, fed by " \
+    "the packetizers through a bounded queue, so that packetizing and " \
+    "decoding overlap. This helps software decoders that are not " \
+    "multi-threaded on multi-core CPUs." )
+
+#define VIDEO_DEC_AFFINITY_TEXT N_("Video decoding CPUs")
+#define VIDEO_DEC_AFFINITY_LONGTEXT N_( \
+    "Comma-separated list of CPUs or ranges of CPUs (e.g. \"2-3\") the " \
+    "video decoding threads run on. By default, they can run on any CPU." )
+
+#define AUDIO_DEC_AFFINITY_TEXT N_("Audio decoding CPUs")
+#define AUDIO_DEC_AFFINITY_LONGTEXT N_( \
+    "Comma-separated list of CPUs or ranges of CPUs (e.g. \"2-3\") the " \
+    "audio decoding threads run on. By default, they can run on any CPU." )
+
 /*****************************************************************************
  * Sout
  ****************************************************************************/
@@ -1112,6 +1143,10 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define STATS_LONGTEXT N_( \
      "Collect miscellaneous local statistics about the playing media.")
 
+#define FRAME_POOL_STATS_TEXT N_("Frame pool statistics")
+#define FRAME_POOL_STATS_LONGTEXT N_( \
+     "Print the data frame allocator cache statistics when exiting.")
+
 #define ONEINSTANCE_TEXT N_("Allow only one running instance")
 #define ONEINSTANCE_LONGTEXT N_( \
     "Allowing only one running instance of VLC can sometimes be useful, " \
@@ -1637,6 +1672,8 @@ vlc_module_begin ()
         change_private ()
     add_bool( "drop-late-frames", true, DROP_LATE_FRAMES_TEXT,
               DROP_LATE_FRAMES_LONGTEXT )
+    add_bool( "vout-pipeline", false, VOUT_PIPELINE_TEXT,
+              VOUT_PIPELINE_LONGTEXT )
     /* Used in vout_synchro */
     add_bool( "skip-frames", true, SKIP_FRAMES_TEXT,
               SKIP_FRAMES_LONGTEXT )
@@ -1838,6 +1875,10 @@ vlc_module_begin ()
     add_bool( "low-delay", false, INPUT_LOWDELAY_TEXT,
               INPUT_LOWDELAY_LONGTEXT )
         change_safe ()
+    add_integer( "live-latency", 0, INPUT_LIVE_LATENCY_TEXT,
+                 INPUT_LIVE_LATENCY_LONGTEXT )
+        change_integer_range( 0, 60000 )
+        change_safe ()
 
     set_section( N_( "Playback control" ) , NULL)
     add_integer( "input-repeat", 0,
@@ -2008,6 +2049,11 @@ vlc_module_begin ()
     add_bool( "hw-dec", true, HW_DEC_TEXT, HW_DEC_LONGTEXT )
     add_obsolete_string( "encoder" ) /* since 4.0.0 */
     add_module("dec-dev", "decoder device", "any", DEC_DEV_TEXT, DEC_DEV_LONGTEXT)
+    add_bool( "dec-pipeline", false, DEC_PIPELINE_TEXT, DEC_PIPELINE_LONGTEXT )
+    add_string( "video-dec-affinity", NULL, VIDEO_DEC_AFFINITY_TEXT,
+                VIDEO_DEC_AFFINITY_LONGTEXT )
+    add_string( "audio-dec-affinity", NULL, AUDIO_DEC_AFFINITY_TEXT,
+                AUDIO_DEC_AFFINITY_LONGTEXT )
 
     //set_subcategory( SUBCAT_INPUT_SCODEC )
     set_subcategory( SUBCAT_INPUT_STREAM_FILTER )
@@ -2208,6 +2254,8 @@ vlc_module_begin ()
               INTERACTION_LONGTEXT )
 
     add_bool ( "stats", true, STATS_TEXT, STATS_LONGTEXT )
+    add_bool ( "frame-pool-stats", false, FRAME_POOL_STATS_TEXT,
+               FRAME_POOL_STATS_LONGTEXT )
 
     set_subcategory( SUBCAT_INTERFACE_MAIN )
     add_module_cat("intf", SUBCAT_INTERFACE_MAIN, NULL,
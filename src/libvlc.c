@@ -390,6 +390,9 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
 
     libvlc_InternalActionsClean( p_libvlc );
 
+    if( var_InheritBool( p_libvlc, "frame-pool-stats" ) )
+        vlc_frame_pool_Dump( VLC_OBJECT(p_libvlc) );
+
     /* Save the configuration */
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( VLC_OBJECT(p_libvlc) );
@@ -40,12 +40,50 @@ void system_End(void);
 #endif
 void vlc_CPU_dump(vlc_object_t *);
 
+/*
+ * Frame pool
+ */
+void vlc_frame_pool_Dump(vlc_object_t *);
+
+/*
+ * Single-producer single-consumer frame queue
+ *
+ * Frames are pushed by one thread and popped by another without locking as
+ * long as the ring has room; excess frames go to a locked overflow lane.
+ * Popping is single-consumer: callers that pop from several threads must
+ * serialize them with a lock of their own. Count and byte accounting match
+ * vlc_fifo_GetCount() and vlc_fifo_GetBytes(), and can be read from any
+ * thread.
+ */
+typedef struct vlc_frame_spsc vlc_frame_spsc_t;
+
+/** Creates a queue with a ring of size slots (a power of two). */
+vlc_frame_spsc_t *vlc_frame_spsc_New(size_t size);
+/** Destroys a queue and releases all frames still queued. */
+void vlc_frame_spsc_Delete(vlc_frame_spsc_t *);
+/** Queues a frame (or a chain of frames). Producer thread only. */
+void vlc_frame_spsc_Push(vlc_frame_spsc_t *, struct vlc_frame_t *);
+/** Dequeues the oldest frame, or NULL if empty. Consumer only. */
+struct vlc_frame_t *vlc_frame_spsc_Pop(vlc_frame_spsc_t *);
+/** Dequeues all frames as a chain. Consumer only. */
+struct vlc_frame_t *vlc_frame_spsc_PopAll(vlc_frame_spsc_t *);
+size_t vlc_frame_spsc_GetCount(const vlc_frame_spsc_t *);
+size_t vlc_frame_spsc_GetBytes(const vlc_frame_spsc_t *);
+
 /*
  * Threads subsystem
  */
 
 void vlc_threads_setup (libvlc_int_t *);
 
+/**
+ * Restricts the calling thread to a list of CPUs, e.g. "1,3" or "2-3".
+ *
+ * \return 0 on success, an error number otherwise (ENOTSUP if the platform
+ * does not support it)
+ */
+int vlc_thread_SetAffinity(const char *cpus);
+
 void vlc_trace (const char *fn, const char *file, unsigned line);
 #define vlc_backtrace() vlc_trace(__func__, __FILE__, __LINE__)
 
@@ -29,23 +29,43 @@
 #include <vlc_threads.h>
 #include "libvlc.h"
 
+/*
+ * Work-stealing executor
+ *
+ * Each executor thread owns one deque per priority class. Runnables submitted
+ * from a thread of the executor (e.g. a task spawning sub-tasks) go to its own
+ * deques, others are spread over the running threads. A thread takes its own
+ * runnables from the front, and steals from the back of the other threads
+ * deques when it has nothing left, always serving higher priorities first.
+ *
+ * Each deque is protected by the lock of its thread, so submission, execution
+ * and cancellation only contend between two threads at a time. The executor
+ * lock is only taken to spawn threads, and to put threads to sleep or wake
+ * them up when the executor runs out of work.
+ */
+
+#define VLC_EXECUTOR_PRIORITY_COUNT (VLC_EXECUTOR_PRIORITY_INTERACTIVE + 1)
+
 /**
  * An executor can spawn several threads.
  *
  * This structure contains the data specific to one thread.
  */
 struct vlc_executor_thread {
-    /** Node of vlc_executor.threads list */
-    struct vlc_list node;
-
     /** The executor owning the thread */
     vlc_executor_t *owner;
 
     /** The system thread */
     vlc_thread_t thread;
 
-    /** The current task executed by the thread, NULL if none */
-    struct vlc_runnable *current_task;
+    /** Lock protecting the deques */
+    vlc_mutex_t lock;
+
+    /** Deques of vlc_runnable, one per priority */
+    struct vlc_list deques[VLC_EXECUTOR_PRIORITY_COUNT];
+
+    /** Number of runnables in the deques (to skip empty victims unlocked) */
+    atomic_uint queued;
 };
 
 /**
@@ -53,66 +73,159 @@ struct vlc_executor_thread {
  * header).
  */
 struct vlc_executor {
+    /** Lock for thread spawning, sleeping and idle waiting */
     vlc_mutex_t lock;
 
     /** Maximum number of threads to run the tasks */
     unsigned max_threads;
 
-    /** List of active vlc_executor_thread */
-    struct vlc_list threads;
+    /** Per-thread data, max_threads entries (only nthreads are running) */
+    struct vlc_executor_thread *threads;
 
-    /** Thread count (in a separate field to quickly compare to max_threads) */
-    unsigned nthreads;
+    /** Number of running threads */
+    atomic_uint nthreads;
+
+    /** Next thread to submit a runnable from outside the executor to */
+    atomic_uint next;
 
     /* Number of tasks requested but not finished. */
-    unsigned unfinished;
+    atomic_uint unfinished;
 
     /** Wait for the executor to be idle (i.e. unfinished == 0) */
     vlc_cond_t idle_wait;
 
-    /** Queue of vlc_runnable */
-    struct vlc_list queue;
+    /** Number of runnables in all the deques */
+    atomic_uint queued;
+
+    /** Number of threads waiting for runnables */
+    atomic_uint sleepers;
 
-    /** Wait for the queue to be non-empty */
+    /** Wait for a runnable to be queued */
     vlc_cond_t queue_wait;
 
     /** True if executor deletion is requested */
-    bool closing;
+    atomic_bool closing;
 };
 
+/** The executor thread running on the calling thread, if any */
+static thread_local struct vlc_executor_thread *current_thread;
+
 static void
-QueuePush(vlc_executor_t *executor, struct vlc_runnable *runnable)
+QueuePush(struct vlc_executor_thread *thread, struct vlc_runnable *runnable,
+          enum vlc_executor_priority priority)
 {
-    vlc_mutex_assert(&executor->lock);
+    vlc_executor_t *executor = thread->owner;
 
-    vlc_list_append(&runnable->node, &executor->queue);
-    vlc_cond_signal(&executor->queue_wait);
+    vlc_mutex_lock(&thread->lock);
+    runnable->queue = thread;
+    vlc_list_append(&runnable->node, &thread->deques[priority]);
+    atomic_fetch_add_explicit(&thread->queued, 1, memory_order_relaxed);
+    vlc_mutex_unlock(&thread->lock);
+
+    /* Pairs with the check in ThreadWaitQueue(): either the sleeping thread
+     * sees the new runnable, or we see the sleeping thread. */
+    atomic_fetch_add(&executor->queued, 1);
+    if (atomic_load(&executor->sleepers) > 0)
+    {
+        vlc_mutex_lock(&executor->lock);
+        vlc_cond_signal(&executor->queue_wait);
+        vlc_mutex_unlock(&executor->lock);
+    }
 }
 
-static struct vlc_runnable *
-QueueTake(vlc_executor_t *executor)
+static void
+QueueRemove(struct vlc_executor_thread *thread, struct vlc_runnable *runnable)
 {
-    vlc_mutex_assert(&executor->lock);
-
-    while (!executor->closing && vlc_list_is_empty(&executor->queue))
-        vlc_cond_wait(&executor->queue_wait, &executor->lock);
+    vlc_mutex_assert(&thread->lock);
 
-    if (executor->closing)
-        return NULL;
-
-    struct vlc_runnable *runnable =
-        vlc_list_first_entry_or_null(&executor->queue, struct vlc_runnable,
-                                     node);
-    assert(runnable);
     vlc_list_remove(&runnable->node);
 
     /* Set links to NULL to know that it has been taken by a thread in
      * vlc_executor_Cancel() */
     runnable->node.prev = runnable->node.next = NULL;
 
+    atomic_fetch_sub_explicit(&thread->queued, 1, memory_order_relaxed);
+    atomic_fetch_sub(&thread->owner->queued, 1);
+}
+
+static struct vlc_runnable *
+QueueTakeFrom(struct vlc_executor_thread *thread,
+              enum vlc_executor_priority priority, bool steal)
+{
+    if (atomic_load_explicit(&thread->queued, memory_order_relaxed) == 0)
+        return NULL;
+
+    vlc_mutex_lock(&thread->lock);
+
+    struct vlc_list *deque = &thread->deques[priority];
+    struct vlc_runnable *runnable = steal
+        ? vlc_list_last_entry_or_null(deque, struct vlc_runnable, node)
+        : vlc_list_first_entry_or_null(deque, struct vlc_runnable, node);
+    if (runnable != NULL)
+        QueueRemove(thread, runnable);
+
+    vlc_mutex_unlock(&thread->lock);
     return runnable;
 }
 
+static struct vlc_runnable *
+QueueTake(struct vlc_executor_thread *thread)
+{
+    vlc_executor_t *executor = thread->owner;
+    unsigned self = thread - executor->threads;
+
+    for (int prio = VLC_EXECUTOR_PRIORITY_COUNT - 1; prio >= 0; prio--)
+    {
+        struct vlc_runnable *runnable = QueueTakeFrom(thread, prio, false);
+        if (runnable != NULL)
+            return runnable;
+
+        unsigned nthreads = atomic_load(&executor->nthreads);
+        for (unsigned i = 1; i < nthreads; i++)
+        {
+            struct vlc_executor_thread *victim =
+                &executor->threads[(self + i) % nthreads];
+
+            runnable = QueueTakeFrom(victim, prio, true);
+            if (runnable != NULL)
+                return runnable;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Waits until a runnable may be available.
+ *
+ * \retval false if the executor is closing
+ */
+static bool
+ThreadWaitQueue(vlc_executor_t *executor)
+{
+    vlc_mutex_lock(&executor->lock);
+    atomic_fetch_add(&executor->sleepers, 1);
+    while (!atomic_load(&executor->closing)
+        && atomic_load(&executor->queued) == 0)
+        vlc_cond_wait(&executor->queue_wait, &executor->lock);
+    atomic_fetch_sub(&executor->sleepers, 1);
+    vlc_mutex_unlock(&executor->lock);
+
+    return !atomic_load(&executor->closing);
+}
+
+static void
+TaskFinished(vlc_executor_t *executor)
+{
+    unsigned unfinished = atomic_fetch_sub(&executor->unfinished, 1);
+    assert(unfinished > 0);
+    if (unfinished == 1)
+    {
+        vlc_mutex_lock(&executor->lock);
+        vlc_cond_broadcast(&executor->idle_wait);
+        vlc_mutex_unlock(&executor->lock);
+    }
+}
+
 static void *
 ThreadRun(void *userdata)
 {
@@ -121,28 +234,25 @@ ThreadRun(void *userdata)
 
     vlc_thread_set_name("vlc-exec-runner");
 
-    vlc_mutex_lock(&executor->lock);
+    current_thread = thread;
 
-    struct vlc_runnable *runnable;
-    /* When the executor is closing, QueueTake() returns NULL */
-    while ((runnable = QueueTake(executor)))
+    do
     {
-        thread->current_task = runnable;
-        vlc_mutex_unlock(&executor->lock);
+        struct vlc_runnable *runnable;
 
-        /* Execute the user-provided runnable, without the executor lock */
-        runnable->run(runnable->userdata);
+        /* When the executor is closing, stop taking new runnables */
+        while (!atomic_load(&executor->closing)
+            && (runnable = QueueTake(thread)) != NULL)
+        {
+            /* Execute the user-provided runnable, without any lock */
+            runnable->run(runnable->userdata);
 
-        vlc_mutex_lock(&executor->lock);
-        thread->current_task = NULL;
-
-        assert(executor->unfinished > 0);
-        --executor->unfinished;
-        if (!executor->unfinished)
-            vlc_cond_signal(&executor->idle_wait);
+            TaskFinished(executor);
+        }
     }
+    while (ThreadWaitQueue(executor));
 
-    vlc_mutex_unlock(&executor->lock);
+    current_thread = NULL;
 
     return NULL;
 }
@@ -150,23 +260,17 @@ ThreadRun(void *userdata)
 static int
 SpawnThread(vlc_executor_t *executor)
 {
-    assert(executor->nthreads < executor->max_threads);
+    vlc_mutex_assert(&executor->lock);
 
-    struct vlc_executor_thread *thread = malloc(sizeof(*thread));
-    if (!thread)
-        return VLC_ENOMEM;
+    unsigned nthreads = atomic_load(&executor->nthreads);
+    assert(nthreads < executor->max_threads);
 
-    thread->owner = executor;
-    thread->current_task = NULL;
+    struct vlc_executor_thread *thread = &executor->threads[nthreads];
 
     if (vlc_clone(&thread->thread, ThreadRun, thread))
-    {
-        free(thread);
         return VLC_EGENERIC;
-    }
 
-    executor->nthreads++;
-    vlc_list_append(&thread->node, &executor->threads);
+    atomic_store(&executor->nthreads, nthreads + 1);
 
     return VLC_SUCCESS;
 }
@@ -179,24 +283,45 @@ vlc_executor_New(unsigned max_threads)
     if (!executor)
         return NULL;
 
+    executor->threads = vlc_alloc(max_threads, sizeof(*executor->threads));
+    if (!executor->threads)
+    {
+        free(executor);
+        return NULL;
+    }
+
     vlc_mutex_init(&executor->lock);
 
     executor->max_threads = max_threads;
-    executor->nthreads = 0;
-    executor->unfinished = 0;
+    atomic_init(&executor->nthreads, 0);
+    atomic_init(&executor->next, 0);
+    atomic_init(&executor->unfinished, 0);
+    atomic_init(&executor->queued, 0);
+    atomic_init(&executor->sleepers, 0);
+
+    for (unsigned i = 0; i < max_threads; ++i)
+    {
+        struct vlc_executor_thread *thread = &executor->threads[i];
 
-    vlc_list_init(&executor->threads);
-    vlc_list_init(&executor->queue);
+        thread->owner = executor;
+        vlc_mutex_init(&thread->lock);
+        for (unsigned prio = 0; prio < VLC_EXECUTOR_PRIORITY_COUNT; ++prio)
+            vlc_list_init(&thread->deques[prio]);
+        atomic_init(&thread->queued, 0);
+    }
 
     vlc_cond_init(&executor->idle_wait);
     vlc_cond_init(&executor->queue_wait);
 
-    executor->closing = false;
+    atomic_init(&executor->closing, false);
 
     /* Create one thread on init so that vlc_executor_Submit() may never fail */
+    vlc_mutex_lock(&executor->lock);
     int ret = SpawnThread(executor);
+    vlc_mutex_unlock(&executor->lock);
     if (ret != VLC_SUCCESS)
     {
+        free(executor->threads);
         free(executor);
         return NULL;
     }
@@ -205,42 +330,65 @@ vlc_executor_New(unsigned max_threads)
 }
 
 void
-vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+vlc_executor_SubmitWithPriority(vlc_executor_t *executor,
+                                struct vlc_runnable *runnable,
+                                enum vlc_executor_priority priority)
 {
-    vlc_mutex_lock(&executor->lock);
+    assert(!atomic_load(&executor->closing));
+    assert(priority < VLC_EXECUTOR_PRIORITY_COUNT);
 
-    assert(!executor->closing);
+    unsigned unfinished = atomic_fetch_add(&executor->unfinished, 1) + 1;
 
-    QueuePush(executor, runnable);
+    struct vlc_executor_thread *thread = current_thread;
+    if (thread == NULL || thread->owner != executor)
+    {
+        unsigned nthreads = atomic_load(&executor->nthreads);
+        unsigned next = atomic_fetch_add_explicit(&executor->next, 1,
+                                                  memory_order_relaxed);
+        thread = &executor->threads[next % nthreads];
+    }
 
-    if (++executor->unfinished > executor->nthreads
-            && executor->nthreads < executor->max_threads)
-        /* If it fails, this is not an error, there is at least one thread */
-        SpawnThread(executor);
+    QueuePush(thread, runnable, priority);
 
-    vlc_mutex_unlock(&executor->lock);
+    if (unfinished > atomic_load(&executor->nthreads)
+     && atomic_load(&executor->nthreads) < executor->max_threads)
+    {
+        vlc_mutex_lock(&executor->lock);
+        if (atomic_load(&executor->nthreads) < executor->max_threads)
+            /* If it fails, this is not an error, there is at least one
+             * thread */
+            SpawnThread(executor);
+        vlc_mutex_unlock(&executor->lock);
+    }
+}
+
+void
+vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+{
+    vlc_executor_SubmitWithPriority(executor, runnable,
+                                    VLC_EXECUTOR_PRIORITY_NORMAL);
 }
 
 bool
 vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
 {
-    vlc_mutex_lock(&executor->lock);
+    /* The runnable never moves to another deque once submitted */
+    struct vlc_executor_thread *thread = runnable->queue;
+    assert(thread != NULL && thread->owner == executor);
+
+    vlc_mutex_lock(&thread->lock);
 
     /* Either both prev and next are set, either both are NULL */
     assert(!runnable->node.prev == !runnable->node.next);
 
     bool in_queue = runnable->node.prev;
     if (in_queue)
-    {
-        vlc_list_remove(&runnable->node);
+        QueueRemove(thread, runnable);
 
-        assert(executor->unfinished > 0);
-        --executor->unfinished;
-        if (!executor->unfinished)
-            vlc_cond_signal(&executor->idle_wait);
-    }
+    vlc_mutex_unlock(&thread->lock);
 
-    vlc_mutex_unlock(&executor->lock);
+    if (in_queue)
+        TaskFinished(executor);
 
     return in_queue;
 }
@@ -249,7 +397,7 @@ void
 vlc_executor_WaitIdle(vlc_executor_t *executor)
 {
     vlc_mutex_lock(&executor->lock);
-    while (executor->unfinished)
+    while (atomic_load(&executor->unfinished))
         vlc_cond_wait(&executor->idle_wait, &executor->lock);
     vlc_mutex_unlock(&executor->lock);
 }
@@ -259,32 +407,30 @@ vlc_executor_Delete(vlc_executor_t *executor)
 {
     vlc_mutex_lock(&executor->lock);
 
-    executor->closing = true;
+    atomic_store(&executor->closing, true);
 
     /* All the tasks must be canceled on delete */
-    assert(vlc_list_is_empty(&executor->queue));
-
-    vlc_mutex_unlock(&executor->lock);
+    assert(atomic_load(&executor->queued) == 0);
 
     /* "closing" is now true, this will wake up threads */
     vlc_cond_broadcast(&executor->queue_wait);
 
-    /* The threads list may not be written at this point, so it is safe to read
-     * it without mutex locked (the mutex must be released to join the
+    vlc_mutex_unlock(&executor->lock);
+
+    /* No thread may be spawned at this point, so it is safe to read nthreads
+     * without mutex locked (the mutex must be released to join the
      * threads). */
 
-    struct vlc_executor_thread *thread;
-    vlc_list_foreach(thread, &executor->threads, node)
-    {
-        vlc_join(thread->thread, NULL);
-        free(thread);
-    }
+    unsigned nthreads = atomic_load(&executor->nthreads);
+    for (unsigned i = 0; i < nthreads; ++i)
+        vlc_join(executor->threads[i].thread, NULL);
 
     /* The queue must still be empty (no runnable submitted a new runnable) */
-    assert(vlc_list_is_empty(&executor->queue));
+    assert(atomic_load(&executor->queued) == 0);
 
     /* There are no tasks anymore */
-    assert(!executor->unfinished);
+    assert(!atomic_load(&executor->unfinished));
 
+    free(executor->threads);
     free(executor);
 }
@@ -26,6 +26,7 @@
 #endif
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 
 #include <vlc_common.h>
@@ -136,3 +137,152 @@ block_t *vlc_fifo_Show( block_fifo_t *p_fifo )
 
     return b;
 }
+
+/**
+ * Internal state for single-producer single-consumer frame queues
+ */
+struct vlc_frame_spsc
+{
+    atomic_size_t head; /**< next ring slot to write (producer-owned) */
+    atomic_size_t tail; /**< next ring slot to read (consumer-owned) */
+    atomic_size_t depth;
+    atomic_size_t bytes;
+
+    /* Overflow lane, used when the ring is full and until it drains */
+    vlc_mutex_t lock;
+    vlc_frame_t *overflow;
+    vlc_frame_t **overflow_last;
+    atomic_size_t overflow_depth;
+
+    size_t mask;
+    vlc_frame_t *ring[];
+};
+
+vlc_frame_spsc_t *vlc_frame_spsc_New(size_t size)
+{
+    assert(size > 0 && (size & (size - 1)) == 0);
+
+    vlc_frame_spsc_t *q = malloc(sizeof (*q) + size * sizeof (q->ring[0]));
+    if (unlikely(q == NULL))
+        return NULL;
+
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->depth, 0);
+    atomic_init(&q->bytes, 0);
+    vlc_mutex_init(&q->lock);
+    q->overflow = NULL;
+    q->overflow_last = &q->overflow;
+    atomic_init(&q->overflow_depth, 0);
+    q->mask = size - 1;
+    return q;
+}
+
+void vlc_frame_spsc_Delete(vlc_frame_spsc_t *q)
+{
+    vlc_frame_ChainRelease(vlc_frame_spsc_PopAll(q));
+    free(q);
+}
+
+static void vlc_frame_spsc_PushOne(vlc_frame_spsc_t *q, vlc_frame_t *frame)
+{
+    /* Accounting is updated before the frame is published, so that the
+     * consumer never sees it going below zero. */
+    atomic_fetch_add(&q->depth, 1);
+    atomic_fetch_add_explicit(&q->bytes, frame->i_buffer,
+                              memory_order_relaxed);
+
+    /* Only the producer increments the overflow depth: if it reads zero
+     * here, the overflow lane is really empty and the ring preserves
+     * ordering. */
+    if (atomic_load_explicit(&q->overflow_depth, memory_order_relaxed) == 0)
+    {
+        size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+        size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+
+        if (head - tail <= q->mask)
+        {
+            q->ring[head & q->mask] = frame;
+            atomic_store_explicit(&q->head, head + 1, memory_order_release);
+            return;
+        }
+    }
+
+    vlc_mutex_lock(&q->lock);
+    *(q->overflow_last) = frame;
+    q->overflow_last = &frame->p_next;
+    atomic_fetch_add_explicit(&q->overflow_depth, 1, memory_order_relaxed);
+    vlc_mutex_unlock(&q->lock);
+}
+
+void vlc_frame_spsc_Push(vlc_frame_spsc_t *q, vlc_frame_t *frame)
+{
+    while (frame != NULL)
+    {
+        vlc_frame_t *next = frame->p_next;
+
+        frame->p_next = NULL;
+        vlc_frame_spsc_PushOne(q, frame);
+        frame = next;
+    }
+}
+
+vlc_frame_t *vlc_frame_spsc_Pop(vlc_frame_spsc_t *q)
+{
+    vlc_frame_t *frame = NULL;
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+
+    if (tail != head)
+    {
+        frame = q->ring[tail & q->mask];
+        atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    }
+    else
+    if (atomic_load_explicit(&q->overflow_depth, memory_order_acquire) > 0)
+    {   /* The ring is drained: older frames are in the overflow lane. */
+        vlc_mutex_lock(&q->lock);
+        frame = q->overflow;
+        if (frame != NULL)
+        {
+            q->overflow = frame->p_next;
+            if (q->overflow == NULL)
+                q->overflow_last = &q->overflow;
+            frame->p_next = NULL;
+            atomic_fetch_sub_explicit(&q->overflow_depth, 1,
+                                      memory_order_relaxed);
+        }
+        vlc_mutex_unlock(&q->lock);
+    }
+
+    if (frame != NULL)
+    {
+        assert(atomic_load_explicit(&q->depth, memory_order_relaxed) > 0);
+        atomic_fetch_sub_explicit(&q->bytes, frame->i_buffer,
+                                  memory_order_relaxed);
+        atomic_fetch_sub(&q->depth, 1);
+    }
+    return frame;
+}
+
+vlc_frame_t *vlc_frame_spsc_PopAll(vlc_frame_spsc_t *q)
+{
+    vlc_frame_t *first = NULL, **pp = &first, *frame;
+
+    while ((frame = vlc_frame_spsc_Pop(q)) != NULL)
+    {
+        *pp = frame;
+        pp = &frame->p_next;
+    }
+    return first;
+}
+
+size_t vlc_frame_spsc_GetCount(const vlc_frame_spsc_t *q)
+{
+    return atomic_load(&q->depth);
+}
+
+size_t vlc_frame_spsc_GetBytes(const vlc_frame_spsc_t *q)
+{
+    return atomic_load_explicit(&q->bytes, memory_order_relaxed);
+}
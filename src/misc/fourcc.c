@@ -810,6 +810,13 @@ static const struct
     { { VLC_CODEC_VUYA, VLC_CODEC_Y210,
         VLC_CODEC_Y410, 0 },                   PACKED_FMT(4, 32) },
 
+    /* MMAL zero-copy: SAND planes are 128 byte wide columns, i_pitch is the
+     * column height in lines rather than a byte stride */
+    { { VLC_CODEC_MMAL_ZC_I420 },              PLANAR_8(3, 2, 2) },
+    { { VLC_CODEC_MMAL_ZC_SAND8 },             SEMIPLANAR(2, 2, 1, 8) },
+    { { VLC_CODEC_MMAL_ZC_SAND30 },            { 2, { {{1,3}, {1,1}}, {{1,3}, {1,2}} }, 4, 30 } },
+    { { VLC_CODEC_MMAL_ZC_RGB32 },             PACKED_FMT(4, 24) },
+
     { { VLC_CODEC_Y211, 0 },                   { 1, { {{1,4}, {1,1}} }, 4, 32 } },
     { { VLC_CODEC_XYZ12,  0 },                 PACKED_FMT(6, 48) },
 
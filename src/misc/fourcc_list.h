@@ -1221,6 +1221,18 @@ static const staticentry_t p_list_video[] = {
     B(VLC_CODEC_MMAL_OPAQUE, "MMAL opaque"),
         A("MMAL"),
 
+    B(VLC_CODEC_MMAL_ZC_I420, "4:2:0 MMAL zero-copy"),
+        A("Z420"),
+
+    B(VLC_CODEC_MMAL_ZC_SAND8, "4:2:0 MMAL zero-copy SAND128"),
+        A("ZSD8"),
+
+    B(VLC_CODEC_MMAL_ZC_SAND30, "4:2:0 10bits MMAL zero-copy SAND128"),
+        A("ZSD3"),
+
+    B(VLC_CODEC_MMAL_ZC_RGB32, "RGB32 MMAL zero-copy"),
+        A("ZRGB"),
+
     B(VLC_CODEC_D3D9_OPAQUE, "4:2:0 D3D9 opaque"),
         A("DXA9"),
 
@@ -37,6 +37,7 @@
 #include <vlc_fs.h>
 
 #include "ancillary.h"
+#include "../libvlc.h"
 
 #ifndef NDEBUG
 static void vlc_frame_Check (vlc_frame_t *frame)
@@ -111,6 +112,301 @@ static const struct vlc_frame_callbacks vlc_frame_generic_cbs =
 /** Initial reserved header and footer size. */
 #define VLC_FRAME_PADDING      32
 
+/*
+ * Frame pool
+ *
+ * Frames allocated with vlc_frame_Alloc() are rounded up to a power-of-two
+ * size class and recycled on release instead of going back to the C run-time
+ * every time. Each pooled frame belongs to the cache of the thread that
+ * allocated it, and its owner is stored after the usable space. A frame
+ * released by its owner thread goes back to the local free list. A frame
+ * released by any other thread, as in the demux -> decoder -> output
+ * hand-off, is pushed onto a lock-free list of the owner cache, which the
+ * owner takes over as a whole when its local list runs dry. Neither path
+ * takes a lock nor calls the heap in the steady state.
+ *
+ * Other threads may still hold frames when the owner exits, so caches are
+ * never freed: they are abandoned then adopted by the next new thread.
+ */
+
+/** Smallest pooled allocation (log2, frame header included) */
+#define VLC_FRAME_POOL_MIN_SHIFT 9  /* 512 bytes */
+/** Largest pooled allocation (log2, frame header included) */
+#define VLC_FRAME_POOL_MAX_SHIFT 17 /* 128 KiB */
+#define VLC_FRAME_POOL_CLASSES \
+    (VLC_FRAME_POOL_MAX_SHIFT - VLC_FRAME_POOL_MIN_SHIFT + 1)
+/** Minimum frames kept per size class in each thread cache */
+#define VLC_FRAME_POOL_CACHE 8
+/** Bytes kept per size class in each thread cache */
+#define VLC_FRAME_POOL_CACHE_SIZE (1 << 18)
+
+struct vlc_frame_class
+{
+    atomic_ulong cache_hits;
+    atomic_ulong remote_hits;
+    atomic_ulong misses;
+    atomic_ulong drops;
+};
+
+struct vlc_frame_cache
+{
+    struct vlc_frame_cache *next; /**< next abandoned cache */
+    /** Frames released by the owner thread, linked through p_next */
+    vlc_frame_t *frames[VLC_FRAME_POOL_CLASSES];
+    unsigned count[VLC_FRAME_POOL_CLASSES];
+    /** Frames released by other threads, linked through p_next */
+    vlc_frame_t *_Atomic remote[VLC_FRAME_POOL_CLASSES];
+};
+
+static struct
+{
+    vlc_once_t once;
+    bool usable;
+    vlc_threadvar_t key;
+    vlc_mutex_t lock; /**< protects abandoned */
+    struct vlc_frame_cache *abandoned;
+    struct vlc_frame_class classes[VLC_FRAME_POOL_CLASSES];
+    atomic_ulong oversize;
+} vlc_frame_pool = { .once = VLC_STATIC_ONCE };
+
+/** Gets the owner cache slot of a pooled frame. */
+static struct vlc_frame_cache **vlc_frame_pool_Owner(vlc_frame_t *frame)
+{
+    return (struct vlc_frame_cache **)(frame->p_start + frame->i_size);
+}
+
+static unsigned vlc_frame_pool_CacheMax(unsigned index)
+{
+    unsigned max = VLC_FRAME_POOL_CACHE_SIZE
+                   >> (VLC_FRAME_POOL_MIN_SHIFT + index);
+
+    return (max > VLC_FRAME_POOL_CACHE) ? max : VLC_FRAME_POOL_CACHE;
+}
+
+static void vlc_frame_pool_FreeList(vlc_frame_t *frame)
+{
+    while (frame != NULL)
+    {
+        vlc_frame_t *next = frame->p_next;
+
+        assert (frame->p_start == (unsigned char *)(frame + 1));
+        free (frame);
+        frame = next;
+    }
+}
+
+static void vlc_frame_cache_Destroy(void *data)
+{
+    struct vlc_frame_cache *cache = data;
+
+    /* Free what this thread kept, but not the cache itself: other threads
+     * may still return frames to it until it is adopted. */
+    for (unsigned i = 0; i < VLC_FRAME_POOL_CLASSES; i++)
+    {
+        vlc_frame_pool_FreeList(cache->frames[i]);
+        cache->frames[i] = NULL;
+        cache->count[i] = 0;
+        vlc_frame_pool_FreeList(atomic_exchange_explicit(&cache->remote[i],
+                                                         NULL,
+                                                         memory_order_acquire));
+    }
+
+    vlc_mutex_lock(&vlc_frame_pool.lock);
+    cache->next = vlc_frame_pool.abandoned;
+    vlc_frame_pool.abandoned = cache;
+    vlc_mutex_unlock(&vlc_frame_pool.lock);
+}
+
+static void vlc_frame_pool_Init(void *data)
+{
+    (void) data;
+
+    for (unsigned i = 0; i < VLC_FRAME_POOL_CLASSES; i++)
+    {
+        struct vlc_frame_class *class = &vlc_frame_pool.classes[i];
+
+        atomic_init(&class->cache_hits, 0);
+        atomic_init(&class->remote_hits, 0);
+        atomic_init(&class->misses, 0);
+        atomic_init(&class->drops, 0);
+    }
+    atomic_init(&vlc_frame_pool.oversize, 0);
+    vlc_mutex_init(&vlc_frame_pool.lock);
+    vlc_frame_pool.abandoned = NULL;
+
+    vlc_frame_pool.usable =
+        vlc_threadvar_create(&vlc_frame_pool.key,
+                             vlc_frame_cache_Destroy) == 0;
+}
+
+/** Gets the calling thread cache, creating or adopting one if needed. */
+static struct vlc_frame_cache *vlc_frame_cache_Get(void)
+{
+    struct vlc_frame_cache *cache = vlc_threadvar_get(vlc_frame_pool.key);
+
+    if (likely(cache != NULL))
+        return cache;
+
+    vlc_mutex_lock(&vlc_frame_pool.lock);
+    cache = vlc_frame_pool.abandoned;
+    if (cache != NULL)
+        vlc_frame_pool.abandoned = cache->next;
+    vlc_mutex_unlock(&vlc_frame_pool.lock);
+
+    if (cache == NULL)
+    {
+        cache = malloc(sizeof (*cache));
+        if (unlikely(cache == NULL))
+            return NULL;
+
+        for (unsigned i = 0; i < VLC_FRAME_POOL_CLASSES; i++)
+        {
+            cache->frames[i] = NULL;
+            cache->count[i] = 0;
+            atomic_init(&cache->remote[i], NULL);
+        }
+    }
+
+    if (vlc_threadvar_set(vlc_frame_pool.key, cache))
+    {
+        vlc_mutex_lock(&vlc_frame_pool.lock);
+        cache->next = vlc_frame_pool.abandoned;
+        vlc_frame_pool.abandoned = cache;
+        vlc_mutex_unlock(&vlc_frame_pool.lock);
+        return NULL;
+    }
+    return cache;
+}
+
+static void vlc_frame_pool_Release(vlc_frame_t *frame)
+{
+    struct vlc_frame_cache *owner = *vlc_frame_pool_Owner(frame);
+    size_t alloc = sizeof (*frame) + frame->i_size + sizeof (owner);
+    unsigned index = ctz(alloc) - VLC_FRAME_POOL_MIN_SHIFT;
+
+    assert (frame->p_start == (unsigned char *)(frame + 1));
+    assert ((alloc & (alloc - 1)) == 0);
+    assert (index < VLC_FRAME_POOL_CLASSES);
+
+    if (unlikely(owner == NULL))
+    {   /* Allocated by a thread without cache */
+        free(frame);
+        return;
+    }
+
+    if (owner != vlc_threadvar_get(vlc_frame_pool.key))
+    {   /* Hand it back to the owner thread */
+        vlc_frame_t *head = atomic_load_explicit(&owner->remote[index],
+                                                 memory_order_relaxed);
+        do
+            frame->p_next = head;
+        while (!atomic_compare_exchange_weak_explicit(&owner->remote[index],
+                                                      &head, frame,
+                                                      memory_order_release,
+                                                      memory_order_relaxed));
+        return;
+    }
+
+    if (owner->count[index] >= vlc_frame_pool_CacheMax(index))
+    {
+        free(frame);
+        atomic_fetch_add_explicit(&vlc_frame_pool.classes[index].drops, 1,
+                                  memory_order_relaxed);
+        return;
+    }
+
+    frame->p_next = owner->frames[index];
+    owner->frames[index] = frame;
+    owner->count[index]++;
+}
+
+static const struct vlc_frame_callbacks vlc_frame_pool_cbs =
+{
+    vlc_frame_pool_Release,
+};
+
+/** Gets a frame of exactly 2^shift bytes, recycled if possible. */
+static vlc_frame_t *vlc_frame_pool_Get(unsigned shift)
+{
+    unsigned index = shift - VLC_FRAME_POOL_MIN_SHIFT;
+    struct vlc_frame_class *class = &vlc_frame_pool.classes[index];
+    struct vlc_frame_cache *cache = vlc_frame_cache_Get();
+    vlc_frame_t *frame;
+
+    if (likely(cache != NULL))
+    {
+        frame = cache->frames[index];
+        if (frame != NULL)
+        {
+            cache->frames[index] = frame->p_next;
+            cache->count[index]--;
+            atomic_fetch_add_explicit(&class->cache_hits, 1,
+                                      memory_order_relaxed);
+            goto out;
+        }
+
+        /* Take over everything other threads returned at once */
+        frame = atomic_exchange_explicit(&cache->remote[index], NULL,
+                                         memory_order_acquire);
+        if (frame != NULL)
+        {
+            vlc_frame_t *next = frame->p_next;
+
+            cache->frames[index] = next;
+            for (; next != NULL; next = next->p_next)
+                cache->count[index]++;
+            atomic_fetch_add_explicit(&class->remote_hits, 1,
+                                      memory_order_relaxed);
+            goto out;
+        }
+    }
+
+    atomic_fetch_add_explicit(&class->misses, 1, memory_order_relaxed);
+    frame = malloc((size_t)1 << shift);
+    if (unlikely(frame == NULL))
+        return NULL;
+out:
+    *(struct vlc_frame_cache **)((unsigned char *)frame + ((size_t)1 << shift)
+                                 - sizeof (cache)) = cache;
+    return frame;
+}
+
+void vlc_frame_pool_Dump(vlc_object_t *obj)
+{
+    if (!vlc_frame_pool.usable)
+        return;
+
+    for (unsigned i = 0; i < VLC_FRAME_POOL_CLASSES; i++)
+    {
+        struct vlc_frame_class *class = &vlc_frame_pool.classes[i];
+        unsigned long cache_hits = atomic_load_explicit(&class->cache_hits,
+                                                        memory_order_relaxed);
+        unsigned long remote_hits = atomic_load_explicit(&class->remote_hits,
+                                                         memory_order_relaxed);
+        unsigned long misses = atomic_load_explicit(&class->misses,
+                                                    memory_order_relaxed);
+        unsigned long drops = atomic_load_explicit(&class->drops,
+                                                   memory_order_relaxed);
+        unsigned long total = cache_hits + remote_hits + misses;
+
+        if (total == 0)
+            continue;
+
+        msg_Info(obj, "frame pool %6zu bytes: %lu allocations, "
+                 "%lu from thread cache, %lu returned by other threads, "
+                 "%lu from heap (%.1f%% hit ratio), %lu dropped",
+                 (size_t)1 << (VLC_FRAME_POOL_MIN_SHIFT + i), total,
+                 cache_hits, remote_hits, misses,
+                 100. * (cache_hits + remote_hits) / total, drops);
+    }
+
+    unsigned long oversize = atomic_load_explicit(&vlc_frame_pool.oversize,
+                                                  memory_order_relaxed);
+    if (oversize > 0)
+        msg_Info(obj, "frame pool: %lu allocations above %zu bytes",
+                 oversize, (size_t)1 << VLC_FRAME_POOL_MAX_SHIFT);
+}
+
 vlc_frame_t *vlc_frame_Alloc (size_t size)
 {
     if (unlikely(size >> 28))
@@ -120,16 +416,42 @@ vlc_frame_t *vlc_frame_Alloc (size_t size)
     }
 
     /* 2 * VLC_FRAME_PADDING: pre + post padding */
-    const size_t alloc = sizeof (vlc_frame_t) + VLC_FRAME_ALIGN + (2 * VLC_FRAME_PADDING)
-                       + size;
+    size_t alloc = sizeof (vlc_frame_t) + VLC_FRAME_ALIGN + (2 * VLC_FRAME_PADDING)
+                 + size;
     if (unlikely(alloc <= size))
         return NULL;
 
-    vlc_frame_t *f = malloc (alloc);
+    const struct vlc_frame_callbacks *cbs = &vlc_frame_generic_cbs;
+    size_t usable;
+    vlc_frame_t *f;
+
+    vlc_once(&vlc_frame_pool.once, vlc_frame_pool_Init, NULL);
+
+    /* Pooled frames end with their owner cache pointer */
+    if (alloc + sizeof (void *) <= ((size_t)1 << VLC_FRAME_POOL_MAX_SHIFT)
+     && likely(vlc_frame_pool.usable))
+    {
+        unsigned shift = (sizeof (unsigned long) * 8)
+                         - vlc_clzl(alloc + sizeof (void *) - 1);
+
+        if (shift < VLC_FRAME_POOL_MIN_SHIFT)
+            shift = VLC_FRAME_POOL_MIN_SHIFT;
+        usable = ((size_t)1 << shift) - sizeof (*f) - sizeof (void *);
+        cbs = &vlc_frame_pool_cbs;
+        f = vlc_frame_pool_Get(shift);
+    }
+    else
+    {
+        atomic_fetch_add_explicit(&vlc_frame_pool.oversize, 1,
+                                  memory_order_relaxed);
+        usable = alloc - sizeof (*f);
+        f = malloc (alloc);
+    }
+
     if (unlikely(f == NULL))
         return NULL;
 
-    vlc_frame_Init(f, &vlc_frame_generic_cbs, f + 1, alloc - sizeof (*f));
+    vlc_frame_Init(f, cbs, f + 1, usable);
     static_assert ((VLC_FRAME_PADDING % VLC_FRAME_ALIGN) == 0,
                    "VLC_FRAME_PADDING must be a multiple of VLC_FRAME_ALIGN");
     f->p_buffer += VLC_FRAME_PADDING + VLC_FRAME_ALIGN - 1;
@@ -54,6 +54,7 @@ typedef struct vlc_modcap
     char *name;
     module_t **modv;
     size_t modc;
+    size_t moda; /**< Allocated size of modv */
 } vlc_modcap_t;
 
 static int vlc_modcap_cmp(const void *a, const void *b)
@@ -103,43 +104,85 @@ static struct
 vlc_plugin_t *vlc_plugins = NULL;
 
 /**
- * Adds a module to the bank
+ * Looks up a capability in the bank, adding it if needed
  */
-static int vlc_module_store(module_t *mod)
+static vlc_modcap_t *vlc_modcap_get(const char *name)
 {
-    const char *name = module_get_capability(mod);
+    vlc_modcap_t key = { .name = (char *)name };
+    void **cp = tfind(&key, &modules.caps_tree, vlc_modcap_cmp);
+
+    if (cp != NULL)
+        return *cp;
+
     vlc_modcap_t *cap = malloc(sizeof (*cap));
     if (unlikely(cap == NULL))
-        return -1;
+        return NULL;
 
     cap->name = strdup(name);
     cap->modv = NULL;
     cap->modc = 0;
+    cap->moda = 0;
 
     if (unlikely(cap->name == NULL))
         goto error;
 
-    void **cp = tsearch(cap, &modules.caps_tree, vlc_modcap_cmp);
+    cp = tsearch(cap, &modules.caps_tree, vlc_modcap_cmp);
     if (unlikely(cp == NULL))
         goto error;
 
-    if (*cp != cap)
-    {
-        vlc_modcap_free(cap);
-        cap = *cp;
-    }
+    assert(*cp == cap);
+    return cap;
+error:
+    vlc_modcap_free(cap);
+    return NULL;
+}
+
+/**
+ * Ensures a capability has room for more modules
+ */
+static int vlc_modcap_reserve(vlc_modcap_t *cap, size_t n)
+{
+    if (cap->moda - cap->modc >= n)
+        return 0;
 
-    module_t **modv = realloc(cap->modv, sizeof (*modv) * (cap->modc + 1));
+    module_t **modv = realloc(cap->modv, sizeof (*modv) * (cap->modc + n));
     if (unlikely(modv == NULL))
         return -1;
 
     cap->modv = modv;
+    cap->moda = cap->modc + n;
+    return 0;
+}
+
+#ifdef HAVE_DYNAMIC_PLUGINS
+/**
+ * Reserves room for the modules of a capability listed in a plugins cache
+ */
+static void vlc_modcap_reserve_cache(const char *name, size_t n)
+{
+    vlc_modcap_t *cap = vlc_modcap_get(name);
+
+    if (likely(cap != NULL))
+        vlc_modcap_reserve(cap, n);
+}
+#endif
+
+/**
+ * Adds a module to the bank
+ */
+static int vlc_module_store(module_t *mod)
+{
+    vlc_modcap_t *cap = vlc_modcap_get(module_get_capability(mod));
+    if (unlikely(cap == NULL))
+        return -1;
+
+    if (cap->modc == cap->moda
+     && vlc_modcap_reserve(cap, cap->modc ? cap->modc : 4))
+        return -1;
+
     cap->modv[cap->modc] = mod;
     cap->modc++;
     return 0;
-error:
-    vlc_modcap_free(cap);
-    return -1;
 }
 
 /**
@@ -520,7 +563,8 @@ static void AllocatePluginPath(vlc_object_t *obj, const char *path,
     };
 
     if (mode & CACHE_READ_FILE)
-        bank.cache = vlc_cache_load(obj, path, &modules.caches);
+        bank.cache = vlc_cache_load(obj, path, &modules.caches,
+                                    vlc_modcap_reserve_cache);
     else
         msg_Dbg(bank.obj, "ignoring plugins cache file");
 
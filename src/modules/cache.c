@@ -36,12 +36,17 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <assert.h>
+#ifdef HAVE_SEARCH_H
+# include <search.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_memstream.h>
 #include "libvlc.h"
 
 #include <vlc_plugin.h>
+#include <vlc_modules.h>
 #include <errno.h>
 
 #include "config/configuration.h"
@@ -57,13 +62,99 @@
 #ifdef HAVE_DYNAMIC_PLUGINS
 /* Sub-version number
  * (only used to avoid breakage in dev version when cache structure changes) */
-#define CACHE_SUBVERSION_NUM 36
+#define CACHE_SUBVERSION_NUM 38
 
 /* Cache filename */
 #define CACHE_NAME "plugins.dat"
 /* Magic for the cache filename */
 #define CACHE_STRING "cache "PACKAGE_NAME" "PACKAGE_VERSION
 
+/* Alignment of the cache header and of each table */
+#define CACHE_ALIGN 8
+
+/*
+ * After the version checks, the cache consists of a header, tables of
+ * fixed-size records and a string table, so that it can be used in place from
+ * a memory mapping. Offsets of the tables are relative to the header. Strings
+ * are referred to by their offset within the string table, 0 meaning NULL.
+ * Configuration items keep a serialised variable-size form: they are only
+ * loaded when first needed, see vlc_cache_load_config().
+ */
+struct vlc_cache_header
+{
+    uint32_t plugins; /**< Offset of the plugin records */
+    uint32_t plugin_count;
+    uint32_t modules; /**< Offset of the module records */
+    uint32_t module_count;
+    uint32_t shortcuts; /**< Offset of the shortcut names */
+    uint32_t shortcut_count;
+    uint32_t caps; /**< Offset of the capabilities index */
+    uint32_t cap_count;
+    uint32_t names; /**< Offset of the configuration item names */
+    uint32_t name_count;
+    uint32_t config; /**< Offset of the serialised configuration items */
+    uint32_t config_size;
+    uint32_t strings; /**< Offset of the string table */
+    uint32_t strings_size;
+};
+
+struct vlc_cache_plugin
+{
+    int64_t mtime;
+    uint64_t size;
+    uint32_t path;
+    uint32_t textdomain;
+    uint32_t module; /**< Index of the first module record */
+    uint32_t module_count;
+    uint32_t config; /**< Offset of the items within the configuration */
+    uint32_t config_size;
+    uint32_t name; /**< Index of the name of the first item */
+    uint16_t conf_size;
+    uint16_t conf_count;
+    uint16_t conf_booleans;
+    uint8_t unloadable;
+    uint8_t reserved[5];
+};
+
+struct vlc_cache_module
+{
+    uint32_t shortname;
+    uint32_t longname;
+    uint32_t help;
+    uint32_t capability;
+    uint32_t activate;
+    uint32_t deactivate;
+    int32_t score;
+    uint32_t shortcut; /**< Index of the first shortcut */
+    uint32_t shortcut_count;
+    uint32_t probe_extensions;
+    uint32_t probe_mime;
+    uint32_t probe_magic;
+};
+
+/* Capabilities index entry, sorted by name */
+struct vlc_cache_cap
+{
+    uint32_t name;
+    uint32_t module_count; /**< Number of modules with the capability */
+};
+
+/* Validated view of a loaded cache */
+struct vlc_cache
+{
+    const struct vlc_cache_plugin *plugins;
+    size_t plugin_count;
+    const struct vlc_cache_module *modules;
+    size_t module_count;
+    const uint32_t *shortcuts;
+    size_t shortcut_count;
+    const uint32_t *names;
+    size_t name_count;
+    const uint8_t *config;
+    size_t config_size;
+    const char *strings;
+    size_t strings_size;
+};
 
 static int vlc_cache_load_immediate(void *out, block_t *in, size_t size)
 {
@@ -179,7 +270,7 @@ static int vlc_cache_load_align(size_t align, block_t *file)
     if (vlc_cache_load_align(alignof(t), file)) \
         goto error
 
-static int vlc_cache_load_config(struct vlc_param *param, block_t *file)
+static int vlc_cache_load_config_item(struct vlc_param *param, block_t *file)
 {
     module_config_t *cfg = &param->item;
 
@@ -200,8 +291,11 @@ static int vlc_cache_load_config(struct vlc_param *param, block_t *file)
         const char *psz;
         LOAD_STRING(psz);
         cfg->orig.psz = (char *)psz;
-        atomic_init(&param->value.str, NULL);
-        vlc_param_SetString(param, psz);
+
+        /* The item is not visible yet: no need for vlc_param_SetString() */
+        char *str = (psz != NULL && psz[0] != '\0') ? strdup(psz) : NULL;
+        atomic_init(&param->value.str, str);
+        cfg->value.psz = str;
 
         if (cfg->list_count)
             cfg->list.psz = xmalloc (cfg->list_count * sizeof (char *));
@@ -250,109 +344,226 @@ error:
 
 static int vlc_cache_load_plugin_config(vlc_plugin_t *plugin, block_t *file)
 {
-    uint16_t lines;
-
-    /* Calculate the structure length */
-    LOAD_IMMEDIATE (lines);
+    size_t lines = plugin->conf.size, count = 0, booleans = 0;
+    struct vlc_param *params = NULL;
 
-    /* Allocate memory */
-    if (lines)
+    if (lines > 0)
     {
-        plugin->conf.params = calloc(sizeof (struct vlc_param), lines);
-        if (unlikely(plugin->conf.params == NULL))
-        {
-            plugin->conf.size = 0;
+        params = calloc(lines, sizeof (*params));
+        if (unlikely(params == NULL))
             return -1;
-        }
     }
-    else
-        plugin->conf.params = NULL;
-
-    plugin->conf.size = lines;
 
-    /* Do the duplication job */
     for (size_t i = 0; i < lines; i++)
     {
-        struct vlc_param *param = plugin->conf.params + i;
+        struct vlc_param *param = params + i;
         module_config_t *item = &param->item;
 
-        if (vlc_cache_load_config(param, file))
-            return -1;
+        if (vlc_cache_load_config_item(param, file))
+            goto error;
+
+        /* The items were indexed by name before they were loaded */
+        const char *name = vlc_plugin_ConfigName(plugin, i);
 
         if (CONFIG_ITEM(item->i_type))
         {
-            plugin->conf.count++;
+            if (name == NULL || item->psz_name == NULL
+             || strcmp(name, item->psz_name))
+                goto error;
+            count++;
             if (item->i_type == CONFIG_ITEM_BOOL)
-                plugin->conf.booleans++;
+                booleans++;
         }
+        else if (name != NULL)
+            goto error;
         param->owner = plugin;
     }
 
+    if (file->i_buffer != 0
+     || count != plugin->conf.count || booleans != plugin->conf.booleans)
+        goto error;
+
+    plugin->conf.params = params;
     return 0;
 error:
-    return -1; /* FIXME: leaks */
+    config_Free(params, lines);
+    return -1;
 }
 
-static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
+/**
+ * Loads the configuration items of a plug-in from the plugins cache.
+ *
+ * The items are only deserialised when first needed, see vlc_plugin_Config().
+ * If they turn out to be corrupted, the plug-in is left without items.
+ */
+int vlc_cache_load_config(vlc_plugin_t *plugin)
+{
+    static vlc_mutex_t lock = VLC_STATIC_MUTEX;
+    int ret = 0;
+
+    vlc_mutex_lock(&lock);
+
+    uintptr_t items = atomic_load_explicit(&plugin->conf.cache,
+                                           memory_order_relaxed);
+    if (items != 0)
+    {   /* Lock is held and the items are not loaded yet */
+        block_t file = {
+            .p_buffer = (uint8_t *)items,
+            .i_buffer = plugin->conf.cache_size,
+        };
+
+        ret = vlc_cache_load_plugin_config(plugin, &file);
+        if (ret)
+        {
+            plugin->conf.size = 0;
+            plugin->conf.count = 0;
+            plugin->conf.booleans = 0;
+        }
+
+        atomic_store_explicit(&plugin->conf.cache, 0, memory_order_release);
+    }
+    vlc_mutex_unlock(&lock);
+    return ret;
+}
+
+/* Checks that a table lies within the cache and is suitably aligned */
+static const void *vlc_cache_table(const uint8_t *base, size_t size,
+                                   uint32_t offset, size_t count,
+                                   size_t elem_size, size_t align)
+{
+    if (offset > size || count > (size - offset) / elem_size)
+        return NULL;
+
+    const uint8_t *table = base + offset;
+
+    if (((uintptr_t)table) % align)
+        return NULL;
+    return table;
+}
+
+#define CACHE_TABLE(p, type, offset, count) \
+    ((p) = vlc_cache_table(base, size, offset, count, sizeof (type), \
+                           alignof (type))) == NULL
+
+static int vlc_cache_string(const struct vlc_cache *cache, uint32_t offset,
+                            const char **restrict p)
+{
+    if (offset >= cache->strings_size)
+        return -1;
+
+    /* The string table starts and ends with a nul byte */
+    *p = (offset != 0) ? cache->strings + offset : NULL;
+    return 0;
+}
+
+#define LOAD_STRING_REF(a, offset) \
+    if (vlc_cache_string(cache, offset, &(a))) \
+        goto error
+
+static int vlc_cache_load_module(const struct vlc_cache *cache,
+                                 vlc_plugin_t *plugin,
+                                 const struct vlc_cache_module *rec)
 {
     module_t *module = vlc_module_create(plugin);
     if (unlikely(module == NULL))
         return -1;
 
-    LOAD_STRING(module->psz_shortname);
-    LOAD_STRING(module->psz_longname);
-    LOAD_STRING(module->psz_help);
-
-    LOAD_IMMEDIATE(module->i_shortcuts);
-    if (module->i_shortcuts > MODULE_SHORTCUT_MAX)
+    LOAD_STRING_REF(module->psz_shortname, rec->shortname);
+    LOAD_STRING_REF(module->psz_longname, rec->longname);
+    LOAD_STRING_REF(module->psz_help, rec->help);
+    LOAD_STRING_REF(module->activate_name, rec->activate);
+    LOAD_STRING_REF(module->deactivate_name, rec->deactivate);
+    LOAD_STRING_REF(module->psz_capability, rec->capability);
+    LOAD_STRING_REF(module->probe_extensions, rec->probe_extensions);
+    LOAD_STRING_REF(module->probe_mime, rec->probe_mime);
+    LOAD_STRING_REF(module->probe_magic, rec->probe_magic);
+    module->i_score = rec->score;
+
+    if (rec->shortcut_count > MODULE_SHORTCUT_MAX
+     || rec->shortcut > cache->shortcut_count
+     || rec->shortcut_count > cache->shortcut_count - rec->shortcut)
         goto error;
-    else
+
+    if (rec->shortcut_count > 0)
     {
         module->pp_shortcuts =
-            xmalloc (sizeof (*module->pp_shortcuts) * module->i_shortcuts);
-        for (unsigned j = 0; j < module->i_shortcuts; j++)
-            LOAD_STRING(module->pp_shortcuts[j]);
+            malloc(sizeof (*module->pp_shortcuts) * rec->shortcut_count);
+        if (unlikely(module->pp_shortcuts == NULL))
+            goto error;
     }
+    module->i_shortcuts = rec->shortcut_count;
 
-    LOAD_STRING(module->activate_name);
-    LOAD_STRING(module->deactivate_name);
-    LOAD_STRING(module->psz_capability);
-    LOAD_IMMEDIATE(module->i_score);
+    for (unsigned i = 0; i < module->i_shortcuts; i++)
+        LOAD_STRING_REF(module->pp_shortcuts[i],
+                     cache->shortcuts[rec->shortcut + i]);
     return 0;
 error:
     return -1;
 }
 
-static vlc_plugin_t *vlc_cache_load_plugin(block_t *file)
+static vlc_plugin_t *vlc_cache_load_plugin(const struct vlc_cache *cache,
+                                           const struct vlc_cache_plugin *rec)
 {
     vlc_plugin_t *plugin = vlc_plugin_create();
     if (unlikely(plugin == NULL))
         return NULL;
 
-    uint32_t modules;
-    LOAD_IMMEDIATE(modules);
+    if (rec->module > cache->module_count
+     || rec->module_count > cache->module_count - rec->module)
+        goto error;
+
+    for (size_t i = 0; i < rec->module_count; i++)
+        if (vlc_cache_load_module(cache, plugin,
+                                  cache->modules + rec->module + i))
+            goto error;
+
+    /* Configuration items are only indexed by name here */
+    if (rec->config > cache->config_size
+     || rec->config_size > cache->config_size - rec->config
+     || rec->name > cache->name_count
+     || rec->conf_size > cache->name_count - rec->name)
+        goto error;
+
+    const uint32_t *names = cache->names + rec->name;
+    size_t count = 0;
 
-    for (size_t i = 0; i < modules; i++)
-        if (vlc_cache_load_module(plugin, file))
+    for (size_t i = 0; i < rec->conf_size; i++)
+    {
+        if (names[i] >= cache->strings_size)
             goto error;
+        if (names[i] != 0)
+            count++;
+    }
 
-    if (vlc_cache_load_plugin_config(plugin, file))
+    if (count != rec->conf_count || rec->conf_booleans > count)
         goto error;
 
-    LOAD_STRING(plugin->textdomain);
+    plugin->conf.size = rec->conf_size;
+    plugin->conf.count = rec->conf_count;
+    plugin->conf.booleans = rec->conf_booleans;
+    if (rec->conf_size > 0)
+    {
+        atomic_init(&plugin->conf.cache,
+                    (uintptr_t)(cache->config + rec->config));
+        plugin->conf.cache_size = rec->config_size;
+        plugin->conf.cache_names = names;
+        plugin->conf.cache_strings = cache->strings;
+    }
+
+    LOAD_STRING_REF(plugin->textdomain, rec->textdomain);
 
     const char *path;
-    LOAD_STRING(path);
-    if (path == NULL)
+    LOAD_STRING_REF(path, rec->path);
+    if (path == NULL || rec->unloadable > 1)
         goto error;
 
     plugin->path = strdup(path);
     if (unlikely(plugin->path == NULL))
         goto error;
 
-    LOAD_FLAG(plugin->unloadable);
-    LOAD_IMMEDIATE(plugin->mtime);
-    LOAD_IMMEDIATE(plugin->size);
+    plugin->unloadable = rec->unloadable;
+    plugin->mtime = rec->mtime;
+    plugin->size = rec->size;
 
     if (plugin->textdomain != NULL)
         vlc_bindtextdomain(plugin->textdomain);
@@ -364,6 +575,39 @@ error:
     return NULL;
 }
 
+/* Maps the tables of the cache after its header */
+static int vlc_cache_map(struct vlc_cache *cache,
+                         const struct vlc_cache_header *hdr,
+                         const uint8_t *base, size_t size,
+                         const struct vlc_cache_cap **restrict caps)
+{
+    if (CACHE_TABLE(cache->plugins, struct vlc_cache_plugin,
+                    hdr->plugins, hdr->plugin_count)
+     || CACHE_TABLE(cache->modules, struct vlc_cache_module,
+                    hdr->modules, hdr->module_count)
+     || CACHE_TABLE(cache->shortcuts, uint32_t,
+                    hdr->shortcuts, hdr->shortcut_count)
+     || CACHE_TABLE(*caps, struct vlc_cache_cap, hdr->caps, hdr->cap_count)
+     || CACHE_TABLE(cache->names, uint32_t, hdr->names, hdr->name_count)
+     || CACHE_TABLE(cache->config, uint8_t, hdr->config, hdr->config_size)
+     || CACHE_TABLE(cache->strings, char, hdr->strings, hdr->strings_size))
+        return -1;
+
+    cache->plugin_count = hdr->plugin_count;
+    cache->module_count = hdr->module_count;
+    cache->shortcut_count = hdr->shortcut_count;
+    cache->name_count = hdr->name_count;
+    cache->config_size = hdr->config_size;
+    cache->strings_size = hdr->strings_size;
+
+    /* Offset 0 is the NULL string, and all strings must be terminated */
+    if (cache->strings_size == 0
+     || cache->strings[0] != '\0'
+     || cache->strings[cache->strings_size - 1] != '\0')
+        return -1;
+    return 0;
+}
+
 /**
  * Loads a plugins cache file.
  *
@@ -371,9 +615,14 @@ error:
  * will in turn be queried by AllocateAllPlugins() to see if it needs to
  * actually load the dynamically loadable module.
  * This allows us to only fully load plugins when they are actually used.
+ *
+ * The cache is used in place: the returned plug-ins refer to its data which
+ * is added to the backing chain. The number of modules of each capability
+ * is reported through the reserve callback, before the plug-ins are loaded.
  */
 vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
-                             block_t **backingp)
+                             block_t **backingp,
+                             void (*reserve)(const char *, size_t))
 {
     char *psz_filename;
 
@@ -444,10 +693,31 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
     }
 
     vlc_plugin_t *cache = NULL;
+    struct vlc_cache_header hdr;
+    struct vlc_cache tables;
+    const struct vlc_cache_cap *caps;
+
+    if (vlc_cache_load_align(CACHE_ALIGN, file)
+     || file->i_buffer < sizeof (hdr))
+        goto error;
 
-    while (file->i_buffer > 0)
+    memcpy(&hdr, file->p_buffer, sizeof (hdr));
+    if (vlc_cache_map(&tables, &hdr, file->p_buffer, file->i_buffer, &caps))
+        goto error;
+
+    for (size_t i = 0; i < hdr.cap_count; i++)
     {
-        vlc_plugin_t *plugin = vlc_cache_load_plugin(file);
+        const char *name;
+
+        if (vlc_cache_string(&tables, caps[i].name, &name) || name == NULL)
+            goto error;
+        reserve(name, caps[i].module_count);
+    }
+
+    for (size_t i = 0; i < tables.plugin_count; i++)
+    {
+        vlc_plugin_t *plugin = vlc_cache_load_plugin(&tables,
+                                                     tables.plugins + i);
         if (plugin == NULL)
             goto error;
 
@@ -470,13 +740,109 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
 error:
     msg_Warn( p_this, "plugins cache not loaded (corrupted)" );
 
-    /* TODO: cleanup */
+    while (cache != NULL)
+    {
+        vlc_plugin_t *plugin = cache;
+
+        cache = plugin->next;
+        vlc_plugin_destroy(plugin);
+    }
     block_Release(file);
     return NULL;
 }
 
+/* Cache being written: tables are accumulated then written in one go */
+struct vlc_cache_writer
+{
+    struct vlc_memstream modules;
+    struct vlc_memstream shortcuts;
+    struct vlc_memstream names;
+    struct vlc_memstream config;
+    struct vlc_memstream strings;
+    uint32_t module_count;
+    uint32_t shortcut_count;
+    uint32_t name_count;
+    uint32_t strings_size;
+    void *string_tree;
+    struct vlc_cache_string **caps;
+    size_t cap_count;
+};
+
+/* String table entry, to store each string only once */
+struct vlc_cache_string
+{
+    const char *str;
+    uint32_t offset;
+    uint32_t module_count; /**< Modules with that capability */
+};
+
+static int vlc_cache_string_cmp(const void *a, const void *b)
+{
+    const struct vlc_cache_string *sa = a, *sb = b;
+    return strcmp(sa->str, sb->str);
+}
+
+static int vlc_cache_cap_cmp(const void *a, const void *b)
+{
+    struct vlc_cache_string *const *ca = a, *const *cb = b;
+    return strcmp((*ca)->str, (*cb)->str);
+}
+
+static struct vlc_cache_string *CacheAddString(struct vlc_cache_writer *w,
+                                               const char *str)
+{
+    struct vlc_cache_string key = { .str = str };
+    void **sp = tfind(&key, &w->string_tree, vlc_cache_string_cmp);
+
+    if (sp != NULL)
+        return *sp;
+
+    size_t len = strlen(str) + 1;
+    if (len > UINT32_MAX - w->strings_size)
+        return NULL;
+
+    struct vlc_cache_string *s = malloc(sizeof (*s));
+    if (unlikely(s == NULL))
+        return NULL;
+
+    s->str = str;
+    s->offset = w->strings_size;
+    s->module_count = 0;
+
+    if (tsearch(s, &w->string_tree, vlc_cache_string_cmp) == NULL)
+    {
+        free(s);
+        return NULL;
+    }
+
+    vlc_memstream_write(&w->strings, str, len);
+    w->strings_size += len;
+    return s;
+}
+
+static int CacheSaveStringRef(struct vlc_cache_writer *w, const char *str,
+                              uint32_t *restrict offset)
+{
+    if (str == NULL)
+    {
+        *offset = 0;
+        return 0;
+    }
+
+    const struct vlc_cache_string *s = CacheAddString(w, str);
+    if (s == NULL)
+        return -1;
+
+    *offset = s->offset;
+    return 0;
+}
+
+#define SAVE_STRING_REF(a, offset) \
+    if (CacheSaveStringRef(w, (a), &(offset))) \
+        goto error
+
 #define SAVE_IMMEDIATE( a ) \
-    if (fwrite (&(a), sizeof(a), 1, file) != 1) \
+    if (vlc_memstream_write(ms, &(a), sizeof (a)) != sizeof (a)) \
         goto error
 #define SAVE_FLAG(a) \
     do { \
@@ -484,12 +850,12 @@ error:
         SAVE_IMMEDIATE(b); \
     } while (0)
 
-static int CacheSaveString (FILE *file, const char *str)
+static int CacheSaveString (struct vlc_memstream *ms, const char *str)
 {
     uint16_t size = (str != NULL) ? (strlen (str) + 1) : 0;
 
     SAVE_IMMEDIATE (size);
-    if (size != 0 && fwrite(str, 1, size, file) != size)
+    if (size != 0 && vlc_memstream_write(ms, str, size) != size)
     {
 error:
         return -1;
@@ -498,26 +864,27 @@ error:
 }
 
 #define SAVE_STRING( a ) \
-    if (CacheSaveString (file, (a))) \
+    if (CacheSaveString (ms, (a))) \
         goto error
 
-static int CacheSaveAlign(FILE *file, size_t align)
+static int CacheSaveAlign(struct vlc_memstream *ms, size_t align)
 {
     assert(align > 0);
 
-    size_t skip = (-ftell(file)) % align;
-    if (skip == 0)
-        return 0;
+    if (vlc_memstream_flush(ms))
+        return -1;
 
-    assert(((ftell(file) + skip) % align) == 0);
-    return fseek(file, skip, SEEK_CUR);
+    for (size_t skip = (-ms->length) % align; skip > 0; skip--)
+        vlc_memstream_putc(ms, 0);
+    return vlc_memstream_flush(ms);
 }
 
 #define SAVE_ALIGNOF(t) \
-    if (CacheSaveAlign(file, alignof (t))) \
+    if (CacheSaveAlign(ms, alignof (t))) \
         goto error
 
-static int CacheSaveConfig(FILE *file, const struct vlc_param *param)
+static int CacheSaveConfig(struct vlc_memstream *ms,
+                           const struct vlc_param *param)
 {
     const module_config_t *cfg = &param->item;
 
@@ -562,94 +929,276 @@ error:
     return -1;
 }
 
-static int CacheSaveModuleConfig(FILE *file, const vlc_plugin_t *plugin)
+static int CacheSaveModuleConfig(struct vlc_cache_writer *w,
+                                 vlc_plugin_t *plugin,
+                                 struct vlc_cache_plugin *rec)
 {
-    uint16_t lines = plugin->conf.size;
+    struct vlc_memstream *ms = &w->config;
+    const struct vlc_param *params = vlc_plugin_Config(plugin);
 
-    SAVE_IMMEDIATE (lines);
+    if (plugin->conf.size > UINT16_MAX)
+        goto error;
 
-    for (size_t i = 0; i < lines; i++)
-        if (CacheSaveConfig(file, plugin->conf.params + i))
-           goto error;
+    /* Items are aligned as they will be in the memory mapping */
+    if (CacheSaveAlign(ms, CACHE_ALIGN))
+        goto error;
+
+    rec->config = ms->length;
+    rec->name = w->name_count;
+    rec->conf_size = plugin->conf.size;
+    rec->conf_count = plugin->conf.count;
+    rec->conf_booleans = plugin->conf.booleans;
+
+    for (size_t i = 0; i < plugin->conf.size; i++)
+    {
+        const struct vlc_param *param = params + i;
+        const module_config_t *item = &param->item;
+        uint32_t name;
+
+        if (CacheSaveConfig(ms, param))
+            goto error;
 
+        SAVE_STRING_REF(CONFIG_ITEM(item->i_type) ? item->psz_name : NULL,
+                        name);
+        vlc_memstream_write(&w->names, &name, sizeof (name));
+        w->name_count++;
+    }
+
+    if (vlc_memstream_flush(ms) || ms->length > UINT32_MAX)
+        goto error;
+
+    rec->config_size = ms->length - rec->config;
     return 0;
 error:
     return -1;
 }
 
-static int CacheSaveModule(FILE *file, const module_t *module)
+static int CacheSaveModule(struct vlc_cache_writer *w, const module_t *module)
 {
-    SAVE_STRING(module->psz_shortname);
-    SAVE_STRING(module->psz_longname);
-    SAVE_STRING(module->psz_help);
-    SAVE_IMMEDIATE(module->i_shortcuts);
+    struct vlc_cache_module rec;
+    struct vlc_cache_string *cap;
+
+    memset(&rec, 0, sizeof (rec));
+    SAVE_STRING_REF(module->psz_shortname, rec.shortname);
+    SAVE_STRING_REF(module->psz_longname, rec.longname);
+    SAVE_STRING_REF(module->psz_help, rec.help);
+    SAVE_STRING_REF(module->activate_name, rec.activate);
+    SAVE_STRING_REF(module->deactivate_name, rec.deactivate);
+    SAVE_STRING_REF(module->probe_extensions, rec.probe_extensions);
+    SAVE_STRING_REF(module->probe_mime, rec.probe_mime);
+    SAVE_STRING_REF(module->probe_magic, rec.probe_magic);
+    rec.score = module->i_score;
+
+    /* Count the modules of each capability for the index */
+    cap = CacheAddString(w, module_get_capability(module));
+    if (cap == NULL)
+        goto error;
+    rec.capability = cap->offset;
+    if (cap->module_count++ == 0)
+    {
+        struct vlc_cache_string **caps = realloc(w->caps,
+                                    (w->cap_count + 1) * sizeof (*caps));
+        if (unlikely(caps == NULL))
+            goto error;
+        caps[w->cap_count++] = cap;
+        w->caps = caps;
+    }
 
+    rec.shortcut = w->shortcut_count;
+    rec.shortcut_count = module->i_shortcuts;
     for (size_t j = 0; j < module->i_shortcuts; j++)
-         SAVE_STRING(module->pp_shortcuts[j]);
+    {
+        uint32_t shortcut;
+
+        SAVE_STRING_REF(module->pp_shortcuts[j], shortcut);
+        vlc_memstream_write(&w->shortcuts, &shortcut, sizeof (shortcut));
+        w->shortcut_count++;
+    }
+
+    vlc_memstream_write(&w->modules, &rec, sizeof (rec));
+    w->module_count++;
+    return 0;
+error:
+    return -1;
+}
 
-    SAVE_STRING(module->activate_name);
-    SAVE_STRING(module->deactivate_name);
-    SAVE_STRING(module->psz_capability);
-    SAVE_IMMEDIATE(module->i_score);
+static int CacheSavePlugin(struct vlc_cache_writer *w, vlc_plugin_t *plugin,
+                           struct vlc_cache_plugin *rec)
+{
+    memset(rec, 0, sizeof (*rec));
+    rec->module = w->module_count;
+    rec->module_count = plugin->modules_count;
+
+    for (module_t *module = plugin->module;
+         module != NULL;
+         module = module->next)
+        if (CacheSaveModule(w, module))
+            goto error;
+
+    /* Config stuff */
+    if (CacheSaveModuleConfig(w, plugin, rec))
+        goto error;
+
+    /* Save common info */
+    SAVE_STRING_REF(plugin->textdomain, rec->textdomain);
+    SAVE_STRING_REF(plugin->path, rec->path);
+    rec->unloadable = plugin->unloadable;
+    rec->mtime = plugin->mtime;
+    rec->size = plugin->size;
     return 0;
 error:
     return -1;
 }
 
+/* Writes a table, padded to the cache alignment */
+static int CacheSaveTable(FILE *file, const void *data, size_t size)
+{
+    static const char pad[CACHE_ALIGN];
+
+    if (size > 0 && fwrite(data, size, 1, file) != 1)
+        return -1;
+
+    size_t skip = (-size) % CACHE_ALIGN;
+    if (skip > 0 && fwrite(pad, skip, 1, file) != 1)
+        return -1;
+    return 0;
+}
+
+static uint32_t CacheTableEnd(uint32_t offset, size_t size)
+{
+    return offset + size + ((-size) % CACHE_ALIGN);
+}
+
+static int CacheCloseTable(struct vlc_memstream *ms)
+{
+    if (vlc_memstream_close(ms))
+    {
+        ms->ptr = NULL;
+        return -1;
+    }
+    return 0;
+}
+
 static int CacheSaveBank(FILE *file, vlc_plugin_t *const *cache, size_t n)
 {
     uint32_t i_file_size = 0;
+    struct vlc_cache_writer w = { .string_tree = NULL };
+    struct vlc_cache_plugin *plugins = NULL;
+    struct vlc_cache_cap *caps = NULL;
+    int ret = -1;
+
+    vlc_memstream_open(&w.modules);
+    vlc_memstream_open(&w.shortcuts);
+    vlc_memstream_open(&w.names);
+    vlc_memstream_open(&w.config);
+    vlc_memstream_open(&w.strings);
+
+    /* Offset 0 is the NULL string */
+    vlc_memstream_putc(&w.strings, '\0');
+    w.strings_size = 1;
+
+    bool ok = true;
+
+    if (n > 0)
+    {
+        plugins = vlc_alloc(n, sizeof (*plugins));
+        ok = plugins != NULL;
+    }
+
+    for (size_t i = 0; i < n && ok; i++)
+        ok = !CacheSavePlugin(&w, cache[i], plugins + i);
+
+    /* Capabilities index, sorted by name */
+    if (ok && w.cap_count > 0)
+    {
+        qsort(w.caps, w.cap_count, sizeof (*w.caps), vlc_cache_cap_cmp);
+
+        caps = vlc_alloc(w.cap_count, sizeof (*caps));
+        ok = caps != NULL;
+    }
+
+    for (size_t i = 0; i < w.cap_count && ok; i++)
+    {
+        memset(caps + i, 0, sizeof (caps[i]));
+        caps[i].name = w.caps[i]->offset;
+        caps[i].module_count = w.caps[i]->module_count;
+    }
+
+    if (CacheCloseTable(&w.modules) | CacheCloseTable(&w.shortcuts)
+      | CacheCloseTable(&w.names) | CacheCloseTable(&w.config)
+      | CacheCloseTable(&w.strings) || !ok)
+        goto out;
+
+    struct vlc_cache_header hdr;
+
+    memset(&hdr, 0, sizeof (hdr));
+    hdr.plugins = CacheTableEnd(0, sizeof (hdr));
+    hdr.plugin_count = n;
+    hdr.modules = CacheTableEnd(hdr.plugins, n * sizeof (*plugins));
+    hdr.module_count = w.module_count;
+    hdr.shortcuts = CacheTableEnd(hdr.modules, w.modules.length);
+    hdr.shortcut_count = w.shortcut_count;
+    hdr.caps = CacheTableEnd(hdr.shortcuts, w.shortcuts.length);
+    hdr.cap_count = w.cap_count;
+    hdr.names = CacheTableEnd(hdr.caps, w.cap_count * sizeof (*caps));
+    hdr.name_count = w.name_count;
+    hdr.config = CacheTableEnd(hdr.names, w.names.length);
+    hdr.config_size = w.config.length;
+    hdr.strings = CacheTableEnd(hdr.config, w.config.length);
+    hdr.strings_size = w.strings_size;
+
+    if ((uint64_t)hdr.strings + w.strings.length > UINT32_MAX)
+        goto out;
 
     /* Contains version number */
     if (fputs (CACHE_STRING, file) == EOF)
-        goto error;
+        goto out;
 #ifdef DISTRO_VERSION
     /* Allow binary maintainer to pass a string to detect new binary version*/
     if (fputs( DISTRO_VERSION, file ) == EOF)
-        goto error;
+        goto out;
 #endif
     /* Sub-version number (to avoid breakage in the dev version when cache
      * structure changes) */
     i_file_size = CACHE_SUBVERSION_NUM;
     if (fwrite (&i_file_size, sizeof (i_file_size), 1, file) != 1 )
-        goto error;
+        goto out;
 
     /* Header marker */
     i_file_size = ftell( file );
     if (fwrite (&i_file_size, sizeof (i_file_size), 1, file) != 1)
-        goto error;
-
-    for (size_t i = 0; i < n; i++)
-    {
-        const vlc_plugin_t *plugin = cache[i];
-        uint32_t count = plugin->modules_count;
-
-        SAVE_IMMEDIATE(count);
-
-        for (module_t *module = plugin->module;
-             module != NULL;
-             module = module->next)
-            if (CacheSaveModule(file, module))
-                goto error;
-
-        /* Config stuff */
-        if (CacheSaveModuleConfig(file, plugin))
-            goto error;
+        goto out;
 
-        /* Save common info */
-        SAVE_STRING(plugin->textdomain);
-        SAVE_STRING(plugin->path);
-        SAVE_FLAG(plugin->unloadable);
-        SAVE_IMMEDIATE(plugin->mtime);
-        SAVE_IMMEDIATE(plugin->size);
-    }
+    /* Align the header, so that the tables are aligned in memory mappings */
+    for (size_t skip = (-(size_t)ftell(file)) % CACHE_ALIGN; skip > 0; skip--)
+        if (fputc(0, file) == EOF)
+            goto out;
+
+    if (CacheSaveTable(file, &hdr, sizeof (hdr))
+     || CacheSaveTable(file, plugins, n * sizeof (*plugins))
+     || CacheSaveTable(file, w.modules.ptr, w.modules.length)
+     || CacheSaveTable(file, w.shortcuts.ptr, w.shortcuts.length)
+     || CacheSaveTable(file, caps, w.cap_count * sizeof (*caps))
+     || CacheSaveTable(file, w.names.ptr, w.names.length)
+     || CacheSaveTable(file, w.config.ptr, w.config.length)
+     || CacheSaveTable(file, w.strings.ptr, w.strings.length))
+        goto out;
 
     if (fflush (file)) /* flush libc buffers */
-        goto error;
-    return 0; /* success! */
+        goto out;
+    ret = 0; /* success! */
 
-error:
-    return -1;
+out:
+    free(w.modules.ptr);
+    free(w.shortcuts.ptr);
+    free(w.names.ptr);
+    free(w.config.ptr);
+    free(w.strings.ptr);
+    tdestroy(w.string_tree, free);
+    free(w.caps);
+    free(caps);
+    free(plugins);
+    return ret;
 }
 
 /**
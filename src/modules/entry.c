@@ -74,6 +74,9 @@ module_t *vlc_module_create(vlc_plugin_t *plugin)
     module->deactivate_name = NULL;
     module->pf_activate = NULL;
     module->deactivate = NULL;
+    module->probe_extensions = NULL;
+    module->probe_mime = NULL;
+    module->probe_magic = NULL;
     return module;
 }
 
@@ -105,6 +108,10 @@ vlc_plugin_t *vlc_plugin_create(void)
     plugin->conf.count = 0;
     plugin->conf.booleans = 0;
 #ifdef HAVE_DYNAMIC_PLUGINS
+    atomic_init(&plugin->conf.cache, 0);
+    plugin->conf.cache_size = 0;
+    plugin->conf.cache_names = NULL;
+    plugin->conf.cache_strings = NULL;
     plugin->unloadable = true;
     atomic_init(&plugin->handle, 0);
     plugin->abspath = NULL;
@@ -130,7 +137,8 @@ void vlc_plugin_destroy(vlc_plugin_t *plugin)
     if (plugin->module != NULL)
         vlc_module_destroy(plugin->module);
 
-    config_Free(plugin->conf.params, plugin->conf.size);
+    if (plugin->conf.params != NULL) /* not loaded from the cache yet */
+        config_Free(plugin->conf.params, plugin->conf.size);
 #ifdef HAVE_DYNAMIC_PLUGINS
     free(plugin->abspath);
     free(plugin->path);
@@ -138,6 +146,29 @@ void vlc_plugin_destroy(vlc_plugin_t *plugin)
     free(plugin);
 }
 
+struct vlc_param *vlc_plugin_Config(vlc_plugin_t *plugin)
+{
+#ifdef HAVE_DYNAMIC_PLUGINS
+    if (atomic_load_explicit(&plugin->conf.cache, memory_order_acquire))
+        vlc_cache_load_config(plugin);
+#endif
+    return plugin->conf.params;
+}
+
+const char *vlc_plugin_ConfigName(const vlc_plugin_t *plugin, size_t i)
+{
+    assert(i < plugin->conf.size);
+#ifdef HAVE_DYNAMIC_PLUGINS
+    if (plugin->conf.cache_names != NULL)
+    {
+        uint32_t offset = plugin->conf.cache_names[i];
+        return (offset != 0) ? plugin->conf.cache_strings + offset : NULL;
+    }
+#endif
+    const module_config_t *item = &plugin->conf.params[i].item;
+    return CONFIG_ITEM(item->i_type) ? item->psz_name : NULL;
+}
+
 static struct vlc_param *vlc_config_create(vlc_plugin_t *plugin, int type)
 {
     unsigned confsize = plugin->conf.size;
@@ -314,6 +345,18 @@ static int vlc_plugin_desc_cb(void *ctx, void *tgt, int propid, ...)
             plugin->textdomain = va_arg(ap, const char *);
             break;
 
+        case VLC_MODULE_PROBE_EXTENSIONS:
+            module->probe_extensions = va_arg(ap, const char *);
+            break;
+
+        case VLC_MODULE_PROBE_MIME:
+            module->probe_mime = va_arg(ap, const char *);
+            break;
+
+        case VLC_MODULE_PROBE_MAGIC:
+            module->probe_magic = va_arg(ap, const char *);
+            break;
+
         case VLC_CONFIG_NAME:
         {
             struct vlc_param *param = tgt;
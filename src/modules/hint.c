@@ -0,0 +1,107 @@
+/*****************************************************************************
+ * hint.c : Module probe hints
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <string.h>
+
+#include <vlc_common.h>
+#include "modules/modules.h"
+
+static bool module_hint_list(const char *list, const char *value)
+{
+    size_t len = strlen(value);
+
+    while (list[0] != '\0') {
+        size_t slen = strcspn(list, ",");
+
+        if (slen == len && strncasecmp(list, value, len) == 0)
+            return true;
+
+        list += slen;
+        list += strspn(list, ",");
+    }
+    return false;
+}
+
+static int module_hint_xdigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+static bool module_hint_magic(const char *list, const uint8_t *buf, size_t len)
+{
+    while (list[0] != '\0') {
+        const char *pattern = list;
+        size_t slen = strcspn(list, ",");
+        bool match = (slen & 1) == 0 && slen / 2 <= len;
+
+        list += slen;
+        list += strspn(list, ",");
+
+        for (size_t i = 0; match && i < slen / 2; i++) {
+            const char *hex = pattern + 2 * i;
+
+            if (hex[0] == '?' && hex[1] == '?')
+                continue;
+
+            int hi = module_hint_xdigit(hex[0]);
+            int lo = module_hint_xdigit(hex[1]);
+
+            match = hi >= 0 && lo >= 0 && buf[i] == ((hi << 4) | lo);
+        }
+
+        if (match)
+            return true;
+    }
+    return false;
+}
+
+bool vlc_module_hint_match(const module_t *m,
+                           const struct vlc_module_hint *hint)
+{
+    if (m->probe_extensions == NULL && m->probe_mime == NULL
+     && m->probe_magic == NULL)
+        return true;
+
+    if (m->probe_extensions != NULL && hint->extension != NULL
+     && module_hint_list(m->probe_extensions, hint->extension))
+        return true;
+
+    if (m->probe_mime != NULL && hint->mime != NULL
+     && module_hint_list(m->probe_mime, hint->mime))
+        return true;
+
+    if (m->probe_magic != NULL) {
+        /* The content could not be peeked: it might match. */
+        if (hint->magic == NULL)
+            return true;
+        if (module_hint_magic(m->probe_magic, hint->magic, hint->magic_size))
+            return true;
+    }
+    return false;
+}
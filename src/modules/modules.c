@@ -187,29 +187,11 @@ void *vlc_module_map(vlc_logger_t *log, module_t *module)
     return vlc_plugin_Map(log, module->plugin) ? NULL : module->pf_activate;
 }
 
-/**
- * Finds and instantiates the best module of a certain type.
- * All candidates modules having the specified capability and name will be
- * sorted in decreasing order of priority. Then the probe callback will be
- * invoked for each module, until it succeeds (returns 0), or all candidate
- * module failed to initialize.
- *
- * The probe callback first parameter is the address of the module entry point.
- * Further parameters are passed as an argument list; it corresponds to the
- * variable arguments passed to this function. This scheme is meant to
- * support arbitrary prototypes for the module entry point.
- *
- * \param log logger (or NULL to ignore)
- * \param capability capability, i.e. class of module
- * \param name name of the module asked, if any
- * \param strict if true, do not fallback to plugin with a different name
- *                 but the same capability
- * \param probe module probe callback
- * \return the module or NULL in case of a failure
- */
-module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
-                            const char *name, bool strict,
-                            vlc_activate_t probe, ...)
+static module_t *vlc_module_load_va(struct vlc_logger *log,
+                                    const char *capability, const char *name,
+                                    bool strict,
+                                    const struct vlc_module_hint *hint,
+                                    vlc_activate_t probe, va_list args)
 {
     if (name == NULL || name[0] == '\0')
         name = "any";
@@ -227,13 +209,19 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
               capability, name, total);
 
     module_t *module = NULL;
-    va_list args;
-
-    va_start(args, probe);
+    size_t skipped = 0;
 
     for (size_t i = 0; i < (size_t)total; i++) {
         module_t *cand = mods[i];
         int ret = VLC_EGENERIC;
+
+        /* Rule out unsuitable modules before loading their plugin. */
+        if (hint != NULL && i >= strict_total
+         && !vlc_module_hint_match(cand, hint)) {
+            skipped++;
+            continue;
+        }
+
         void *cb = vlc_module_map(log, cand);
 
         if (cb != NULL) {
@@ -256,8 +244,9 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
     }
 
 done:
-    va_end (args);
-
+    if (skipped > 0)
+        vlc_debug(log, "skipped %zu %s modules from probe hints", skipped,
+                  capability);
     if (module == NULL)
         vlc_debug(log, "no %s modules matched with name %s", capability, name);
 
@@ -265,6 +254,54 @@ done:
     return module;
 }
 
+/**
+ * Finds and instantiates the best module of a certain type.
+ * All candidates modules having the specified capability and name will be
+ * sorted in decreasing order of priority. Then the probe callback will be
+ * invoked for each module, until it succeeds (returns 0), or all candidate
+ * module failed to initialize.
+ *
+ * The probe callback first parameter is the address of the module entry point.
+ * Further parameters are passed as an argument list; it corresponds to the
+ * variable arguments passed to this function. This scheme is meant to
+ * support arbitrary prototypes for the module entry point.
+ *
+ * \param log logger (or NULL to ignore)
+ * \param capability capability, i.e. class of module
+ * \param name name of the module asked, if any
+ * \param strict if true, do not fallback to plugin with a different name
+ *                 but the same capability
+ * \param probe module probe callback
+ * \return the module or NULL in case of a failure
+ */
+module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
+                            const char *name, bool strict,
+                            vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_load_va(log, capability, name, strict,
+                                          NULL, probe, args);
+    va_end(args);
+    return module;
+}
+
+module_t *vlc_module_load_hinted(struct vlc_logger *log,
+                                 const char *capability, const char *name,
+                                 bool strict,
+                                 const struct vlc_module_hint *hint,
+                                 vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_load_va(log, capability, name, strict,
+                                          hint, probe, args);
+    va_end(args);
+    return module;
+}
+
 static int generic_start(void *func, bool forced, va_list ap)
 {
     vlc_object_t *obj = va_arg(ap, vlc_object_t *);
@@ -331,7 +368,7 @@ module_t *module_find (const char *name)
 
 module_config_t *module_config_get( const module_t *module, unsigned *restrict psize )
 {
-    const vlc_plugin_t *plugin = module->plugin;
+    vlc_plugin_t *plugin = module->plugin;
 
     assert( psize != NULL );
     *psize = 0;
@@ -342,6 +379,7 @@ module_config_t *module_config_get( const module_t *module, unsigned *restrict p
         return NULL;
     }
 
+    const struct vlc_param *params = vlc_plugin_Config(plugin);
     size_t size = plugin->conf.size;
     module_config_t *config = vlc_alloc( size, sizeof( *config ) );
 
@@ -351,7 +389,7 @@ module_config_t *module_config_get( const module_t *module, unsigned *restrict p
     unsigned i, j;
     for( i = 0, j = 0; i < size; i++ )
     {
-        const struct vlc_param *param = plugin->conf.params + i;
+        const struct vlc_param *param = params + i;
         const module_config_t *item = &param->item;
 
         if (param->internal /* internal option */
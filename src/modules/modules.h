@@ -24,6 +24,7 @@
 # define LIBVLC_MODULES_H 1
 
 # include <stdatomic.h>
+# include <vlc_modules.h>
 
 struct vlc_param;
 
@@ -45,6 +46,16 @@ typedef struct vlc_plugin_t
         size_t size; /**< Total count of all items */
         size_t count; /**< Count of real options (excludes hints) */
         size_t booleans; /**< Count of options that are of boolean type */
+#ifdef HAVE_DYNAMIC_PLUGINS
+        /**
+         * Serialised items from the plugins cache, until they are loaded by
+         * vlc_plugin_Config() (or nul)
+         */
+        atomic_uintptr_t cache;
+        size_t cache_size; /**< Size of the serialised items */
+        const uint32_t *cache_names; /**< Name of each item (or NULL) */
+        const char *cache_strings; /**< String table for cache_names */
+#endif
     } conf;
 
 #ifdef HAVE_DYNAMIC_PLUGINS
@@ -101,6 +112,11 @@ struct module_t
     const char *deactivate_name;
     void *pf_activate;
     vlc_deactivate_cb deactivate;
+
+    /* Probe hints (see set_probe_extensions()) */
+    const char *probe_extensions; /**< Accepted file extensions (or NULL) */
+    const char *probe_mime; /**< Accepted MIME types (or NULL) */
+    const char *probe_magic; /**< Accepted leading bytes (or NULL) */
 };
 
 vlc_plugin_t *vlc_plugin_create(void);
@@ -111,6 +127,27 @@ void vlc_module_destroy (module_t *);
 vlc_plugin_t *vlc_plugin_describe(vlc_plugin_cb);
 int vlc_plugin_resolve(vlc_plugin_t *, vlc_plugin_cb);
 
+/**
+ * Gets the configuration items of a plug-in.
+ *
+ * The items of plug-ins from the plugins cache are only loaded the first time
+ * they are needed, so this must be called before accessing conf.params.
+ *
+ * \note This function is thread-safe.
+ * \return the table of conf.size items (NULL if there are none)
+ */
+struct vlc_param *vlc_plugin_Config(vlc_plugin_t *);
+
+/**
+ * Gets the name of a configuration item of a plug-in.
+ *
+ * Unlike vlc_plugin_Config(), this does not load the items.
+ *
+ * \param i index of the item (must be less than conf.size)
+ * \return the item name, or NULL if the item is a hint
+ */
+const char *vlc_plugin_ConfigName(const vlc_plugin_t *, size_t i);
+
 void module_InitBank (void);
 void module_LoadPlugins(vlc_object_t *);
 #define module_LoadPlugins(a) module_LoadPlugins(VLC_OBJECT(a))
@@ -134,6 +171,39 @@ void *vlc_plugin_Symbol(struct vlc_logger *, vlc_plugin_t *, const char *name);
  */
 size_t module_list_cap(module_t *const **tab, const char *name);
 
+/**
+ * Description of the content to probe, for vlc_module_load_hinted().
+ */
+struct vlc_module_hint
+{
+    const char *extension; /**< File extension, without the dot (or NULL) */
+    const char *mime; /**< MIME type, without parameters (or NULL) */
+    const uint8_t *magic; /**< First bytes of the content (or NULL) */
+    size_t magic_size; /**< Count of bytes at magic */
+};
+
+/**
+ * Checks whether a module may accept some content.
+ *
+ * This only looks at the probe hints declared by the module, and thus does not
+ * map the module in memory. Modules without hints always match.
+ *
+ * \return false if the module certainly does not accept the content
+ */
+bool vlc_module_hint_match(const module_t *, const struct vlc_module_hint *);
+
+/**
+ * Finds and instantiates the best module for some content.
+ *
+ * This is the same as vlc_module_load(), except that non-strictly matched
+ * candidates are skipped, without mapping them, if vlc_module_hint_match()
+ * rules them out.
+ */
+module_t *vlc_module_load_hinted(struct vlc_logger *log, const char *cap,
+                                 const char *name, bool strict,
+                                 const struct vlc_module_hint *hint,
+                                 vlc_activate_t probe, ...) VLC_USED;
+
 int vlc_bindtextdomain (const char *);
 
 /* Low-level OS-dependent handler */
@@ -181,7 +251,9 @@ void *vlc_dlsym(void *handle, const char *) VLC_USED;
 char *vlc_dlerror(void) VLC_USED;
 
 /* Plugins cache */
-vlc_plugin_t *vlc_cache_load(vlc_object_t *, const char *, block_t **);
+vlc_plugin_t *vlc_cache_load(vlc_object_t *, const char *, block_t **,
+                             void (*)(const char *, size_t));
+int vlc_cache_load_config(vlc_plugin_t *);
 vlc_plugin_t *vlc_cache_lookup(vlc_plugin_t **, const char *relpath);
 
 void CacheSave(vlc_object_t *, const char *, vlc_plugin_t *const *, size_t);
@@ -875,6 +875,12 @@ unsigned vlc_GetCPUCount (void)
     return numprocs;
 }
 
+int vlc_thread_SetAffinity(const char *cpus)
+{
+    VLC_UNUSED(cpus);
+    return ENOTSUP;
+}
+
 int _CRT_init(void);
 void _CRT_term(void);
 
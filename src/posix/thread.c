@@ -320,3 +320,41 @@ unsigned vlc_GetCPUCount(void)
     return 1;
 #endif
 }
+
+int vlc_thread_SetAffinity(const char *cpus)
+{
+#ifdef HAVE_SCHED_GETAFFINITY
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    do
+    {
+        char *end;
+        unsigned long first = strtoul(cpus, &end, 10), last = first;
+
+        if (end == cpus)
+            return EINVAL;
+        if (*end == '-')
+        {
+            cpus = end + 1;
+            last = strtoul(cpus, &end, 10);
+            if (end == cpus || last < first)
+                return EINVAL;
+        }
+        if (last >= CPU_SETSIZE)
+            return EINVAL;
+
+        for (unsigned long cpu = first; cpu <= last; cpu++)
+            CPU_SET(cpu, &set);
+        cpus = end;
+    }
+    while (*(cpus++) == ',');
+
+    if (cpus[-1] != '\0')
+        return EINVAL;
+    return sched_setaffinity(0, sizeof (set), &set) ? errno : 0;
+#else
+    VLC_UNUSED(cpus);
+    return ENOTSUP;
+#endif
+}
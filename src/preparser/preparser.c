@@ -345,7 +345,14 @@ int input_preparser_Push( input_preparser_t *preparser,
 
     PreparserAddTask(preparser, task);
 
-    vlc_executor_Submit(preparser->executor, &task->runnable);
+    /* Requests that may interact with the user are waited for, others are
+     * typically queued in bulk by library scans */
+    enum vlc_executor_priority priority =
+        i_options & META_REQUEST_OPTION_DO_INTERACT
+            ? VLC_EXECUTOR_PRIORITY_INTERACTIVE
+            : VLC_EXECUTOR_PRIORITY_BACKGROUND;
+    vlc_executor_SubmitWithPriority(preparser->executor, &task->runnable,
+                                    priority);
     return VLC_SUCCESS;
 }
 
@@ -23,6 +23,7 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #undef NDEBUG
 #include <assert.h>
@@ -86,11 +87,97 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void test_block_Pool(void)
+{
+    /* Released frames are recycled by the same thread */
+    block_t *block = block_Alloc(1000);
+    assert (block != NULL);
+    void *addr = block;
+    block_Release(block);
+
+    block = block_Alloc(1100);
+    assert (block != NULL);
+    assert ((void *)block == addr);
+    assert (block->i_buffer == 1100);
+    assert (block->p_start + block->i_size >= block->p_buffer + 1100);
+    block_Release(block);
+
+    /* Large frames bypass the pool */
+    block = block_Alloc(1 << 20);
+    assert (block != NULL);
+    memset(block->p_buffer, 0, block->i_buffer);
+    block_Release(block);
+}
+
+#define POOL_FRAMES 100
+
+static void *test_block_PoolThread(void *data)
+{
+    block_t **blocks = data;
+
+    for (unsigned i = 0; i < POOL_FRAMES; i++)
+    {
+        blocks[i] = block_Alloc(188 * 7);
+        assert (blocks[i] != NULL);
+        memset(blocks[i]->p_buffer, i, blocks[i]->i_buffer);
+    }
+    return NULL;
+}
+
+static void test_block_PoolThreads(void)
+{
+    block_t *blocks[POOL_FRAMES];
+
+    /* Frames allocated by a thread and released by another, after the
+     * allocating thread exited, then allocated again by a new thread. */
+    for (unsigned round = 0; round < 3; round++)
+    {
+        vlc_thread_t th;
+
+        if (vlc_clone(&th, test_block_PoolThread, blocks))
+            abort();
+        vlc_join(th, NULL);
+
+        for (unsigned i = 0; i < POOL_FRAMES; i++)
+        {
+            assert (blocks[i]->p_buffer[0] == (uint8_t)i);
+            block_Release(blocks[i]);
+        }
+    }
+}
+
+static void *test_block_PoolRelease(void *data)
+{
+    block_Release(data);
+    return NULL;
+}
+
+static void test_block_PoolReturn(void)
+{
+    /* Frames released by another thread go back to their owner thread */
+    block_t *block = block_Alloc(4000);
+    assert (block != NULL);
+    void *addr = block;
+    vlc_thread_t th;
+
+    if (vlc_clone(&th, test_block_PoolRelease, block))
+        abort();
+    vlc_join(th, NULL);
+
+    block = block_Alloc(4000);
+    assert (block != NULL);
+    assert ((void *)block == addr);
+    block_Release(block);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_Pool();
+    test_block_PoolThreads();
+    test_block_PoolReturn();
     return 0;
 }
 
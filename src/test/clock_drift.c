@@ -0,0 +1,216 @@
+/*****************************************************************************
+ * clock_drift.c: Test for the clock drift estimation
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+
+#include "../clock/clock_internal.h"
+
+#define STEP VLC_TICK_FROM_MS(20)
+#define JITTER VLC_TICK_FROM_MS(1)
+
+static unsigned seed = 42;
+
+/* Deterministic jitter in [-JITTER, JITTER] */
+static vlc_tick_t jitter(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return (vlc_tick_t)((seed >> 16) % (2 * JITTER + 1)) - JITTER;
+}
+
+static vlc_tick_t system_of(vlc_tick_t stream, double ppm)
+{
+    return VLC_TICK_FROM_SEC(1000) + llround(stream * (1. + ppm * 1e-6));
+}
+
+static void feed(clock_drift_t *drift, vlc_tick_t from, vlc_tick_t to,
+                 double ppm)
+{
+    for (vlc_tick_t stream = from; stream < to; stream += STEP)
+    {
+        vlc_tick_t system = system_of(stream, ppm) + jitter();
+        DriftUpdate(drift, clock_point_Create(system, stream));
+    }
+}
+
+static void test_drift(double ppm)
+{
+    clock_drift_t drift;
+    DriftInit(&drift, VLC_TICK_FROM_SEC(10));
+
+    assert(DriftGetSystem(&drift, 0) == VLC_TICK_INVALID);
+    assert(DriftGetCoeff(&drift) == 1.);
+
+    /* The slope is not trusted over too short a span */
+    feed(&drift, 0, VLC_TICK_FROM_MS(500), ppm);
+    assert(DriftGetCoeff(&drift) == 1.);
+
+    feed(&drift, VLC_TICK_FROM_MS(500), VLC_TICK_FROM_SEC(60), ppm);
+    double coeff = DriftGetCoeff(&drift);
+    printf("drift: expected %f ppm, estimated %f ppm, error %"PRId64" us\n",
+           ppm, (coeff - 1.) * 1e6, DriftGetError(&drift));
+    assert(fabs((coeff - 1.) * 1e6 - ppm) < 5.);
+
+    /* The fit filters out the jitter of the points */
+    const vlc_tick_t stream = VLC_TICK_FROM_SEC(60);
+    assert(llabs(DriftGetSystem(&drift, stream) - system_of(stream, ppm))
+           < JITTER / 2);
+    assert(DriftGetError(&drift) > 0 && DriftGetError(&drift) <= JITTER);
+
+    /* Pausing moves the system points */
+    const vlc_tick_t pause = VLC_TICK_FROM_SEC(5);
+    vlc_tick_t before = DriftGetSystem(&drift, stream);
+    DriftShift(&drift, pause);
+    assert(DriftGetSystem(&drift, stream) == before + pause);
+
+    DriftReset(&drift);
+    assert(DriftGetSystem(&drift, stream) == VLC_TICK_INVALID);
+    assert(DriftGetCoeff(&drift) == 1.);
+    assert(DriftGetError(&drift) == 0);
+}
+
+struct resampler_run
+{
+    double max_drift; /* Largest drift (s) */
+    double min_drift; /* Smallest drift (s) */
+    double drift; /* Final drift (s) */
+    double ratio; /* Final resampling ratio */
+    double max_ratio; /* Largest resampling ratio, in absolute value */
+    unsigned changes; /* Resampler rate changes */
+};
+
+/* Plays for the given time with an output running off by mismatch (ratio),
+ * starting with the given drift (s), the output timings being jittered.
+ * With a sample rate, resamples by integer steps of it, as the resamplers
+ * do, otherwise by the exact ratio. */
+static struct resampler_run run_resampler(clock_resampler_t *resamp,
+                                          unsigned rate,
+                                          double mismatch, double drift,
+                                          vlc_tick_t length)
+{
+    struct resampler_run run = { drift, drift, drift, 0., 0., 0 };
+    const double dt = secf_from_vlc_tick(STEP);
+    double ratio = resamp->ratio;
+    int step = 0;
+
+    for (vlc_tick_t system = STEP; system <= length; system += STEP)
+    {
+        /* Late playback drifts further while the output is slower than the
+         * stream, and catches up with a positive resampling ratio */
+        drift += (mismatch - (rate ? (double)step / rate : ratio)) * dt;
+        ratio = ResamplerUpdate(resamp, VLC_TICK_FROM_SEC(1000) + system,
+                                vlc_tick_from_sec(drift) + jitter());
+        if (rate)
+        {
+            int next = ResamplerGetStep(step, ratio, rate);
+            run.changes += next != step;
+            step = next;
+        }
+
+        run.max_drift = fmax(run.max_drift, drift);
+        run.min_drift = fmin(run.min_drift, drift);
+        run.max_ratio = fmax(run.max_ratio, fabs(ratio));
+    }
+    run.drift = drift;
+    run.ratio = ratio;
+    return run;
+}
+
+static void test_resampler(void)
+{
+    clock_resampler_t resamp;
+    struct resampler_run run;
+
+    /* Drift step: with critically damped gains, the drift is caught up in
+     * about a minute and undershoots by e^-2 (13.5%) of the step at most */
+    ResamplerReset(&resamp);
+    run = run_resampler(&resamp, 0, 0., 0.040, VLC_TICK_FROM_SEC(200));
+    printf("resampler: 40 ms step, drift %f ms (min %f ms), ratio %f ppm\n",
+           run.drift * 1e3, run.min_drift * 1e3, run.ratio * 1e6);
+    assert(run.max_drift <= 0.040);
+    assert(run.min_drift > -0.040 * 0.15);
+    assert(fabs(run.drift) < 0.0001);
+    /* The measurement jitter only moves the proportional term */
+    assert(fabs(resamp.integral) < 2e-6);
+    assert(fabs(run.ratio) < 30e-6);
+
+    /* Rate mismatch step: the integral term takes it over */
+    ResamplerReset(&resamp);
+    run = run_resampler(&resamp, 0, 300e-6, 0., VLC_TICK_FROM_SEC(60));
+    printf("resampler: 300 ppm step, peak drift %f ms\n",
+           run.max_drift * 1e3);
+    assert(run.max_drift < 0.0025);
+    assert(run.min_drift > -0.0005);
+
+    /* Steady state */
+    run = run_resampler(&resamp, 0, 300e-6, run.drift, VLC_TICK_FROM_SEC(200));
+    printf("resampler: 300 ppm steady, drift %f ms, integral %f ppm\n",
+           run.drift * 1e3, resamp.integral * 1e6);
+    assert(fabs(run.drift) < 0.0001);
+    assert(run.min_drift > -0.0005);
+    assert(fabs(resamp.integral - 300e-6) < 2e-6);
+    assert(fabs(run.ratio - 300e-6) < 30e-6);
+
+    /* Saturation: the ratio stays bounded and the integral does not wind up,
+     * so that the undershoot stays as small as for the unsaturated case */
+    ResamplerReset(&resamp);
+    run = run_resampler(&resamp, 0, 0., 0.500, VLC_TICK_FROM_SEC(300));
+    printf("resampler: 500 ms step, drift %f ms (min %f ms), "
+           "max ratio %f ppm\n", run.drift * 1e3, run.min_drift * 1e3,
+           run.max_ratio * 1e6);
+    assert(run.max_ratio <= 0.005);
+    assert(run.min_drift > -0.010);
+    assert(fabs(run.drift) < 0.0001);
+
+    /* Integer rate steps: every change of step reconfigures the resampler,
+     * which must not happen on every block: allow one per 100 blocks */
+    const vlc_tick_t length = VLC_TICK_FROM_SEC(600);
+    ResamplerReset(&resamp);
+    run = run_resampler(&resamp, 48000, 30e-6, 0., length);
+    printf("resampler: 30 ppm at 48 kHz, %u changes, drift %f to %f ms\n",
+           run.changes, run.min_drift * 1e3, run.max_drift * 1e3);
+    assert(run.changes < length / VLC_TICK_FROM_SEC(2));
+    assert(run.max_drift < 0.001 && run.min_drift > -0.001);
+
+    ResamplerReset(&resamp);
+    run = run_resampler(&resamp, 44100, 0., 0.040, length);
+    printf("resampler: 40 ms step at 44.1 kHz, %u changes, "
+           "drift %f ms\n", run.changes, run.drift * 1e3);
+    assert(run.changes < length / VLC_TICK_FROM_SEC(2));
+    assert(fabs(run.drift) < 0.002);
+}
+
+int main(void)
+{
+    test_drift(0.);
+    test_drift(+250.);
+    test_drift(-1000.);
+    test_resampler();
+    return 0;
+}
@@ -25,6 +25,7 @@
 #undef NDEBUG
 
 #include <assert.h>
+#include <string.h>
 
 #include <vlc_common.h>
 #include <vlc_executor.h>
@@ -271,6 +272,92 @@ static void test_task_chain(void)
         assert(array[i] == 2 * i);
 }
 
+struct order_data
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    bool blocked;
+    bool started;
+    char order[4];
+    size_t count;
+};
+
+struct order_task
+{
+    struct order_data *data;
+    char name;
+    struct vlc_runnable runnable;
+};
+
+static void RunOrder(void *userdata)
+{
+    struct order_task *task = userdata;
+    struct order_data *data = task->data;
+
+    vlc_mutex_lock(&data->lock);
+    data->started = true;
+    vlc_cond_broadcast(&data->cond);
+    while (data->blocked)
+        vlc_cond_wait(&data->cond, &data->lock);
+    assert(data->count < ARRAY_SIZE(data->order));
+    data->order[data->count++] = task->name;
+    vlc_mutex_unlock(&data->lock);
+}
+
+static void test_priority(void)
+{
+    vlc_executor_t *executor = vlc_executor_New(1);
+    assert(executor);
+
+    struct order_data data = {
+        .blocked = true,
+        .started = false,
+        .count = 0,
+    };
+    vlc_mutex_init(&data.lock);
+    vlc_cond_init(&data.cond);
+
+    struct order_task tasks[] = {
+        { .data = &data, .name = 'x' }, /* blocks the single thread */
+        { .data = &data, .name = 'b' },
+        { .data = &data, .name = 'n' },
+        { .data = &data, .name = 'i' },
+    };
+    static const enum vlc_executor_priority priorities[] = {
+        VLC_EXECUTOR_PRIORITY_NORMAL,
+        VLC_EXECUTOR_PRIORITY_BACKGROUND,
+        VLC_EXECUTOR_PRIORITY_NORMAL,
+        VLC_EXECUTOR_PRIORITY_INTERACTIVE,
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); ++i)
+    {
+        tasks[i].runnable.run = RunOrder;
+        tasks[i].runnable.userdata = &tasks[i];
+        vlc_executor_SubmitWithPriority(executor, &tasks[i].runnable,
+                                        priorities[i]);
+        if (i == 0)
+        {   /* Make sure the blocking task is started first */
+            vlc_mutex_lock(&data.lock);
+            while (!data.started)
+                vlc_cond_wait(&data.cond, &data.lock);
+            vlc_mutex_unlock(&data.lock);
+        }
+    }
+
+    vlc_mutex_lock(&data.lock);
+    data.blocked = false;
+    vlc_cond_broadcast(&data.cond);
+    vlc_mutex_unlock(&data.lock);
+
+    vlc_executor_WaitIdle(executor);
+    vlc_executor_Delete(executor);
+
+    /* Queued tasks run by decreasing priority */
+    assert(data.count == 4);
+    assert(!memcmp(data.order, "xinb", 4));
+}
+
 int main(void)
 {
     test_single_runnable();
@@ -278,5 +365,6 @@ int main(void)
     test_blocking_delete();
     test_cancel();
     test_task_chain();
+    test_priority();
     return 0;
 }
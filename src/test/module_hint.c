@@ -0,0 +1,91 @@
+/*****************************************************************************
+ * module_hint.c: test module probe hints
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+
+#include "../modules/modules.h"
+
+const char vlc_module_name[] = "test_module_hint";
+
+static bool match(const module_t *m, const char *ext, const char *mime,
+                  const char *magic)
+{
+    struct vlc_module_hint hint = {
+        .extension = ext,
+        .mime = mime,
+        .magic = (const uint8_t *)magic,
+        .magic_size = (magic != NULL) ? strlen(magic) : 0,
+    };
+
+    return vlc_module_hint_match(m, &hint);
+}
+
+int main(void)
+{
+    module_t m = { .probe_extensions = NULL };
+
+    /* No hints: always probed */
+    assert(match(&m, "txt", "text/plain", "hello"));
+    assert(match(&m, NULL, NULL, NULL));
+
+    /* Extensions and MIME types, case insensitive */
+    m.probe_extensions = "flac,fla";
+    m.probe_mime = "audio/flac";
+    assert(match(&m, "FLA", NULL, NULL));
+    assert(match(&m, NULL, "Audio/FLAC", NULL));
+    assert(!match(&m, "fl", NULL, NULL));
+    assert(!match(&m, "flac2", "audio/flac2", NULL));
+    /* Nothing to check against */
+    assert(!match(&m, NULL, NULL, "fLaC"));
+
+    /* Leading bytes, with wildcards */
+    m.probe_extensions = NULL;
+    m.probe_mime = NULL;
+    m.probe_magic = "52494646????????57415645,664C6143";
+    assert(match(&m, NULL, NULL, "RIFF\x01\x02\x03\x04WAVEfmt "));
+    assert(match(&m, "ogg", NULL, "fLaC"));
+    assert(!match(&m, NULL, NULL, "RIFF\x01\x02\x03\x04AVI LIST"));
+    assert(!match(&m, NULL, NULL, "OggS"));
+    /* Too short to tell */
+    assert(!match(&m, NULL, NULL, "RIFF"));
+    /* The content could not be peeked */
+    assert(match(&m, NULL, NULL, NULL));
+
+    /* Any hint is enough */
+    m.probe_extensions = "wav";
+    assert(match(&m, "wav", NULL, "OggS"));
+    assert(!match(&m, "ogg", NULL, "OggS"));
+
+    /* MIME type only, the leading bytes don't match */
+    m.probe_extensions = NULL;
+    m.probe_mime = "application/ogg,video/ogg,audio/ogg";
+    m.probe_magic = "4F676753";
+    assert(match(&m, NULL, "video/ogg", "\x1A\x45\xDF\xA3"));
+    assert(match(&m, NULL, NULL, "OggS"));
+    assert(!match(&m, NULL, "video/webm", "\x1A\x45\xDF\xA3"));
+    return 0;
+}
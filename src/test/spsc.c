@@ -0,0 +1,196 @@
+/*****************************************************************************
+ * spsc.c: Test for the single-producer single-consumer frame queue
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_frame.h>
+#include <vlc_atomic.h>
+#include "../libvlc.h"
+
+#define RING_SIZE 4
+
+/* Frames without payload, numbered with their DTS, whose releases are
+ * counted */
+static atomic_uint released;
+
+static void frame_Free(vlc_frame_t *frame)
+{
+    atomic_fetch_add(&released, 1);
+    free(frame);
+}
+
+static const struct vlc_frame_callbacks frame_cbs = { frame_Free };
+
+static vlc_frame_t *frame_New(unsigned seq)
+{
+    vlc_frame_t *frame = malloc(sizeof (*frame));
+    assert(frame != NULL);
+    vlc_frame_Init(frame, &frame_cbs, NULL, seq + 1);
+    frame->i_dts = seq;
+    return frame;
+}
+
+static void pop_check(vlc_frame_spsc_t *q, unsigned seq)
+{
+    vlc_frame_t *frame = vlc_frame_spsc_Pop(q);
+
+    assert(frame != NULL);
+    assert(frame->i_dts == (vlc_tick_t)seq);
+    assert(frame->p_next == NULL);
+    vlc_frame_Release(frame);
+}
+
+static void test_spsc_Order(void)
+{
+    vlc_frame_spsc_t *q = vlc_frame_spsc_New(RING_SIZE);
+    assert(q != NULL);
+    assert(vlc_frame_spsc_Pop(q) == NULL);
+
+    /* Twice the ring: the second half goes to the overflow lane */
+    size_t bytes = 0;
+    for (unsigned i = 0; i < 2 * RING_SIZE; i++)
+    {
+        vlc_frame_spsc_Push(q, frame_New(i));
+        bytes += i + 1;
+    }
+    assert(vlc_frame_spsc_GetCount(q) == 2 * RING_SIZE);
+    assert(vlc_frame_spsc_GetBytes(q) == bytes);
+
+    /* Room in the ring while the lane is not drained: later frames must
+     * still queue behind the lane */
+    pop_check(q, 0);
+    vlc_frame_spsc_Push(q, frame_New(2 * RING_SIZE));
+    for (unsigned i = 1; i <= 2 * RING_SIZE; i++)
+        pop_check(q, i);
+    assert(vlc_frame_spsc_Pop(q) == NULL);
+    assert(vlc_frame_spsc_GetCount(q) == 0);
+    assert(vlc_frame_spsc_GetBytes(q) == 0);
+
+    /* Chains are queued frame by frame, in order */
+    vlc_frame_t *chain = NULL;
+    vlc_frame_t **pp = &chain;
+    for (unsigned i = 0; i < RING_SIZE + 2; i++)
+    {
+        *pp = frame_New(i);
+        pp = &(*pp)->p_next;
+    }
+    vlc_frame_spsc_Push(q, chain);
+    assert(vlc_frame_spsc_GetCount(q) == RING_SIZE + 2);
+    for (unsigned i = 0; i < RING_SIZE + 2; i++)
+        pop_check(q, i);
+
+    vlc_frame_spsc_Delete(q);
+}
+
+static void test_spsc_PopAll(void)
+{
+    vlc_frame_spsc_t *q = vlc_frame_spsc_New(RING_SIZE);
+    assert(q != NULL);
+    assert(vlc_frame_spsc_PopAll(q) == NULL);
+
+    for (unsigned i = 0; i < RING_SIZE + 3; i++)
+        vlc_frame_spsc_Push(q, frame_New(i));
+
+    /* Ring and lane come out as a single chain, in order */
+    vlc_frame_t *chain = vlc_frame_spsc_PopAll(q);
+    unsigned seq = 0;
+    for (vlc_frame_t *frame = chain; frame != NULL; frame = frame->p_next)
+        assert(frame->i_dts == (vlc_tick_t)seq++);
+    assert(seq == RING_SIZE + 3);
+    assert(vlc_frame_spsc_GetCount(q) == 0);
+    assert(vlc_frame_spsc_GetBytes(q) == 0);
+    vlc_frame_ChainRelease(chain);
+
+    /* The ring is used again once the lane is drained */
+    vlc_frame_spsc_Push(q, frame_New(0));
+    pop_check(q, 0);
+    vlc_frame_spsc_Delete(q);
+}
+
+static void test_spsc_Delete(void)
+{
+    vlc_frame_spsc_t *q = vlc_frame_spsc_New(RING_SIZE);
+    assert(q != NULL);
+
+    /* Queued frames, in the ring and in the lane, are released */
+    atomic_store(&released, 0);
+    for (unsigned i = 0; i < RING_SIZE + 3; i++)
+        vlc_frame_spsc_Push(q, frame_New(i));
+    vlc_frame_spsc_Delete(q);
+    assert(atomic_load(&released) == RING_SIZE + 3);
+}
+
+#define THREAD_FRAMES 100000
+
+static void *producer(void *data)
+{
+    vlc_frame_spsc_t *q = data;
+
+    for (unsigned i = 0; i < THREAD_FRAMES; i++)
+        vlc_frame_spsc_Push(q, frame_New(i));
+    return NULL;
+}
+
+static void test_spsc_Threads(void)
+{
+    vlc_frame_spsc_t *q = vlc_frame_spsc_New(RING_SIZE);
+    vlc_thread_t th;
+    assert(q != NULL);
+
+    /* The small ring overflows often while the consumer lags */
+    atomic_store(&released, 0);
+    int ret = vlc_clone(&th, producer, q);
+    assert(ret == 0);
+
+    for (unsigned i = 0; i < THREAD_FRAMES;)
+    {
+        vlc_frame_t *frame = vlc_frame_spsc_Pop(q);
+        if (frame == NULL)
+            continue;
+
+        assert(frame->i_dts == (vlc_tick_t)i);
+        vlc_frame_Release(frame);
+        i++;
+    }
+
+    vlc_join(th, NULL);
+    assert(vlc_frame_spsc_Pop(q) == NULL);
+    assert(vlc_frame_spsc_GetCount(q) == 0);
+    assert(vlc_frame_spsc_GetBytes(q) == 0);
+    assert(atomic_load(&released) == THREAD_FRAMES);
+    vlc_frame_spsc_Delete(q);
+}
+
+int main(void)
+{
+    test_spsc_Order();
+    test_spsc_PopAll();
+    test_spsc_Delete();
+    test_spsc_Threads();
+    return 0;
+}
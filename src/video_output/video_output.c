@@ -63,6 +63,15 @@
 #include "chrono.h"
 #include "control.h"
 
+/* A prerendered picture waiting for its display date */
+struct vout_prerendered
+{
+    picture_t       *picture;
+    subpicture_t    *subpic;
+    float           rate;
+    bool            render_now;
+};
+
 typedef struct vout_thread_sys_t
 {
     struct vout_thread_t obj;
@@ -159,11 +168,52 @@ typedef struct vout_thread_sys_t
     } filter;
 
     picture_fifo_t  *decoder_fifo;
+    /* Span of queued pictures over which the oldest ones are dropped, 0 if
+     * unbound (see vout_configuration_t.queue_max) */
+    vlc_tick_t      queue_max;
+    _Atomic vlc_tick_t queue_tail; /* date of the last queued picture */
     struct {
         vout_chrono_t static_filter;
         vout_chrono_t render;         /**< picture render time estimator */
+        vout_chrono_t prepare;        /**< display prepare time estimator */
     } chrono;
 
+    /* Display thread of the pipelined rendering: it waits for the date of
+     * the prerendered pictures and displays them, while the vout thread
+     * prerenders the next one. Up to three pictures are in flight: the one
+     * on screen, the one waiting for its date and the ready one. */
+    struct {
+        bool            enabled;
+        bool            running;
+        vlc_thread_t    thread;
+        vlc_mutex_t     lock;
+        vlc_cond_t      wait;
+        struct vout_prerendered ready;
+        bool            busy;       /* a picture is waiting for its date */
+        vlc_tick_t      busy_date;  /* timestamp of the busy picture */
+        atomic_bool     discard;    /* the busy picture has been flushed */
+        vlc_tick_t      date;       /* last display date */
+        bool            terminated;
+    } pipeline;
+
+    /* Presentation feedback of the display (vblank timestamps), written
+     * from the thread of the display events */
+    struct {
+        vlc_mutex_t     lock;
+        struct {
+            vlc_tick_t  call;       /* system date of the display call */
+            vlc_tick_t  target;     /* expected scanout, INVALID if forced */
+        } displayed[4];
+        unsigned        next;
+        vlc_tick_t      vblank;     /* last reported vblank */
+        uint64_t        sequence;   /* vblank counter of the last report */
+        vlc_tick_t      ref_vblank; /* reference of the period estimation */
+        uint64_t        ref_sequence;
+        vlc_tick_t      period;     /* vblank period, 0 if unknown */
+        vlc_tick_t      mode_period; /* period reported by the display */
+        vlc_tick_t      latency;    /* average scanout latency */
+    } presentation;
+
     vlc_atomic_rc_t rc;
 
 } vout_thread_sys_t;
@@ -185,6 +235,10 @@ typedef struct vout_thread_sys_t
 /* Better be in advance when awakening than late... */
 #define VOUT_MWAIT_TOLERANCE VLC_TICK_FROM_MS(4)
 
+/* The vblank grid is extrapolated from the last presentation up to this
+ * delay, after which the display dates are not aligned anymore. */
+#define VOUT_VBLANK_GRID_VALIDITY VLC_TICK_FROM_SEC(1)
+
 /* */
 static inline struct vlc_tracer *GetTracer(vout_thread_sys_t *sys)
 {
@@ -199,6 +253,163 @@ static inline void VoutResetChronoLocked(vout_thread_sys_t *sys)
     /* Arbitrary initial time */
     vout_chrono_Init(&sys->chrono.render, 5, VLC_TICK_FROM_MS(10));
     vout_chrono_Init(&sys->chrono.static_filter, 4, VLC_TICK_FROM_MS(0));
+    vout_chrono_Init(&sys->chrono.prepare, 5, VLC_TICK_FROM_MS(1));
+}
+
+static void VoutResetPresentation(vout_thread_sys_t *sys)
+{
+    vlc_mutex_lock(&sys->presentation.lock);
+    for (size_t i = 0; i < ARRAY_SIZE(sys->presentation.displayed); i++)
+        sys->presentation.displayed[i].call = VLC_TICK_INVALID;
+    sys->presentation.next = 0;
+    sys->presentation.vblank = VLC_TICK_INVALID;
+    sys->presentation.sequence = 0;
+    sys->presentation.ref_vblank = VLC_TICK_INVALID;
+    sys->presentation.ref_sequence = 0;
+    sys->presentation.period = 0;
+    sys->presentation.mode_period = 0;
+    sys->presentation.latency = 0;
+    vlc_mutex_unlock(&sys->presentation.lock);
+}
+
+/* Snap a display date to the closest vblank of the display, and return the
+ * date to commit the picture so that it is scanned out at that vblank. */
+static vlc_tick_t VoutSnapToVblank(vout_thread_sys_t *sys, vlc_tick_t *date)
+{
+    vlc_tick_t wakeup = *date;
+
+    vlc_mutex_lock(&sys->presentation.lock);
+    const vlc_tick_t period = sys->presentation.period;
+    const vlc_tick_t vblank = sys->presentation.vblank;
+    if (period > 0 && llabs(*date - vblank) < VOUT_VBLANK_GRID_VALIDITY)
+    {
+        vlc_tick_t offset = *date - vblank + period / 2;
+        vlc_tick_t count = offset >= 0 ? offset / period
+                                       : -((period - 1 - offset) / period);
+        *date = vblank + count * period;
+        wakeup = *date - period / 2;
+    }
+    vlc_mutex_unlock(&sys->presentation.lock);
+    return wakeup;
+}
+
+static void VoutQueuePresentation(vout_thread_sys_t *sys, vlc_tick_t call,
+                                  vlc_tick_t target)
+{
+    vlc_mutex_lock(&sys->presentation.lock);
+    unsigned i = sys->presentation.next;
+    sys->presentation.displayed[i].call = call;
+    sys->presentation.displayed[i].target = target;
+    sys->presentation.next = (i + 1) % ARRAY_SIZE(sys->presentation.displayed);
+    vlc_mutex_unlock(&sys->presentation.lock);
+}
+
+void vout_ReportRefreshPeriod(vout_thread_t *vout, vlc_tick_t period)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+
+    /* Seed the period of the mode, and measure it again from there */
+    vlc_mutex_lock(&sys->presentation.lock);
+    sys->presentation.period = sys->presentation.mode_period = period;
+    sys->presentation.ref_vblank = VLC_TICK_INVALID;
+    sys->presentation.ref_sequence = 0;
+    vlc_mutex_unlock(&sys->presentation.lock);
+}
+
+void vout_ReportPresented(vout_thread_t *vout, vlc_tick_t date,
+                          uint64_t sequence)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+    const size_t count = ARRAY_SIZE(sys->presentation.displayed);
+    vlc_tick_t latency = 0; /* can be 0 or negative */
+    bool scanned = false;
+    unsigned missed = 0;
+
+    vlc_mutex_lock(&sys->presentation.lock);
+
+    /* Estimate the vblank period over the longest span of the counter, and
+     * start over if the refresh rate changed */
+    if (sequence != 0 && sys->presentation.ref_sequence != 0
+     && sequence > sys->presentation.ref_sequence
+     && date > sys->presentation.ref_vblank)
+    {
+        vlc_tick_t period = (date - sys->presentation.ref_vblank)
+                          / (sequence - sys->presentation.ref_sequence);
+        vlc_tick_t previous = sys->presentation.period;
+
+        if (previous > 0 && llabs(period - previous) > previous / 10)
+        {
+            /* Keep the last interval only */
+            period = (date - sys->presentation.vblank)
+                   / (sequence > sys->presentation.sequence ?
+                      sequence - sys->presentation.sequence : 1);
+            sys->presentation.ref_vblank = sys->presentation.vblank;
+            sys->presentation.ref_sequence = sys->presentation.sequence;
+        }
+        sys->presentation.period = period;
+    }
+    else
+    {
+        sys->presentation.ref_vblank = date;
+        sys->presentation.ref_sequence = sequence;
+        if (sequence == 0) /* only the mode period is known */
+            sys->presentation.period = sys->presentation.mode_period;
+    }
+    sys->presentation.vblank = date;
+    sys->presentation.sequence = sequence;
+
+    /* The scanned out picture is the last one displayed before the vblank */
+    for (size_t n = 1; n <= count; n++)
+    {
+        size_t i = (sys->presentation.next + count - n) % count;
+        const vlc_tick_t call = sys->presentation.displayed[i].call;
+        if (call == VLC_TICK_INVALID || call > date)
+            continue;
+
+        vlc_tick_t target = sys->presentation.displayed[i].target;
+        if (target != VLC_TICK_INVALID)
+        {
+            scanned = true;
+            latency = date - target;
+            sys->presentation.latency +=
+                (latency - sys->presentation.latency) / 8;
+
+            const vlc_tick_t period = sys->presentation.period;
+            if (period > 0 && latency > period / 2)
+                missed = (latency + period / 2) / period;
+        }
+        /* Older pictures won't be scanned out anymore */
+        for (size_t k = 0; k < count; k++)
+            if (sys->presentation.displayed[k].call <= call)
+                sys->presentation.displayed[k].call = VLC_TICK_INVALID;
+        break;
+    }
+
+    const vlc_tick_t period = sys->presentation.period;
+    const vlc_tick_t average = sys->presentation.latency;
+    vlc_mutex_unlock(&sys->presentation.lock);
+
+    if (!scanned)
+        return;
+
+    struct vlc_tracer *tracer = GetTracer(sys);
+    if (tracer != NULL)
+        vlc_tracer_Trace(tracer, VLC_TRACE("type", "RENDER"),
+                         VLC_TRACE("id", sys->str_id),
+                         VLC_TRACE("event", "presented"),
+                         VLC_TRACE("vblank", date),
+                         VLC_TRACE("latency", latency),
+                         VLC_TRACE("avg_latency", average),
+                         VLC_TRACE("vblank_period", period),
+                         VLC_TRACE_INT("missed", missed), VLC_TRACE_END);
+
+    if (missed > 0)
+    {
+        msg_Dbg(&sys->obj, "picture scanned out late (missed %u vblank%s, "
+                "%"PRId64" us)", missed, missed > 1 ? "s" : "",
+                US_FROM_VLC_TICK(latency));
+        vout_statistic_AddLate(&sys->statistic, 1);
+    }
 }
 
 static bool VoutCheckFormat(const video_format_t *src)
@@ -258,7 +469,11 @@ bool vout_IsEmpty(vout_thread_t *vout)
     if (!sys->decoder_fifo)
         return true;
 
-    return picture_fifo_IsEmpty(sys->decoder_fifo);
+    vlc_mutex_lock(&sys->pipeline.lock);
+    bool empty = sys->pipeline.ready.picture == NULL && !sys->pipeline.busy;
+    vlc_mutex_unlock(&sys->pipeline.lock);
+
+    return empty && picture_fifo_IsEmpty(sys->decoder_fifo);
 }
 
 void vout_DisplayTitle(vout_thread_t *vout, const char *title)
@@ -392,6 +607,9 @@ void vout_PutPicture(vout_thread_t *vout, picture_t *picture)
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
     assert(!sys->dummy);
     assert( !picture_HasChainedPics( picture ) );
+    if (sys->queue_max > 0)
+        atomic_store_explicit(&sys->queue_tail, picture->date,
+                              memory_order_relaxed);
     picture_fifo_Push(sys->decoder_fifo, picture);
     vout_control_Wake(&sys->control);
 }
@@ -917,6 +1135,21 @@ static picture_t *PreparePicture(vout_thread_sys_t *vout, bool reuse_decoded,
             decoded = picture_fifo_Pop(sys->decoder_fifo);
 
             if (decoded) {
+                if (sys->queue_max > 0 && !decoded->b_force && !frame_by_frame)
+                {
+                    const vlc_tick_t tail =
+                        atomic_load_explicit(&sys->queue_tail,
+                                             memory_order_relaxed);
+
+                    if (tail != VLC_TICK_INVALID
+                     && tail - decoded->date > sys->queue_max)
+                    {   /* Over the live latency budget of the output */
+                        picture_Release(decoded);
+                        vout_statistic_AddLost(&sys->statistic, 1);
+                        filter_chain_VideoFlush(sys->filter.chain_static);
+                        continue;
+                    }
+                }
                 if (is_late_dropped && !decoded->b_force)
                 {
                     const vlc_tick_t system_now = vlc_tick_now();
@@ -1220,31 +1453,24 @@ static int PrerenderPicture(vout_thread_sys_t *sys, picture_t *filtered,
     return VLC_SUCCESS;
 }
 
-static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
+/* Display a prerendered picture, with the display lock held. Returns the
+ * display date. */
+static vlc_tick_t DisplayRenderedPicture(vout_thread_sys_t *sys,
+                                         vout_chrono_t *chrono,
+                                         picture_t *todisplay,
+                                         subpicture_t *subpic,
+                                         bool render_now, float rate)
 {
     vout_display_t *vd = sys->display;
+    vlc_tick_t display_date;
 
-    vout_chrono_Start(&sys->chrono.render);
-
-    picture_t *filtered = FilterPictureInteractive(sys);
-    if (!filtered)
-        return VLC_EGENERIC;
-
-    vlc_mutex_lock(&sys->display_lock);
-
-    picture_t *todisplay;
-    subpicture_t *subpic;
-    int ret = PrerenderPicture(sys, filtered, &render_now, &todisplay, &subpic);
-    if (ret != VLC_SUCCESS)
-    {
-        vlc_mutex_unlock(&sys->display_lock);
-        return ret;
-    }
+    vlc_mutex_assert(&sys->display_lock);
 
     vlc_tick_t system_now = vlc_tick_now();
+    vlc_tick_t target = VLC_TICK_INVALID;
     const vlc_tick_t pts = todisplay->date;
     vlc_tick_t system_pts = render_now ? system_now :
-        vlc_clock_ConvertToSystem(sys->clock, system_now, pts, sys->rate);
+        vlc_clock_ConvertToSystem(sys->clock, system_now, pts, rate);
     if (unlikely(system_pts == VLC_TICK_MAX))
     {
         /* The clock is paused, it's too late to fallback to the previous
@@ -1260,7 +1486,7 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
     if (vd->ops->prepare != NULL)
         vd->ops->prepare(vd, todisplay, subpic, system_pts);
 
-    vout_chrono_Stop(&sys->chrono.render);
+    vout_chrono_Stop(chrono);
 
     system_now = vlc_tick_now();
     if (!render_now)
@@ -1289,36 +1515,100 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
             bool timed_out = false;
             while (!timed_out)
             {
-                vlc_tick_t deadline;
+                vlc_tick_t deadline, wakeup;
                 if (vlc_clock_IsPaused(sys->clock))
-                    deadline = max_deadline;
+                    deadline = wakeup = max_deadline;
                 else
                 {
                     deadline = vlc_clock_ConvertToSystemLocked(sys->clock,
-                                                vlc_tick_now(), pts, sys->rate);
+                                                vlc_tick_now(), pts, rate);
+                    /* Aim at the closest vblank if the display reports its
+                     * presentations, rather than at the wall clock */
+                    wakeup = VoutSnapToVblank(sys, &deadline);
                     if (deadline > max_deadline)
-                        deadline = max_deadline;
+                        deadline = wakeup = max_deadline;
                 }
 
                 system_pts = deadline;
-                timed_out = vlc_clock_Wait(sys->clock, deadline);
+                timed_out = vlc_clock_Wait(sys->clock, wakeup);
             }
 
             vlc_clock_Unlock(sys->clock);
+            target = system_pts;
         }
-        sys->displayed.date = system_pts;
+        else
+            target = system_pts;
+        display_date = system_pts;
     }
     else
     {
-        sys->displayed.date = system_now;
+        display_date = system_now;
         /* Tell the clock that the pts was forced */
         system_pts = VLC_TICK_MAX;
     }
-    vlc_clock_UpdateVideo(sys->clock, system_pts, pts, sys->rate,
+    vlc_clock_UpdateVideo(sys->clock, system_pts, pts, rate,
                           frame_rate, frame_rate_base);
 
     /* Display the direct buffer returned by vout_RenderPicture */
+    VoutQueuePresentation(sys, vlc_tick_now(), target);
     vout_display_Display(vd, todisplay);
+
+    vout_statistic_AddDisplayed(&sys->statistic, 1);
+
+    return display_date;
+}
+
+static void QueuePrerenderedPicture(vout_thread_sys_t *sys,
+                                    const struct vout_prerendered *entry)
+{
+    vlc_mutex_lock(&sys->pipeline.lock);
+    /* DisplayPicture() waits for some room, but not DisplayNextFrame() */
+    while (sys->pipeline.ready.picture != NULL)
+        vlc_cond_wait(&sys->pipeline.wait, &sys->pipeline.lock);
+    sys->pipeline.ready = *entry;
+    vlc_cond_signal(&sys->pipeline.wait);
+    vlc_mutex_unlock(&sys->pipeline.lock);
+}
+
+static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
+{
+    vout_chrono_Start(&sys->chrono.render);
+
+    picture_t *filtered = FilterPictureInteractive(sys);
+    if (!filtered)
+        return VLC_EGENERIC;
+
+    vlc_mutex_lock(&sys->display_lock);
+
+    picture_t *todisplay;
+    subpicture_t *subpic;
+    int ret = PrerenderPicture(sys, filtered, &render_now, &todisplay, &subpic);
+    if (ret != VLC_SUCCESS)
+    {
+        vlc_mutex_unlock(&sys->display_lock);
+        return ret;
+    }
+    vlc_clock_ReportStage(sys->clock, VLC_CLOCK_STAGE_PRERENDER,
+                          todisplay->date);
+
+    if (sys->pipeline.running)
+    {
+        vlc_mutex_unlock(&sys->display_lock);
+        vout_chrono_Stop(&sys->chrono.render);
+
+        const struct vout_prerendered entry = {
+            .picture = todisplay,
+            .subpic = subpic,
+            .rate = sys->rate,
+            .render_now = render_now,
+        };
+        QueuePrerenderedPicture(sys, &entry);
+        return VLC_SUCCESS;
+    }
+
+    sys->displayed.date =
+        DisplayRenderedPicture(sys, &sys->chrono.render, todisplay, subpic,
+                               render_now, sys->rate);
     vlc_mutex_unlock(&sys->display_lock);
 
     picture_Release(todisplay);
@@ -1326,11 +1616,171 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
     if (subpic)
         subpicture_Delete(subpic);
 
-    vout_statistic_AddDisplayed(&sys->statistic, 1);
-
     return VLC_SUCCESS;
 }
 
+/* Wait for the prepare date of a prerendered picture, without blocking the
+ * prerendering of the next one. Returns false if the picture was flushed. */
+static bool DisplayThreadWait(vout_thread_sys_t *sys,
+                              const struct vout_prerendered *entry)
+{
+    if (entry->render_now)
+        return !atomic_load(&sys->pipeline.discard);
+
+    const vlc_tick_t max_deadline = vlc_tick_now() + VOUT_REDISPLAY_DELAY;
+
+    vlc_mutex_lock(&sys->display_lock);
+    const vlc_tick_t prepare_delay = vout_chrono_GetHigh(&sys->chrono.prepare)
+                                   + VOUT_MWAIT_TOLERANCE;
+    vlc_mutex_unlock(&sys->display_lock);
+
+    vlc_clock_Lock(sys->clock);
+    while (!atomic_load(&sys->pipeline.discard)
+        && !vlc_clock_IsPaused(sys->clock))
+    {
+        vlc_tick_t deadline =
+            vlc_clock_ConvertToSystemLocked(sys->clock, vlc_tick_now(),
+                                            entry->picture->date, entry->rate);
+        deadline = __MIN(deadline - prepare_delay, max_deadline);
+        if (vlc_clock_Wait(sys->clock, deadline))
+            break;
+    }
+    vlc_clock_Unlock(sys->clock);
+
+    return !atomic_load(&sys->pipeline.discard);
+}
+
+static void *DisplayThread(void *data)
+{
+    vout_thread_sys_t *sys = data;
+
+    vlc_thread_set_name("vlc-vout-disp");
+
+    vlc_mutex_lock(&sys->pipeline.lock);
+    for (;;)
+    {
+        while (sys->pipeline.ready.picture == NULL && !sys->pipeline.terminated)
+            vlc_cond_wait(&sys->pipeline.wait, &sys->pipeline.lock);
+        if (sys->pipeline.terminated)
+            break;
+
+        struct vout_prerendered entry = sys->pipeline.ready;
+        sys->pipeline.ready.picture = NULL;
+        sys->pipeline.busy = true;
+        sys->pipeline.busy_date = entry.picture->date;
+        atomic_store(&sys->pipeline.discard, false);
+        vlc_cond_signal(&sys->pipeline.wait);
+        vlc_mutex_unlock(&sys->pipeline.lock);
+
+        /* The vout thread can prerender the next picture */
+        vout_control_Wake(&sys->control);
+
+        vlc_tick_t date = VLC_TICK_INVALID;
+        if (DisplayThreadWait(sys, &entry))
+        {
+            vlc_mutex_lock(&sys->display_lock);
+            if (!atomic_load(&sys->pipeline.discard))
+            {
+                vout_chrono_Start(&sys->chrono.prepare);
+                date = DisplayRenderedPicture(sys, &sys->chrono.prepare,
+                                              entry.picture, entry.subpic,
+                                              entry.render_now, entry.rate);
+            }
+            vlc_mutex_unlock(&sys->display_lock);
+        }
+
+        picture_Release(entry.picture);
+        if (entry.subpic != NULL)
+            subpicture_Delete(entry.subpic);
+
+        vlc_mutex_lock(&sys->pipeline.lock);
+        sys->pipeline.busy = false;
+        if (date != VLC_TICK_INVALID)
+            sys->pipeline.date = date;
+    }
+    vlc_mutex_unlock(&sys->pipeline.lock);
+    return NULL;
+}
+
+static bool PrerenderedIsFlushed(vlc_tick_t pts, bool below, vlc_tick_t date)
+{
+    return date == VLC_TICK_INVALID ||
+           ( below && pts <= date) ||
+           (!below && pts >= date);
+}
+
+static void FlushPipeline(vout_thread_sys_t *sys, bool below, vlc_tick_t date)
+{
+    struct vout_prerendered flushed = { .picture = NULL };
+
+    vlc_mutex_lock(&sys->pipeline.lock);
+    if (sys->pipeline.ready.picture != NULL &&
+        PrerenderedIsFlushed(sys->pipeline.ready.picture->date, below, date))
+    {
+        flushed = sys->pipeline.ready;
+        sys->pipeline.ready.picture = NULL;
+    }
+    if (sys->pipeline.busy &&
+        PrerenderedIsFlushed(sys->pipeline.busy_date, below, date))
+    {
+        atomic_store(&sys->pipeline.discard, true);
+        vlc_clock_Lock(sys->clock);
+        vlc_clock_Wake(sys->clock);
+        vlc_clock_Unlock(sys->clock);
+    }
+    if (sys->displayed.date == VLC_TICK_INVALID)
+        sys->pipeline.date = VLC_TICK_INVALID;
+    vlc_mutex_unlock(&sys->pipeline.lock);
+
+    if (flushed.picture != NULL)
+    {
+        picture_Release(flushed.picture);
+        if (flushed.subpic != NULL)
+            subpicture_Delete(flushed.subpic);
+    }
+}
+
+static void StartPipeline(vout_thread_sys_t *sys)
+{
+    sys->pipeline.running = false;
+    if (!sys->pipeline.enabled)
+        return;
+
+    if (sys->display->ops->display == NULL)
+    {
+        msg_Dbg(&sys->obj, "display handles the timing, not pipelining");
+        return;
+    }
+
+    sys->pipeline.ready.picture = NULL;
+    sys->pipeline.busy = false;
+    atomic_store(&sys->pipeline.discard, false);
+    sys->pipeline.date = VLC_TICK_INVALID;
+    sys->pipeline.terminated = false;
+
+    if (vlc_clone(&sys->pipeline.thread, DisplayThread, sys))
+    {
+        msg_Warn(&sys->obj, "cannot spawn the display thread");
+        return;
+    }
+    sys->pipeline.running = true;
+}
+
+static void StopPipeline(vout_thread_sys_t *sys)
+{
+    if (!sys->pipeline.running)
+        return;
+
+    vlc_mutex_lock(&sys->pipeline.lock);
+    assert(sys->pipeline.ready.picture == NULL);
+    sys->pipeline.terminated = true;
+    vlc_cond_signal(&sys->pipeline.wait);
+    vlc_mutex_unlock(&sys->pipeline.lock);
+
+    vlc_join(sys->pipeline.thread, NULL);
+    sys->pipeline.running = false;
+}
+
 static void UpdateDeinterlaceFilter(vout_thread_sys_t *sys)
 {
     vlc_mutex_lock(&sys->filter.lock);
@@ -1375,11 +1825,29 @@ static vlc_tick_t DisplayPicture(vout_thread_sys_t *vout)
     const vlc_tick_t render_delay = vout_chrono_GetHigh(&sys->chrono.render) + VOUT_MWAIT_TOLERANCE;
     const bool first = !sys->displayed.current;
 
+    /* With the pipelined rendering, the next picture is prerendered as soon
+     * as the display thread is done with the ready one, and the current one
+     * can only be redisplayed once the display thread is idle. */
+    bool can_prerender = true, idle = true;
+    if (sys->pipeline.running)
+    {
+        vlc_mutex_lock(&sys->pipeline.lock);
+        can_prerender = sys->pipeline.ready.picture == NULL;
+        idle = can_prerender && !sys->pipeline.busy;
+        sys->displayed.date = sys->pipeline.date;
+        vlc_mutex_unlock(&sys->pipeline.lock);
+    }
+
     picture_t *next = NULL;
     if (first)
     {
         next = PreparePicture(vout, true, false);
     }
+    else if (sys->pipeline.running)
+    {
+        if (!paused && can_prerender)
+            next = PreparePicture(vout, false, false);
+    }
     else if (!paused)
     {
         const vlc_tick_t system_swap_current =
@@ -1412,7 +1880,7 @@ static vlc_tick_t DisplayPicture(vout_thread_sys_t *vout)
             /* Prepare the next picture immediately without waiting */
             return VLC_TICK_INVALID;
     }
-    else if (likely(sys->displayed.date != VLC_TICK_INVALID))
+    else if (likely(sys->displayed.date != VLC_TICK_INVALID) && idle)
     {
         // next date we need to display again the current picture
         vlc_tick_t date_refresh = sys->displayed.date + VOUT_REDISPLAY_DELAY - render_delay;
@@ -1489,6 +1957,11 @@ static void vout_FlushUnlocked(vout_thread_sys_t *vout, bool below,
     }
 
     picture_fifo_Flush(sys->decoder_fifo, date, below);
+    atomic_store_explicit(&sys->queue_tail, VLC_TICK_INVALID,
+                          memory_order_relaxed);
+
+    if (sys->pipeline.running)
+        FlushPipeline(sys, below, date);
 
     vlc_mutex_lock(&sys->display_lock);
     if (sys->display != NULL)
@@ -1645,6 +2118,7 @@ static int vout_Start(vout_thread_sys_t *vout, vlc_video_context *vctx, const vo
 
     /* Reinitialize chrono to ensure we re-compute any new render timing. */
     VoutResetChronoLocked(sys);
+    VoutResetPresentation(sys);
 
     /* Setup the window size, protected by the display_lock */
     dcfg.display.width = sys->window_width;
@@ -1680,6 +2154,8 @@ static int vout_Start(vout_thread_sys_t *vout, vlc_video_context *vctx, const vo
     sys->spu_blend_chroma        = 0;
     sys->spu_blend               = NULL;
 
+    StartPipeline(sys);
+
     video_format_Print(VLC_OBJECT(&vout->obj), "original format", &sys->original);
     return VLC_SUCCESS;
 error:
@@ -1763,6 +2239,7 @@ static void vout_ReleaseDisplay(vout_thread_sys_t *vout)
     /* Destroy the rendering display */
     if (sys->private.display_pool != NULL)
         vout_FlushUnlocked(vout, true, VLC_TICK_MAX);
+    StopPipeline(sys);
 
     vlc_mutex_lock(&sys->display_lock);
     vout_CloseWrapper(&vout->obj, &sys->private, sys->display);
@@ -1971,6 +2448,20 @@ vout_thread_t *vout_Create(vlc_object_t *object)
     vout_InitInterlacingSupport(vout, &sys->private);
 
     sys->is_late_dropped = var_InheritBool(vout, "drop-late-frames");
+    sys->queue_max = 0;
+    atomic_init(&sys->queue_tail, VLC_TICK_INVALID);
+
+    sys->pipeline.enabled = var_InheritBool(vout, "vout-pipeline");
+    sys->pipeline.running = false;
+    sys->pipeline.ready.picture = NULL;
+    sys->pipeline.busy = false;
+    atomic_init(&sys->pipeline.discard, false);
+    vlc_mutex_init(&sys->pipeline.lock);
+    vlc_cond_init(&sys->pipeline.wait);
+    sys->private.queued_pictures = sys->pipeline.enabled ? 2 : 0;
+
+    vlc_mutex_init(&sys->presentation.lock);
+    VoutResetPresentation(sys);
 
     vlc_mutex_init(&sys->filter.lock);
 
@@ -2085,6 +2576,8 @@ int vout_Request(const vout_configuration_t *cfg, vlc_video_context *vctx, input
     video_format_t original;
     VoutFixFormat(&original, cfg->fmt);
 
+    sys->queue_max = cfg->queue_max;
+
     if (vout_ChangeSource(cfg->vout, &original, vctx) == 0)
     {
         video_format_Clean(&original);
@@ -47,6 +47,9 @@ typedef struct {
     const video_format_t *fmt;
     vlc_mouse_event      mouse_event;
     void                 *mouse_opaque;
+    /* Span of the decoded pictures queued for display over which the oldest
+     * ones are dropped, 0 if unbound */
+    vlc_tick_t           queue_max;
 } vout_configuration_t;
 
 /**
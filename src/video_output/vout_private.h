@@ -41,6 +41,8 @@ struct vout_thread_private_t
 
     picture_pool_t  *private_pool;
     picture_pool_t  *display_pool;
+
+    unsigned        queued_pictures; /* prerendered pictures awaiting display */
 };
 
 /* */
@@ -52,4 +54,8 @@ void vout_InitInterlacingSupport(vout_thread_t *, vout_thread_private_t *);
 void vout_ReinitInterlacingSupport(vout_thread_t *, vout_thread_private_t *);
 void vout_SetInterlacingState(vout_thread_t *, vout_thread_private_t *, bool is_interlaced);
 
+/* Presentation feedback of the display, see vout_display_SendEventPresented() */
+void vout_ReportPresented(vout_thread_t *, vlc_tick_t date, uint64_t sequence);
+void vout_ReportRefreshPeriod(vout_thread_t *, vlc_tick_t period);
+
 #endif // LIBVLC_VOUT_PRIVATE_H
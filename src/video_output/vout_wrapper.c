@@ -49,6 +49,16 @@ static void VoutViewpointMoved(void *sys, const vlc_viewpoint_t *vp)
     var_SetAddress(vout, "viewpoint-moved", (void*)vp);
 }
 
+static void VoutPresented(void *sys, vlc_tick_t date, uint64_t sequence)
+{
+    vout_ReportPresented(sys, date, sequence);
+}
+
+static void VoutRefreshPeriod(void *sys, vlc_tick_t period)
+{
+    vout_ReportRefreshPeriod(sys, period);
+}
+
 /* Minimum number of display picture */
 #define DISPLAY_PICTURE_COUNT (1)
 
@@ -61,7 +71,8 @@ vout_display_t *vout_OpenWrapper(vout_thread_t *vout, vout_thread_private_t *sys
 {
     vout_display_t *vd;
     vout_display_owner_t owner = {
-        .viewpoint_moved = VoutViewpointMoved, .sys = vout,
+        .viewpoint_moved = VoutViewpointMoved, .presented = VoutPresented,
+        .refresh_period = VoutRefreshPeriod, .sys = vout,
     };
     const char *modlist;
     char *modlistbuf = NULL;
@@ -83,7 +94,8 @@ vout_display_t *vout_OpenWrapper(vout_thread_t *vout, vout_thread_private_t *sys
 
     sys->display_pool = NULL;
 
-    const unsigned private_picture  = 4; /* XXX 3 for filter, 1 for SPU */
+    /* XXX 3 for filter, 1 for SPU, and the prerendered ones */
+    const unsigned private_picture  = 4 + sys->queued_pictures;
     const unsigned kept_picture     = 1; /* last displayed picture */
     const unsigned reserved_picture = DISPLAY_PICTURE_COUNT +
                                       private_picture +
@@ -690,6 +690,12 @@ unsigned vlc_GetCPUCount (void)
     return systemInfo.dwNumberOfProcessors;
 }
 
+int vlc_thread_SetAffinity(const char *cpus)
+{
+    VLC_UNUSED(cpus);
+    return ENOTSUP;
+}
+
 
 /*** Initialization ***/
 static SRWLOCK setup_lock = SRWLOCK_INIT; /* FIXME: use INIT_ONCE */
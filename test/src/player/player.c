@@ -197,6 +197,7 @@ struct media_params
     bool null_names;
 
     const char *config;
+    const char *const *options; /* NULL terminated input item options */
 };
 
 #define DEFAULT_MEDIA_PARAMS(param_length) { \
@@ -218,6 +219,7 @@ struct media_params
     .error = false, \
     .null_names = false, \
     .config = NULL, \
+    .options = NULL, \
 }
 
 struct ctx
@@ -729,6 +731,11 @@ create_mock_media(const char *name, const struct media_params *params)
     input_item_t *item = input_item_New(url, name);
     assert(item);
     free(url);
+    for (const char *const *opt = params->options; opt && *opt; ++opt)
+    {
+        ret = input_item_AddOption(item, *opt, VLC_INPUT_OPTION_TRUSTED);
+        assert(ret == VLC_SUCCESS);
+    }
     return item;
 }
 
@@ -2094,6 +2101,130 @@ test_outputs(struct ctx *ctx)
     test_end(ctx);
 }
 
+static void
+test_latency_stats(struct ctx *ctx)
+{
+    test_log("latency_stats\n");
+    vlc_player_t *player = ctx->player;
+
+    struct media_params params = DEFAULT_MEDIA_PARAMS(VLC_TICK_FROM_MS(200));
+    player_set_current_mock_media(ctx, "media1", &params, false);
+    input_item_t *media = vlc_player_GetCurrentMedia(player);
+    input_item_Hold(media);
+    player_start(ctx);
+
+    wait_state(ctx, VLC_PLAYER_STATE_STOPPED);
+
+    /* The statistics are computed one last time when the input ends */
+    vlc_mutex_lock(&media->lock);
+    assert(media->p_stats != NULL);
+    const struct input_stats_latency_t *lats[] = {
+        media->p_stats->video_latency, media->p_stats->audio_latency,
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(lats); ++i)
+    {
+        const struct input_stats_latency_t *total =
+            &lats[i][INPUT_STATS_LATENCY_TOTAL];
+        assert(total->max != VLC_TICK_INVALID);
+        assert(total->p50 <= total->p99 && total->p99 <= total->max);
+
+        for (int j = 0; j < INPUT_STATS_LATENCY_TOTAL; ++j)
+            if (lats[i][j].max != VLC_TICK_INVALID)
+                assert(lats[i][j].p50 <= lats[i][j].p99
+                    && lats[i][j].p99 <= lats[i][j].max);
+    }
+    vlc_mutex_unlock(&media->lock);
+    input_item_Release(media);
+
+    test_end(ctx);
+}
+
+static void
+test_live_latency(struct ctx *ctx)
+{
+    test_log("live_latency\n");
+    vlc_player_t *player = ctx->player;
+
+    /* A live capture with a caching way over the latency target */
+    static const char *const options[] = {
+        ":mock-realtime", ":mock-can_control_pace=0", ":mock-pts_delay=2000",
+        ":live-latency=400", NULL,
+    };
+    const vlc_tick_t target = VLC_TICK_FROM_MS(400);
+    struct media_params params = DEFAULT_MEDIA_PARAMS(VLC_TICK_FROM_MS(500));
+    params.audio_sample_length = VLC_TICK_FROM_MS(20);
+    params.track_count[SPU_ES] = 0;
+    params.options = options;
+
+    player_set_current_mock_media(ctx, "media1", &params, false);
+    input_item_t *media = vlc_player_GetCurrentMedia(player);
+    input_item_Hold(media);
+    player_start(ctx);
+
+    wait_state(ctx, VLC_PLAYER_STATE_STOPPED);
+
+    vlc_mutex_lock(&media->lock);
+    assert(media->p_stats != NULL);
+    const struct input_stats_latency_t *lats[] = {
+        media->p_stats->video_latency, media->p_stats->audio_latency,
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(lats); ++i)
+    {
+        const struct input_stats_latency_t *total =
+            &lats[i][INPUT_STATS_LATENCY_TOTAL];
+        assert(total->max != VLC_TICK_INVALID);
+        assert(total->p50 <= target);
+        assert(total->p99 <= target);
+
+        /* Queued in the decoder fifo: caching, jitter and decoder shares */
+        assert(lats[i][INPUT_STATS_LATENCY_DEMUX].p99
+               <= target / 2 + target / 10 + target / 5);
+        /* Queued in the outputs: caching, jitter and output shares */
+        assert(lats[i][INPUT_STATS_LATENCY_VOUT].p99
+               <= target / 2 + target / 10 + target / 5);
+        assert(lats[i][INPUT_STATS_LATENCY_DISPLAY].p99
+               <= target / 2 + target / 10 + target / 5);
+    }
+    vlc_mutex_unlock(&media->lock);
+    input_item_Release(media);
+
+    test_end(ctx);
+}
+
+static void
+test_dec_pipeline(struct ctx *ctx)
+{
+    test_log("dec_pipeline\n");
+    vlc_player_t *player = ctx->player;
+
+    /* Not packetized: the decoder modules run on the pipeline threads */
+    static const char *const options[] = { ":dec-pipeline", NULL };
+    struct media_params params = DEFAULT_MEDIA_PARAMS(VLC_TICK_FROM_MS(200));
+    params.audio_sample_length = VLC_TICK_FROM_MS(20);
+    params.video_packetized = params.audio_packetized = false;
+    params.track_count[SPU_ES] = 0;
+    params.options = options;
+
+    player_set_current_mock_media(ctx, "media1", &params, false);
+    input_item_t *media = vlc_player_GetCurrentMedia(player);
+    input_item_Hold(media);
+    player_start(ctx);
+
+    /* Flush the pipelines while decoding */
+    vlc_player_SetTimeFast(player, VLC_TICK_FROM_MS(100));
+
+    wait_state(ctx, VLC_PLAYER_STATE_STOPPED);
+
+    vlc_mutex_lock(&media->lock);
+    assert(media->p_stats != NULL);
+    assert(media->p_stats->i_decoded_video > 0);
+    assert(media->p_stats->i_decoded_audio > 0);
+    vlc_mutex_unlock(&media->lock);
+    input_item_Release(media);
+
+    test_end(ctx);
+}
+
 static void
 ctx_destroy(struct ctx *ctx)
 {
@@ -2925,6 +3056,9 @@ main(void)
     test_programs(&ctx);
     test_timers(&ctx);
     test_teletext(&ctx);
+    test_latency_stats(&ctx);
+    test_live_latency(&ctx);
+    test_dec_pipeline(&ctx);
 
     test_delete_while_playback(VLC_OBJECT(ctx.vlc->p_libvlc_int), true);
     test_delete_while_playback(VLC_OBJECT(ctx.vlc->p_libvlc_int), false);
@@ -42,6 +42,7 @@ const char vlc_module_name[] = MODULE_STRING;
 #include <vlc_player.h>
 #include <vlc_filter.h>
 #include <vlc_vout_display.h>
+#include <vlc_tracer.h>
 
 #include <limits.h>
 
@@ -167,8 +168,28 @@ static int OpenWindow(vlc_window_t *wnd)
 
 static void Display(vout_display_t *vd, picture_t *picture)
 {
-    (void) vd;
-    (void) picture;
+    struct vout_scenario *scenario = &vout_scenarios[current_scenario];
+    if (scenario->display_display != NULL)
+        scenario->display_display(vd, picture);
+}
+
+static void Trace(void *data, vlc_tick_t ts, va_list entries)
+{
+    (void)data; (void)ts;
+    struct vout_scenario *scenario = &vout_scenarios[current_scenario];
+    if (scenario->trace != NULL)
+        scenario->trace(entries);
+}
+
+static const struct vlc_tracer_operations *
+OpenTracer(vlc_object_t *obj, void **restrict sysp)
+{
+    (void)obj; (void)sysp;
+    static const struct vlc_tracer_operations ops =
+    {
+        .trace = Trace,
+    };
+    return &ops;
 }
 
 static int OpenDisplay(vout_display_t *vd, video_format_t *fmtp,
@@ -211,6 +232,9 @@ static void play_scenario(intf_thread_t *intf, struct vout_scenario *scenario)
     var_Create(intf, "window", VLC_VAR_STRING);
     var_SetString(intf, "window", MODULE_STRING);
 
+    var_Create(intf, "vout-pipeline", VLC_VAR_BOOL);
+    var_SetBool(intf, "vout-pipeline", scenario->pipeline);
+
     vlc_player_t *player = vlc_player_New(&intf->obj,
         VLC_PLAYER_LOCK_NORMAL, NULL, NULL);
     assert(player);
@@ -225,6 +249,7 @@ static void play_scenario(intf_thread_t *intf, struct vout_scenario *scenario)
     vlc_player_Delete(player);
     input_item_Release(media);
 
+    var_Destroy(intf, "vout-pipeline");
     var_Destroy(intf, "vout");
     var_Destroy(intf, "codec");
 }
@@ -275,6 +300,10 @@ vlc_module_begin()
         set_callback(OpenDisplay)
         set_capability("vout display", 0)
 
+    add_submodule()
+        set_callback(OpenTracer)
+        set_capability("tracer", 0)
+
     /* Interface module to avoid casting libvlc_instance_t to object */
     add_submodule()
         set_callback(OpenIntf)
@@ -300,7 +329,7 @@ int main( int argc, char **argv )
     const char * const args[] = {
         "-vvv", "--vout=dummy", "--aout=dummy", "--text-renderer=dummy",
         "--no-auto-preparse", "--dec-dev=" MODULE_STRING,
-        "--no-spu", "--no-osd",
+        "--no-spu", "--no-osd", "--tracer=" MODULE_STRING,
     };
 
     libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
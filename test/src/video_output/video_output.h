@@ -41,6 +41,8 @@ struct vout_scenario {
     void (*display_display)(vout_display_t *, picture_t *);
     void (*filter_setup)(filter_t *);
     void (*converter_setup)(filter_t *);
+    void (*trace)(va_list entries);
+    bool pipeline; /* --vout-pipeline */
 };
 
 
@@ -32,6 +32,7 @@
 #include "video_output.h"
 
 #include <vlc_filter.h>
+#include <vlc_tracer.h>
 #include <vlc_vout_display.h>
 
 static struct scenario_data
@@ -42,6 +43,11 @@ static struct scenario_data
     bool converter_opened;
     bool display_opened;
     bool test_finished;
+    vlc_tick_t display_date;
+    vlc_tick_t flip_date;
+    vlc_tick_t flip_period;
+    vlc_tick_t mode_period;
+    unsigned presented_count;
 
     vlc_fourcc_t display_chroma;
 } scenario_data;
@@ -114,6 +120,22 @@ end:
     block_Release(block);
 }
 
+static void decoder_decode_frame(decoder_t *dec, block_t *block)
+{
+    if (decoder_UpdateVideoOutput(dec, NULL) == 0)
+    {
+        const picture_resource_t resource = {
+            .p_sys = NULL,
+        };
+        picture_t *pic = picture_NewFromResource(&dec->fmt_out.video, &resource);
+        assert(pic);
+        pic->date = block->i_pts;
+        pic->b_progressive = true;
+        decoder_QueueVideo(dec, pic);
+    }
+    block_Release(block);
+}
+
 static int display_fixed_size(vout_display_t *vd, video_format_t *fmtp,
         struct vlc_video_context *vctx, vlc_fourcc_t chroma,
         unsigned width, unsigned height)
@@ -148,6 +170,86 @@ static int display_800_600_fail_second_time(
         struct vlc_video_context *vctx)
     { return display_fail_second_time(vd, fmtp, vctx, 800, 600); }
 
+static int display_800_600(vout_display_t *vd, video_format_t *fmtp,
+        struct vlc_video_context *vctx)
+    { return display_fixed_size(vd, fmtp, vctx, fmtp->i_chroma, 800, 600); }
+
+static void display_in_order(vout_display_t *vd, picture_t *pic)
+{
+    (void)vd;
+    /* The pictures prerendered ahead are still displayed in order */
+    assert(pic->date > scenario_data.display_date);
+    scenario_data.display_date = pic->date;
+
+    if (++scenario_data.display_picture_count == 5)
+        vlc_sem_post(&scenario_data.wait_stop);
+}
+
+static int display_800_600_mode(vout_display_t *vd, video_format_t *fmtp,
+        struct vlc_video_context *vctx)
+{
+    /* Report the refresh period of a 100 Hz mode */
+    scenario_data.mode_period = VLC_TICK_FROM_MS(10);
+    vout_display_SendEventRefreshPeriod(vd, scenario_data.mode_period);
+    return display_800_600(vd, fmtp, vctx);
+}
+
+static void display_flip(vout_display_t *vd, picture_t *pic, bool counter)
+{
+    /* Report a scanout at the next vblank of a 10 ms grid, from which the
+     * next pictures are scheduled */
+    const vlc_tick_t period = VLC_TICK_FROM_MS(10);
+    const uint64_t sequence = vlc_tick_now() / period + 1;
+
+    scenario_data.flip_date = sequence * period;
+    scenario_data.flip_period = period;
+    vout_display_SendEventPresented(vd, sequence * period,
+                                    counter ? sequence : 0);
+
+    /* The last picture can be displayed again */
+    assert(pic->date >= scenario_data.display_date);
+    scenario_data.display_date = pic->date;
+
+    if (++scenario_data.display_picture_count == 10)
+        vlc_sem_post(&scenario_data.wait_stop);
+}
+
+static void display_presented(vout_display_t *vd, picture_t *pic)
+    { display_flip(vd, pic, true); }
+
+static void display_presented_no_counter(vout_display_t *vd, picture_t *pic)
+    { display_flip(vd, pic, false); }
+
+static void trace_presented(va_list entries)
+{
+    const char *event = NULL;
+    vlc_tick_t vblank = VLC_TICK_INVALID, period = 0;
+
+    for (struct vlc_tracer_entry entry = va_arg(entries, struct vlc_tracer_entry);
+         entry.key != NULL;
+         entry = va_arg(entries, struct vlc_tracer_entry))
+    {
+        if (strcmp(entry.key, "event") == 0)
+            event = entry.value.string;
+        else if (strcmp(entry.key, "vblank") == 0)
+            vblank = entry.value.integer;
+        else if (strcmp(entry.key, "vblank_period") == 0)
+            period = entry.value.integer;
+    }
+
+    if (event == NULL || strcmp(event, "presented") != 0)
+        return;
+
+    /* The presentation is the flip reported by the display, and the vblank
+     * period is the one of the mode, or measured from the flips */
+    assert(vblank == scenario_data.flip_date);
+    if (scenario_data.mode_period != 0)
+        assert(period == scenario_data.mode_period);
+    else
+        assert(period == 0 || period == scenario_data.flip_period);
+    scenario_data.presented_count++;
+}
+
 const char source_800_600[] = "mock://video_track_count=1;length=100000000000;video_width=800;video_height=600";
 struct vout_scenario vout_scenarios[] =
 {{
@@ -155,6 +257,27 @@ struct vout_scenario vout_scenarios[] =
     .decoder_setup = decoder_rgba_800_600,
     .decoder_decode = decoder_decode_change_chroma,
     .display_setup = display_800_600_fail_second_time,
+},{
+    .source = source_800_600,
+    .decoder_setup = decoder_rgba_800_600,
+    .decoder_decode = decoder_decode_frame,
+    .display_setup = display_800_600,
+    .display_display = display_in_order,
+    .pipeline = true,
+},{
+    .source = source_800_600,
+    .decoder_setup = decoder_rgba_800_600,
+    .decoder_decode = decoder_decode_frame,
+    .display_setup = display_800_600,
+    .display_display = display_presented,
+    .trace = trace_presented,
+},{
+    .source = source_800_600,
+    .decoder_setup = decoder_rgba_800_600,
+    .decoder_decode = decoder_decode_frame,
+    .display_setup = display_800_600_mode,
+    .display_display = display_presented_no_counter,
+    .trace = trace_presented,
 }};
 size_t vout_scenarios_count = ARRAY_SIZE(vout_scenarios);
 
@@ -165,6 +288,11 @@ void vout_scenario_init(void)
     scenario_data.converter_opened = false;
     scenario_data.display_opened = false;
     scenario_data.test_finished = false;
+    scenario_data.display_date = VLC_TICK_INVALID;
+    scenario_data.flip_date = VLC_TICK_INVALID;
+    scenario_data.flip_period = 0;
+    scenario_data.mode_period = 0;
+    scenario_data.presented_count = 0;
     vlc_sem_init(&scenario_data.wait_stop, 0);
 }
 
@@ -176,4 +304,7 @@ void vout_scenario_wait(struct vout_scenario *scenario)
 
     if (scenario->display_setup != NULL)
         assert(scenario_data.display_opened);
+
+    if (scenario->trace != NULL)
+        assert(scenario_data.presented_count > 0);
 }